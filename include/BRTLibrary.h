@@ -45,7 +45,9 @@
 #include "ProcessingModules/DirectivityConvolver.hpp"
 #include "ServiceModules/SphericalFIRTable.hpp"
 #include "ServiceModules/SphericalInterpolatedFIRTable.hpp"
+#include "ServiceModules/SphericalHarmonicFIRTable.hpp"
 #include "ServiceModules/SphericalSOSTable.hpp"
+#include "ServiceModules/HRTFRegistry.hpp"
 #include "ServiceModules/Room.hpp"
 
 #include "EnvironmentModels/SDNEnvironmentModel.hpp"
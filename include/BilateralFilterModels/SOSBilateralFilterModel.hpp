@@ -223,8 +223,7 @@ namespace BRTBilateralFilter {
 			
 			if (inputLeftBuffer.size() == 0 || inputRightBuffer.size() == 0) return;
 						
-			sosFilter.Process(inputLeftBuffer, outLeftBuffer, Common::T_ear::LEFT);
-			sosFilter.Process(inputRightBuffer, outRightBuffer, Common::T_ear::RIGHT);
+			sosFilter.Process(inputLeftBuffer, outLeftBuffer, inputRightBuffer, outRightBuffer);
 			
 			if (enableModel) {
 				outLeftBuffer.ApplyGain(gain);
@@ -256,11 +255,11 @@ namespace BRTBilateralFilter {
 				SET_RESULT(RESULT_ERROR_NOTSET, "Error setting up the SOS filter in CSOSBilateralFilterModel");			
 				return false;
 			}			
-			bool resultLeft = sosFilter.SetCoefficients(Common::T_ear::LEFT, coefficients.left);
+			bool resultLeft = sosFilter.SetCoefficients(Common::T_ear::LEFT, std::vector<float>(coefficients.left.begin(), coefficients.left.end()));
 			if (!resultLeft) {
 				SET_RESULT(RESULT_ERROR_NOTSET, "Error setting coefficients of the left channel of SOS filter in CSOSBilateralFilterModel");				
 			}
-			bool resultRight = sosFilter.SetCoefficients(Common::T_ear::RIGHT, coefficients.right);
+			bool resultRight = sosFilter.SetCoefficients(Common::T_ear::RIGHT, std::vector<float>(coefficients.right.begin(), coefficients.right.end()));
 			if (!resultRight) {
 				SET_RESULT(RESULT_ERROR_NOTSET, "Error setting coefficients of the right channel of SOS filter in CSOSBilateralFilterModel");
 			}
@@ -0,0 +1,97 @@
+/**
+* \class CAlignedAllocator
+*
+* \brief Declaration of CAlignedAllocator class interface.
+* \detail Standard allocator that aligns the storage of the containers to cache lines and pads it to whole vector registers.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CALIGNED_ALLOCATOR_HPP_
+#define _CALIGNED_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <limits>
+#include <vector>
+
+/** \brief Alignment, in bytes, of the sample buffers and spectra. One cache line, and one AVX-512 register */
+#ifndef BRT_BUFFER_ALIGNMENT
+#define BRT_BUFFER_ALIGNMENT 64
+#endif
+
+namespace Common {
+
+	/** \details Allocator for std::vector that returns storage aligned to Alignment bytes, with its size rounded up to a multiple of
+	*	Alignment. The first element of the container is aligned, and the last vector register of a vectorized loop can be loaded
+	*	entirely without reading outside the allocation.
+	*	\tparam T element type
+	*	\tparam Alignment alignment in bytes, a power of two
+	*/
+	template <class T, std::size_t Alignment = BRT_BUFFER_ALIGNMENT>
+	class CAlignedAllocator {
+		static_assert((Alignment & (Alignment - 1)) == 0, "The alignment has to be a power of two");
+		static_assert(Alignment >= alignof(T), "The alignment has to be at least the alignment of the element type");
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using propagate_on_container_move_assignment = std::true_type;
+		using is_always_equal = std::true_type;
+
+		template <class U>
+		struct rebind {
+			using other = CAlignedAllocator<U, Alignment>;
+		};
+
+		CAlignedAllocator() noexcept = default;
+
+		template <class U>
+		CAlignedAllocator(const CAlignedAllocator<U, Alignment> &) noexcept { }
+
+		T * allocate(std::size_t n)
+		{
+			if (n > std::numeric_limits<std::size_t>::max() / sizeof(T) - Alignment) throw std::bad_array_new_length();
+			return static_cast<T *>(::operator new(PaddedSize(n), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T * p, std::size_t n) noexcept
+		{
+			::operator delete(p, PaddedSize(n), std::align_val_t(Alignment));
+		}
+
+		template <class U>
+		bool operator==(const CAlignedAllocator<U, Alignment> &) const noexcept { return true; }
+		template <class U>
+		bool operator!=(const CAlignedAllocator<U, Alignment> &) const noexcept { return false; }
+
+	private:
+		// Size in bytes of the allocation of n elements, rounded up to a multiple of the alignment
+		static std::size_t PaddedSize(std::size_t n)
+		{
+			return (n * sizeof(T) + Alignment - 1) & ~(Alignment - 1);
+		}
+	};
+
+	/** \brief std::vector with aligned and padded storage
+	*/
+	template <class T>
+	using TAlignedVector = std::vector<T, CAlignedAllocator<T>>;
+}
+#endif
@@ -30,8 +30,12 @@
 #include <vector>
 #include <algorithm>
 #include <cassert>
+#include <type_traits>
+#include <initializer_list>
 #include <Common/ErrorHandler.hpp>
 #include <Common/GlobalParameters.hpp>
+#include <Common/BufferKernels.hpp>
+#include <Common/AlignedAllocator.hpp>
 //#include <initializer_list>
 
 /*! \file */
@@ -39,17 +43,18 @@
 namespace Common {
 
 	/** \details This is a template class to manage audio streamers and buffers
+	*	\details Samples are stored aligned to BRT_BUFFER_ALIGNMENT bytes, with the storage padded to a multiple of it (see CAlignedAllocator)
 	*/
 	template <unsigned int NChannels, class stored>
 	
-	class CBuffer : public std::vector<stored, std::allocator<stored>>
+	class CBuffer : public TAlignedVector<stored>
 	{
 	public:
-		using std::vector<stored>::vector;    //   inherit all std::vector constructors
-		using std::vector<stored>::size;      //   MacOSX clang seems to need this to compile
-		using std::vector<stored>::begin;     //   MacOSX clang seems to need this to compile
-		using std::vector<stored>::end;       //   MacOSX clang seems to need this to compile
-		using std::vector<stored>::resize;     //   MacOSX clang seems to need this to compile
+		using TAlignedVector<stored>::vector;    //   inherit all std::vector constructors
+		using TAlignedVector<stored>::size;      //   MacOSX clang seems to need this to compile
+		using TAlignedVector<stored>::begin;     //   MacOSX clang seems to need this to compile
+		using TAlignedVector<stored>::end;       //   MacOSX clang seems to need this to compile
+		using TAlignedVector<stored>::resize;     //   MacOSX clang seems to need this to compile
 
 		/** \brief Get number of channels in the buffer
 		*	\retval nChannels number of channels
@@ -70,7 +75,11 @@ namespace Common {
 			//ASSERT(GetNChannels() == oth.GetNChannels(), "Attempt to mix two buffers of different sizes", ""); 
 			//ASSERT(size() == oth.size(), "Attempt to mix two buffers of different sizes", "");
 
-			std::transform(begin(), end(), oth.begin(), begin(), [](stored a, stored b) { return a + b; });
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::Add(this->data(), oth.data(), size());
+			} else {
+				std::transform(begin(), end(), oth.begin(), begin(), [](stored a, stored b) { return a + b; });
+			}
 			return *this;
 		}
 
@@ -84,7 +93,11 @@ namespace Common {
 			//ASSERT(GetNChannels() == oth.GetNChannels(), "Attempt to mix two buffers of different sizes", ""); 
 			//ASSERT(size() == oth.size(), "Attempt to mix two buffers of different sizes", "");
 
-			std::transform(begin(), end(), oth.begin(), begin(), [](stored a, stored b) { return a - b; });
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::Subtract(this->data(), oth.data(), size());
+			} else {
+				std::transform(begin(), end(), oth.begin(), begin(), [](stored a, stored b) { return a - b; });
+			}
 			return *this;
 		}
 
@@ -115,7 +128,11 @@ namespace Common {
 		void ApplyGain(stored gain)
 		{
 			//SET_RESULT(RESULT_OK, "Gain applied to buffer succesfully");
-			std::for_each(begin(), end(), [gain](stored & a) { a *= gain; });
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::Scale(this->data(), gain, size());
+			} else {
+				std::for_each(begin(), end(), [gain](stored & a) { a *= gain; });
+			}
 		}
 
 		/** \brief Multiply the values in the buffer by a no-constant gain (calculate using Weighted moving average method)
@@ -131,6 +148,12 @@ namespace Common {
 
 			//Apply atennuation to each sample
 			int nChannels = GetNChannels();
+			if constexpr (std::is_same_v<stored, float>) {
+				if (nChannels == 1 || nChannels == 2) {
+					CBufferKernels::ApplyLinearRamp(this->data(), size() / nChannels, nChannels, previousAttenuation, attenuationInc);
+					return;
+				}
+			}
 			if (nChannels == 1)
 			{
 				int i = 0;
@@ -153,6 +176,18 @@ namespace Common {
 			}
 		}
 
+		/** \brief Get the smoothing factor used by ApplyGainExponentially
+		*	\param [in] sampleRate sample rate, in Hz
+		*	\retval alpha fraction of the distance to the target gain covered in each sample
+		*   \eh Nothing is reported to the error handler.
+		*/
+		static float CalculateExponentialGainAlpha(int sampleRate)
+		{
+			float denominator = ATTACK_TIME_DISTANCE_ATTENUATION * sampleRate;
+			if (denominator > EPSILON_ATTACK_SAMPLES) { return 1 - std::exp(1000 * std::log(0.01f) / denominator); }
+			return 1;
+		}
+
 		/** \brief Multiply the values in the buffer by a no-constant gain (calculate using Exponential moving average method)
 		*	\param [in] previousAttenuation_Channel1 Last frame attenuation, for mono buffers or left channel of stereo buffer
 		*	\param [in] previousAttenuation_Channel2 Last frame attenuation, for right channel of stereo buffer
@@ -167,15 +202,21 @@ namespace Common {
 			float gainChannel2 = 0.0f;
 			float previousGainChannel1 = previousAttenuation_Channel1;
 			float gainChannel1 = 0.0f;
-			float alpha;
-
-			//Calculate alpha
-			float denominator = ATTACK_TIME_DISTANCE_ATTENUATION * sampleRate;
-			if (denominator > EPSILON_ATTACK_SAMPLES) { alpha = 1 - std::exp(1000 * std::log(0.01f) / denominator); }
-			else { alpha = 1; }
+			float alpha = CalculateExponentialGainAlpha(sampleRate);
 
 			//Apply atennuation to each sample
 			int nChannels = GetNChannels();
+			if constexpr (std::is_same_v<stored, float>) {
+				if (nChannels == 1) {
+					CBufferKernels::ApplyExponentialRamp(this->data(), size(), 1, previousAttenuation_Channel1, attenuation, alpha);
+					return;
+				}
+				if (nChannels == 2) {
+					CBufferKernels::ApplyExponentialRamp(this->data(), size() / 2, 2, previousAttenuation_Channel1, attenuation, alpha);
+					CBufferKernels::ApplyExponentialRamp(this->data() + 1, size() / 2, 2, previousAttenuation_Channel2, attenuation, alpha);
+					return;
+				}
+			}
 			if (nChannels == 1)
 			{
 				int j = 0;
@@ -310,6 +351,11 @@ namespace Common {
 			//if (GetNChannels() != 1)
 			//	return stereoBuffer; // <- this wont work
 
+			if constexpr (std::is_same_v<stored, float>) {
+				stereoBuffer.resize(2 * size());
+				CBufferKernels::Interlace(this->data(), this->data(), stereoBuffer.data(), size());
+				return stereoBuffer;
+			}
 			for (int i = 0; i < size(); i++)
 			{
 				stereoBuffer.push_back((*this)[i]);
@@ -336,6 +382,11 @@ namespace Common {
 			//if (GetNChannels() != 1)
 			//	return stereoBuffer; // <- this wont work
 
+			if constexpr (std::is_same_v<stored, float>) {
+				stereoBuffer.resize(2 * size());
+				CBufferKernels::MonoToStereo(this->data(), stereoBuffer.data(), size(), leftGain, rightGain);
+				return stereoBuffer;
+			}
 			for (int i = 0; i < size(); i++)
 			{
 				stereoBuffer.push_back(leftGain  * (*this)[i]);
@@ -455,6 +506,12 @@ namespace Common {
 			ASSERT(left.size() == right.size(), RESULT_ERROR_BADSIZE, "Attempt to interlace two mono buffers of different length", "");
 			//SET_RESULT(RESULT_OK, "Stereo buffer interlaced from two mono buffers succesfully");
 
+			if constexpr (std::is_same_v<stored, float>) {
+				this->resize(2 * left.size());
+				CBufferKernels::Interlace(left.data(), right.data(), this->data(), left.size());
+				return;
+			}
+
 			// Start with a clean buffer
 			this->clear();
 			this->reserve(2 * left.size());
@@ -479,6 +536,13 @@ namespace Common {
 			ASSERT(GetNChannels() == 2, RESULT_ERROR_BADSIZE, "Attempt to deinterlace a non-stereo buffer", "");
 			//SET_RESULT(RESULT_OK, "Stereo buffer deinterlaced into two mono buffers succesfully");
 
+			if constexpr (std::is_same_v<stored, float>) {
+				left.resize(this->GetNsamples());
+				right.resize(this->GetNsamples());
+				CBufferKernels::Deinterlace(this->data(), left.data(), right.data(), this->GetNsamples());
+				return;
+			}
+
 			// Start with clean buffers
 			left.clear();
 			right.clear();
@@ -543,6 +607,11 @@ namespace Common {
 				ASSERT((*it).size() == bufferSize, RESULT_ERROR_BADSIZE, "Attempt to mix buffers with different sizes", "");
 			}
 
+			if constexpr (std::is_same_v<stored, float>) {
+				MixWithKernels(sourceBuffers.begin(), sourceBuffers.end(), bufferSize);
+				return;
+			}
+
 			// Iterate through all samples
 			this->clear();
 			for (int i = 0; i < bufferSize; i++)
@@ -557,24 +626,29 @@ namespace Common {
 			}
 		}
 
-		void SetFromMix(std::vector <CBuffer> sourceBuffers)
+		void SetFromMix(const std::vector <CBuffer> & sourceBuffers)
 		{
 			// Get size of all sourceBuffers and check they are the same
 			size_t bufferSize = 0;
-			for (typename std::vector<CBuffer>::iterator it = sourceBuffers.begin(); it != sourceBuffers.end(); ++it)
+			for (typename std::vector<CBuffer>::const_iterator it = sourceBuffers.begin(); it != sourceBuffers.end(); ++it)
 			{
 				if (bufferSize == 0)
 					bufferSize = (*it).size();
 				ASSERT((*it).size() == bufferSize, RESULT_ERROR_BADSIZE, "Attempt to mix buffers with different sizes", "");
 			}
 
+			if constexpr (std::is_same_v<stored, float>) {
+				MixWithKernels(sourceBuffers.begin(), sourceBuffers.end(), bufferSize);
+				return;
+			}
+
 			// Iterate through all samples
 			this->clear();
 			for (int i = 0; i < bufferSize; i++)
 			{
 				// Iterate through all source buffers
 				float sum = 0.0f;
-				for (typename std::vector<CBuffer>::iterator it = sourceBuffers.begin(); it != sourceBuffers.end(); ++it)
+				for (typename std::vector<CBuffer>::const_iterator it = sourceBuffers.begin(); it != sourceBuffers.end(); ++it)
 				{
 					sum += (*it)[i];
 				}
@@ -760,6 +834,19 @@ namespace Common {
 			
 			return overlapedSamples <= 0 ? 0 : acum / ((float)overlapedSamples);
 		}
+
+	private:
+
+		/** \brief Set this buffer to the sum of the buffers in [first, last), adding them in order, as SetFromMix does
+		*/
+		template <typename TIterator>
+		void MixWithKernels(TIterator first, TIterator last, size_t bufferSize)
+		{
+			this->assign(bufferSize, 0.0f);
+			for (TIterator it = first; it != last; ++it) {
+				CBufferKernels::Add(this->data(), (*it).data(), bufferSize);
+			}
+		}
 	};
 }
 
@@ -773,14 +860,6 @@ using CMonoBuffer = Common::CBuffer<1,stored>;
 template<class stored>
 using CStereoBuffer = Common::CBuffer<2,stored>;
 
-/** \brief Non-enforcing buffer 
-*	\details Current implementation does not inherits from CBuffer
-*/
-template<class stored>
-using CMultiChannelBuffer = std::vector<stored>; // TO DO: why isnt it CBuffer?????
-
-
-
 namespace Common
 {
 	/** \brief Stream output for float Mono buffers
@@ -0,0 +1,212 @@
+/**
+* \class CBufferKernels
+*
+* \brief Declaration of CBufferKernels class interface.
+* \detail Sample loops behind the arithmetic, gain and interlacing methods of CBuffer for float samples.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CBUFFER_KERNELS_HPP_
+#define _CBUFFER_KERNELS_HPP_
+
+#include <cstddef>
+#include <algorithm>
+
+/** \brief Runtime CPU dispatch of the buffer kernels
+*	\details With GCC on x86 ELF targets every kernel is compiled for AVX2 and for the baseline instruction set, and the best version
+*	for the running CPU is selected when the program is loaded. FMA is not enabled, so all versions give the same results. The
+*	kernels are vectorized with the dynamic cost model, since GCC only vectorizes loops with a known trip count at -O2.
+*	Elsewhere the kernels are compiled once for the target of the build. Define BRT_DISABLE_KERNEL_DISPATCH to turn it off.
+*/
+#if !defined(BRT_DISABLE_KERNEL_DISPATCH) && defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__)) && defined(__ELF__)
+#define BRT_KERNEL_DISPATCH __attribute__((target_clones("avx2", "default"), optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#else
+#define BRT_KERNEL_DISPATCH
+#endif
+
+#if defined(_MSC_VER)
+#define BRT_RESTRICT __restrict
+#else
+#define BRT_RESTRICT __restrict__
+#endif
+
+namespace Common {
+
+	/** \details Float sample kernels used by CBuffer. They are simple loops over contiguous samples, with non aliased pointers and no
+	*	loop carried dependencies, so that they are vectorized by the compiler.
+	*/
+	class CBufferKernels {
+	public:
+
+		/** \brief dst[i] += src[i]. dst and src may be the same buffer
+		*/
+		static void Add(float * dst, const float * src, std::size_t n)
+		{
+			if (dst == src) Scale(dst, 2.0f, n);
+			else AddDistinct(dst, src, n);
+		}
+
+		/** \brief dst[i] -= src[i]. dst and src may be the same buffer
+		*/
+		static void Subtract(float * dst, const float * src, std::size_t n)
+		{
+			if (dst == src) Scale(dst, 0.0f, n);
+			else SubtractDistinct(dst, src, n);
+		}
+
+		/** \brief dst[i] += src[i], dst and src do not overlap
+		*/
+		BRT_KERNEL_DISPATCH
+		static void AddDistinct(float * BRT_RESTRICT dst, const float * BRT_RESTRICT src, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) dst[i] += src[i];
+		}
+
+		/** \brief dst[i] -= src[i], dst and src do not overlap
+		*/
+		BRT_KERNEL_DISPATCH
+		static void SubtractDistinct(float * BRT_RESTRICT dst, const float * BRT_RESTRICT src, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) dst[i] -= src[i];
+		}
+
+		/** \brief dst[i] *= gain
+		*/
+		BRT_KERNEL_DISPATCH
+		static void Scale(float * BRT_RESTRICT dst, float gain, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) dst[i] *= gain;
+		}
+
+		/** \brief dst[i] += gain * src[i], dst and src do not overlap
+		*/
+		BRT_KERNEL_DISPATCH
+		static void MultiplyAccumulate(float * BRT_RESTRICT dst, const float * BRT_RESTRICT src, float gain, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i++) dst[i] += gain * src[i];
+		}
+
+		/** \brief Multiply every frame by a linear ramp, gain = startGain + gainIncrement * frame
+		*	\param [in,out] dst interlaced samples
+		*	\param [in] nFrames number of frames
+		*	\param [in] nChannels number of channels, 1 or 2
+		*/
+		BRT_KERNEL_DISPATCH
+		static void ApplyLinearRamp(float * BRT_RESTRICT dst, std::size_t nFrames, std::size_t nChannels, float startGain, float gainIncrement)
+		{
+			if (nChannels == 1) {
+				for (std::size_t i = 0; i < nFrames; i++) dst[i] *= startGain + gainIncrement * static_cast<float>(static_cast<int>(i));
+			} else {
+				for (std::size_t i = 0; i < nFrames; i++) {
+					const float gain = startGain + gainIncrement * static_cast<float>(static_cast<int>(i));
+					dst[2 * i] *= gain;
+					dst[2 * i + 1] *= gain;
+				}
+			}
+		}
+
+		/** \brief Multiply the samples of one channel by a gain that approaches targetGain exponentially
+		*	\details Sample k is multiplied by the gain after k + 1 steps of gain += (targetGain - gain) * alpha. The gain of each sample is
+		*	computed from the distance to the target at the start of a block of samples, so the samples of a block are independent.
+		*	\param [in,out] dst interlaced samples
+		*	\param [in] nFrames number of frames
+		*	\param [in] stride number of channels
+		*	\param [in,out] gain gain before the first sample, updated to the gain of the last sample
+		*	\param [in] targetGain gain to approach
+		*	\param [in] alpha fraction of the distance to the target covered in each sample
+		*/
+		BRT_KERNEL_DISPATCH
+		static void ApplyExponentialRamp(float * BRT_RESTRICT dst, std::size_t nFrames, std::size_t stride, float & gain, float targetGain, float alpha)
+		{
+			constexpr std::size_t BLOCK = 16;
+			const float decay = 1 - alpha;
+			float decayPowers[BLOCK];		// decay^(k+1)
+			float power = decay;
+			for (std::size_t k = 0; k < BLOCK; k++) {
+				decayPowers[k] = power;
+				power *= decay;
+			}
+			const float blockDecay = decayPowers[BLOCK - 1];
+
+			float distance = gain - targetGain;
+			std::size_t i = 0;
+			for (; i + BLOCK <= nFrames; i += BLOCK) {
+				float * block = dst + i * stride;
+				for (std::size_t k = 0; k < BLOCK; k++) block[k * stride] *= targetGain + distance * decayPowers[k];
+				distance *= blockDecay;
+			}
+			float lastGain = targetGain + distance;
+			for (std::size_t k = 0; i < nFrames; i++, k++) {
+				lastGain = targetGain + distance * decayPowers[k];
+				dst[i * stride] *= lastGain;
+			}
+			gain = lastGain;
+		}
+
+		/** \brief dst = left[0], right[0], left[1], right[1]...
+		*/
+		BRT_KERNEL_DISPATCH
+		static void Interlace(const float * BRT_RESTRICT left, const float * BRT_RESTRICT right, float * BRT_RESTRICT dst, std::size_t nFrames)
+		{
+			for (std::size_t i = 0; i < nFrames; i++) {
+				dst[2 * i] = left[i];
+				dst[2 * i + 1] = right[i];
+			}
+		}
+
+		/** \brief Inverse of Interlace
+		*/
+		BRT_KERNEL_DISPATCH
+		static void Deinterlace(const float * BRT_RESTRICT src, float * BRT_RESTRICT left, float * BRT_RESTRICT right, std::size_t nFrames)
+		{
+			for (std::size_t i = 0; i < nFrames; i++) {
+				left[i] = src[2 * i];
+				right[i] = src[2 * i + 1];
+			}
+		}
+
+		/** \brief dst = leftGain * src[0], rightGain * src[0], leftGain * src[1], rightGain * src[1]...
+		*/
+		BRT_KERNEL_DISPATCH
+		static void MonoToStereo(const float * BRT_RESTRICT src, float * BRT_RESTRICT dst, std::size_t nFrames, float leftGain, float rightGain)
+		{
+			for (std::size_t i = 0; i < nFrames; i++) {
+				dst[2 * i] = leftGain * src[i];
+				dst[2 * i + 1] = rightGain * src[i];
+			}
+		}
+
+		/** \brief Read src at the fractional positions startPosition + step * i, with linear interpolation
+		*	\details Each position is computed from its index, without accumulation, and the integer part is clamped to srcSize - 2
+		*	instead of being checked, so the loop has no branches. srcSize has to be at least 2 and the positions in [0, srcSize - 1].
+		*/
+		BRT_KERNEL_DISPATCH
+		static void ResampleLinear(const float * BRT_RESTRICT src, std::size_t srcSize, float * BRT_RESTRICT dst, std::size_t nFrames, float startPosition, float step)
+		{
+			const int lastIndex = static_cast<int>(srcSize) - 2;
+			for (std::size_t i = 0; i < nFrames; i++) {
+				const float position = startPosition + step * static_cast<float>(static_cast<int>(i));
+				const int j = std::min(static_cast<int>(position), lastIndex);
+				const float fraction = position - static_cast<float>(j);
+				dst[i] = src[j] + (src[j + 1] - src[j]) * fraction;
+			}
+		}
+	};
+}
+#endif
@@ -32,6 +32,7 @@
 #include <cmath>
 #include "fftsg.hpp"
 #include "Buffer.hpp"
+#include "ReducedPrecision.hpp"
 
 #ifndef THRESHOLD
 #define THRESHOLD 0.0000001f
@@ -57,7 +58,7 @@ namespace Common {
 		*	\param [in] inputAudioBuffer_time vector containing the samples of input signal in time-domain. N is this buffer size.
 		*	\param [out] outputAudioBuffer_frequency FFT of the input signal. Have a size of B * 2, because contains the real and imaginary parts of each B point.
 		*/
-		static void CalculateFFT(const std::vector<float>& inputAudioBuffer_time, std::vector<float>& outputAudioBuffer_frequency)		
+		static void CalculateFFT(const TAlignedVector<float>& inputAudioBuffer_time, TAlignedVector<float>& outputAudioBuffer_frequency)		
 		{
 			int inputBufferSize = inputAudioBuffer_time.size();
 
@@ -108,7 +109,7 @@ namespace Common {
 		*	\param [out] outputAudioBuffer_frequency FFT of the input signal. Have a size of B * 2 = (N + P + k) * 2, because contains the real and imaginary parts of each B point.
 		*	\param [in] irDataLength is P, the size in the time domain of the other vector which is going to do the convolved with this one in the frequency domain (multiplication).
 		*/
-		static void CalculateFFT(const std::vector<float>& inputAudioBuffer_time, std::vector<float>& outputAudioBuffer_frequency, int irDataLength)		
+		static void CalculateFFT(const TAlignedVector<float>& inputAudioBuffer_time, TAlignedVector<float>& outputAudioBuffer_frequency, int irDataLength)		
 		{
 			int inputBufferSize = inputAudioBuffer_time.size();
 
@@ -160,7 +161,7 @@ namespace Common {
 		*	\pre inputAudioBuffer_frequency has to have the same size that the one returned by any of the CalculateFFT_ methods.
 		*   \throws May throw exceptions and errors to debugger
 		*/
-		static void CalculateIFFT(const std::vector<float>& inputAudioBuffer_frequency, std::vector<float>& outputAudioBuffer_time)		       
+		static void CalculateIFFT(const TAlignedVector<float>& inputAudioBuffer_frequency, TAlignedVector<float>& outputAudioBuffer_time)		       
 		{
 			int inputBufferSize = inputAudioBuffer_frequency.size();
 			ASSERT(inputBufferSize > 0, RESULT_ERROR_BADSIZE, "Bad input size", "");
@@ -208,7 +209,7 @@ namespace Common {
 		*	\pre Both vectors (x and h) have to be the same size
 		*   \throws May throw exceptions and errors to debugger
 		*/
-		static void ProcessComplexMultiplication(const std::vector<float>& x, const std::vector<float>& h, std::vector<float>& y)		       
+		static void ProcessComplexMultiplication(const TAlignedVector<float>& x, const TAlignedVector<float>& h, TAlignedVector<float>& y)		       
 		{
 			ASSERT(x.size() == h.size(), RESULT_ERROR_BADSIZE, "Complex multiplication in frequency convolver requires two vectors of the same size", "");
 
@@ -229,6 +230,72 @@ namespace Common {
 			}
 		}
 
+		/** \brief Multiply two vectors of complex numbers and add the result to a third one, y += x * h.
+		*   \details Same as ProcessComplexMultiplication followed by a sum, but in a single pass and without a temporary buffer.
+		*   \param [in] x Vector of complex numbers, real and imaginary parts interlaced
+		*	\param [in] h Vector of complex numbers, real and imaginary parts interlaced
+		*	\param [in,out] y Accumulated vector of complex numbers, it has to have the same size as x
+		*/
+		static void ProcessComplexMultiplyAccumulate(const TAlignedVector<float>& x, const TAlignedVector<float>& h, TAlignedVector<float>& y)
+		{
+			ASSERT(x.size() == h.size() && x.size() == y.size(), RESULT_ERROR_BADSIZE, "Complex multiply-accumulate in frequency convolver requires three vectors of the same size", "");
+
+			if (x.size() == h.size() && x.size() == y.size())	//Just in case error handler is off
+			{
+				ProcessComplexMultiplyAccumulate(x.data(), h.data(), y.data(), (int)y.size() / 2);
+			}
+		}
+
+		/** \brief Multiply two arrays of complex numbers and add the result to a third one, y += x * h.
+		*   \details Same as the vector version, for spectra that are stored inside a bigger buffer (for instance, one channel of a CMultiChannelBuffer).
+		*   \param [in] x Complex numbers, real and imaginary parts interlaced
+		*	\param [in] h Complex numbers, real and imaginary parts interlaced
+		*	\param [in,out] y Accumulated complex numbers
+		*	\param [in] numberOfComplexValues Number of complex numbers of the three arrays
+		*/
+		static void ProcessComplexMultiplyAccumulate(const float* x, const float* h, float* y, int numberOfComplexValues)
+		{
+			for (int i = 0; i < numberOfComplexValues; i++)
+			{
+				float a = x[2 * i];
+				float b = x[2 * i + 1];
+				float c = h[2 * i];
+				float d = h[2 * i + 1];
+
+				y[2 * i] += a * c - b * d;
+				y[2 * i + 1] += a * d + b * c;
+			}
+		}
+
+		/** \brief Multiply a vector of complex numbers by another one stored with a 16-bit format and add the result to a third one, y += x * h.
+		*   \details The conversion of h to float is done inside the multiply-accumulate loop, so h is read only once with half of the memory bandwidth.
+		*   \param [in] x Vector of complex numbers, real and imaginary parts interlaced
+		*	\param [in] h Complex numbers stored with a 16-bit format, real and imaginary parts interlaced. It has to have the same size as x
+		*	\param [in] hPrecision 16-bit format of h, float16 or bfloat16
+		*	\param [in,out] y Accumulated vector of complex numbers, it has to have the same size as x
+		*/
+		static void ProcessComplexMultiplyAccumulate(const TAlignedVector<float>& x, const uint16_t* h, TSpectralPrecision hPrecision, TAlignedVector<float>& y)
+		{
+			ASSERT(x.size() == y.size(), RESULT_ERROR_BADSIZE, "Complex multiply-accumulate in frequency convolver requires vectors of the same size", "");
+
+			if (x.size() == y.size())	//Just in case error handler is off
+			{
+				ProcessComplexMultiplyAccumulate(x.data(), h, hPrecision, y.data(), (int)y.size() / 2);
+			}
+		}
+
+		/** \brief Same as the vector version, with x and y given as arrays of numberOfComplexValues complex numbers
+		*/
+		static void ProcessComplexMultiplyAccumulate(const float* x, const uint16_t* h, TSpectralPrecision hPrecision, float* y, int numberOfComplexValues)
+		{
+			if (hPrecision == TSpectralPrecision::bfloat16) {
+				ProcessComplexMultiplyAccumulate<TSpectralPrecision::bfloat16>(x, h, y, numberOfComplexValues);
+			}
+			else {
+				ProcessComplexMultiplyAccumulate<TSpectralPrecision::float16>(x, h, y, numberOfComplexValues);
+			}
+		}
+
 		/** \brief Process a buffer with complex numbers to get two separated vectors one with the modules and other with the phases.
 		*   \details This method return two vectors with the module and phase of the vector introduced.
 		*   \param [in] inputBuffer Vector of samples that has real and imaginary parts interlaced. inputBuffer[i] = Re[Xj], x[i+1] = Img[Xj]
@@ -236,7 +303,7 @@ namespace Common {
 		*	\param [out] phaseBuffer  Vector of real numbers that are the argument of the complex numbers.	phaseBuffer [i] = atan(inputBuffer[2 * i + 1] / inputBuffer[2 * i]^2)		
 		*   \throws May throw exceptions and errors to debugger
 		*/
-		static void ProcessToModulePhase(const std::vector<float>& inputBuffer, std::vector<float>& moduleBuffer, std::vector<float>& phaseBuffer)		       
+		static void ProcessToModulePhase(const TAlignedVector<float>& inputBuffer, TAlignedVector<float>& moduleBuffer, TAlignedVector<float>& phaseBuffer)		       
 		{
 			ASSERT(inputBuffer.size() > 0, RESULT_ERROR_BADSIZE, "Bad input size", "");
 
@@ -265,7 +332,7 @@ namespace Common {
 		*	\param [out] phaseBuffer  Vector of real numbers that are the argument of the complex numbers.	phaseBuffer [i] = atan(inputBuffer[2 * i + 1] / inputBuffer[2 * i]^2)
 		*   \throws May throw exceptions and errors to debugger
 		*/
-		static void ProcessToPowerPhase(const std::vector<float>& inputBuffer, std::vector<float>& powerBuffer, std::vector<float>& phaseBuffer)		       
+		static void ProcessToPowerPhase(const TAlignedVector<float>& inputBuffer, TAlignedVector<float>& powerBuffer, TAlignedVector<float>& phaseBuffer)		       
 		{
 			ASSERT(inputBuffer.size() > 0, RESULT_ERROR_BADSIZE, "Bad input size", "");
 
@@ -294,7 +361,7 @@ namespace Common {
 			\param [out] outputBuffer Vector of samples that has real and imaginary parts interlaced. outputBuffer[i] = Re[Xi] = moduleBuffer[i] * cos(phaseBuffer[i]), outputBuffer[i+1] = Img[Xi] = moduleBuffer[i] * sin(phaseBuffer[i])
 		*   \throws May throw exceptions and errors to debugger
 		*/
-		static void ProcessToRealImaginary(const std::vector<float>& moduleBuffer, const std::vector<float>& phaseBuffer, std::vector<float>& outputBuffer)		       
+		static void ProcessToRealImaginary(const TAlignedVector<float>& moduleBuffer, const TAlignedVector<float>& phaseBuffer, TAlignedVector<float>& outputBuffer)		       
 		{
 			ASSERT(moduleBuffer.size() > 0, RESULT_ERROR_BADSIZE, "Bad input size moduleBuffer", "");
 			ASSERT(phaseBuffer.size() > 0, RESULT_ERROR_BADSIZE, "Bad input size phaseBuffer", "");
@@ -364,7 +431,7 @@ namespace Common {
 		*   \throws May throw exceptions and errors to debugger
 		*	\sa CalculateFFT_Input, CalculateFFT_IR
 		*/		
-		void CalculateIFFT_OLA(const std::vector<float>& inputBuffer_frequency, std::vector<float>& outputBuffer_time)
+		void CalculateIFFT_OLA(const TAlignedVector<float>& inputBuffer_frequency, TAlignedVector<float>& outputBuffer_time)
 		{
 			ASSERT(inputBuffer_frequency.size() == FFTBufferSize, RESULT_ERROR_BADSIZE, "Incorrect size of input buffer when computing inverse FFT in frequency convolver", "");
 			ASSERT(setupDone, RESULT_ERROR_NOTINITIALIZED, "SetupIFFT_OLA method should be called before call this method", "");
@@ -402,6 +469,22 @@ namespace Common {
 		}*/
 
 	private:
+
+		template <TSpectralPrecision P>
+		static void ProcessComplexMultiplyAccumulate(const float* x, const uint16_t* h, float* y, int numberOfComplexValues)
+		{
+			for (int i = 0; i < numberOfComplexValues; i++)
+			{
+				float a = x[2 * i];
+				float b = x[2 * i + 1];
+				float c = CReducedPrecision::ToFloat<P>(h[2 * i]);
+				float d = CReducedPrecision::ToFloat<P>(h[2 * i + 1]);
+
+				y[2 * i] += a * c - b * d;
+				y[2 * i + 1] += a * d + b * c;
+			}
+		}
+
 		// ATTRIBUTES	
 		int inputSize;			//Size of the inputs buffer		
 		int IRSize;				//Size of the AmbiIR buffer
@@ -416,7 +499,7 @@ namespace Common {
 		// METHODS 	
 
 		// brief This method copies the input vector into an array and insert the imaginary part.
-		static void ProcessAddImaginaryPart(const std::vector<float>& input, std::vector<double>& output)
+		static void ProcessAddImaginaryPart(const TAlignedVector<float>& input, std::vector<double>& output)
 		{
 			ASSERT(output.size() >= 2 * input.size(), RESULT_ERROR_BADSIZE, "Output buffer size must be at least twice the input buffer size when adding imaginary part in frequency convolver", "");
 
@@ -428,7 +511,7 @@ namespace Common {
 
 
 		//This method copy the FFT-1 output array into the storage vector, remove the imaginary part and normalize the output.			
-		void ProcessOutputBuffer_IFFT_OverlapAddMethod(std::vector<double>& input_ConvResultBuffer, std::vector<float>& outBuffer)
+		void ProcessOutputBuffer_IFFT_OverlapAddMethod(std::vector<double>& input_ConvResultBuffer, TAlignedVector<float>& outBuffer)
 		{
 			//Prepare the outbuffer
 			if (outBuffer.size() < inputSize)
@@ -0,0 +1,100 @@
+/**
+* \class CFractionalDelayLine
+*
+* \brief Declaration of CFractionalDelayLine class interface.
+* \detail Circular delay line with interpolated fractional read and a linear delay ramp within each frame, used to add the ITD.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CFRACTIONAL_DELAY_LINE_HPP_
+#define _CFRACTIONAL_DELAY_LINE_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <Common/Buffer.hpp>
+#include <Common/MultiTapDelayLine.hpp>
+
+/** \brief Initial capacity, in samples, of the fractional delay lines. It grows to the next power of two if a longer delay is requested */
+#ifndef FRACTIONAL_DELAY_LINE_INITIAL_CAPACITY
+#define FRACTIONAL_DELAY_LINE_INITIAL_CAPACITY 2048
+#endif
+
+namespace Common {
+
+	/** \details Delay line that adds a time varying delay to a stream of frames, to simulate the ITD. It is a CMultiTapDelayLine with
+	*	a single tap, written and read once per frame.
+	*	The samples are kept in a circular buffer whose capacity is a power of two, so the history is never moved or reallocated when the
+	*	delay changes. When the delay of a frame is different from the delay of the previous one, the delay moves linearly from one to the other
+	*	along the frame, and the samples are read with linear interpolation. This stretches or compresses the frame as the expansion method
+	*	did, with the same cost whatever the change of delay. While the delay does not change and is an integer number of samples, the frame is
+	*	copied without interpolation.
+	*/
+	class CFractionalDelayLine {
+	public:
+
+		/** \brief Default constructor, with no delay
+		*/
+		CFractionalDelayLine() : line{ FRACTIONAL_DELAY_LINE_INITIAL_CAPACITY } {
+			line.SetNumberOfTaps(1);
+			line.SetTapDelay(0, 0);
+		}
+
+		/** \brief Delay one frame
+		*	\param [in] input frame to be delayed
+		*	\param [out] output delayed frame, with the same size as the input
+		*	\param [in] newDelay delay at the end of the frame, in samples. It may be fractional
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void Process(const CMonoBuffer<float> & input, CMonoBuffer<float> & output, float newDelay) {
+			const std::size_t frameSize = input.size();
+			if (output.size() != frameSize) { output.resize(frameSize); }
+			if (frameSize == 0) { return; }
+			if (newDelay < 0) { newDelay = 0; }
+
+			// Grown before writing the frame, so that all the history that was kept is still there
+			line.Reserve(frameSize + static_cast<std::size_t>(std::ceil(std::max(line.GetTapDelay(0), newDelay))) + 2);
+			line.Write(input);
+			line.ReadTap(0, output, newDelay);
+		}
+
+		/** \brief Set all the samples of the line to zero and the delay to zero. The capacity is kept
+		*/
+		void Reset() {
+			line.Reset();
+			line.SetTapDelay(0, 0);
+		}
+
+		/** \brief Make the next frame start directly at its delay, without a ramp from the delay of the last frame. Used after a period in which the line has not been processed
+		*/
+		void SkipNextDelayRamp() { line.ResetTap(0); }
+
+		/** \brief Get the delay, in samples, at the end of the last frame
+		*/
+		float GetDelay() const { return line.GetTapDelay(0); }
+
+		/** \brief Get the number of samples that the line can hold
+		*/
+		std::size_t GetCapacity() const { return line.GetCapacity(); }
+
+	private:
+		CMultiTapDelayLine line;		// Line with a single tap
+	};
+}
+#endif
@@ -0,0 +1,230 @@
+/**
+* \class CMultiTapDelayLine
+*
+* \brief Declaration of CMultiTapDelayLine class interface.
+* \detail Circular delay line written once per frame and read by several taps, each one with its own time varying fractional delay.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CMULTITAP_DELAY_LINE_HPP_
+#define _CMULTITAP_DELAY_LINE_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <Common/Buffer.hpp>
+#include <Common/BufferKernels.hpp>
+#include <Common/ErrorHandler.hpp>
+
+/** \brief Initial capacity, in samples, of the multi-tap delay lines. It grows to the next power of two if a longer delay is requested */
+#ifndef MULTITAP_DELAY_LINE_INITIAL_CAPACITY
+#define MULTITAP_DELAY_LINE_INITIAL_CAPACITY 4096
+#endif
+
+namespace Common {
+
+	/** \details Delay line shared by several propagation paths of the same signal. Each frame is written once, and then every tap reads
+	*	it with its own delay. The samples are kept in a circular buffer whose capacity is a power of two. When the delay of a tap changes
+	*	from one frame to the next, it moves linearly along the frame and the samples are read with linear interpolation, which produces
+	*	the Doppler effect of the movement of the path. The first time a tap is read, or after a reset, it starts directly at its delay.
+	*/
+	class CMultiTapDelayLine {
+	public:
+
+		/** \brief Default constructor, without taps
+		*	\param [in] initialCapacity number of samples allocated, rounded up to a power of two
+		*/
+		explicit CMultiTapDelayLine(std::size_t initialCapacity = MULTITAP_DELAY_LINE_INITIAL_CAPACITY) : writeIndex{ 0 }, frameSize{ 0 } {
+			SetCapacity(initialCapacity);
+		}
+
+		/** \brief Set the number of taps. All of them start at their first delay the next time they are read
+		*/
+		void SetNumberOfTaps(std::size_t numberOfTaps) {
+			taps.assign(numberOfTaps, TTap());
+		}
+
+		/** \brief Get the number of taps
+		*/
+		std::size_t GetNumberOfTaps() const { return taps.size(); }
+
+		/** \brief Allocate the line for a number of samples, so that delays up to that number minus one frame can be read without growing it
+		*/
+		void Reserve(std::size_t samples) {
+			EnsureCapacity(samples);
+		}
+
+		/** \brief Write a new frame. It has to be done once per frame, before reading the taps
+		*	\param [in] input frame
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void Write(const CMonoBuffer<float> & input) {
+			frameSize = input.size();
+			EnsureCapacity(frameSize + 2);
+			const std::size_t firstBlock = std::min(frameSize, buffer.size() - writeIndex);
+			std::copy(input.begin(), input.begin() + firstBlock, buffer.begin() + writeIndex);
+			std::copy(input.begin() + firstBlock, input.end(), buffer.begin());
+			writeIndex = (writeIndex + frameSize) & mask;
+		}
+
+		/** \brief Read the last frame written through one tap
+		*	\param [in] tap tap index
+		*	\param [out] output delayed frame, with the size of the last frame written
+		*	\param [in] newDelay delay of the tap at the end of the frame, in samples. It may be fractional
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		void ReadTap(std::size_t tap, CMonoBuffer<float> & output, float newDelay) {
+			ASSERT(tap < taps.size(), RESULT_ERROR_OUTOFRANGE, "Trying to read a tap that does not exist in the delay line", "");
+			if (tap >= taps.size()) return;
+			output.resize(frameSize);
+			if (frameSize == 0) return;
+			if (newDelay < 0) newDelay = 0;
+
+			TTap & thisTap = taps[tap];
+			if (!thisTap.initialized) {
+				thisTap.delay = newDelay;
+				thisTap.initialized = true;
+			}
+			// Only grows the first time a delay exceeds the capacity
+			EnsureCapacity(frameSize + static_cast<std::size_t>(std::ceil(std::max(thisTap.delay, newDelay))) + 2);
+
+			if (newDelay == thisTap.delay && newDelay == std::floor(newDelay)) {
+				ReadInteger(output.data(), static_cast<std::size_t>(newDelay));
+			} else {
+				ReadRamp(output.data(), thisTap.delay, newDelay);
+			}
+			thisTap.delay = newDelay;
+		}
+
+		/** \brief Get the delay of one tap at the end of the last frame read, in samples
+		*/
+		float GetTapDelay(std::size_t tap) const {
+			if (tap >= taps.size()) return 0;
+			return taps[tap].delay;
+		}
+
+		/** \brief Set the delay of one tap as if it had been read with it, so that the next time it is read its delay ramps from this one
+		*/
+		void SetTapDelay(std::size_t tap, float delay) {
+			if (tap >= taps.size()) return;
+			taps[tap].delay = delay < 0 ? 0 : delay;
+			taps[tap].initialized = true;
+		}
+
+		/** \brief Make one tap start at its delay the next time it is read, without a ramp from its previous delay. Used when a tap has not been read for a while
+		*/
+		void ResetTap(std::size_t tap) {
+			if (tap >= taps.size()) return;
+			taps[tap].initialized = false;
+		}
+
+		/** \brief Set all the samples of the line to zero. The taps start at their first delay the next time they are read, and the capacity is kept
+		*/
+		void Reset() {
+			std::fill(buffer.begin(), buffer.end(), 0.0f);
+			writeIndex = 0;
+			std::fill(taps.begin(), taps.end(), TTap());
+		}
+
+		/** \brief Get the number of samples that the line can hold
+		*/
+		std::size_t GetCapacity() const { return buffer.size(); }
+
+	private:
+
+		/// State of one tap
+		struct TTap {
+			float delay = 0;			// Delay at the end of the last frame, in samples
+			bool initialized = false;	// False until the tap is read for the first time
+		};
+
+		// Attributes
+		CMonoBuffer<float> buffer;		// Circular buffer, its size is a power of two
+		std::size_t mask;				// buffer.size() - 1
+		std::size_t writeIndex;			// Position of the first sample of the next frame
+		std::size_t frameSize;			// Size of the last frame written
+		std::vector<TTap> taps;			// State of the taps
+
+		// Methods
+
+		/// Read the last frame with a constant integer delay, in one or two contiguous blocks
+		void ReadInteger(float * out, std::size_t delay) const {
+			const std::size_t readIndex = (writeIndex - frameSize - delay) & mask;
+			const std::size_t firstBlock = std::min(frameSize, buffer.size() - readIndex);
+			std::copy(buffer.begin() + readIndex, buffer.begin() + readIndex + firstBlock, out);
+			std::copy(buffer.begin(), buffer.begin() + (frameSize - firstBlock), out + firstBlock);
+		}
+
+		/// Read the last frame with a delay that moves linearly from startDelay to endDelay, with linear interpolation between samples
+		void ReadRamp(float * out, float startDelay, float endDelay) const {
+			// Read position of sample i is (frame start - startDelay - delayStep) + i * (1 - delayStep). One whole capacity is added so
+			// that it is never negative
+			const double delayStep = (static_cast<double>(endDelay) - startDelay) / static_cast<double>(frameSize);
+			const double positionStep = 1.0 - delayStep;
+			const double firstPosition = static_cast<double>(writeIndex - frameSize + buffer.size()) - startDelay - delayStep;
+			const double lastPosition = firstPosition + positionStep * static_cast<double>(frameSize - 1);
+
+			// If all the samples to be read are contiguous in the buffer, use the resampling kernel
+			const std::size_t lowestSample = static_cast<std::size_t>(std::min(firstPosition, lastPosition));
+			const std::size_t highestSample = static_cast<std::size_t>(std::max(firstPosition, lastPosition)) + 1;
+			const std::size_t lowestIndex = lowestSample & mask;
+			if (lowestIndex + (highestSample - lowestSample) < buffer.size()) {
+				CBufferKernels::ResampleLinear(buffer.data() + lowestIndex, highestSample - lowestSample + 1, out, frameSize,
+					static_cast<float>(firstPosition - static_cast<double>(lowestSample)), static_cast<float>(positionStep));
+				return;
+			}
+
+			const float * samples = buffer.data();
+			double position = firstPosition;
+			for (std::size_t i = 0; i < frameSize; i++, position += positionStep) {
+				const std::size_t integerPart = static_cast<std::size_t>(position);
+				const float fraction = static_cast<float>(position - static_cast<double>(integerPart));
+				const std::size_t index = integerPart & mask;
+				out[i] = samples[index] + (samples[(index + 1) & mask] - samples[index]) * fraction;
+			}
+		}
+
+		/// Grow the circular buffer to a power of two of at least the given number of samples, keeping the history
+		void EnsureCapacity(std::size_t samples) {
+			if (samples <= buffer.size()) { return; }
+			std::size_t newCapacity = buffer.size();
+			while (newCapacity < samples) { newCapacity *= 2; }
+
+			CMonoBuffer<float> newBuffer(newCapacity, 0.0f);
+			const std::size_t newMask = newCapacity - 1;
+			for (std::size_t k = 1; k <= buffer.size(); k++) {
+				newBuffer[(writeIndex - k) & newMask] = buffer[(writeIndex - k) & mask];
+			}
+			buffer = std::move(newBuffer);
+			mask = newMask;
+			writeIndex &= mask;
+		}
+
+		/// Set the capacity of an empty line, rounded up to a power of two
+		void SetCapacity(std::size_t samples) {
+			std::size_t capacity = 1;
+			while (capacity < samples) { capacity *= 2; }
+			buffer.assign(capacity, 0.0f);
+			mask = capacity - 1;
+			writeIndex = 0;
+		}
+	};
+}
+#endif
@@ -0,0 +1,232 @@
+/**
+* \class CPlanarBuffer
+*
+* \brief Declaration of CPlanarBuffer class interface.
+* \detail Multichannel buffer that keeps the samples of all channels in one allocation, one channel after another.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CPLANAR_BUFFER_HPP_
+#define _CPLANAR_BUFFER_HPP_
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <Common/ErrorHandler.hpp>
+#include <Common/Buffer.hpp>
+#include <Common/BufferKernels.hpp>
+#include <Common/AlignedAllocator.hpp>
+
+namespace Common {
+
+	/** \details Planar multichannel buffer. All the channels have the same number of samples and are stored in a single aligned
+	*	allocation, channel after channel. The distance between the first samples of two consecutive channels (the stride) is the channel
+	*	size rounded up to BRT_BUFFER_ALIGNMENT bytes, so every channel starts aligned. The samples between the end of a channel and the
+	*	start of the next one are kept at zero, which allows the operations on all channels to be done in a single sweep of the storage.
+	*	Channels are accessed through views that do not own the samples.
+	*/
+	template <class stored>
+	class CPlanarBuffer {
+	public:
+
+		/** \brief Non owning view of the samples of one channel
+		*/
+		template <class T>
+		class CChannelView {
+		public:
+			CChannelView(T * _samples, std::size_t _size) : samples{ _samples }, channelSize{ _size } {}
+
+			/** \brief Read only view of a writable channel
+			*/
+			template <class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+			CChannelView(const CChannelView<U> & oth) : samples{ oth.data() }, channelSize{ oth.size() } {}
+
+			T * data() const { return samples; }
+			std::size_t size() const { return channelSize; }
+			T * begin() const { return samples; }
+			T * end() const { return samples + channelSize; }
+			T & operator[](std::size_t i) const { return samples[i]; }
+
+		private:
+			T * samples;
+			std::size_t channelSize;
+		};
+
+		using TChannel = CChannelView<stored>;
+		using TConstChannel = CChannelView<const stored>;
+
+		/** \brief Default constructor, empty buffer without channels
+		*/
+		CPlanarBuffer() : numberOfChannels{ 0 }, channelSize{ 0 }, stride{ 0 } {}
+
+		/** \brief Constructor of a buffer of silence
+		*	\param [in] _numberOfChannels number of channels
+		*	\param [in] _channelSize number of samples of each channel
+		*/
+		CPlanarBuffer(std::size_t _numberOfChannels, std::size_t _channelSize) : CPlanarBuffer() {
+			Resize(_numberOfChannels, _channelSize);
+		}
+
+		/** \brief Set the number of channels and the size of the channels. All samples are set to zero
+		*	\details The storage is only reallocated when the new layout needs more memory than the current one.
+		*	\param [in] _numberOfChannels number of channels
+		*	\param [in] _channelSize number of samples of each channel
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void Resize(std::size_t _numberOfChannels, std::size_t _channelSize) {
+			constexpr std::size_t samplesPerLine = BRT_BUFFER_ALIGNMENT / sizeof(stored) > 0 ? BRT_BUFFER_ALIGNMENT / sizeof(stored) : 1;
+			numberOfChannels = _numberOfChannels;
+			channelSize = _channelSize;
+			stride = (channelSize + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+			samples.assign(numberOfChannels * stride, stored(0));
+		}
+
+		/** \brief Remove all the channels
+		*/
+		void Clear() {
+			numberOfChannels = 0;
+			channelSize = 0;
+			stride = 0;
+			samples.clear();
+		}
+
+		/** \brief Set all the samples of all the channels to zero
+		*/
+		void SetToZero() {
+			std::fill(samples.begin(), samples.end(), stored(0));
+		}
+
+		/** \brief Get the number of channels
+		*/
+		std::size_t GetNChannels() const { return numberOfChannels; }
+
+		/** \brief Get the number of samples of each channel
+		*/
+		std::size_t GetChannelSize() const { return channelSize; }
+
+		/** \brief Get the distance, in samples, between the beginning of two consecutive channels
+		*/
+		std::size_t GetStride() const { return stride; }
+
+		/** \brief Check if the buffer has no channels
+		*/
+		bool IsEmpty() const { return numberOfChannels == 0; }
+
+		/** \brief Check if two buffers have the same number of channels and the same channel size
+		*/
+		bool HasSameLayout(const CPlanarBuffer<stored> & oth) const {
+			return numberOfChannels == oth.numberOfChannels && channelSize == oth.channelSize;
+		}
+
+		/** \brief Get a view of the samples of one channel
+		*/
+		TChannel operator[](std::size_t channel) { return TChannel(samples.data() + channel * stride, channelSize); }
+		TConstChannel operator[](std::size_t channel) const { return TConstChannel(samples.data() + channel * stride, channelSize); }
+
+		/** \brief Get the first sample of the storage. Channel n starts at data() + n * GetStride()
+		*/
+		stored * data() { return samples.data(); }
+		const stored * data() const { return samples.data(); }
+
+		/** \brief Copy the samples of a mono buffer to one channel
+		*	\param [in] channel channel index
+		*	\param [in] buffer samples, it has to have the size of the channels
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		void SetChannel(std::size_t channel, const CMonoBuffer<stored> & buffer) {
+			ASSERT(channel < numberOfChannels && buffer.size() == channelSize, RESULT_ERROR_BADSIZE, "The buffer does not match the size of the channels of the planar buffer", "");
+			if (channel >= numberOfChannels || buffer.size() != channelSize) { return; }
+			std::copy(buffer.begin(), buffer.end(), (*this)[channel].begin());
+		}
+
+		/** \brief Add the samples of a mono buffer, multiplied by a gain, to one channel
+		*	\param [in] channel channel index
+		*	\param [in] buffer samples, it has to have the size of the channels
+		*	\param [in] gain gain applied to the samples of the buffer
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		void AddToChannel(std::size_t channel, const CMonoBuffer<stored> & buffer, stored gain = 1) {
+			ASSERT(channel < numberOfChannels && buffer.size() == channelSize, RESULT_ERROR_BADSIZE, "The buffer does not match the size of the channels of the planar buffer", "");
+			if (channel >= numberOfChannels || buffer.size() != channelSize) { return; }
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::MultiplyAccumulate((*this)[channel].data(), buffer.data(), gain, channelSize);
+			} else {
+				TChannel dst = (*this)[channel];
+				for (std::size_t i = 0; i < channelSize; i++) dst[i] += gain * buffer[i];
+			}
+		}
+
+		/** \brief Add all the channels of another buffer with the same layout, in one sweep of the storage
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		CPlanarBuffer<stored> & operator+=(const CPlanarBuffer<stored> & oth) {
+			ASSERT(HasSameLayout(oth), RESULT_ERROR_BADSIZE, "Attempt to mix two planar buffers with different layout", "");
+			if (!HasSameLayout(oth)) { return *this; }
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::Add(samples.data(), oth.samples.data(), samples.size());
+			} else {
+				std::transform(samples.begin(), samples.end(), oth.samples.begin(), samples.begin(), [](stored a, stored b) { return a + b; });
+			}
+			return *this;
+		}
+
+		/** \brief Multiply all the samples of all the channels by a constant gain, in one sweep of the storage
+		*/
+		void ApplyGain(stored gain) {
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::Scale(samples.data(), gain, samples.size());
+			} else {
+				std::for_each(samples.begin(), samples.end(), [gain](stored & a) { a *= gain; });
+			}
+		}
+
+		/** \brief Multiply the samples of one channel by a gain that approaches the attenuation exponentially
+		*	\details Same as CBuffer::ApplyGainExponentially for a mono buffer
+		*	\param [in] channel channel index
+		*	\param [in,out] previousAttenuation last frame attenuation, updated to the gain of the last sample
+		*	\param [in] attenuation current frame attenuation
+		*	\param [in] sampleRate sample rate, in Hz
+		*/
+		void ApplyGainExponentially(std::size_t channel, float & previousAttenuation, float attenuation, int sampleRate) {
+			float alpha = CMonoBuffer<stored>::CalculateExponentialGainAlpha(sampleRate);
+			TChannel dst = (*this)[channel];
+			if constexpr (std::is_same_v<stored, float>) {
+				CBufferKernels::ApplyExponentialRamp(dst.data(), channelSize, 1, previousAttenuation, attenuation, alpha);
+			} else {
+				for (std::size_t i = 0; i < channelSize; i++) {
+					previousAttenuation = (attenuation - previousAttenuation) * alpha + previousAttenuation;
+					dst[i] *= previousAttenuation;
+				}
+			}
+		}
+
+	private:
+		std::size_t numberOfChannels;		// Number of channels
+		std::size_t channelSize;			// Number of samples of each channel
+		std::size_t stride;					// Distance between the beginning of two consecutive channels
+		TAlignedVector<stored> samples;		// Samples of all the channels
+	};
+}
+
+/** \brief Multichannel buffer with all the channels in one allocation (see Common::CPlanarBuffer)
+*/
+template<class stored>
+using CMultiChannelBuffer = Common::CPlanarBuffer<stored>;
+
+#endif
@@ -0,0 +1,185 @@
+/**
+* \class CReducedPrecision
+*
+* \brief Declaration of CReducedPrecision class interface.
+* \detail Conversion between 32-bit floats and 16-bit storage formats (IEEE 754 half precision and bfloat16), used to store
+	partitioned spectra with half of the memory.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CREDUCED_PRECISION_HPP_
+#define _CREDUCED_PRECISION_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+namespace Common {
+
+	/**
+	 * @brief Storage format of the partitioned spectra.
+	 *	- float32: 32-bit float, no precision loss.
+	 *	- float16: IEEE 754 half precision. Relative error of every stored value below 2^-11 (about -66 dB) for magnitudes in [6.1e-5, 65504],
+	 *		absolute error below 3e-8 for smaller magnitudes. Larger magnitudes are saturated to 65504.
+	 *	- bfloat16: upper half of a 32-bit float. Relative error of every stored value below 2^-8 (about -48 dB), same range as float32.
+	 *	Every complex product of the convolution is affected by that relative error, so the error of the output spectrum is bounded by the relative error
+	 *	times the sum of the magnitudes of the products. It is only below -66 dB (float16) or -48 dB (bfloat16) of the output level when the products do not
+	 *	cancel each other; with long IRs, where they partially cancel, signal to error ratios of about 63 dB (float16) and 43 dB (bfloat16) have been measured.
+	 */
+	enum class TSpectralPrecision {
+		float32,
+		float16,
+		bfloat16
+	};
+
+	class CReducedPrecision {
+	public:
+
+		/**
+		 * @brief Convert a float to IEEE 754 half precision, rounding to the nearest even value. Values out of range are saturated.
+			The conversion has no branches, so that loops using it can be vectorised by the compiler.
+		 * @param _value value to convert
+		 * @return half precision bits
+		 */
+		static uint16_t FloatToHalf(float _value) {
+			const float scaleToInfinity = 0x1.0p+112f;
+			const float scaleToZero = 0x1.0p-110f;
+			float base = (std::fabs(_value) * scaleToInfinity) * scaleToZero;
+
+			const uint32_t bits = FloatToBits(_value);
+			const uint32_t shiftedBits = bits + bits;
+			const uint32_t sign = bits & 0x80000000u;
+			uint32_t bias = shiftedBits & 0xff000000u;
+			bias = bias < 0x71000000u ? 0x71000000u : bias;
+
+			// The float addition does the rounding of the mantissa, also for subnormals
+			base = BitsToFloat((bias >> 1) + 0x07800000u) + base;
+			const uint32_t baseBits = FloatToBits(base);
+			uint32_t nonSign = ((baseBits >> 13) & 0x00007c00u) + (baseBits & 0x00000fffu);
+			nonSign = nonSign > 0x7bffu ? 0x7bffu : nonSign;	// Saturate to the maximum instead of infinity
+			nonSign = shiftedBits > 0xff000000u ? 0x7e00u : nonSign;	// NaN stays NaN
+			return static_cast<uint16_t>((sign >> 16) | nonSign);
+		}
+
+		/**
+		 * @brief Convert IEEE 754 half precision to float. The conversion is exact and has no branches.
+		 * @param _value half precision bits
+		 * @return float value
+		 */
+		static float HalfToFloat(uint16_t _value) {
+			const uint32_t bits = static_cast<uint32_t>(_value) << 16;
+			const uint32_t sign = bits & 0x80000000u;
+			const uint32_t shiftedBits = bits + bits;
+
+			const float normalized = BitsToFloat((shiftedBits >> 4) + (0xe0u << 23)) * 0x1.0p-112f;
+			const float denormalized = BitsToFloat((shiftedBits >> 17) | (126u << 23)) - 0.5f;
+			const uint32_t magnitude = shiftedBits < (1u << 27) ? FloatToBits(denormalized) : FloatToBits(normalized);
+			return BitsToFloat(sign | magnitude);
+		}
+
+		/**
+		 * @brief Convert a float to bfloat16, rounding to the nearest even value
+		 * @param _value value to convert
+		 * @return bfloat16 bits
+		 */
+		static uint16_t FloatToBFloat16(float _value) {
+			uint32_t bits = FloatToBits(_value);
+			if ((bits & 0x7fffffffu) > 0x7f800000u) {
+				return static_cast<uint16_t>((bits >> 16) | 0x40u); // Keep NaN a quiet NaN
+			}
+			bits += 0x7fffu + ((bits >> 16) & 1u);
+			return static_cast<uint16_t>(bits >> 16);
+		}
+
+		/**
+		 * @brief Convert bfloat16 to float. The conversion is exact.
+		 * @param _value bfloat16 bits
+		 * @return float value
+		 */
+		static float BFloat16ToFloat(uint16_t _value) {
+			return BitsToFloat(static_cast<uint32_t>(_value) << 16);
+		}
+
+		/**
+		 * @brief Convert a stored 16-bit value to float. The format is a template parameter, so that it can be used inside loops without branches.
+		 */
+		template <TSpectralPrecision P>
+		static float ToFloat(uint16_t _value) {
+			return P == TSpectralPrecision::bfloat16 ? BFloat16ToFloat(_value) : HalfToFloat(_value);
+		}
+
+		/**
+		 * @brief Convert a buffer of floats to a 16-bit format
+		 * @param _in input values
+		 * @param [out] _out converted values, it has to have room for _size values
+		 * @param _size number of values
+		 * @param _precision 16-bit format, float16 or bfloat16
+		 */
+		static void Encode(const float * _in, uint16_t * _out, size_t _size, TSpectralPrecision _precision) {
+			if (_precision == TSpectralPrecision::bfloat16) {
+				for (size_t i = 0; i < _size; i++) { _out[i] = FloatToBFloat16(_in[i]); }
+			} else {
+				for (size_t i = 0; i < _size; i++) { _out[i] = FloatToHalf(_in[i]); }
+			}
+		}
+
+		/**
+		 * @brief Convert a buffer of 16-bit values to floats
+		 * @param _in input values
+		 * @param [out] _out converted values, it has to have room for _size values
+		 * @param _size number of values
+		 * @param _precision 16-bit format of the input, float16 or bfloat16
+		 */
+		static void Decode(const uint16_t * _in, float * _out, size_t _size, TSpectralPrecision _precision) {
+			if (_precision == TSpectralPrecision::bfloat16) {
+				for (size_t i = 0; i < _size; i++) { _out[i] = BFloat16ToFloat(_in[i]); }
+			} else {
+				for (size_t i = 0; i < _size; i++) { _out[i] = HalfToFloat(_in[i]); }
+			}
+		}
+
+		/**
+		 * @brief Get the maximum relative error of a value stored with a given format, inside its normal range
+		 * @param _precision storage format
+		 * @return relative error bound
+		 */
+		static float GetRelativeErrorBound(TSpectralPrecision _precision) {
+			switch (_precision) {
+			case TSpectralPrecision::float16: return 1.0f / 2048.0f;	// 2^-11
+			case TSpectralPrecision::bfloat16: return 1.0f / 256.0f;	// 2^-8
+			default: return 0.0f;
+			}
+		}
+
+	private:
+		static uint32_t FloatToBits(float _value) {
+			uint32_t bits;
+			std::memcpy(&bits, &_value, sizeof(bits));
+			return bits;
+		}
+
+		static float BitsToFloat(uint32_t _bits) {
+			float value;
+			std::memcpy(&value, &_bits, sizeof(value));
+			return value;
+		}
+	};
+}
+#endif
@@ -0,0 +1,325 @@
+/**
+* \class CSharedMemorySegment
+*
+* \brief Declaration of CSharedMemorySegment class interface.
+* \detail Named memory segment that can be mapped by several processes. The process that creates it maps it for writing,
+	the rest of them map it read only. The segment is released when the last process that uses it closes it. POSIX shared memory
+	is used on Linux and macOS (link with -lrt on glibc older than 2.34) and named file mappings on Windows.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CSHARED_MEMORY_SEGMENT_HPP_
+#define _CSHARED_MEMORY_SEGMENT_HPP_
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <Common/ErrorHandler.hpp>
+
+#if defined(_WIN32)
+// Keep the Windows headers from leaking min/max macros and the rarely used APIs into the code that includes this file
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define _CSHARED_MEMORY_SEGMENT_LEAN_AND_MEAN_
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#define _CSHARED_MEMORY_SEGMENT_NOMINMAX_
+#endif
+#include <windows.h>
+#ifdef _CSHARED_MEMORY_SEGMENT_LEAN_AND_MEAN_
+#undef WIN32_LEAN_AND_MEAN
+#undef _CSHARED_MEMORY_SEGMENT_LEAN_AND_MEAN_
+#endif
+#ifdef _CSHARED_MEMORY_SEGMENT_NOMINMAX_
+#undef NOMINMAX
+#undef _CSHARED_MEMORY_SEGMENT_NOMINMAX_
+#endif
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+	class CSharedMemorySegment {
+	public:
+		~CSharedMemorySegment() { Close(); }
+
+		CSharedMemorySegment(const CSharedMemorySegment &) = delete;
+		CSharedMemorySegment & operator=(const CSharedMemorySegment &) = delete;
+
+		/**
+		 * @brief Create a new segment, mapped for writing. It fails if a segment with the same name already exists.
+		 * @param _name name of the segment, without platform prefixes
+		 * @param _size size in bytes
+		 * @return the segment, or nullptr if it could not be created
+		 */
+		static std::shared_ptr<CSharedMemorySegment> Create(const std::string & _name, size_t _size) {
+			std::shared_ptr<CSharedMemorySegment> segment(new CSharedMemorySegment(_name));
+			if (_size == 0 || !segment->CreateMapping(_size)) { return nullptr; }
+			return segment;
+		}
+
+		/**
+		 * @brief Open an existing segment, mapped read only
+		 * @param _name name of the segment, without platform prefixes
+		 * @return the segment, or nullptr if it does not exist
+		 */
+		static std::shared_ptr<CSharedMemorySegment> Open(const std::string & _name) {
+			std::shared_ptr<CSharedMemorySegment> segment(new CSharedMemorySegment(_name));
+			if (!segment->OpenMapping()) { return nullptr; }
+			return segment;
+		}
+
+		/**
+		 * @brief Remove the name of a segment, so it cannot be opened anymore. The processes that have it mapped can still use it.
+			Segments are removed automatically when the last process that uses them closes them, so this is only needed to discard
+			a segment earlier, or one left behind by a process that has crashed. On Windows the segment is released when the last
+			process closes it, so this method does nothing.
+		 * @param _name name of the segment, without platform prefixes
+		 * @return true if the name has been removed
+		 */
+		static bool Remove(const std::string & _name) {
+#if defined(_WIN32)
+			return false;
+#else
+			return shm_unlink(GetPlatformName(_name).c_str()) == 0;
+#endif
+		}
+
+		/**
+		 * @brief Get an identifier of the calling process
+		 */
+		static uint64_t GetProcessIdentifier() {
+#if defined(_WIN32)
+			return static_cast<uint64_t>(::GetCurrentProcessId());
+#else
+			return static_cast<uint64_t>(getpid());
+#endif
+		}
+
+		/**
+		 * @brief Check if a process is still running
+		 * @param _processIdentifier identifier returned by GetProcessIdentifier in that process
+		 * @return false only if the process is known to have finished. Processes of other users, or in other process namespaces,
+			may be reported as running.
+		 */
+		static bool IsProcessRunning(uint64_t _processIdentifier) {
+#if defined(_WIN32)
+			HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(_processIdentifier));
+			if (process == NULL) { return GetLastError() == ERROR_ACCESS_DENIED; }
+			const bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+			CloseHandle(process);
+			return running;
+#else
+			if (_processIdentifier == 0) { return false; }
+			return kill(static_cast<pid_t>(_processIdentifier), 0) == 0 || errno == EPERM;
+#endif
+		}
+
+		/**
+		 * @brief Get the time when the segment was last written or resized, by any process
+		 * @return seconds since the epoch, or -1 if it is not known. On Windows it is never known.
+		 */
+		int64_t GetModificationTime() const {
+#if defined(_WIN32)
+			return -1;
+#else
+			struct stat status;
+			if (fileDescriptor < 0 || fstat(fileDescriptor, &status) != 0) { return -1; }
+			return static_cast<int64_t>(status.st_mtime);
+#endif
+		}
+
+		/**
+		 * @brief Get the mapped memory for writing. Only available in the process that has created the segment.
+		 */
+		void * GetWritableData() { return writable ? data : nullptr; }
+
+		/**
+		 * @brief Get the mapped memory
+		 */
+		const void * GetData() const { return data; }
+
+		/**
+		 * @brief Get the size of the mapped memory, in bytes
+		 */
+		size_t GetSize() const { return size; }
+
+		/**
+		 * @brief Get the name of the segment
+		 */
+		const std::string & GetName() const { return name; }
+
+		/**
+		 * @brief Check if the segment has been created by this process
+		 */
+		bool IsWritable() const { return writable; }
+
+	private:
+		CSharedMemorySegment(const std::string & _name)
+			: name { _name }
+			, data { nullptr }
+			, size { 0 }
+			, writable { false }
+#if defined(_WIN32)
+			, handle { NULL }
+#else
+			, fileDescriptor { -1 }
+#endif
+		{ }
+
+#if defined(_WIN32)
+		static std::string GetPlatformName(const std::string & _name) { return "Local\\" + _name; }
+
+		bool CreateMapping(size_t _size) {
+			const uint64_t size64 = static_cast<uint64_t>(_size);
+			handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffffu), GetPlatformName(name).c_str());
+			if (handle == NULL) { return false; }
+			if (GetLastError() == ERROR_ALREADY_EXISTS) {
+				Close();
+				return false;
+			}
+			data = MapViewOfFile(handle, FILE_MAP_WRITE, 0, 0, _size);
+			if (data == nullptr) {
+				Close();
+				return false;
+			}
+			size = _size;
+			writable = true;
+			return true;
+		}
+
+		bool OpenMapping() {
+			handle = OpenFileMappingA(FILE_MAP_READ, FALSE, GetPlatformName(name).c_str());
+			if (handle == NULL) { return false; }
+			data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+			if (data == nullptr) {
+				Close();
+				return false;
+			}
+			MEMORY_BASIC_INFORMATION info;
+			size = VirtualQuery(data, &info, sizeof(info)) != 0 ? info.RegionSize : 0;
+			return true;
+		}
+
+		void Close() {
+			if (data != nullptr) { UnmapViewOfFile(data); }
+			if (handle != NULL) { CloseHandle(handle); }
+			data = nullptr;
+			handle = NULL;
+			size = 0;
+		}
+#else
+		static std::string GetPlatformName(const std::string & _name) { return "/" + _name; }
+
+		// Every process that maps the segment keeps its descriptor open with a shared lock on it, so that the last one to close it can
+		// tell that nobody else is using it. Where the locks are not supported, the segment is kept until it is removed.
+		bool CreateMapping(size_t _size) {
+			int newDescriptor = shm_open(GetPlatformName(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+			if (newDescriptor < 0) { return false; }
+			if (ftruncate(newDescriptor, static_cast<off_t>(_size)) != 0) {
+				close(newDescriptor);
+				shm_unlink(GetPlatformName(name).c_str());
+				return false;
+			}
+			void * mapped = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, newDescriptor, 0);
+			if (mapped == MAP_FAILED) {
+				close(newDescriptor);
+				shm_unlink(GetPlatformName(name).c_str());
+				return false;
+			}
+			flock(newDescriptor, LOCK_SH);
+			fileDescriptor = newDescriptor;
+			data = mapped;
+			size = _size;
+			writable = true;
+			return true;
+		}
+
+		bool OpenMapping() {
+			int newDescriptor = shm_open(GetPlatformName(name).c_str(), O_RDONLY, 0);
+			if (newDescriptor < 0) { return false; }
+			struct stat status;
+			if (fstat(newDescriptor, &status) != 0 || status.st_size <= 0) {
+				close(newDescriptor);
+				return false;
+			}
+			void * mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, newDescriptor, 0);
+			if (mapped == MAP_FAILED) {
+				close(newDescriptor);
+				return false;
+			}
+			flock(newDescriptor, LOCK_SH);
+			fileDescriptor = newDescriptor;
+			data = mapped;
+			size = static_cast<size_t>(status.st_size);
+			return true;
+		}
+
+		void Close() {
+			if (data != nullptr) { munmap(data, size); }
+			if (fileDescriptor >= 0) {
+				// Only the last user gets the exclusive lock. The shared lock is released first instead of converting it, because the conversion
+				// is not atomic and a failed one may keep the shared lock, so two users closing at the same time could both fail. Released
+				// explicitly, a user that fails holds no lock anymore and the other one succeeds. The name is removed only if it has not been
+				// given to another segment meanwhile.
+				flock(fileDescriptor, LOCK_UN);
+				if (flock(fileDescriptor, LOCK_EX | LOCK_NB) == 0 && IsNameOfThisSegment()) {
+					shm_unlink(GetPlatformName(name).c_str());
+				}
+				close(fileDescriptor);
+			}
+			fileDescriptor = -1;
+			data = nullptr;
+			size = 0;
+		}
+
+		// Check if the name of the segment still refers to the memory held by this object
+		bool IsNameOfThisSegment() const {
+			int otherDescriptor = shm_open(GetPlatformName(name).c_str(), O_RDONLY, 0);
+			if (otherDescriptor < 0) { return false; }
+			struct stat thisStatus;
+			struct stat otherStatus;
+			const bool same = fstat(fileDescriptor, &thisStatus) == 0 && fstat(otherDescriptor, &otherStatus) == 0
+				&& thisStatus.st_dev == otherStatus.st_dev && thisStatus.st_ino == otherStatus.st_ino;
+			close(otherDescriptor);
+			return same;
+		}
+#endif
+
+		std::string name;		// Name of the segment, without platform prefixes
+		void * data;			// Mapped memory
+		size_t size;			// Size of the mapped memory
+		bool writable;			// True if the segment has been created by this process
+#if defined(_WIN32)
+		HANDLE handle;			// File mapping handle
+#else
+		int fileDescriptor;		// Descriptor of the segment, open while it is mapped and holding a shared lock on it
+#endif
+	};
+}
+#endif
@@ -26,13 +26,19 @@
 #define _CWAVE_GUIDE_H_
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <Common/Buffer.hpp>
 #include <Common/Vector3.hpp>
 #include <Common/GlobalParameters.hpp>
-#include <boost/circular_buffer.hpp>
 #include <Common/ErrorHandler.hpp>
 #include <Filters/FilterBase.hpp>
 
+#ifndef WAVEGUIDE_MAXIMUM_DISTANCE
+	#define WAVEGUIDE_MAXIMUM_DISTANCE 50 ///< Source-listener distance, in meters, for which the waveguide storage is preallocated
+#endif
+
 namespace Common {
 	class CWaveguide
 	{
@@ -42,19 +48,44 @@ namespace Common {
 		*/				
 		CWaveguide() 
 			: enablePropagationDelay(false)
+			, ringMask(0)
+			, ringHead(0)
+			, ringSize(0)
+			, ringCapacity(0)
+			, maximumDistance(WAVEGUIDE_MAXIMUM_DISTANCE)
 			, previousListenerPositionInitialized(false)
-			, checkSoundSpeedLimit(0)			
 			, propagationFilter {nullptr}
+			, checkSoundSpeedLimit(0)			
 		{}
 		
 		/** \brief Enable propagation delay for this waveguide
+		*	\details The storage for the maximum distance is allocated here, so that the movement of the source or the listener does not allocate memory while processing
 		*   \eh Nothing is reported to the error handler.
 		*/
 		void EnablePropagationDelay() { 
 			checkSoundSpeedLimit = float(globalParameters.GetBufferSize()) * (globalParameters.GetSoundSpeed() / float(globalParameters.GetSampleRate()));
+			ReserveMaximumDistance();
 			enablePropagationDelay = true; 
 		}
 
+		/** \brief Set the maximum source-listener distance expected for this waveguide, used to preallocate its storage
+		*	\details Longer distances are still supported, but the storage has to grow (and allocate) the first time they are reached.
+		*	\param [in] _maximumDistance distance in meters
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		void SetMaximumDistance(float _maximumDistance) {
+			if (_maximumDistance <= 0) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "The maximum distance of the waveguide has to be greater than zero");
+				return;
+			}
+			maximumDistance = _maximumDistance;
+			if (enablePropagationDelay) { ReserveMaximumDistance(); }
+		}
+
+		/** \brief Get the maximum source-listener distance for which the storage is preallocated, in meters
+		*/
+		float GetMaximumDistance() const { return maximumDistance; }
+
 		/** \brief Disable propagation delay for this waveguide
 		*   \eh Nothing is reported to the error handler.
 		*/
@@ -137,7 +168,8 @@ namespace Common {
 			enablePropagationDelay = false;
 			previousListenerPositionInitialized = false;
 			previousListenerPosition = CVector3(0, 0, 0); // Init previous Listener position
-			circular_buffer.clear(); // reset the circular buffer
+			ringHead = 0; // reset the circular buffer, keeping its storage
+			ringSize = 0;
 			SetCirculaBufferCapacity(0);
 			sourcePositionsBuffer.clear(); // reset the source position buffer
 			mostRecentBuffer.clear();
@@ -200,25 +232,25 @@ namespace Common {
 				SET_RESULT(RESULT_WARNING, "The source is moving faster than the sound speed");
 			}*/
 
-			if (circular_buffer.capacity() == 0) {
+			if (ringCapacity == 0) {
 				// This is the first Time
 				// We initialize the buffers the first time, this is when its capacity is zero
 				int newDelayInSamples = CalculateDistanceInSamples(globalParameters.GetSampleRate(), globalParameters.GetSoundSpeed(), currentDistanceToListener);
 				ResizeCirculaBuffer(newDelayInSamples + globalParameters.GetBufferSize()); // Buffer has to grow, full of Zeros
 				InitSourcePositionBuffer(changeInDelayInSamples, _sourcePosition); // Introduce first data into the sourcePositionBuffer.
 				// Save data into the circular_buffer
-				circular_buffer.insert(circular_buffer.end(), _inputBuffer.begin(), _inputBuffer.end()); // Introduce the input buffer into the circular buffer
+				PushBackCirculaBuffer(_inputBuffer.data(), _inputBuffer.size()); // Introduce the input buffer into the circular buffer
 				InsertBackSourcePositionBuffer(_inputBuffer.size(), _sourcePosition); // Introduce the source positions into its buffer
 			} else if (changeInDelayInSamples == 0) {
 				//No movement
-				circular_buffer.insert(circular_buffer.end(), _inputBuffer.begin(), _inputBuffer.end()); //introduce the input buffer into the circular buffer
+				PushBackCirculaBuffer(_inputBuffer.data(), _inputBuffer.size()); //introduce the input buffer into the circular buffer
 				InsertBackSourcePositionBuffer(_inputBuffer.size(), _sourcePosition); // introduce the source positions into its buffer
 			} else {
 				// There a Source Movement
 				// If source moves towards the listener --> Distance decreases --> Time compression --> insertBufferSize < bufferSize
 				// If source moves away from listener   --> Distance increases --> Time expansion
 
-				int currentDelayInSamples = circular_buffer.size() - globalParameters.GetBufferSize(); // Calculate current delay in samples
+				int currentDelayInSamples = ringSize - globalParameters.GetBufferSize(); // Calculate current delay in samples
 				int newDelayInSamples = changeInDelayInSamples + currentDelayInSamples; // Calculate the new delay in samples
 				int insertBufferSize = changeInDelayInSamples + globalParameters.GetBufferSize(); // Calculate the expasion/compression				
 				if (insertBufferSize <= 0) {
@@ -229,7 +261,7 @@ namespace Common {
 						SET_RESULT(RESULT_ERROR_BADSIZE, "Trying to set a negative capacity to the circular buffer");
 					}
 					SetCirculaBufferCapacity(newBufferCapacity); // Remove samples from circular buffer
-					ResizeSourcePositionsBuffer(circular_buffer.size()); // Remove samples for source positions buffer
+					ResizeSourcePositionsBuffer(ringSize); // Remove samples for source positions buffer
 					InsertBackSourcePositionBuffer(1, _sourcePosition); // Insert the last position with zero samples into the source position buffer
 				} else {
 					// Change circular_buffer capacity. This is when you throw away the samples, which are already out.
@@ -269,17 +301,16 @@ namespace Common {
 			if (samplesToBeExtracted <= 0) {
 				samplesToBeExtracted *= -1; // To operate with a positive number
 				// Increase the buffer capacity so that no samples are lost.
-				RsetCirculaBuffer(circular_buffer.capacity() + globalParameters.GetBufferSize() + samplesToBeExtracted);
+				RsetCirculaBuffer(ringCapacity + globalParameters.GetBufferSize() + samplesToBeExtracted);
 				// Introduce zeros at the begging of the buffer
-				CMonoBuffer<float> insertBuffer(samplesToBeExtracted);
-				circular_buffer.insert(circular_buffer.begin(), insertBuffer.begin(), insertBuffer.end());
+				PushFrontZerosCirculaBuffer(samplesToBeExtracted);
 				//Introduce the new sample into the buffer of source positions
 				CVector3 firstPosition = sourcePositionsBuffer.front().GetPosition();
 				ShiftRightSourcePositionsBuffer(samplesToBeExtracted);
 				InsertFrontSourcePositionBuffer(samplesToBeExtracted, firstPosition);
 				//InsertFrontSourcePositionBuffer(samplesToBeExtracted, CVector3(0, 0, 0));
 				// Output a frame of zeros
-				outbuffer.resize(globalParameters.GetBufferSize());				
+				outbuffer.assign(globalParameters.GetBufferSize(), 0.0f);
 				SET_RESULT(RESULT_WARNING, "The listener is moving away from the source faster than the sound speed");
 				return;
 			}
@@ -287,23 +318,25 @@ namespace Common {
 			// In other case Get samples from buffer
 			if (samplesToBeExtracted == globalParameters.GetBufferSize()) {
 				// If it doesn't needed to do and expasion or compression									
-				outbuffer.insert(outbuffer.begin(), circular_buffer.begin(), circular_buffer.begin() + samplesToBeExtracted);
+				outbuffer.resize(samplesToBeExtracted);
+				CopyFrontCirculaBuffer(outbuffer.data(), samplesToBeExtracted);
 				// TODO FILTER HERE				
 				//propagationFilter->Process(outbuffer);
 				if (propagationFilter != nullptr)	propagationFilter->Process(outbuffer);
 				ShiftLeftSourcePositionsBuffer(samplesToBeExtracted); // Delete samples that have left the buffer storing the source positions.				
 			} else {				
-				if (samplesToBeExtracted > circular_buffer.size()) {					
-					samplesToBeExtracted = circular_buffer.size();
+				if (static_cast<size_t>(samplesToBeExtracted) > ringSize) {					
+					samplesToBeExtracted = static_cast<int>(ringSize);
 					SET_RESULT(RESULT_ERROR_BADSIZE, "Trying to extract more samples than the circular buffer has");
 				}
 				//In case we need to expand or compress
-				CMonoBuffer<float> extractingBuffer(circular_buffer.begin(), circular_buffer.begin() + samplesToBeExtracted);
+				extractingBuffer.resize(samplesToBeExtracted);
+				CopyFrontCirculaBuffer(extractingBuffer.data(), samplesToBeExtracted);
 				//propagationFilter->Process(extractingBuffer);
 				if (propagationFilter != nullptr) propagationFilter->Process(extractingBuffer);
 				ShiftLeftSourcePositionsBuffer(samplesToBeExtracted); // Delete samples that have left the buffer storing the source positions.
 				// the capacity of the circular buffer must be increased with the samples that have not been removed
-				RsetCirculaBuffer(circular_buffer.capacity() + globalParameters.GetBufferSize() - samplesToBeExtracted);
+				RsetCirculaBuffer(ringCapacity + globalParameters.GetBufferSize() - samplesToBeExtracted);
 				// Expand or compress the buffer and return it
 				outbuffer.resize(globalParameters.GetBufferSize()); // Prepare buffer
 				ProcessExpansionCompressionMethod(extractingBuffer, outbuffer); // Expand or compress the buffer
@@ -317,36 +350,109 @@ namespace Common {
 		/// CIRCULAR BUFFER
 		/////////////////////////////
 
-		/// Resize the circular buffer
-		void ResizeCirculaBuffer(size_t newSize) {
+		/// Allocate the storage needed for the maximum distance, if it is not already larger
+		void ReserveMaximumDistance() {
+			int maximumDelay = static_cast<int>(std::ceil(maximumDistance / globalParameters.GetSoundSpeed() * globalParameters.GetSampleRate()));
+			ReserveCirculaBuffer(maximumDelay + 2 * globalParameters.GetBufferSize());
+			sourcePositionsBuffer.reserve(maximumDelay / globalParameters.GetBufferSize() + 4);
+		}
+
+		/// Make sure the storage can hold the given number of samples. It is a power of two, so that the positions are wrapped with a mask.
+		/// It only allocates when it has to grow, keeping the samples in the buffer.
+		void ReserveCirculaBuffer(size_t samples) {
+			if (samples <= ringBuffer.size()) return;
+			if (samples > std::numeric_limits<size_t>::max() / 4) {
+				SET_RESULT(RESULT_ERROR_BADALLOC, "Bad alloc in delay buffer");
+				return;
+			}
+			size_t newStorageSize = 1;
+			while (newStorageSize < samples) newStorageSize *= 2;
 			try {
-				circular_buffer.resize(newSize);
-			} catch (std::bad_alloc & e) {
+				CMonoBuffer<float> newRingBuffer(newStorageSize, 0.0f);
+				for (size_t i = 0; i < ringSize; i++) {
+					newRingBuffer[i] = ringBuffer[(ringHead + i) & ringMask];
+				}
+				ringBuffer = std::move(newRingBuffer);
+			} catch (std::bad_alloc &) {
 				SET_RESULT(RESULT_ERROR_BADALLOC, "Bad alloc in delay buffer");
 				return;
 			}
+			ringMask = newStorageSize - 1;
+			ringHead = 0;
+		}
+
+		/// Resize the circular buffer, adding zeros to the back side or throwing away the newest samples
+		void ResizeCirculaBuffer(size_t newSize) {
+			if (newSize > ringCapacity) SetCirculaBufferCapacity(newSize);
+			if (newSize > ringCapacity) return;
+			for (; ringSize < newSize; ringSize++) {
+				ringBuffer[(ringHead + ringSize) & ringMask] = 0.0f;
+			}
+			ringSize = newSize;
 		}
 
 		/// Changes de circular buffer capacity, throwing away the newest samples
 		void SetCirculaBufferCapacity(size_t newSize) {
-			try {
-				/// It adds space to future samples on the back side and throws samples from the front side
-				circular_buffer.set_capacity(newSize);
-			} catch (std::bad_alloc &) {
-				SET_RESULT(RESULT_ERROR_BADALLOC, "Bad alloc in delay buffer (pushing back frame)");
-				return;
-			}
+			ReserveCirculaBuffer(newSize);
+			if (newSize > ringBuffer.size()) return;
+			/// It adds space to future samples on the back side and throws samples from the back side
+			if (newSize < ringSize) ringSize = newSize;
+			ringCapacity = newSize;
 		}
 
 		/// Changes de circular buffer capacity, throwing away the oldest samples
 		void RsetCirculaBuffer(size_t newSize) {
-			try {
-				/// It adds space to future samples on the back side and throws samples from the front side
-				circular_buffer.rset_capacity(newSize);
-			} catch (std::bad_alloc &) {
-				SET_RESULT(RESULT_ERROR_BADALLOC, "Bad alloc in delay buffer (pushing back frame)");
-				return;
+			ReserveCirculaBuffer(newSize);
+			if (newSize > ringBuffer.size()) return;
+			/// It adds space to future samples on the back side and throws samples from the front side
+			if (newSize < ringSize) {
+				ringHead = (ringHead + ringSize - newSize) & ringMask;
+				ringSize = newSize;
 			}
+			ringCapacity = newSize;
+		}
+
+		/// Throw away the oldest samples needed to insert numberOfSamples samples, at most the capacity, and return the position of the first one
+		size_t MakeRoomCirculaBuffer(size_t numberOfSamples) {
+			if (ringSize + numberOfSamples > ringCapacity) {
+				size_t overflow = ringSize + numberOfSamples - ringCapacity;
+				ringHead = (ringHead + overflow) & ringMask;
+				ringSize -= overflow;
+			}
+			return (ringHead + ringSize) & ringMask;
+		}
+
+		/// Insert samples at the back side, throwing away the oldest samples that do not fit
+		void PushBackCirculaBuffer(const float * samples, size_t numberOfSamples) {
+			if (numberOfSamples > ringCapacity) {
+				samples += numberOfSamples - ringCapacity;
+				numberOfSamples = ringCapacity;
+			}
+			// Copy in one or two contiguous blocks
+			size_t writeIndex = MakeRoomCirculaBuffer(numberOfSamples);
+			size_t firstBlock = std::min(numberOfSamples, ringBuffer.size() - writeIndex);
+			std::copy(samples, samples + firstBlock, ringBuffer.begin() + writeIndex);
+			std::copy(samples + firstBlock, samples + numberOfSamples, ringBuffer.begin());
+			ringSize += numberOfSamples;
+		}
+
+		/// Insert zeros at the front side, as long as they fit in the capacity
+		void PushFrontZerosCirculaBuffer(size_t numberOfSamples) {
+			numberOfSamples = std::min(numberOfSamples, ringCapacity - ringSize);
+			for (size_t i = 0; i < numberOfSamples; i++) {
+				ringHead = (ringHead - 1) & ringMask;
+				ringBuffer[ringHead] = 0.0f;
+			}
+			ringSize += numberOfSamples;
+		}
+
+		/// Copy the oldest samples, without removing them. If the circular buffer has fewer samples, the rest are set to zero
+		void CopyFrontCirculaBuffer(float * out, size_t numberOfSamples) const {
+			size_t availableSamples = std::min(numberOfSamples, ringSize);
+			size_t firstBlock = std::min(availableSamples, ringBuffer.size() - ringHead);
+			std::copy(ringBuffer.begin() + ringHead, ringBuffer.begin() + ringHead + firstBlock, out);
+			std::copy(ringBuffer.begin(), ringBuffer.begin() + (availableSamples - firstBlock), out + firstBlock);
+			std::fill(out + availableSamples, out + numberOfSamples, 0.0f);
 		}
 		
 		////////////////
@@ -371,63 +477,38 @@ namespace Common {
 		/////////////////////////
 		/// Execute a buffer expansion or compression
 		void ProcessExpansionCompressionMethod(const CMonoBuffer<float> & input, CMonoBuffer<float> & output) {
-			int outputSize = output.size();
-			//Calculate the compresion factor. See technical report
-			float position = 0;
-			float numerator = input.size() - 1;
-			float denominator = outputSize - 1;
-			float compressionFactor = numerator / denominator;
-
-			int j;
-			float rest;
-			int i;
-			//Fill the output buffer with the new values
-			for (i = 0; i < outputSize - 1; i++) {
-				j = static_cast<int>(position);
-				rest = position - j;
-
-				if ((j + 1) < input.size()) {
-					output[i] = input[j] * (1 - rest) + input[j + 1] * rest;
-
-				} else {
-					// TODO think why this happens. If this solution the ok?
-					output[i] = input[j] * (1 - rest);
-				}
-				position += compressionFactor;
-			}
-			output[outputSize - 1] = input[input.size() - 1]; // the last sample has to be the same as the one in the input buffer.
+			ProcessExpansionCompressionMethod(input, output.size(), 0, output.size(), output.data());
 		}
 
 		/// Execute a buffer expansion or compression, and introduce the samples directly into the circular buffer
 		void ProcessExpansionCompressionMethod(const CMonoBuffer<float> & input, int outputSize) {
-			//Calculate the compresion factor. See technical report
-			float position = 0;
-			float numerator = input.size() - 1;
-			float denominator = outputSize - 1;
-			float compressionFactor = numerator / denominator;
-
-			int j;
-			float rest;
-			int i;
-			//Fill the output buffer with the new values
-			for (i = 0; i < outputSize - 1; i++) {
-				j = static_cast<int>(position);
-				rest = position - j;
-
-				if ((j + 1) < input.size()) {
-					//output[i] = input[j] * (1 - rest) + input[j + 1] * rest;
-					circular_buffer.push_back(input[j] * (1 - rest) + input[j + 1] * rest);
+			if (outputSize <= 0 || ringCapacity == 0) return;
+			// If the expanded buffer does not fit, only its newest samples are kept
+			size_t firstOutput = static_cast<size_t>(outputSize) > ringCapacity ? outputSize - ringCapacity : 0;
+			size_t numberOfSamples = outputSize - firstOutput;
+			// Write in one or two contiguous blocks
+			size_t writeIndex = MakeRoomCirculaBuffer(numberOfSamples);
+			size_t firstBlock = std::min(numberOfSamples, ringBuffer.size() - writeIndex);
+			ProcessExpansionCompressionMethod(input, outputSize, firstOutput, firstBlock, ringBuffer.data() + writeIndex);
+			ProcessExpansionCompressionMethod(input, outputSize, firstOutput + firstBlock, numberOfSamples - firstBlock, ringBuffer.data());
+			ringSize += numberOfSamples;
+		}
 
-				} else {
-					// TODO think why this happens. If this solution the ok?
-					//output[i] = input[j] * (1 - rest);
-					circular_buffer.push_back(input[j] * (1 - rest));
-				}
-				position += compressionFactor;
+		/// Write the samples [firstOutput, firstOutput + numberOfSamples) of the input buffer expanded or compressed to outputSize samples.
+		/// The first and last samples of the expanded buffer are the first and last samples of the input buffer, and the rest are read with linear interpolation
+		void ProcessExpansionCompressionMethod(const CMonoBuffer<float> & input, size_t outputSize, size_t firstOutput, size_t numberOfSamples, float * output) {
+			if (numberOfSamples == 0) return;
+			if (input.size() < 2 || outputSize < 2) {
+				std::fill(output, output + numberOfSamples, input.empty() ? 0.0f : input.back());
+				return;
+			}
+			//Calculate the compresion factor. See technical report
+			float compressionFactor = float(input.size() - 1) / float(outputSize - 1);
+			CBufferKernels::ResampleLinear(input.data(), input.size(), output, numberOfSamples, compressionFactor * float(firstOutput), compressionFactor);
+			if (firstOutput + numberOfSamples == outputSize) {
+				output[numberOfSamples - 1] = input.back(); // the last sample has to be the same as the one in the input buffer.
 			}
-			//output[outputSize - 1] = input[input.size() - 1];		// the last sample has to be the same as the one in the input buffer.
-			circular_buffer.push_back(input[input.size() - 1]);
-		}	
+		}
 
 		////////////////////////////
 		// Source Positions Buffer
@@ -442,8 +523,8 @@ namespace Common {
 
 		/// Insert at the buffer back the source position for a set of samples
 		void InsertBackSourcePositionBuffer(int bufferSize, const CVector3 & _sourcePosition) {
-			int begin = circular_buffer.size() - bufferSize;
-			int end = circular_buffer.size() - 1;
+			int begin = ringSize - bufferSize;
+			int end = ringSize - 1;
 			TSourcePosition temp(begin, end, _sourcePosition);
 			sourcePositionsBuffer.push_back(temp); // introduce in to the sourcepositionsbuffer
 		}
@@ -458,29 +539,22 @@ namespace Common {
 		/// This is because it is assumed that samples will have come out of the circular buffer from the front.
 		void ShiftLeftSourcePositionsBuffer(int samples) {
 
-			std::vector<int> positionsToDelete;
 			if (samples <= 0) {
 				return;
 			}
 
-			//int positionToDelete = -1;
-			int index = 0;
+			bool allPositionsLeft = true;
 			for (auto & element : sourcePositionsBuffer) {
 				element.beginIndex = element.beginIndex - samples;
 				element.endIndex = element.endIndex - samples;
-				if (element.endIndex < 0) {
-					// Delete
-					//positionToDelete = index;
-					positionsToDelete.push_back(index);
-				} else if (element.beginIndex < 0) {
-					element.beginIndex = 0;
+				if (element.endIndex >= 0) {
+					allPositionsLeft = false;
+					if (element.beginIndex < 0) element.beginIndex = 0;
 				}
-				index++;
 			}
-			if (positionsToDelete.size() < sourcePositionsBuffer.size()) {							
-				for (int i = positionsToDelete.size() - 1; i > -1; i--) {
-					sourcePositionsBuffer.erase(sourcePositionsBuffer.begin() + positionsToDelete[i]);
-				}
+			if (!allPositionsLeft) {
+				// Delete, in place, the positions of the samples that have left
+				sourcePositionsBuffer.erase(std::remove_if(sourcePositionsBuffer.begin(), sourcePositionsBuffer.end(), [](const TSourcePosition & element) { return element.endIndex < 0; }), sourcePositionsBuffer.end());
 			} else {				
 				/// This prevents the source position buffer from becoming empty, which would suggest a source movement 
 				// to the Process Source Movement method. The situation where this buffer becomes empty occurs when the 
@@ -506,23 +580,17 @@ namespace Common {
 		/// Remove samples from the back side of the buffer in order to have the same size that the circular buffer
 		void ResizeSourcePositionsBuffer(int newSize) {
 
-			std::vector<int> positionsToDelete;
 			if (newSize <= 0) {
 				return;
 			}
 
-			for (int i = sourcePositionsBuffer.size() - 1; i > -1; i--) {
-
-				if (sourcePositionsBuffer[i].beginIndex > newSize - 1) {
-					positionsToDelete.push_back(i);
-				} else if (sourcePositionsBuffer[i].endIndex > newSize - 1) {
-					sourcePositionsBuffer[i].endIndex = newSize - 1;
+			for (auto & element : sourcePositionsBuffer) {
+				if (element.beginIndex <= newSize - 1 && element.endIndex > newSize - 1) {
+					element.endIndex = newSize - 1;
 				}
 			}
-
-			for (auto & element : positionsToDelete) {
-				sourcePositionsBuffer.erase(sourcePositionsBuffer.begin() + element);
-			}
+			// Delete, in place, the positions of the samples that have been thrown away
+			sourcePositionsBuffer.erase(std::remove_if(sourcePositionsBuffer.begin(), sourcePositionsBuffer.end(), [newSize](const TSourcePosition & element) { return element.beginIndex > newSize - 1; }), sourcePositionsBuffer.end());
 		}
 
 		/// Get the last source position
@@ -561,7 +629,13 @@ namespace Common {
 		bool enablePropagationDelay;					/// To store if the propagation delay is enabled or not		
 		CMonoBuffer<float> mostRecentBuffer;			/// To store the last buffer introduced into the waveguide
 		CVector3 mostRecentSourceTransform;				/// To store the last source transform introduced into the waveguide
-		boost::circular_buffer<float> circular_buffer;	/// To store the samples into the waveguide			
+		CMonoBuffer<float> ringBuffer;					/// To store the samples into the waveguide. Its size is a power of two
+		size_t ringMask;								/// ringBuffer.size() - 1, to wrap the positions
+		size_t ringHead;								/// Position of the oldest sample
+		size_t ringSize;								/// Number of samples in the waveguide
+		size_t ringCapacity;							/// Number of samples that the waveguide can hold before throwing away the oldest ones
+		CMonoBuffer<float> extractingBuffer;			/// To store the samples extracted when the listener moves
+		float maximumDistance;							/// Distance, in meters, for which the storage is preallocated
 		
 		std::vector<TSourcePosition> sourcePositionsBuffer;	/// To store the source positions in each frame
 		CVector3 previousListenerPosition;				/// To store the last position of the listener
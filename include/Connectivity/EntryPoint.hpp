@@ -27,6 +27,7 @@
 #include <Connectivity/ExitPoint.hpp>
 #include <Connectivity/ObserverBase.hpp>
 #include <Common/Buffer.hpp>
+#include <Common/PlanarBuffer.hpp>
 #include <Common/Transform.hpp>
 #include <Connectivity/Command.hpp>
 #include <ServiceModules/AmbisonicBIR.hpp>
@@ -77,7 +78,7 @@ namespace BRTConnectivity {
     };
            
     using CEntryPointSamplesVector = CEntryPointBase<CMonoBuffer<float>>;
-    using CEntryPointMultipleSamplesVector = CEntryPointBase<std::vector<CMonoBuffer<float>>>;
+    using CEntryPointMultipleSamplesVector = CEntryPointBase<CMultiChannelBuffer<float>>;
     using CEntryPointTransform = CEntryPointBase<Common::CTransform>;     
     using CEntryPointCommand = CEntryPointBase<BRTConnectivity::CCommand>;
     using CEntryPointID = CEntryPointBase<std::string>;
@@ -27,6 +27,7 @@
 #include <memory>
 #include <Connectivity/ObserverBase.hpp>
 #include <Common/Buffer.hpp>
+#include <Common/PlanarBuffer.hpp>
 #include <Common/Transform.hpp>
 #include <Connectivity/Command.hpp>
 #include <ServiceModules/AmbisonicBIR.hpp>
@@ -60,7 +61,7 @@ namespace BRTConnectivity {
     };
     
     using CExitPointSamplesVector = CExitPointBase<CMonoBuffer<float> >;
-    using CExitPointMultipleSamplesVector = CExitPointBase<std::vector<CMonoBuffer<float>>>;
+    using CExitPointMultipleSamplesVector = CExitPointBase<CMultiChannelBuffer<float>>;
     using CExitPointTransform = CExitPointBase<Common::CTransform >;
     using CExitPointCommand = CExitPointBase<BRTConnectivity::CCommand>;
     using CExitPointID = CExitPointBase<std::string>;
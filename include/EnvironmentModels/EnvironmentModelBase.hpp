@@ -82,6 +82,17 @@ namespace BRTEnvironmentModel {
 
 		virtual size_t GetNumberOfVirtualSources() { return 0; }
 		virtual size_t GetNumberOfActiveVirtualSources() { return 0; }
+		virtual size_t GetNumberOfRenderedVirtualSources() { return 0; }
+
+		virtual bool SetAudibilityBudget(int _maxImageSources) { return false; }
+		virtual int GetAudibilityBudget() { return 0; }
+
+		virtual bool SetAudibilityThreshold(float _thresholdDB) { return false; }
+		virtual float GetAudibilityThreshold() { return 0; }
+
+		virtual void EnableParallelImageTree(int _numberOfThreads = 0) { }
+		virtual void DisableParallelImageTree() { }
+		virtual bool IsParallelImageTreeEnabled() { return false; }
 
 		virtual bool ConnectSoundSource(const std::string & _sourceID) { return false; }
 		virtual bool DisconnectSoundSource(const std::string & _sourceID) { return false; }	
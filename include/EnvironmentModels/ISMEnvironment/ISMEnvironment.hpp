@@ -23,9 +23,15 @@
 #define _ISM_ENVIRONMENT_HPP_
 
 #include <memory>
+#include <limits>
+#include <algorithm>
 #include <Common/ErrorHandler.hpp>
 #include <Common/Vector3.hpp>
+#include <Common/PlanarBuffer.hpp>
+#include <Common/MultiTapDelayLine.hpp>
+#include <ProcessingModules/DistanceAttenuator.hpp>
 #include <ServiceModules/Room.hpp>
+#include <ServiceModules/SetupWorkerPool.hpp>
 #include "ISMParameters.hpp"
 #include "ISMSourceImage.hpp"
 #include <Filters/CascadeGraphicEq9OctaveBands.hpp>
@@ -35,6 +41,7 @@ namespace BRTEnvironmentModel {
 	class CISMEnvironment {
 	
 		constexpr static float visibilityThreshold = 0.00001; // Threshold to consider a source as audible (visible)
+		constexpr static float fadeOutAttenuationThreshold = 0.0001; // Attenuation below which an evicted image source is no longer rendered
 	
 	public:
 		CISMEnvironment()
@@ -45,7 +52,12 @@ namespace BRTEnvironmentModel {
 			, imageSources{ nullptr }
 			, imageSourcesPositionList { std::vector<Common::CVector3>() }
 			, imageSourcesDataList { std::vector<TImageSourceData>() }
+			, positionsHistoryFrames { 0 }
+			, positionsHistoryNewestFrame { 0 }
+			, audibilityBudget { 0 }
+			, audibilityThresholdDB { -std::numeric_limits<float>::infinity() }
 			, numVisibleImageSources { 0 }						
+			, numRenderedImageSources { 0 }
 		{
 		};
 
@@ -85,11 +97,17 @@ namespace BRTEnvironmentModel {
 			sourceLocation = _sourceTransform.GetPosition();
 			ISMParameters->listenerPosition = _listenerTransform.GetPosition();
 
+			std::shared_ptr<BRTServices::CSetupWorkerPool> workerPool;
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				workerPool = imageTreeWorkerPool;
+			}
 			imageSources = std::make_shared<CISMSourceImage>(ISMParameters);
-			imageSources->createImagesTree(ISMParameters->room, reflectionOrder, sourceLocation);
+			imageSources->createImagesTree(ISMParameters->room, reflectionOrder, sourceLocation, workerPool.get());
+			imageSourcesDataList.clear();
 			UpdateImageSourceDataFromImageTree();
 			
-			SetupWaveGuideProcessors();
+			SetupPropagationDelayLine();
 			SetupDistanceAttenuator();
 
 			// TODO check if everything went fine before setting setupDone to true
@@ -149,6 +167,84 @@ namespace BRTEnvironmentModel {
 			return numVisibleImageSources;
 		}
 		
+		/**
+		 * @brief Returns the number of image sources rendered in the last frame, including those that are fading out.
+		 * @return The count of rendered image sources as a size_t value.
+		 */
+		size_t GetNumberOfRenderedImageSources() const {
+			return numRenderedImageSources;
+		}
+
+		/**
+		 * @brief Sets the maximum number of image sources rendered in each frame.
+		 * @details Every frame the visible image sources are ranked by their estimated energy at the listener, and only the loudest ones
+		 *	are rendered. Image sources fade in when they are admitted and fade out when they are evicted.
+		 * @param _maxImageSources maximum number of rendered image sources. With 0 all the visible image sources are rendered.
+		 * @return True if the value is valid
+		 */
+		bool SetAudibilityBudget(int _maxImageSources) {
+			if (_maxImageSources < 0) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "The audibility budget must be equal or greater than zero");
+				return false;
+			}
+			std::lock_guard<std::mutex> l(mutex);
+			audibilityBudget = static_cast<size_t>(_maxImageSources);
+			return true;
+		}
+
+		/**
+		 * @brief Returns the maximum number of image sources rendered in each frame, 0 if there is no limit.
+		 */
+		size_t GetAudibilityBudget() const {
+			return audibilityBudget;
+		}
+
+		/**
+		 * @brief Sets the energy below which an image source is not rendered.
+		 * @details The energy of an image source is estimated as its distance attenuation times the mean energy of its reflection
+		 *	coefficients, so it is relative to the energy of the original source at the reference distance.
+		 * @param _thresholdDB threshold in decibels. With -infinity, the default value, all the visible image sources can be rendered.
+		 */
+		void SetAudibilityThreshold(float _thresholdDB) {
+			std::lock_guard<std::mutex> l(mutex);
+			audibilityThresholdDB = _thresholdDB;
+		}
+
+		/**
+		 * @brief Returns the energy below which an image source is not rendered, in decibels.
+		 */
+		float GetAudibilityThreshold() const {
+			return audibilityThresholdDB;
+		}
+
+		/**
+		 * @brief Creates the image sources tree on worker threads in the next setups.
+		 * @details The subtree of each first order image source is created on one of the workers, and the first visibilities are computed
+		 *	in blocks on them if there are at least ISM_PARALLEL_VISIBILITY_MIN_IMAGES image sources. The workers are never used by Process:
+		 *	the updates when the source or the listener move run in the audio thread, without waiting for other threads. The pool can be
+		 *	shared by several environments, and it is kept alive by each of them.
+		 * @param _workerPool worker threads to use, null to create the tree in the calling thread
+		 */
+		void EnableParallelImageTree(std::shared_ptr<BRTServices::CSetupWorkerPool> _workerPool) {
+			std::lock_guard<std::mutex> l(mutex);
+			imageTreeWorkerPool = std::move(_workerPool);
+		}
+
+		/**
+		 * @brief Creates the image sources tree in the calling thread
+		 */
+		void DisableParallelImageTree() {
+			std::lock_guard<std::mutex> l(mutex);
+			imageTreeWorkerPool.reset();
+		}
+
+		/**
+		 * @brief Checks if the image sources tree is created and updated on worker threads
+		 */
+		bool IsParallelImageTreeEnabled() const {
+			return imageTreeWorkerPool != nullptr;
+		}
+
 		/** \brief Returns data of all image sources
 		*	\details This method returns the location of all image sources and wether they are visible or not, not including the
 		*	original source (direct path).
@@ -172,20 +268,23 @@ namespace BRTEnvironmentModel {
 		void Process(CMonoBuffer<float> & _inBuffer
 			, const Common::CTransform & _sourceTransform
 			, const Common::CTransform & _listenerTransform
-			, std::vector<CMonoBuffer<float>> & _outBuffers
+			, CMultiChannelBuffer<float> & _outBuffers
 			, std::vector<Common::CTransform> & _virtualSourcePositions) 
 		{
 		
 			std::lock_guard<std::mutex> l(mutex);
 			ASSERT(_inBuffer.size() == globalParameters.GetBufferSize(), RESULT_ERROR_BADSIZE, "InBuffer size has to be equal to the input size indicated by the BRT::GlobalParameters method", "");
-			ASSERT(_outBuffers.size() == GetNumberOfImageSources() || _virtualSourcePositions.size() == GetNumberOfImageSources(), RESULT_ERROR_BADSIZE, "_outBuffers and _virtualSourcePositions size needs to be " + std::to_string(GetNumberOfImageSources()), "");
+			ASSERT(_outBuffers.GetNChannels() == GetNumberOfImageSources() || _virtualSourcePositions.size() == GetNumberOfImageSources(), RESULT_ERROR_BADSIZE, "_outBuffers and _virtualSourcePositions size needs to be " + std::to_string(GetNumberOfImageSources()), "");
 
 
 			SetSourceAndListenerPositions_withoutLock(_sourceTransform.GetPosition(), _listenerTransform.GetPosition());
-			// Process the waveguide			
-			PushToWaveGuideProcessors(_inBuffer);						
-			// Pop front the waveguide to get the output buffer and the effective source position (with propagation delay)
-			PopFromWaveGuideProcessors(_outBuffers, _virtualSourcePositions);								
+			// Write the source once into the delay line shared by all the image sources
+			propagationDelayLine.Write(_inBuffer);
+			StoreImageSourcesPositions();
+			// Choose the image sources that are rendered in this frame
+			UpdateAudibleImageSources(_listenerTransform);
+			// Read each image source through its tap to get the output buffer and the effective source position (with propagation delay)
+			ReadImageSourcesFromDelayLine(_outBuffers, _virtualSourcePositions);
 			//Apply visiblity and distance gain to each output buffer			
 			ApplyGainToOutputBuffers(_outBuffers, _virtualSourcePositions, _listenerTransform);
 		}
@@ -200,15 +299,29 @@ namespace BRTEnvironmentModel {
 				sourceLocation = Common::CVector3(0, 0, 0);
 				imageSourcesPositionList.clear();				
 				imageSourcesDataList.clear();
-				listOfChannelSourceListener.clear();		
+				propagationDelayLine.SetNumberOfTaps(0);
+				propagationFilters.clear();
+				imageSourcesPositionsHistory.clear();
+				positionsHistoryFrames = 0;
 				imageSourcesPreviousAttenuationList.clear();
+				imageSourcesEnergyList.clear();
+				imageSourcesAdmittedList.clear();
+				imageSourcesRenderedList.clear();
+				numRenderedImageSources = 0;
 			}
 		}
 
+		/**
+		 * @brief Reset the propagation delay line and filters of all the image sources
+		 */
 		void ResetWaveguideBuffers() {
-			for (auto & _channel : listOfChannelSourceListener) {
-				_channel->Reset();
+			propagationDelayLine.Reset();
+			for (auto & _filter : propagationFilters) {
+				_filter->ResetBuffers();
 			}
+			ResetImageSourcesPositionsHistory();
+			std::fill(imageSourcesPreviousAttenuationList.begin(), imageSourcesPreviousAttenuationList.end(), 0.0f);
+			std::fill(imageSourcesRenderedList.begin(), imageSourcesRenderedList.end(), false);
 		}
 	private:
 		
@@ -223,16 +336,16 @@ namespace BRTEnvironmentModel {
 		//	}
 		//}
 
-		void ApplyGainToOutputBuffers(std::vector<CMonoBuffer<float>> & _outBuffers, const std::vector<Common::CTransform> & _virtualSourcePositions, const Common::CTransform & _listenerTransform) { 
-			if (_outBuffers.size() != imageSourcesDataList.size()) return;
-			for (int i = 0; i < _outBuffers.size(); i++) { 
-				if (!imageSourcesDataList[i].visible) {
-					_outBuffers[i] = CMonoBuffer<float>(globalParameters.GetBufferSize(), 0.0f); //Set to zero
+		void ApplyGainToOutputBuffers(CMultiChannelBuffer<float> & _outBuffers, const std::vector<Common::CTransform> & _virtualSourcePositions, const Common::CTransform & _listenerTransform) { 
+			if (_outBuffers.GetNChannels() != imageSourcesDataList.size()) return;
+			for (int i = 0; i < _outBuffers.GetNChannels(); i++) { 
+				if (!imageSourcesRenderedList[i]) {
+					continue; // Already set to zero
 				} else {
 					float distanceAttenuation = distanceAttenuator.CalculateDistanceAttenuation(_virtualSourcePositions[i].GetPosition(), _listenerTransform);
-					float attenuation = distanceAttenuation * imageSourcesDataList[i].visibility;
-					float unnecessary_fixme;
-					_outBuffers[i].ApplyGainExponentially(imageSourcesPreviousAttenuationList[i], unnecessary_fixme, attenuation, globalParameters.GetBufferSize(), globalParameters.GetSampleRate());
+					// Evicted image sources fade out until they are no longer rendered
+					float attenuation = imageSourcesAdmittedList[i] ? distanceAttenuation * imageSourcesDataList[i].visibility : 0.0f;
+					_outBuffers.ApplyGainExponentially(i, imageSourcesPreviousAttenuationList[i], attenuation, globalParameters.GetSampleRate());
 				}
 			}
 		}
@@ -288,7 +401,7 @@ namespace BRTEnvironmentModel {
 		void ActionsAfterUpdateImageSourcePositionsOrVisibilities() {			
 			UpdateImageSourceDataFromImageTree();
 			//UpdateImageSourcesPositionList();
-			UpdateWaveGuideFiltersVisibility();			
+			UpdatePropagationFiltersVisibility();			
 
 #if defined(DEBUG) || defined(_DEBUG)
 			ShowImageSourceData(imageSourcesDataList); // TO DELETE
@@ -297,12 +410,16 @@ namespace BRTEnvironmentModel {
 
 		/**
 		 * @brief Updates image source data from the image source tree after any change
+		 * @details While the tree is the same, only the locations and visibilities are updated, in place. The whole list is only built
+		 *	again after the tree has been created.
 		 */
 		void UpdateImageSourceDataFromImageTree() {
 			if (imageSources == nullptr) return;
 			
-			imageSourcesDataList.clear();			
-			imageSources->getImageSourcesData(imageSourcesDataList);
+			if (!imageSources->UpdateImageSourcesData(imageSourcesDataList)) {
+				imageSourcesDataList.clear();			
+				imageSources->getImageSourcesData(imageSourcesDataList);
+			}
 			UpdateImageSourcesPositionList();			
 		}
 		
@@ -310,11 +427,11 @@ namespace BRTEnvironmentModel {
 		 * @brief Updates images source positions after any change
 		 */
 		void UpdateImageSourcesPositionList() {			
-			imageSourcesPositionList.clear();
+			imageSourcesPositionList.resize(imageSourcesDataList.size());
 			numVisibleImageSources = 0;
-			for (auto & image : imageSourcesDataList) {
-				imageSourcesPositionList.push_back(image.location);
-				if (image.visible) numVisibleImageSources++;
+			for (size_t i = 0; i < imageSourcesDataList.size(); i++) {
+				imageSourcesPositionList[i] = imageSourcesDataList[i].location;
+				if (imageSourcesDataList[i].visible) numVisibleImageSources++;
 			}
 		}
 		
@@ -333,25 +450,26 @@ namespace BRTEnvironmentModel {
 		}
 		
 		/**
-		 * @brief Initializes the wave guide processors by clearing and resizing 
-			the list of channel source-listeners based on the number of image source locations.
+		 * @brief Initializes the delay line shared by all the image sources, with one tap per image source, and the propagation filters.
+		 * @details The line and the history of image source positions are allocated for the longest distance at which an image source can be visible.
 		 */
-		void SetupWaveGuideProcessors() { 			
-			listOfChannelSourceListener.clear();			
-			//listOfChannelSourceListener.resize(imageSourcesPositionList.size());
-			for (int i = 0; i < imageSourcesPositionList.size(); i++) { 
-				listOfChannelSourceListener.push_back(std::make_unique<Common::CWaveguide>());
-			}
-			SetupWaveGuidesFilters();
-			EnablePropagationDelay();
+		void SetupPropagationDelayLine() {
+			propagationDelayLine.SetNumberOfTaps(imageSourcesPositionList.size());
+			float maximumDistance = ISMParameters->maxDistanceSourcesToListener + 0.5f * ISMParameters->transitionMeters;
+			size_t maximumDelay = static_cast<size_t>(std::ceil(maximumDistance / globalParameters.GetSoundSpeed() * globalParameters.GetSampleRate()));
+			propagationDelayLine.Reserve(maximumDelay + 2 * globalParameters.GetBufferSize());
+
+			positionsHistoryFrames = maximumDelay / globalParameters.GetBufferSize() + 2;
+			ResetImageSourcesPositionsHistory();
+			SetupPropagationFilters();
 		}
 		
 		/**
-		 * @brief Sets up filters for all waveguide processors in the list using the reflection bands from the image sources data.
+		 * @brief Sets up one propagation filter per image source, using the reflection bands from the image sources data.
 		 */ 
-		void SetupWaveGuidesFilters() {
-			if (listOfChannelSourceListener.size() != imageSourcesDataList.size()) return;
-			for (int i = 0; i < listOfChannelSourceListener.size(); i++) {	
+		void SetupPropagationFilters() {
+			propagationFilters.clear();
+			for (int i = 0; i < imageSourcesDataList.size(); i++) {	
 				
 				std::shared_ptr<BRTFilters::CFilterBase> _filter;
 				_filter = std::make_shared<BRTFilters::CCascadeGraphicEq9OctaveBands>();
@@ -361,66 +479,140 @@ namespace BRTEnvironmentModel {
 				} else {
 					_filter->Disable();
 				}
-				listOfChannelSourceListener[i]->SetPropagationFilter(_filter);				
+				propagationFilters.push_back(_filter);				
 			}
 		}
 		/**
-		 * @brief Updates the visibility of waveguide filters based on the visibility of image sources.
+		 * @brief Updates the visibility of propagation filters based on the visibility of image sources.
 		 */
-		void UpdateWaveGuideFiltersVisibility() {
-			if (listOfChannelSourceListener.size() != imageSourcesDataList.size()) return;
-			for (int i = 0; i < listOfChannelSourceListener.size(); i++) {
+		void UpdatePropagationFiltersVisibility() {
+			if (propagationFilters.size() != imageSourcesDataList.size()) return;
+			for (int i = 0; i < propagationFilters.size(); i++) {
 				if (imageSourcesDataList[i].visibility > visibilityThreshold) {
-					listOfChannelSourceListener[i]->EnablePropagationFilter();
+					propagationFilters[i]->Enable();
 				} else {
-					listOfChannelSourceListener[i]->DisablePropagationFilter();
+					propagationFilters[i]->Disable();
 				}
 			}
 		}		
 
 		/**
-		 * @brief Enables propagation delay for all waveguide processors in the list.
+		 * @brief Fills the history of image source positions with their current positions.
 		 */
-		void EnablePropagationDelay() {
-			for (auto& _channel : listOfChannelSourceListener) {
-				_channel->EnablePropagationDelay();
+		void ResetImageSourcesPositionsHistory() {
+			imageSourcesPositionsHistory.resize(positionsHistoryFrames * imageSourcesPositionList.size());
+			for (size_t frame = 0; frame < positionsHistoryFrames; frame++) {
+				std::copy(imageSourcesPositionList.begin(), imageSourcesPositionList.end(), imageSourcesPositionsHistory.begin() + frame * imageSourcesPositionList.size());
 			}
+			positionsHistoryNewestFrame = 0;
 		}
-		
+
 		/**
-		 * @brief Disables propagation delay for all channel source listeners in the list.
+		 * @brief Stores the positions of the image sources in this frame, to know where they were when the samples being read were emitted.
 		 */
-		void DisablePropagationDelay() {
-			for (auto& _channel : listOfChannelSourceListener) {
-				_channel->DisablePropagationDelay();
-			}
+		void StoreImageSourcesPositions() {
+			if (positionsHistoryFrames == 0 || imageSourcesPositionsHistory.size() != positionsHistoryFrames * imageSourcesPositionList.size()) return;
+			positionsHistoryNewestFrame = (positionsHistoryNewestFrame + 1) % positionsHistoryFrames;
+			std::copy(imageSourcesPositionList.begin(), imageSourcesPositionList.end(), imageSourcesPositionsHistory.begin() + positionsHistoryNewestFrame * imageSourcesPositionList.size());
 		}
 
-		void PushToWaveGuideProcessors(CMonoBuffer<float> & _inBuffer) {						
-			ASSERT(listOfChannelSourceListener.size() == imageSourcesPositionList.size(), RESULT_ERROR_BADSIZE, "Number of waveguide processors must be equal to the number of image sources", "");
-			
-			for (int i = 0; i < listOfChannelSourceListener.size(); i++) {
-				listOfChannelSourceListener[i]->PushBack(_inBuffer, imageSourcesPositionList[i], ISMParameters->listenerPosition);
+		/**
+		 * @brief Returns the position of an image source when the frame read with a given delay was emitted.
+		 */
+		Common::CVector3 GetImageSourcePositionWhenEmitted(size_t imageSource, float delayInSamples) const {
+			if (positionsHistoryFrames == 0 || imageSourcesPositionsHistory.size() != positionsHistoryFrames * imageSourcesPositionList.size()) {
+				return imageSourcesPositionList[imageSource];
 			}
+			size_t framesBack = std::min(static_cast<size_t>(delayInSamples / globalParameters.GetBufferSize() + 0.5f), positionsHistoryFrames - 1);
+			size_t frame = (positionsHistoryNewestFrame + positionsHistoryFrames - framesBack) % positionsHistoryFrames;
+			return imageSourcesPositionsHistory[frame * imageSourcesPositionList.size() + imageSource];
 		}
 
-		void PopFromWaveGuideProcessors(std::vector<CMonoBuffer<float>> & _outBuffers, std::vector<Common::CTransform> & _virtualSourcePositions) {
-			int i =0;
-			for (auto & _channel : listOfChannelSourceListener) {
-				CMonoBuffer<float> _channelOutBuffer;
-				Common::CVector3 _channelOutSourcePosition;
-				_channel->PopFront(_channelOutBuffer, ISMParameters->listenerPosition, _channelOutSourcePosition);
-				
-				_outBuffers[i]=_channelOutBuffer;
-				
-				if (_channel->IsPropagationDelayEnabled()) {
-					_virtualSourcePositions[i] = Common::CTransform(_channelOutSourcePosition);
-				} else {
-					_virtualSourcePositions[i] = Common::CTransform(sourceLocation);
+		/**
+		 * @brief Reads every image source from its tap of the delay line, with the delay of its current distance to the listener, and applies its propagation filter.
+		 */
+		void ReadImageSourcesFromDelayLine(CMultiChannelBuffer<float> & _outBuffers, std::vector<Common::CTransform> & _virtualSourcePositions) {
+			ASSERT(propagationDelayLine.GetNumberOfTaps() == imageSourcesPositionList.size() && propagationFilters.size() == imageSourcesPositionList.size(), RESULT_ERROR_BADSIZE, "Number of delay line taps and propagation filters must be equal to the number of image sources", "");
+			if (propagationDelayLine.GetNumberOfTaps() != imageSourcesPositionList.size() || propagationFilters.size() != imageSourcesPositionList.size()) return;
+
+			const float samplesPerMeter = globalParameters.GetSampleRate() / globalParameters.GetSoundSpeed();
+			for (size_t i = 0; i < imageSourcesPositionList.size(); i++) {
+				// Rounded to whole samples, as the waveguides did, so that a static image source is read without interpolation
+				float delayInSamples = std::nearbyint((imageSourcesPositionList[i] - ISMParameters->listenerPosition).GetDistance() * samplesPerMeter);
+				_virtualSourcePositions[i] = Common::CTransform(GetImageSourcePositionWhenEmitted(i, delayInSamples));
+
+				// Image sources that are not rendered are neither read nor filtered
+				if (!imageSourcesRenderedList[i]) {
+					std::fill(_outBuffers[i].begin(), _outBuffers[i].end(), 0.0f);
+					continue;
 				}
-				i++;
+				propagationDelayLine.ReadTap(i, channelOutBuffer, delayInSamples);
+				propagationFilters[i]->Process(channelOutBuffer);
+				_outBuffers.SetChannel(i, channelOutBuffer);
 			}
 		};
+
+		/**
+		 * @brief Decides which image sources are rendered in this frame.
+		 * @details The energy of each visible image source at the listener is estimated from its distance attenuation, its visibility and
+		 *	its reflection coefficients. The image sources above the audibility threshold are admitted, and if there are more than the
+		 *	audibility budget, only the loudest ones. An image source is rendered while it is admitted and while it fades out after being evicted.
+		 *	When an image source starts being rendered again, its tap and its filter start from scratch and it fades in from silence.
+		 */
+		void UpdateAudibleImageSources(const Common::CTransform & _listenerTransform) {
+			const size_t numberOfImageSources = imageSourcesDataList.size();
+			if (imageSourcesEnergyList.size() != numberOfImageSources || imageSourcesPreviousAttenuationList.size() != numberOfImageSources) {
+				imageSourcesEnergyList.assign(numberOfImageSources, 0.0f);
+				imageSourcesAdmittedList.assign(numberOfImageSources, false);
+				imageSourcesRenderedList.assign(numberOfImageSources, false);
+				imageSourcesPreviousAttenuationList.assign(numberOfImageSources, 0.0f);
+				audibilityRankingList.reserve(numberOfImageSources);
+			}
+
+			const float thresholdEnergy = std::pow(10.0f, audibilityThresholdDB / 10.0f);
+			audibilityRankingList.clear();
+			for (size_t i = 0; i < numberOfImageSources; i++) {
+				imageSourcesAdmittedList[i] = false;
+				imageSourcesEnergyList[i] = 0.0f;
+				if (!imageSourcesDataList[i].visible) continue;
+
+				const std::vector<float> & bands = imageSourcesDataList[i].reflectionBands;
+				float bandsEnergy = 0.0f;
+				for (float band : bands) {
+					bandsEnergy += band * band;
+				}
+				if (!bands.empty()) bandsEnergy /= bands.size();
+				float amplitude = distanceAttenuator.CalculateDistanceAttenuation(Common::CTransform(imageSourcesPositionList[i]), _listenerTransform) * imageSourcesDataList[i].visibility;
+				imageSourcesEnergyList[i] = amplitude * amplitude * bandsEnergy;
+				if (imageSourcesEnergyList[i] >= thresholdEnergy) {
+					audibilityRankingList.push_back(i);
+				}
+			}
+
+			if (audibilityBudget > 0 && audibilityRankingList.size() > audibilityBudget) {
+				std::nth_element(audibilityRankingList.begin(), audibilityRankingList.begin() + audibilityBudget, audibilityRankingList.end(),
+					[this](size_t a, size_t b) { return imageSourcesEnergyList[a] > imageSourcesEnergyList[b]; });
+				audibilityRankingList.resize(audibilityBudget);
+			}
+			for (size_t i : audibilityRankingList) {
+				imageSourcesAdmittedList[i] = true;
+			}
+
+			numRenderedImageSources = 0;
+			for (size_t i = 0; i < numberOfImageSources; i++) {
+				bool rendered = imageSourcesDataList[i].visible && (imageSourcesAdmittedList[i] || imageSourcesPreviousAttenuationList[i] > fadeOutAttenuationThreshold);
+				if (rendered && !imageSourcesRenderedList[i]) {
+					propagationDelayLine.ResetTap(i);
+					if (i < propagationFilters.size()) propagationFilters[i]->ResetBuffers();
+				}
+				if (rendered) {
+					numRenderedImageSources++;
+				} else {
+					imageSourcesPreviousAttenuationList[i] = 0.0f;
+				}
+				imageSourcesRenderedList[i] = rendered;
+			}
+		}
 	
 		void SetupDistanceAttenuator() {
 			distanceAttenuator.SetDistanceAttenuationFactor(globalParameters.distanceAttenuationFactorDB);
@@ -428,6 +620,10 @@ namespace BRTEnvironmentModel {
 			distanceAttenuator.EnableProcessor();
 
 			imageSourcesPreviousAttenuationList.resize(imageSourcesPositionList.size(), 0.0f);
+			imageSourcesEnergyList.assign(imageSourcesPositionList.size(), 0.0f);
+			imageSourcesAdmittedList.assign(imageSourcesPositionList.size(), false);
+			imageSourcesRenderedList.assign(imageSourcesPositionList.size(), false);
+			audibilityRankingList.reserve(imageSourcesPositionList.size());
 		}
 				
 
@@ -506,15 +702,29 @@ namespace BRTEnvironmentModel {
 		std::shared_ptr<CISMParameters> ISMParameters;		// Common parameters for the ISM simulation			
 		Common::CVector3 sourceLocation;					// Location of the original source
 		std::shared_ptr<CISMSourceImage> imageSources;		// Root of the image sources tree
+		std::shared_ptr<BRTServices::CSetupWorkerPool> imageTreeWorkerPool; // Worker threads to create the tree, shared with other environments. Null to do it in the calling thread
 		std::vector<Common::CVector3> imageSourcesPositionList; // List of image source locations
 		std::vector<TImageSourceData> imageSourcesDataList; // List of image source data (location, visibility, reflection walls, etc)
 
-		std::vector<std::unique_ptr<Common::CWaveguide>> listOfChannelSourceListener; // Waveguide processors
+		Common::CMultiTapDelayLine propagationDelayLine;	// Delay line shared by all the image sources, with one tap per image source
+		std::vector<std::shared_ptr<BRTFilters::CFilterBase>> propagationFilters; // Reflection filter of each image source
+		std::vector<Common::CVector3> imageSourcesPositionsHistory; // Positions of all the image sources in the last frames, frame after frame
+		size_t positionsHistoryFrames;						// Number of frames in the history of positions
+		size_t positionsHistoryNewestFrame;					// Frame of the history with the current positions
 		BRTProcessing::CDistanceAttenuator distanceAttenuator;		// Distance attenuation processor
+		CMonoBuffer<float> channelOutBuffer;						// Output of the tap being read, before it is copied to its channel
 
 		std::vector<float> imageSourcesPreviousAttenuationList;
 
+		size_t audibilityBudget;							// Maximum number of image sources rendered in each frame, 0 for no limit
+		float audibilityThresholdDB;						// Estimated energy below which an image source is not rendered
+		std::vector<float> imageSourcesEnergyList;			// Estimated energy of each image source at the listener in this frame
+		std::vector<bool> imageSourcesAdmittedList;			// Image sources within the budget and above the threshold in this frame
+		std::vector<bool> imageSourcesRenderedList;			// Image sources that are admitted or still fading out
+		std::vector<size_t> audibilityRankingList;			// Image sources above the threshold, to be ranked by energy
+
 		size_t numVisibleImageSources;
+		size_t numRenderedImageSources;
 	};
 }
 
@@ -216,7 +216,7 @@ namespace BRTEnvironmentModel {
 			ASSERT(inBuffer.size() == globalParameters.GetBufferSize(), RESULT_ERROR_BADSIZE, "InBuffer size has to be equal to the input size indicated by the BRT::GlobalParameters method", "");
 
 			if (!enableProcessor) {
-				virtualSourceBuffers = std::vector<CMonoBuffer<float>>(numberOfImageSources, CMonoBuffer<float>(globalParameters.GetBufferSize()));								
+				virtualSourceBuffers.Resize(numberOfImageSources, globalParameters.GetBufferSize());
 				virtualSourcePositions = std::vector<Common::CTransform>(numberOfImageSources, Common::CTransform());				
 				SyncAllVirtualSourcesToModel();
 				return;
@@ -226,7 +226,7 @@ namespace BRTEnvironmentModel {
 			if (IsInBounds(sourceLocation.GetPosition()) && IsInBounds(listenerPosition.GetPosition())) {				
 				CISMEnvironment::Process(inBuffer, sourceLocation, listenerPosition, virtualSourceBuffers, virtualSourcePositions);				
 			} else {		
-				virtualSourceBuffers = std::vector<CMonoBuffer<float>>(numberOfImageSources, CMonoBuffer<float>(globalParameters.GetBufferSize()));			
+				virtualSourceBuffers.Resize(numberOfImageSources, globalParameters.GetBufferSize());
 			}
 			SyncAllVirtualSourcesToModel();
 		}
@@ -243,6 +243,50 @@ namespace BRTEnvironmentModel {
 			return CISMEnvironment::GetNumberOfVisibleImageSources();
 		}
 
+		/**
+		 * @brief Get the number of image sources rendered in the last frame
+		 * @return Number of rendered image sources
+		 */
+		size_t GetNumberOfRenderedImageSources() const {
+			return CISMEnvironment::GetNumberOfRenderedImageSources();
+		}
+
+		/**
+		 * @brief Set the maximum number of image sources rendered in each frame, the loudest ones
+		 * @param _maxImageSources Maximum number of image sources, 0 for no limit
+		 * @return True if the value is valid
+		 */
+		bool SetAudibilityBudget(int _maxImageSources) {
+			return CISMEnvironment::SetAudibilityBudget(_maxImageSources);
+		}
+
+		/**
+		 * @brief Set the estimated energy below which an image source is not rendered
+		 * @param _thresholdDB Threshold in decibels
+		 */
+		void SetAudibilityThreshold(float _thresholdDB) {
+			CISMEnvironment::SetAudibilityThreshold(_thresholdDB);
+		}
+
+		/**
+		 * @brief Create the image sources tree on worker threads, or in the calling thread
+		 * @param _workerPool Worker threads, usually shared by all the processors of the model. Null to use the calling thread
+		 */
+		void SetParallelImageTree(std::shared_ptr<BRTServices::CSetupWorkerPool> _workerPool) {
+			if (_workerPool != nullptr) {
+				CISMEnvironment::EnableParallelImageTree(std::move(_workerPool));
+			} else {
+				CISMEnvironment::DisableParallelImageTree();
+			}
+		}
+
+		/**
+		 * @brief Check if the image sources tree is created on worker threads
+		 */
+		bool IsParallelImageTreeEnabled() const {
+			return CISMEnvironment::IsParallelImageTreeEnabled();
+		}
+
 		
 
 		void ResetProcessBuffers() {
@@ -303,8 +347,7 @@ namespace BRTEnvironmentModel {
 						
 			numberOfImageSources = CISMEnvironment::GetNumberOfImageSources();
 
-			CMonoBuffer<float> inBuffer = CMonoBuffer<float>(globalParameters.GetBufferSize());			
-			virtualSourceBuffers = std::vector<CMonoBuffer<float>>(numberOfImageSources, inBuffer);
+			virtualSourceBuffers.Resize(numberOfImageSources, globalParameters.GetBufferSize());
 			virtualSourcePositions = std::vector<Common::CTransform>(numberOfImageSources);
 			
 			CreateBRTVirtualSources();	
@@ -327,7 +370,7 @@ namespace BRTEnvironmentModel {
 			RemoveBRTVirtualSources(); // Remove all the virtual sources
 			CISMEnvironment::Reset(); // Reset the ISM environment
 			numberOfImageSources = CISMEnvironment::GetNumberOfImageSources();
-			virtualSourceBuffers.clear();
+			virtualSourceBuffers.Clear();
 			virtualSourcePositions.clear();
 
 			if (!result) {
@@ -376,8 +419,14 @@ namespace BRTEnvironmentModel {
 		 */
 		void SyncAllVirtualSourcesToModel() {
 			
-			ASSERT(virtualSourceBuffers.size() == numberOfImageSources, RESULT_ERROR_BADSIZE, "The number of virtual source buffers does not match the number of image sources", "");
+			ASSERT(virtualSourceBuffers.GetNChannels() == numberOfImageSources, RESULT_ERROR_BADSIZE, "The number of virtual source buffers does not match the number of image sources", "");
 			ASSERT(virtualSourcePositions.size() == numberOfImageSources, RESULT_ERROR_BADSIZE, "The number of virtual source positions does not match the number of image sources", "");
+			// Mute or gain of all the virtual sources at once
+			if (muteReverbPath) {
+				virtualSourceBuffers.SetToZero();
+			} else {
+				virtualSourceBuffers.ApplyGain(gain);
+			}
 			for (int i = 0; i < numberOfImageSources; i++) {
 				SyncOneVirtualSourceToModel(i);
 			}
@@ -388,12 +437,7 @@ namespace BRTEnvironmentModel {
 		 * @param index Index of the virtual source
 		 */
 		void SyncOneVirtualSourceToModel(int index) {
-
-			if (muteReverbPath) {
-				std::fill(virtualSourceBuffers[index].begin(), virtualSourceBuffers[index].end(), 0);				
-			}						
 			SetVirtualSourcePosition(GetBRTVirtualSourceID(index), virtualSourcePositions[index]);						
-			virtualSourceBuffers[index].ApplyGain(gain);
 			SetVirtualSourceBuffer(GetBRTVirtualSourceID(index), virtualSourceBuffers[index]);
 		}
 		
@@ -412,7 +456,7 @@ namespace BRTEnvironmentModel {
 		
 		mutable std::mutex mutex;							// To avoid access collisions
 		Common::CGlobalParameters globalParameters;
-		std::vector<CMonoBuffer<float>> virtualSourceBuffers;
+		CMultiChannelBuffer<float> virtualSourceBuffers;	// Output of all the image sources, one channel per image source
 		std::vector<Common::CTransform> virtualSourcePositions;		
 		BRTBase::CBRTManager * brtManager;		
 		
@@ -24,13 +24,20 @@
 #ifndef _ISM_SOURCE_IMAGES_HPP_
 #define _ISM_SOURCE_IMAGES_HPP_
 
+#include <algorithm>
 #include <Common/Vector3.hpp>
 #include <Common/ErrorHandler.hpp>
 #include <Common/CommonDefinitions.hpp>
 #include <ServiceModules/Room.hpp>
 #include <ServiceModules/Wall.hpp>
+#include <ServiceModules/SetupWorkerPool.hpp>
 #include "ISMParameters.hpp"
 
+/** \brief Minimum number of image sources to update their visibility on the worker threads. Smaller trees are updated in the calling thread */
+#ifndef ISM_PARALLEL_VISIBILITY_MIN_IMAGES
+#define ISM_PARALLEL_VISIBILITY_MIN_IMAGES 256
+#endif
+
 
 //#include <Common/CascadeGraphicEq9OctaveBands.h>
 
@@ -102,6 +109,23 @@ namespace BRTEnvironmentModel {
 				image->getImageSourcesData(imageSourceDataList); //recurse to the next level
 			}
 		}
+
+		/** \brief Updates the location and visibility of the image sources data returned by getImageSourcesData
+		*	\details The reflection walls and coefficients only change when the tree is created again, so they are kept. Nothing is
+			allocated. It has to be called on the root of the tree.
+		*	\param [in,out] imageSourceDataList: Vector with the data of the image sources, in the same order as getImageSourcesData
+		*	\return false if the list does not have one element per image source, and then it is not modified
+		*/
+		bool UpdateImageSourcesData(std::vector<TImageSourceData>& imageSourceDataList) const
+		{
+			if (imageSourceDataList.size() != flatImagesTree.size()) return false;
+			for (size_t i = 0; i < flatImagesTree.size(); i++) {
+				imageSourceDataList[i].location = flatImagesTree[i]->sourceLocation;
+				imageSourceDataList[i].visibility = flatImagesTree[i]->visibility;
+				imageSourceDataList[i].visible = flatImagesTree[i]->visible;
+			}
+			return true;
+		}
 						
 		/**
 		 * @brief Creates all image sources up to a given order
@@ -111,9 +135,12 @@ namespace BRTEnvironmentModel {
 		 * @param _room Real (original) room geometry
 		 * @param _order recursion depth
 		 * @param _sourceLocation Current location of the real (original) source
+		 * @param _workerPool if not null, the subtree of each first order image is created on the worker threads, and so are the visibilities
 		 */
-		void createImagesTree(std::shared_ptr<BRTServices::CRoom> & _room, const int & _order, const Common::CVector3 & _sourceLocation) {
+		void createImagesTree(std::shared_ptr<BRTServices::CRoom> & _room, const int & _order, const Common::CVector3 & _sourceLocation, BRTServices::CSetupWorkerPool * _workerPool = nullptr) {
 			imagesTree.clear();
+			flatImagesTree.clear();
+			flatParentIndex.clear();
 						
 			std::vector<BRTServices::CWall> path;			
 			try {
@@ -126,34 +153,54 @@ namespace BRTEnvironmentModel {
 			std::vector<float> absorptionCoefficients = std::vector<float>(NUM_BAND_ABSORTION, 1.0f);
 
 			sourceLocation = _sourceLocation;
-			createImagesTree(_room, _order, path, absorptionCoefficients);
+			createImagesTree(_room, _order, path, absorptionCoefficients, _workerPool);
+			if (_workerPool != nullptr) _workerPool->Wait();
 			
 			// TODO LIBERAR MEMORIA RESERVADA previamente EN PATH 
 			// mediante std::vector<Wall>(path).swap(path);
 			
-			UpdateImagesTreeVisibilities();			
+			FlattenImagesTree();
+			UpdateImagesTreeVisibilities(_workerPool);			
 		}
 						
 		/** \brief updates imege source location, reflection and visibility
-		*	\details Updates the recursive image source tree with the source locations and computes refelction coefficients and visibility
-					 to be applied when process
+		*	\details Updates the image source tree with the source locations and computes visibility to be applied when process. The
+					 images are walked in the order of the flattened tree, so each one is placed from the location of its parent. It has to
+					 be called on the root of the tree.
+		*	\param [in] _sourcePosition: new location of the original source
 		*/
 		void UpdateSourceLocation(const Common::CVector3& _sourcePosition)
 		{												
-			for (auto& image : imagesTree) {
-				image->SetSourceLocation(image->getMyReflectionWall().GetImagePoint(_sourcePosition));
+			sourceLocation = _sourcePosition;
+			for (size_t i = 0; i < flatImagesTree.size(); i++) {
+				const Common::CVector3 & parentLocation = flatParentIndex[i] < 0 ? sourceLocation : flatImagesTree[flatParentIndex[i]]->sourceLocation;
+				flatImagesTree[i]->sourceLocation = flatImagesTree[i]->getMyReflectionWall().GetImagePoint(parentLocation);
 			}
-			UpdateImageVisibility();			
+			UpdateImagesTreeVisibilities();
 		}
 
 		/**
-		 * @brief Update visibility for all images in the tree
+		 * @brief Update visibility for all images in the tree. Only the visibilities depend on the listener, so this is all that has to
+			be done when only the listener moves. It has to be called on the root of the tree.
+		 * @param _workerPool if not null and the tree is large, the images are split in blocks that are computed on the worker threads. It
+			blocks until they finish, so it is only used when the tree is created, never from the audio thread
 		 */
-		void UpdateImagesTreeVisibilities() {
-			for (auto& image : imagesTree) {
-				image->UpdateImagesTreeVisibilities();
-			}		
+		void UpdateImagesTreeVisibilities(BRTServices::CSetupWorkerPool * _workerPool = nullptr) {
 			UpdateImageVisibility();
+			const size_t numberOfImages = flatImagesTree.size();
+			if (_workerPool == nullptr || numberOfImages < ISM_PARALLEL_VISIBILITY_MIN_IMAGES) {
+				UpdateFlatImagesVisibilities(0, numberOfImages);
+				return;
+			}
+			// One block per worker and one for this thread
+			const size_t numberOfBlocks = static_cast<size_t>(_workerPool->GetNumberOfThreads()) + 1;
+			const size_t blockSize = (numberOfImages + numberOfBlocks - 1) / numberOfBlocks;
+			for (size_t begin = blockSize; begin < numberOfImages; begin += blockSize) {
+				const size_t end = std::min(begin + blockSize, numberOfImages);
+				_workerPool->Submit([this, begin, end]() { UpdateFlatImagesVisibilities(begin, end); });
+			}
+			UpdateFlatImagesVisibilities(0, std::min(blockSize, numberOfImages));
+			_workerPool->Wait();
 		}		
 
 		/*void UpdateImagesTreeWallsAbsorptionCoefficients() {						
@@ -187,6 +234,8 @@ namespace BRTEnvironmentModel {
 
 		void Reset() {
 			imagesTree.clear();
+			flatImagesTree.clear();
+			flatParentIndex.clear();
 			reflectionWallsPath.clear();
 			reflectionBands.clear();
 			sourceLocation = Common::CVector3(0, 0, 0);
@@ -197,6 +246,35 @@ namespace BRTEnvironmentModel {
 
 	private:
 
+		/**
+		 * @brief Lists all the images of the tree below this one, in the same order as getImageSourcesData, with the index of their parent
+			in the list (-1 for the children of this image)
+		 */
+		void FlattenImagesTree() {
+			flatImagesTree.clear();
+			flatParentIndex.clear();
+			FlattenImagesTree(-1, flatImagesTree, flatParentIndex);
+		}
+
+		void FlattenImagesTree(int parentIndex, std::vector<CISMSourceImage *> & imagesList, std::vector<int> & parentsList) {
+			for (auto & image : imagesTree) {
+				int imageIndex = static_cast<int>(imagesList.size());
+				imagesList.push_back(image.get());
+				parentsList.push_back(parentIndex);
+				image->FlattenImagesTree(imageIndex, imagesList, parentsList);
+			}
+		}
+
+		/**
+		 * @brief Update the visibility of a block of images of the flattened tree. Each image only writes its own visibility, so the
+			blocks can be updated at the same time.
+		 */
+		void UpdateFlatImagesVisibilities(size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				flatImagesTree[i]->UpdateImageVisibility();
+			}
+		}
+
 		/**
 		 * @brief Check visibility through all reflection walls and compute a visibility coeficient
 		 */
@@ -245,19 +323,9 @@ namespace BRTEnvironmentModel {
 		}
 
 
-		/** \brief changes the location of the original source
-		*	\details Sets a new location for the original source and updates all images accordingly.
-		*   \param [in] _location: new location for the original source.
-		*/
-		void SetSourceLocation(const Common::CVector3& _sourceLocation)
-		{			
-			sourceLocation = _sourceLocation;
-			UpdateSourceLocation(_sourceLocation);
-		}
-
 
 
-		void createImagesTree(std::shared_ptr<BRTServices::CRoom> & _currentRoom, int order, std::vector<BRTServices::CWall> & path, std::vector<float> & absorptionCoefficients) {
+		void createImagesTree(std::shared_ptr<BRTServices::CRoom> & _currentRoom, int order, std::vector<BRTServices::CWall> & path, std::vector<float> & absorptionCoefficients, BRTServices::CSetupWorkerPool * _workerPool = nullptr) {
 			if (order == 0) return;
 			
 			const auto& wallsList = _currentRoom->GetWalls();
@@ -299,7 +367,14 @@ namespace BRTEnvironmentModel {
 					std::shared_ptr<BRTServices::CRoom> nextRoom = std::make_shared<BRTServices::CRoom>();
 					for (auto& wj : wallsList)
 						nextRoom->InsertWall(wall.GetImageWall(wj));
-					child->createImagesTree(nextRoom, order - 1, path, absorptionCoefficients);
+					if (_workerPool != nullptr) {
+						// The subtree only writes in the child, so it is created on a worker thread with its own copy of the path
+						_workerPool->Submit([child, nextRoom, order, subtreePath = path, subtreeCoefficients = absorptionCoefficients]() mutable {
+							child->createImagesTree(nextRoom, order - 1, subtreePath, subtreeCoefficients);
+						});
+					} else {
+						child->createImagesTree(nextRoom, order - 1, path, absorptionCoefficients);
+					}
 				}				
 
 				imagesTree.push_back(std::move(child));
@@ -347,7 +422,7 @@ namespace BRTEnvironmentModel {
 		/** \brief Returns the  wall where the reflecion produced this image
 		*   \param [out] Reflection wall.
 		*/
-		BRTServices::CWall getMyReflectionWall()
+		const BRTServices::CWall & getMyReflectionWall() const
 		{
 			return reflectionWallsPath.back();
 		}
@@ -370,6 +445,8 @@ namespace BRTEnvironmentModel {
 		std::vector<BRTServices::CWall> reflectionWallsPath; // vector containing the walls where the sound has been reflected in inverse order (last reflection first)
 		std::vector<float> reflectionBands;				// coeficients, for each octave Band, to be applied to simulate walls' absortion
 		std::vector<std::shared_ptr<CISMSourceImage>> imagesTree;	// recursive list of images			
+		std::vector<CISMSourceImage *> flatImagesTree;	// All the images below the root, each one after its parent. Only in the root
+		std::vector<int> flatParentIndex;				// Index in flatImagesTree of the parent of each image, -1 for the first order images
 		//Common::CascadeGraphicEq9OctaveBands eq;		// Filter to simulate walls' absortion		
 
 		std::shared_ptr<CISMParameters> ISMParameters;	// To access ISM parameters
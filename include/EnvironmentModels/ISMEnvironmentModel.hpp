@@ -24,6 +24,8 @@
 #define _C_ISM_ENVIRONMENT_MODEL_HPP_
 
 #include <memory>
+#include <cmath>
+#include <limits>
 #include <ListenerModels/ListenerModelBase.hpp>
 #include <EnvironmentModels/EnvironmentModelBase.hpp>
 #include <EnvironmentModels/ISMEnvironment/ISMEnvironmentProcessor.hpp>
@@ -149,6 +151,32 @@ namespace BRTEnvironmentModel {
 			size_t GetNumberOfVisibleImageSources() {
 				return ISMProcessor->GetNumberOfVisibleImageSources();
 			}
+
+			/**
+			 * @brief Get the number of image sources rendered in the last frame by this processor
+			 * @return number of rendered image sources
+			 */
+			size_t GetNumberOfRenderedImageSources() {
+				return ISMProcessor->GetNumberOfRenderedImageSources();
+			}
+
+			/**
+			 * @brief Set the audibility budget and threshold of the processor
+			 * @param _audibilityBudget maximum number of image sources rendered in each frame, 0 for no limit
+			 * @param _audibilityThresholdDB estimated energy below which an image source is not rendered, in decibels
+			 */
+			void SetAudibility(int _audibilityBudget, float _audibilityThresholdDB) {
+				ISMProcessor->SetAudibilityBudget(_audibilityBudget);
+				ISMProcessor->SetAudibilityThreshold(_audibilityThresholdDB);
+			}
+
+			/**
+			 * @brief Create the image sources tree of the processor on worker threads, or in the calling thread
+			 * @param _workerPool worker threads of the model, null to use the calling thread
+			 */
+			void SetParallelImageTree(std::shared_ptr<BRTServices::CSetupWorkerPool> _workerPool) {
+				ISMProcessor->SetParallelImageTree(std::move(_workerPool));
+			}
 			
 			bool DisconnectFromListenerModel(std::shared_ptr<BRTListenerModel::CListenerModelBase> _listenerModel) {
 				return ISMProcessor->DisconnectFromListenerModel(_listenerModel);
@@ -175,6 +203,8 @@ namespace BRTEnvironmentModel {
 			, reflectionOrder {1}
 			, maxDistanceSourcesToListener { 3.43 }
 			, windowSlopeDistance { 2 * globalParameters.GetSoundSpeed() * 0.001f }			
+			, audibilityBudget { 0 }
+			, audibilityThresholdDB { -std::numeric_limits<float>::infinity() }
 		{ 			
 			// Default room
 			room = std::make_shared<BRTServices::CRoom>();
@@ -284,6 +314,99 @@ namespace BRTEnvironmentModel {
 			return numberOrVisibleVirtualSources;
 		}
 
+		/**
+		 * @brief Get the number of virtual sources rendered in the last frame, within the audibility budget and threshold
+		 * @return number of rendered virtual sources
+		 */
+		size_t GetNumberOfRenderedVirtualSources() override {
+			std::lock_guard<std::mutex> l(mutex);
+			size_t numberOfRenderedVirtualSources = 0;
+			for (auto& it : sourcesConnectedProcessors) {
+				numberOfRenderedVirtualSources += it.GetNumberOfRenderedImageSources();
+			}
+			return numberOfRenderedVirtualSources;
+		}
+
+		/**
+		 * @brief Set the maximum number of image sources rendered in each frame for each source. The loudest ones at the listener are
+		 *	rendered, and they fade in and out when they enter or leave the budget.
+		 * @param _maxImageSources maximum number of image sources per source, 0 for no limit
+		 * @return true if success
+		 */
+		bool SetAudibilityBudget(int _maxImageSources) override {
+			if (_maxImageSources < 0) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "The audibility budget must be equal or greater than zero.");
+				return false;
+			}
+			audibilityBudget = _maxImageSources;
+			SetConfigurationInALLSourcesProcessors();
+			return true;
+		}
+
+		/**
+		 * @brief Get the maximum number of image sources rendered in each frame for each source
+		 * @return audibility budget, 0 if there is no limit
+		 */
+		int GetAudibilityBudget() override {
+			return audibilityBudget;
+		}
+
+		/**
+		 * @brief Set the estimated energy at the listener below which an image source is not rendered
+		 * @param _thresholdDB threshold in decibels, relative to the original source at the reference distance
+		 * @return true if success
+		 */
+		bool SetAudibilityThreshold(float _thresholdDB) override {
+			if (std::isnan(_thresholdDB)) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "The audibility threshold must be a number.");
+				return false;
+			}
+			audibilityThresholdDB = _thresholdDB;
+			SetConfigurationInALLSourcesProcessors();
+			return true;
+		}
+
+		/**
+		 * @brief Get the estimated energy at the listener below which an image source is not rendered
+		 * @return audibility threshold in decibels
+		 */
+		float GetAudibilityThreshold() override {
+			return audibilityThresholdDB;
+		}
+
+		/**
+		 * @brief Create the image sources tree of each source on worker threads, the next time it is set up. All the sources share the
+		 *	same workers. The updates when the source or the listener move are not affected, they always run in the audio thread.
+		 * @param _numberOfThreads number of worker threads. With 0, one less than the number of hardware threads is used.
+		 */
+		void EnableParallelImageTree(int _numberOfThreads = 0) override {
+			std::lock_guard<std::mutex> l(mutex);
+			imageTreeWorkerPool = std::make_shared<BRTServices::CSetupWorkerPool>(_numberOfThreads);
+			for (auto & it : sourcesConnectedProcessors) {
+				it.SetParallelImageTree(imageTreeWorkerPool);
+			}
+		}
+
+		/**
+		 * @brief Create the image sources tree of each source in the calling thread. The workers stop when no setup is using them
+		 */
+		void DisableParallelImageTree() override {
+			std::lock_guard<std::mutex> l(mutex);
+			imageTreeWorkerPool.reset();
+			for (auto & it : sourcesConnectedProcessors) {
+				it.SetParallelImageTree(nullptr);
+			}
+		}
+
+		/**
+		 * @brief Check if the image sources tree is created on worker threads
+		 * @return true if the worker threads are used
+		 */
+		bool IsParallelImageTreeEnabled() override {
+			std::lock_guard<std::mutex> l(mutex);
+			return imageTreeWorkerPool != nullptr;
+		}
+
 		/**
 		 * @brief Connect a new source to this listener
 		 * @param _source Pointer to the source
@@ -522,6 +645,7 @@ namespace BRTEnvironmentModel {
 		*/
 		void SetSourceProcessorsConfiguration(CISMProcessors & sourceProcessor) {
 			sourceProcessor.SetConfiguration(enableReverbPath);
+			sourceProcessor.SetAudibility(audibilityBudget, audibilityThresholdDB);
 		}
 
 
@@ -566,6 +690,7 @@ namespace BRTEnvironmentModel {
 			control = control && brtManager->ConnectModulesSamples(_source, "samples", _newISMProcessors.ISMProcessor, "inputSamples");			
 									
 			if (control) {
+				_newISMProcessors.SetParallelImageTree(imageTreeWorkerPool);
 				_newISMProcessors.Setup(reflectionOrder, maxDistanceSourcesToListener, windowSlopeDistance, room, _listenerModel);
 				control = control && _newISMProcessors.ConnectToListenerModel(_listenerModel);
 			}
@@ -656,6 +781,9 @@ namespace BRTEnvironmentModel {
 		int reflectionOrder; // Reflection order
 		float maxDistanceSourcesToListener; // Maximum distance from sources to listener to consider reflections
 		float windowSlopeDistance; // Distance for smoothing the window slope
+		int audibilityBudget; // Maximum number of image sources rendered per source, 0 for no limit
+		float audibilityThresholdDB; // Estimated energy below which an image source is not rendered
+		std::shared_ptr<BRTServices::CSetupWorkerPool> imageTreeWorkerPool; // Worker threads shared by the processors of all the sources to create their trees, null if disabled
 
 	};
 }
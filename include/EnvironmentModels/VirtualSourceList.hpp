@@ -115,6 +115,17 @@ namespace BRTEnvironmentModel {
 			}			
 		}
 
+		void SetVirtualSourceBuffer(const std::string& _virtualSourceID, CMultiChannelBuffer<float>::TConstChannel _buffer) {
+			
+			auto&& it = std::find_if(virtualSources.begin(), virtualSources.end(), [&_virtualSourceID](std::shared_ptr<BRTSourceModel::CVirtualSourceModel> virtualSource) { return virtualSource->GetID() == _virtualSourceID; });
+			if (it != virtualSources.end()) {					
+				it[0]->SetBuffer(_buffer);								
+			}
+			else {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "There is no virtual source with that name.");
+			}			
+		}
+
 
 		void SetVirtualSourcePosition(const std::string& _virtualSourceID, const Common::CTransform& _sourcePosition) {
 			auto&& it = std::find_if(virtualSources.begin(), virtualSources.end(), [&_virtualSourceID](std::shared_ptr<BRTSourceModel::CVirtualSourceModel> virtualSource) { return virtualSource->GetID() == _virtualSourceID; });
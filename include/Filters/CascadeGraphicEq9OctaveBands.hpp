@@ -130,6 +130,7 @@ namespace BRTFilters {
             commandGains = _gains;
             ResetFiltersChain(CalculatePeakGains());
 			enable = true;
+			return true;
         }
 
         /** 
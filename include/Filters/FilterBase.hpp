@@ -80,6 +80,9 @@ namespace BRTFilters {
 			, const Common::CTransform & sourceTransform, const Common::CTransform & listenerTransform
 			, const Common::T_ear _ear, std::weak_ptr<BRTServices::CServicesBase> & _irTableWeakPtr) { }
 
+		virtual void ProcessByInterauralAzimuth(const CMonoBuffer<float> & _inLeftBuffer, CMonoBuffer<float> & outLeftBuffer, const CMonoBuffer<float> & _inRightBuffer, CMonoBuffer<float> & outRightBuffer
+			, const Common::CTransform & sourceTransform, const Common::CTransform & listenerTransform, std::weak_ptr<BRTServices::CServicesBase> & _irTableWeakPtr) { }
+
 		virtual void ResetBuffers() { }
 
 	private:
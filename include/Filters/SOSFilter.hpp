@@ -103,6 +103,18 @@ namespace BRTFilters {
 			BRTProcessing::CMultichannelBiquadFilterChain::Process(_channel, _inBuffer, outBuffer);						
 		}
 
+		/**
+		 * @brief Filter both ears in the same pass. The filter has to be set up with 2 channels, left (0) and right (1)
+		 * @param _inLeftBuffer left ear input buffer
+		 * @param _outLeftBuffer left ear output buffer
+		 * @param _inRightBuffer right ear input buffer
+		 * @param _outRightBuffer right ear output buffer
+		 */
+		void Process(const CMonoBuffer<float> & _inLeftBuffer, CMonoBuffer<float> & _outLeftBuffer, const CMonoBuffer<float> & _inRightBuffer, CMonoBuffer<float> & _outRightBuffer) override
+		{
+			BRTProcessing::CMultichannelBiquadFilterChain::Process(_inLeftBuffer, _outLeftBuffer, _inRightBuffer, _outRightBuffer);
+		}
+
 		/**
 		 * @brief Reset the buffers of the process
 		 */
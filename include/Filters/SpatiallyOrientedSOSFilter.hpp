@@ -59,6 +59,7 @@ namespace BRTFilters {
 				BRTProcessing::CMultichannelBiquadFilterChain::DisableProcessor();
 				return false;
 			}
+			appliedCells.assign(_numberOfChannels, TAppliedCell());
 
 			if (enable) {
 				BRTProcessing::CMultichannelBiquadFilterChain::EnableProcessor();
@@ -74,6 +75,7 @@ namespace BRTFilters {
 		 * @param _coefficients vector of coefficients for the channel
 		 */
 		bool SetCoefficients(const int & _channel, const std::vector<float>& _coefficients) override {
+			if (_channel >= 0 && _channel < static_cast<int>(appliedCells.size())) { appliedCells[_channel] = TAppliedCell(); }
 			return BRTProcessing::CMultichannelBiquadFilterChain::SetCoefficients(_channel, _coefficients);			
 		}
 		
@@ -138,9 +140,9 @@ namespace BRTFilters {
 			Common::CSourceListenerRelativePositionCalculation::CalculateSourceListenerRelativePositions(sourceTransform, listenerTransform, azimuth, elevation);
 
 			//Get coefficients from the ILD table
-			std::vector<float> coefficients = _SOSFilterPtr->GetSOSCoefficients_SpatiallyOriented(azimuth, elevation, distance, _ear);
+			BRTServices::TSOSCoefficientsView coefficients = _SOSFilterPtr->GetSOSCoefficientsView_SpatiallyOriented(azimuth, elevation, distance, _ear);
 
-			BRTProcessing::CMultichannelBiquadFilterChain::SetCoefficients(_channel, coefficients); //Set coefficients
+			ApplyCoefficients(_channel, coefficients, *_SOSFilterPtr); //Set coefficients, if the table cell has changed
 			BRTProcessing::CMultichannelBiquadFilterChain::Process(_channel, _inBuffer, outBuffer); // Process the signal
 		}
 
@@ -187,12 +189,66 @@ namespace BRTFilters {
 			float interauralAzimuth = Common::CSourceListenerRelativePositionCalculation::CalculateInterauralAzimuth(sourceTransform, listenerTransform);
 
 			//Get coefficients from the ILD table			
-			std::vector<float> coefficients = _SOSFilterPtr->GetSOSCoefficients_SpatiallyOriented(interauralAzimuth, 0, distance, _ear);
+			BRTServices::TSOSCoefficientsView coefficients = _SOSFilterPtr->GetSOSCoefficientsView_SpatiallyOriented(interauralAzimuth, 0, distance, _ear);
 												
-			BRTProcessing::CMultichannelBiquadFilterChain::SetCoefficients(_channel, coefficients); //Set coefficients						
+			ApplyCoefficients(_channel, coefficients, *_SOSFilterPtr); //Set coefficients, if the table cell has changed						
 			BRTProcessing::CMultichannelBiquadFilterChain::Process(_channel, _inBuffer, outBuffer); // Process the signal
 		}
 
+		/**
+		 * @brief Filter both ears in the same pass, using only the interaural azimuth to get the coefficients. The filter has to be set up
+		 * with 2 channels, left (0) and right (1). The result is the same as calling ProcessByInterauralAzimuth for each ear.
+		 * @param _inLeftBuffer left ear input buffer
+		 * @param outLeftBuffer left ear output buffer
+		 * @param _inRightBuffer right ear input buffer
+		 * @param outRightBuffer right ear output buffer
+		 * @param sourceTransform source position and orientation
+		 * @param listenerTransform listener position and orientation
+		 * @param _SOSFilterWeakPtr filter coefficients service pointer
+		 */
+		void ProcessByInterauralAzimuth(const CMonoBuffer<float> & _inLeftBuffer, CMonoBuffer<float> & outLeftBuffer, const CMonoBuffer<float> & _inRightBuffer, CMonoBuffer<float> & outRightBuffer,
+			const Common::CTransform & sourceTransform, const Common::CTransform & listenerTransform, std::weak_ptr<BRTServices::CServicesBase> & _SOSFilterWeakPtr) override
+		{
+			// Check process flag
+			if (!enable) {
+				outLeftBuffer = _inLeftBuffer;
+				outRightBuffer = _inRightBuffer;
+				return;
+			}
+
+			float distance = Common::CSourceListenerRelativePositionCalculation::CalculateSourceListenerDistance(sourceTransform, listenerTransform);
+
+			if (distance > DISTANCE_MODEL_THRESHOLD_NEAR) {
+				outLeftBuffer = _inLeftBuffer;
+				outRightBuffer = _inRightBuffer;
+				return;
+			}
+			if (Common::AreSame(distance, 0, MINIMUM_DISTANCE_SOURCE_LISTENER)) {
+				SET_RESULT(RESULT_WARNING, "The source is inside the listener's head.");
+				outLeftBuffer = _inLeftBuffer;
+				outRightBuffer = _inRightBuffer;
+				return;
+			}
+
+			// Check listener ILD
+			std::shared_ptr<BRTServices::CServicesBase> _SOSFilterPtr = _SOSFilterWeakPtr.lock();
+			if (!_SOSFilterPtr) {
+				SET_RESULT(RESULT_ERROR_NULLPOINTER, "SOS filter pointer is null when trying to use in BRTProcessing::CBiquadChainTable");
+				outLeftBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
+				outRightBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
+				return;
+			}
+
+			float interauralAzimuth = Common::CSourceListenerRelativePositionCalculation::CalculateInterauralAzimuth(sourceTransform, listenerTransform);
+
+			//Get coefficients from the ILD table, and set them if the table cell has changed
+			BRTServices::TSOSCoefficientsView leftCoefficients = _SOSFilterPtr->GetSOSCoefficientsView_SpatiallyOriented(interauralAzimuth, 0, distance, Common::T_ear::LEFT);
+			BRTServices::TSOSCoefficientsView rightCoefficients = _SOSFilterPtr->GetSOSCoefficientsView_SpatiallyOriented(interauralAzimuth, 0, distance, Common::T_ear::RIGHT);
+			ApplyCoefficients(Common::T_ear::LEFT, leftCoefficients, *_SOSFilterPtr);
+			ApplyCoefficients(Common::T_ear::RIGHT, rightCoefficients, *_SOSFilterPtr);
+			BRTProcessing::CMultichannelBiquadFilterChain::Process(_inLeftBuffer, outLeftBuffer, _inRightBuffer, outRightBuffer); // Process both ears
+		}
+
 		
 
 		/**
@@ -204,10 +260,43 @@ namespace BRTFilters {
 
 	
 	private:
+		// Table cell whose coefficients are set in a channel
+		struct TAppliedCell {
+			const BRTServices::CServicesBase * table = nullptr;	// Table the coefficients were taken from
+			uint32_t setupRevision = 0;							// Setup revision of that table when they were taken
+			int64_t cell = -1;									// Cell of the table, -1 if the coefficients were not taken from a table
+		};
+
 		///////////////////////
 		// Private Methods
 		///////////////////////		
 
+		/**
+		 * @brief Set the coefficients of a table cell in a channel. If the cell is the one already set, nothing is done, so the biquads
+			do not crossfade between identical coefficients while the source stays in the same cell.
+		 * @param _channel channel number
+		 * @param _coefficients coefficients found in the table
+		 * @param _table table where they were found
+		 */
+		void ApplyCoefficients(const int & _channel, const BRTServices::TSOSCoefficientsView & _coefficients, const BRTServices::CServicesBase & _table) {
+			if (_channel < 0 || _channel >= static_cast<int>(appliedCells.size())) {
+				BRTProcessing::CMultichannelBiquadFilterChain::SetCoefficients(_channel, _coefficients.data, _coefficients.size); // Reports the error
+				return;
+			}
+			TAppliedCell & appliedCell = appliedCells[_channel];
+			const uint32_t setupRevision = _table.GetSetupRevision();
+			if (!_coefficients.empty() && appliedCell.cell == _coefficients.cell && appliedCell.table == &_table && appliedCell.setupRevision == setupRevision) {
+				return;
+			}
+			if (BRTProcessing::CMultichannelBiquadFilterChain::SetCoefficients(_channel, _coefficients.data, _coefficients.size)) {
+				appliedCell.table = &_table;
+				appliedCell.setupRevision = setupRevision;
+				appliedCell.cell = _coefficients.cell;
+			} else {
+				appliedCell = TAppliedCell();
+			}
+		}
+
 		/// Calculates the parameters derived from the source and listener position
 		//float CalculateInterauralAzimuth(const Common::CTransform& _sourceTransform, const Common::CTransform& _listenerTransform)
 		//{
@@ -228,6 +317,7 @@ namespace BRTFilters {
 		// Private Attributes
 		///////////////////////		
 		Common::CGlobalParameters globalParameters;		
+		std::vector<TAppliedCell> appliedCells;		// Table cell set in each channel
 	};
 }
 #endif
\ No newline at end of file
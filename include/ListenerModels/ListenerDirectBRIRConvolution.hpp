@@ -24,6 +24,8 @@
 #define _CLISTENER_DIRECT_BRIR_CONVOLUTION_MODEL_HPP_
 
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include <ListenerModels/ListenerModelBase.hpp>
 //#include <ServiceModules/HRBRIR.hpp>
 #include <ProcessingModules/HRTFConvolverProcessor.hpp>
@@ -111,6 +113,20 @@ namespace BRTListenerModel {
 				binauralConvolverProcessor->ResetSourceConvolutionBuffers();				
 			}
 
+			/**
+			 * @brief Prepare the convolvers for a table that is going to replace the current one
+			*/
+			void PrepareTableChange(std::shared_ptr<BRTServices::CServicesBase> _newTable) {
+				binauralConvolverProcessor->PrepareTableChange(_newTable);
+			}
+
+			/**
+			 * @brief Check if the convolvers are using a table
+			*/
+			bool IsUsingTable(const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+				return binauralConvolverProcessor->IsUsingTable(_table);
+			}
+
 			std::string sourceID;
 			std::shared_ptr <BRTProcessing::CHRTFConvolverProcessor> binauralConvolverProcessor;
 			std::shared_ptr<BRTProcessing::CDistanceAttenuatorProcessor> distanceAttenuatorProcessor;
@@ -204,6 +220,19 @@ namespace BRTListenerModel {
 				SET_RESULT(RESULT_ERROR_NOTSET, "This nonInterpolatedHRTF has not been assigned to the listener. The sample rate of the nonInterpolatedHRTF does not match the one set in the library Global Parameters.");
 				return false;
 			}
+			if (listenerHRBRIR != nullptr) {
+				// Replacement of the HRBRIR in use. The convolvers crossfade to the new one in their next frame, without resetting their buffers.
+				if (!_listenerBRIR->IsDataReady()) {
+					SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "The new HRBRIR has to be ready to replace the one in use.");
+					return false;
+				}
+				PrepareTableChangeInALLSourcesProcessors(_listenerBRIR);
+				replacedListenerHRBRIRs.push_back(listenerHRBRIR);
+				listenerHRBRIR = _listenerBRIR;
+				GetHRBRIRExitPoint()->sendDataPtr(_listenerBRIR);
+				ReleaseReplacedHRBRIRs();
+				return true;
+			}
 			listenerHRBRIR = _listenerBRIR;
 			GetHRBRIRExitPoint()->sendDataPtr(_listenerBRIR);
 			ResetProcessorBuffers();
@@ -220,6 +249,16 @@ namespace BRTListenerModel {
 			return listenerHRBRIR;
 		}
 
+		/** \brief Release the HRBRIRs replaced by the current one that are not used any more. The convolvers keep using a replaced HRBRIR
+		*	until its crossfade ends, so it is kept until then and never released in the audio thread. This is done on each HRBRIR change, and
+		*	can also be called from any thread other than the audio one to release them earlier.
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void ReleaseReplacedHRBRIRs() {
+			std::lock_guard<std::mutex> l(mutex);
+			ReleaseUnusedTables(replacedListenerHRBRIRs, listenerHRBRIR);
+		}
+
 		/** \brief Remove the HRBRIR of thelistener
 		*   \eh Nothing is reported to the error handler.
 		*/
@@ -386,6 +425,28 @@ namespace BRTListenerModel {
 				SetSourceProcessorsConfiguration(it);				
 			}			
 		}
+
+		/**
+		 * @brief Prepare the convolvers of all sources for a table that is going to replace the current one, so they do not allocate in the audio thread
+		*/
+		void PrepareTableChangeInALLSourcesProcessors(std::shared_ptr<BRTServices::CServicesBase> _newTable) {
+			std::lock_guard<std::mutex> l(mutex);
+			for (auto& it : sourcesConnectedProcessors) {
+				it.PrepareTableChange(_newTable);
+			}
+		}
+
+		/**
+		 * @brief Remove from a list of replaced tables those that no source convolver is using
+		*/
+		void ReleaseUnusedTables(std::vector<std::shared_ptr<BRTServices::CServicesBase>> & _replacedTables, const std::shared_ptr<BRTServices::CServicesBase> & _currentTable) {
+			_replacedTables.erase(std::remove_if(_replacedTables.begin(), _replacedTables.end(), [&](const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+				if (_table == _currentTable) { return true; }
+				return std::none_of(sourcesConnectedProcessors.begin(), sourcesConnectedProcessors.end(), [&](CSourceProcessors & _sourceProcessors) {
+					return _sourceProcessors.IsUsingTable(_table);
+				});
+			}), _replacedTables.end());
+		}
 		/**
 		 * @brief Update configuration just in one source processor
 		 * @param sourceProcessor 
@@ -498,6 +559,7 @@ namespace BRTListenerModel {
 		mutable std::mutex mutex;									// To avoid access collisions
 		//std::string listenerID;										// Store unique listener ID		
 		std::shared_ptr<BRTServices::CServicesBase>	listenerHRBRIR;	// RBRIR of listener		
+		std::vector<std::shared_ptr<BRTServices::CServicesBase>> replacedListenerHRBRIRs;	// HRBRIRs replaced by the current one, kept while the convolvers fade them out
 		std::vector< CSourceProcessors> sourcesConnectedProcessors;	// Store the sources connected to this listener		
 
 		bool enableSpatialization;			// Flags for independent control of processes
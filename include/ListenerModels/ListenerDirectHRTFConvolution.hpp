@@ -24,6 +24,8 @@
 #define _CLISTENER_DIRECT_HRTF_CONVOLUTION_MODEL_HPP_
 
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include <ListenerModels/ListenerModelBase.hpp>
 #include <EnvironmentModels/EnvironmentModelBase.hpp>
 #include <ServiceModules/ServicesBase.hpp>
@@ -107,6 +109,20 @@ namespace BRTListenerModel {
 				nearFieldEffectProcessor->ResetProcessBuffers();
 			}
 
+			/**
+			 * @brief Prepare the convolvers for a table that is going to replace the current one
+			*/
+			void PrepareTableChange(std::shared_ptr<BRTServices::CServicesBase> _newTable) {
+				binauralConvolverProcessor->PrepareTableChange(_newTable);
+			}
+
+			/**
+			 * @brief Check if the convolvers are using a table
+			*/
+			bool IsUsingTable(const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+				return binauralConvolverProcessor->IsUsingTable(_table);
+			}
+
 			std::string sourceID;
 			std::shared_ptr <BRTProcessing::CHRTFConvolverProcessor> binauralConvolverProcessor;
 			std::shared_ptr <BRTProcessing::CNearFieldEffectProcessor> nearFieldEffectProcessor;
@@ -165,6 +181,19 @@ namespace BRTListenerModel {
 				SET_RESULT(RESULT_ERROR_NOTSET, "This nonInterpolatedHRTF has not been assigned to the listener. The sample rate of the nonInterpolatedHRTF does not match the one set in the library Global Parameters.");
 				return false;
 			}
+			if (listenerHRTF != nullptr) {
+				// Replacement of the HRTF in use. The convolvers crossfade to the new one in their next frame, without resetting their buffers.
+				if (!_listenerHRTF->IsDataReady()) {
+					SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "The new HRTF has to be ready to replace the one in use.");
+					return false;
+				}
+				PrepareTableChangeInALLSourcesProcessors(_listenerHRTF);
+				replacedListenerHRTFs.push_back(listenerHRTF);
+				listenerHRTF = _listenerHRTF;
+				GetHRTFExitPoint()->sendDataPtr(listenerHRTF);
+				ReleaseReplacedHRTFs();
+				return true;
+			}
 			listenerHRTF = _listenerHRTF;
 			//GetHRTFExitPoint()->sendDataPtr(listenerHRTF);
 			GetHRTFExitPoint()->sendDataPtr(listenerHRTF);
@@ -182,6 +211,16 @@ namespace BRTListenerModel {
 			return listenerHRTF;
 		}
 
+		/** \brief Release the HRTFs replaced by the current one that are not used any more. The convolvers keep using a replaced HRTF
+		*	until its crossfade ends, so it is kept until then and never released in the audio thread. This is done on each HRTF change, and
+		*	can also be called from any thread other than the audio one to release them earlier.
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void ReleaseReplacedHRTFs() {
+			std::lock_guard<std::mutex> l(mutex);
+			ReleaseUnusedTables(replacedListenerHRTFs, listenerHRTF);
+		}
+
 		/** \brief Remove the HRTF of this listener model
 		*   \eh Nothing is reported to the error handler.
 		*/
@@ -552,6 +591,28 @@ namespace BRTListenerModel {
 				SetSourceProcessorsConfiguration(it);				
 			}			
 		}
+
+		/**
+		 * @brief Prepare the convolvers of all sources for a table that is going to replace the current one, so they do not allocate in the audio thread
+		*/
+		void PrepareTableChangeInALLSourcesProcessors(std::shared_ptr<BRTServices::CServicesBase> _newTable) {
+			std::lock_guard<std::mutex> l(mutex);
+			for (auto& it : sourcesConnectedProcessors) {
+				it.PrepareTableChange(_newTable);
+			}
+		}
+
+		/**
+		 * @brief Remove from a list of replaced tables those that no source convolver is using
+		*/
+		void ReleaseUnusedTables(std::vector<std::shared_ptr<BRTServices::CServicesBase>> & _replacedTables, const std::shared_ptr<BRTServices::CServicesBase> & _currentTable) {
+			_replacedTables.erase(std::remove_if(_replacedTables.begin(), _replacedTables.end(), [&](const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+				if (_table == _currentTable) { return true; }
+				return std::none_of(sourcesConnectedProcessors.begin(), sourcesConnectedProcessors.end(), [&](CSourceProcessors & _sourceProcessors) {
+					return _sourceProcessors.IsUsingTable(_table);
+				});
+			}), _replacedTables.end());
+		}
 		/**
 		 * @brief Update configuration just in one source processor
 		 * @param sourceProcessor 
@@ -659,6 +720,7 @@ namespace BRTListenerModel {
 		std::shared_ptr<BRTServices::CSphericalFIRTable> listenerHeadIRModel;	// Head model of listener
 		//std::shared_ptr<BRTServices::CSphericalInterpolatedFIRTable>		listenerHRTF;					// HRTF of listener
 		std::shared_ptr<BRTServices::CServicesBase> listenerHRTF;				// HRTF of listener
+		std::vector<std::shared_ptr<BRTServices::CServicesBase>> replacedListenerHRTFs;	// HRTFs replaced by the current one, kept while the convolvers fade them out
 		std::shared_ptr<BRTServices::CSphericalSOSTable> listenerNFCFilters;		// SOS Filter of listener						
 		std::vector< CSourceProcessors> sourcesConnectedProcessors;
 		BRTBase::CBRTManager* brtManager;
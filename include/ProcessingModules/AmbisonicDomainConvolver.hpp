@@ -27,6 +27,7 @@
 
 #include <ProcessingModules/UniformPartitionedConvolution.hpp>
 #include <Common/Buffer.hpp>
+#include <Common/PlanarBuffer.hpp>
 #include <ServiceModules/SphericalInterpolatedFIRTable.hpp>
 #include <ServiceModules/AmbisonicBIR.hpp>
 
@@ -74,7 +75,7 @@ namespace BRTProcessing {
 		 * @param outBuffer Output channel in time in the real domain.
 		 * @param _listenerAmbisoninBIRWeak Smart pointer to impulse responses in the ambisonic domain of virtual loudspeakers.
 		*/
-		void Process(std::vector<CMonoBuffer<float>>& _inChannelsBuffers, CMonoBuffer<float>& outBuffer, std::weak_ptr<BRTServices::CServicesBase>& _listenerAmbisoninBIRWeak, Common::CTransform& _listenerTransform) {
+		void Process(const CMultiChannelBuffer<float>& _inChannelsBuffers, CMonoBuffer<float>& outBuffer, std::weak_ptr<BRTServices::CServicesBase>& _listenerAmbisoninBIRWeak, Common::CTransform& _listenerTransform) {
 
 			std::lock_guard<std::mutex> l(mutex);
 			
@@ -85,7 +86,7 @@ namespace BRTProcessing {
 			}
 						
 			// Check the number of channels
-			if (_inChannelsBuffers.size() != numberOfAmbisonicChannels) {
+			if (_inChannelsBuffers.GetNChannels() != numberOfAmbisonicChannels) {
 				SET_RESULT(RESULT_ERROR_BADSIZE, "InChannlesBuffers size has to be equal to the number of channels set. This usually occurs because the ambisonic order has been changed during reproduction.");
 				outBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
 				return;
@@ -109,9 +110,9 @@ namespace BRTProcessing {
 			// First time - Initialize convolution buffers
 			if (!convolutionBuffersInitialized) { InitializedSourceConvolutionBuffers(_listenerAmbisonicBIR); }
 			
-			// Process						
-			std::vector<CMonoBuffer<float>> allChannelsBuffersConvolved (numberOfAmbisonicChannels);
-			for (int nChannel = 0; nChannel < _inChannelsBuffers.size(); nChannel++) {																
+			// Process and mix the spectra of all the channels
+			CMonoBuffer<float> mixedChannels;
+			for (int nChannel = 0; nChannel < _inChannelsBuffers.GetNChannels(); nChannel++) {																
 				if (!enableProcessor) { 
 					SET_RESULT(RESULT_WARNING, "Failure to obtain an IR from AmbisonicIR. This usually occurs because the ABIR has been changed during reproduction.");
 					outBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
@@ -123,11 +124,11 @@ namespace BRTProcessing {
 					outBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
 					return;
 				}				
-				channelsUPConvolutionVector[nChannel]->ProcessUPConvolutionWithMemory(_inChannelsBuffers[nChannel], oneChannel_ABIR_partitioned, allChannelsBuffersConvolved[nChannel], false);				
+				channelInBuffer.assign(_inChannelsBuffers[nChannel].begin(), _inChannelsBuffers[nChannel].end());
+				channelsUPConvolutionVector[nChannel]->ProcessUPConvolutionWithMemory(channelInBuffer, oneChannel_ABIR_partitioned, channelConvolvedBuffer, false);				
+				if (nChannel == 0) { mixedChannels = channelConvolvedBuffer; }
+				else { mixedChannels += channelConvolvedBuffer; }
 			}
-			// Mixer
-			CMonoBuffer<float> mixedChannels;
-			mixedChannels.SetFromMix({ allChannelsBuffersConvolved });			
 			mixedChannels.ApplyGain(1.0f / numberOfAmbisonicChannels);
 			// InverseFFT
 			BRTProcessing::CUniformPartitionedConvolution::CalculateIFFT(mixedChannels, outBuffer);			
@@ -148,6 +149,8 @@ namespace BRTProcessing {
 		// Atributes
 		Common::CGlobalParameters globalParameters;		
 		std::vector<std::shared_ptr<BRTProcessing::CUniformPartitionedConvolution>> channelsUPConvolutionVector; // Object to make the inverse fft of the left channel with the UPC method				
+		CMonoBuffer<float> channelInBuffer;					// Samples of the channel being convolved
+		CMonoBuffer<float> channelConvolvedBuffer;			// Spectrum of the convolution of the channel being convolved
 		
 		Common::T_ear earToProcess;							// Ear to process
 		int numberOfAmbisonicChannels;						// Number of ambisonic channels
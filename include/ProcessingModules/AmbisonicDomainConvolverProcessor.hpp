@@ -37,7 +37,7 @@ namespace BRTProcessing {
 	class CAmbisonicDomainConvolverProcessor : public BRTConnectivity::CBRTConnectivity, public CAmbisonicDomainConvolver {
 		
     public:
-		CAmbisonicDomainConvolverProcessor(Common::T_ear _earToProcess) : CAmbisonicDomainConvolver(_earToProcess) {
+		CAmbisonicDomainConvolverProcessor(Common::T_ear _earToProcess) : CAmbisonicDomainConvolver(_earToProcess), channelsBufferMixed{ false } {
 			CreateMultipleChannelsEntryPoint("inputChannels", 1);            
 			//CreateABIRPtrEntryPoint("listenerAmbisonicBIR");
 			CreateServicePtrEntryPoint("listenerAmbisonicBIR");
@@ -54,8 +54,8 @@ namespace BRTProcessing {
 		void OneEntryPointOneDataReceived(std::string _entryPointId) {
 			std::lock_guard<std::mutex> l(mutex);
 			if (_entryPointId == "inputChannels") {				
-				std::vector<CMonoBuffer<float>> inputChannels = GetMultipleSamplesVectorEntryPoint("inputChannels")->GetData();
-				if (inputChannels.size() != 0) { MixChannelsBuffer(inputChannels); }
+				CMultiChannelBuffer<float> inputChannels = GetMultipleSamplesVectorEntryPoint("inputChannels")->GetData();
+				if (!inputChannels.IsEmpty()) { MixChannelsBuffer(inputChannels); }
 			}
 		}
         
@@ -65,14 +65,14 @@ namespace BRTProcessing {
 		void AllEntryPointsAllDataReady() {
 			
 			std::lock_guard<std::mutex> l(mutex);
-			if (channelsBuffer.size() == 0) { return;	}
+			if (!channelsBufferMixed) { return;	}
 			CMonoBuffer<float> outBuffer;			
 							
 			std::weak_ptr<BRTServices::CServicesBase> listenerABIR = GetServicePtrEntryPoint("listenerAmbisonicBIR")->GetData();
 			Common::CTransform _listenerTransform = GetPositionEntryPoint("listenerPosition")->GetData();
 			Process(channelsBuffer, outBuffer, listenerABIR, _listenerTransform);
 			GetSamplesExitPoint("outputSamples")->sendData(outBuffer);					
-			channelsBuffer.clear();
+			channelsBufferMixed = false;
 			
 			
         }
@@ -102,25 +102,26 @@ namespace BRTProcessing {
     private:
        
 		mutable std::mutex mutex;				
-		std::vector<CMonoBuffer<float>> channelsBuffer;		// To store the mix of the ambisonic channels before doing the process.
+		CMultiChannelBuffer<float> channelsBuffer;		// To store the mix of the ambisonic channels before doing the process.
+		bool channelsBufferMixed;						// True when channelsBuffer has received the channels of a source in this frame
 				
 
 		void ResetMixBuffers() {
-			channelsBuffer.clear();
+			channelsBuffer.Clear();
+			channelsBufferMixed = false;
 		}
 		/**
 		 * @brief Mix new channes with buffer channesl
-		 * @param inputChannels Vector of CMonoBuffer to be mixed with the buffer
+		 * @param inputChannels Ambisonic channels to be mixed with the buffer
 		*/
-		void MixChannelsBuffer(std::vector<CMonoBuffer<float>> inputChannels) {
+		void MixChannelsBuffer(const CMultiChannelBuffer<float> & inputChannels) {
 			
-			if (channelsBuffer.size() != inputChannels.size()) {
-				channelsBuffer = std::vector<CMonoBuffer<float>>(inputChannels.size(), CMonoBuffer<float>(inputChannels[0].size()));
-			}
-
-			for (int nChannel = 0; nChannel < inputChannels.size(); nChannel++) {
-				channelsBuffer[nChannel] += inputChannels[nChannel];
+			if (!channelsBufferMixed || !channelsBuffer.HasSameLayout(inputChannels)) {
+				channelsBuffer = inputChannels;
+			} else {
+				channelsBuffer += inputChannels;
 			}
+			channelsBufferMixed = true;
 		}
 
 		/**
@@ -26,6 +26,7 @@
 #define _CAMBISONIC_ENCODER_HPP_
 
 #include <Common/Buffer.hpp>
+#include <Common/PlanarBuffer.hpp>
 #include <Common/ErrorHandler.hpp>
 #include <Common/CommonDefinitions.hpp>
 
@@ -94,25 +95,27 @@ namespace BRTProcessing {
 		
 		/**
 		 * @brief Init ambisonic channels 
-		 * @return vector of as many CMonoBuffers as ambisonic channels
+		 * @param channelsBuffers planar buffer with as many channels as ambisonic channels, all set to zero
+		 * @param bufferSize number of samples of each channel
 		*/
-		void InitAmbisonicChannels(std::vector< CMonoBuffer<float>>& channelsBuffers, int bufferSize) {
+		void InitAmbisonicChannels(CMultiChannelBuffer<float>& channelsBuffers, int bufferSize) {
 			if (!initialized) { 
 				SET_RESULT(RESULT_ERROR_NOTSET, "AmbisonicEncoder class not initialised");
-				channelsBuffers = std::vector< CMonoBuffer<float> >();
+				channelsBuffers.Clear();
+				return;
 			}
 
-			channelsBuffers = std::vector< CMonoBuffer<float>>(GetTotalChannels(), CMonoBuffer<float>(bufferSize, 0.0f));			
+			channelsBuffers.Resize(GetTotalChannels(), bufferSize);
 		}
 
 		/**
 		 * @brief Performs coding of all ambisonic channels as a function of azimuth and elevation.
 		 * @param inBuffer Input samples
-		 * @param outVectorOfBuffers vector of as many CMonoBuffers as ambisonic channels
+		 * @param channelsOutBuffers planar buffer with as many channels as ambisonic channels, the encoded samples are added to it
 		 * @param azimuth source azimuth
 		 * @param elevation source elevetaion
 		*/		
-		void EncodedIR(const CMonoBuffer<float>& inBuffer, std::vector< CMonoBuffer<float> >& channelsOutBuffers, float _azimuthDegress, float _elevationDegress) {
+		void EncodedIR(const CMonoBuffer<float>& inBuffer, CMultiChannelBuffer<float>& channelsOutBuffers, float _azimuthDegress, float _elevationDegress) {
 
 			if (!initialized) { 
 				SET_RESULT(RESULT_ERROR_NOTSET, "AmbisonicEncoder class not initialised");
@@ -122,9 +125,7 @@ namespace BRTProcessing {
 			std::vector<double> ambisonicFactors = GetRealSphericalHarmonics(DegreesToRadians(_azimuthDegress), DegreesToRadians(_elevationDegress));
 			
 			for (int nChannel = 0; nChannel < GetTotalChannels(); nChannel++) {				
-				for (int nSample = 0; nSample < inBuffer.size(); nSample++)	{							
-					channelsOutBuffers[nChannel][nSample] += inBuffer[nSample] * ambisonicFactors[nChannel];					
-				}
+				channelsOutBuffers.AddToChannel(nChannel, inBuffer, static_cast<float>(ambisonicFactors[nChannel]));
 			}
 		}
 		
@@ -33,7 +33,7 @@
 #include <Common/GlobalParameters.hpp>
 #include <Common/CommonDefinitions.hpp>
 #include <ProcessingModules/AmbisonicEncoder.hpp>
-#include <Common/AddDelayExpansionMethod.hpp>
+#include <Common/FractionalDelayLine.hpp>
 #include <Common/SourceListenerRelativePositionCalculation.hpp>
 #include <ServiceModules/SphericalInterpolatedFIRTable.hpp>
 #include <ProcessingModules/UniformPartitionedConvolution.hpp>
@@ -121,7 +121,7 @@ namespace BRTProcessing {
 		 * @param _listenerHRTFWeak Weak smart pointer to the listener HRTF
 		 * @param _listenerILDWeak Weak smart pointer to the listener ILD
 		*/
-		void Process(CMonoBuffer<float> & _inBuffer, std::vector<CMonoBuffer<float>> & leftChannelsBuffers, std::vector<CMonoBuffer<float>> & rightChannelsBuffers, Common::CTransform & sourceTransform, Common::CTransform & listenerTransform, std::weak_ptr<BRTServices::CServicesBase> & _listenerHRTFWeak, std::weak_ptr<BRTServices::CServicesBase> & _listenerILDWeak) {
+		void Process(CMonoBuffer<float> & _inBuffer, CMultiChannelBuffer<float> & leftChannelsBuffers, CMultiChannelBuffer<float> & rightChannelsBuffers, Common::CTransform & sourceTransform, Common::CTransform & listenerTransform, std::weak_ptr<BRTServices::CServicesBase> & _listenerHRTFWeak, std::weak_ptr<BRTServices::CServicesBase> & _listenerILDWeak) {
 
 			std::lock_guard<std::mutex> l(mutex);
 			
@@ -184,14 +184,13 @@ namespace BRTProcessing {
 			// ADD Delay
 			CMonoBuffer<float> delayedLeftEarBuffer;
 			CMonoBuffer<float> delayedRightEarBuffer;			
-			Common::CAddDelayExpansionMethod::ProcessAddDelay_ExpansionMethod(_inBuffer, delayedLeftEarBuffer, leftChannelDelayBuffer, delays.left);
-			Common::CAddDelayExpansionMethod::ProcessAddDelay_ExpansionMethod(_inBuffer, delayedRightEarBuffer, rightChannelDelayBuffer, delays.right);
+			leftChannelDelayLine.Process(_inBuffer, delayedLeftEarBuffer, static_cast<float>(delays.left));
+			rightChannelDelayLine.Process(_inBuffer, delayedRightEarBuffer, static_cast<float>(delays.right));
 			
 			// Near Field Proccess
 			CMonoBuffer<float> nearFilteredLeftEarBuffer;
 			CMonoBuffer<float> nearFilteredRightEarBuffer;			
-			nearFieldEffectProcess.ProcessByInterauralAzimuth(Common::T_ear::LEFT, delayedLeftEarBuffer, nearFilteredLeftEarBuffer, sourceTransform, listenerTransform, Common::T_ear::LEFT, _listenerILDWeak);
-			nearFieldEffectProcess.ProcessByInterauralAzimuth(Common::T_ear::RIGHT, delayedRightEarBuffer, nearFilteredRightEarBuffer, sourceTransform, listenerTransform, Common::T_ear::RIGHT, _listenerILDWeak);
+			nearFieldEffectProcess.ProcessByInterauralAzimuth(delayedLeftEarBuffer, nearFilteredLeftEarBuffer, delayedRightEarBuffer, nearFilteredRightEarBuffer, sourceTransform, listenerTransform, _listenerILDWeak);
 
 			// Ambisonic Encoder						
 			ambisonicEncoder.EncodedIR(nearFilteredLeftEarBuffer, leftChannelsBuffers, leftAzimuth, leftElevation);
@@ -201,9 +200,9 @@ namespace BRTProcessing {
 		/// Reset convolvers and convolution buffers
 		void ResetBuffers() {
 			std::lock_guard<std::mutex> l(mutex);
-			//Init buffer to store delay to be used in the ProcessAddDelay_ExpansionMethod method
-			leftChannelDelayBuffer.clear();
-			rightChannelDelayBuffer.clear();
+			//Reset the lines that add the ITD
+			leftChannelDelayLine.Reset();
+			rightChannelDelayLine.Reset();
 			nearFieldEffectProcess.ResetBuffers();
 		}
 
@@ -216,8 +215,8 @@ namespace BRTProcessing {
 
 		BRTProcessing::CAmbisonicEncoder ambisonicEncoder; // Ambisonic encoder
 
-		CMonoBuffer<float> leftChannelDelayBuffer;				// To store the delay of the left channel of the expansion method
-		CMonoBuffer<float> rightChannelDelayBuffer;				// To store the delay of the right channel of the expansion method
+		Common::CFractionalDelayLine leftChannelDelayLine;		// To add the delay of the left channel
+		Common::CFractionalDelayLine rightChannelDelayLine;		// To add the delay of the right channel
 		int ambisonicOrder;
 		Common::TAmbisonicNormalization ambisonicNormalization;
 		
@@ -229,8 +228,8 @@ namespace BRTProcessing {
 		/// PRIVATE Methods        				
 		/// Initialize convolvers and convolition buffers		
 		void InitializedSourceConvolutionBuffers(std::shared_ptr<BRTServices::CSphericalInterpolatedFIRTable>& _listenerHRTF) {		
-			leftChannelDelayBuffer.clear();
-			rightChannelDelayBuffer.clear();
+			leftChannelDelayLine.Reset();
+			rightChannelDelayLine.Reset();
 		}		
 	};
 }
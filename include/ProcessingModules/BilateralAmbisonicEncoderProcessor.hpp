@@ -63,8 +63,8 @@ class CBilateralAmbisonicEncoderProcessor : public BRTConnectivity::CBRTConnecti
 			
 			//std::lock_guard<std::mutex> l(mutex);
 
-			std::vector<CMonoBuffer<float>> leftAmbisonicChannelsBuffers;
-			std::vector<CMonoBuffer<float>> rightAmbisonicChannelsBuffers;
+			CMultiChannelBuffer<float> leftAmbisonicChannelsBuffers;
+			CMultiChannelBuffer<float> rightAmbisonicChannelsBuffers;
 			CMonoBuffer<float> outRightBuffer;
 			
 			CMonoBuffer<float> buffer = GetSamplesEntryPoint("inputSamples")->GetData();
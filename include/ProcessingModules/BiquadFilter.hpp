@@ -47,6 +47,78 @@ namespace BRTProcessing {
 		PEAKNOTCH = 5	///< Peak Notch filter
 	};
 
+	/** \brief Type definition for specifying how the filter moves to new coefficients
+	*/
+	enum TBiquadTransition {
+		CROSSFADING = 0,				///< The frame is filtered with the old and the new coefficients and both outputs are crossfaded
+		COEFFICIENTS_INTERPOLATION = 1	///< The frame is filtered once, in normalized lattice form, interpolating its parameters from the old to the new ones
+	};
+
+	/** \brief Normalized lattice (Gray-Markel) form of a biquad, used to move a filter from one set of coefficients to another
+	*	\details The poles are set by the reflection coefficients k1 and k2 and the zeros by the ladder taps w0, w1 and w2. Each lattice
+	*	stage rotates its two signals by an angle whose sine is k, so while |k1| and |k2| are below 1 the energy stored in the delay cells
+	*	can not grow, however fast the parameters change. A filter is stable if and only if its reflection coefficients are below 1, and
+	*	that holds along any linear path between two stable filters, so the parameters can be interpolated sample by sample.
+	*	\n The delay cells are converted from and to the Direct Form II cells of CBiquadFilter, so the lattice is only used during a transition.
+	*/
+	struct TBiquadLattice {
+		double k1, k2;		// Reflection coefficients
+		double w0, w1, w2;	// Ladder taps
+
+		TBiquadLattice() : k1 { 0 }, k2 { 0 }, w0 { 1 }, w1 { 0 }, w2 { 0 } { }
+
+		/** \brief Get the lattice parameters of the biquad (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+		*	\retval true if the biquad is stable and the lattice exists, false otherwise
+		*/
+		bool SetFromDirectForm(double b0, double b1, double b2, double a1, double a2) {
+			if (!(std::abs(a2) < 1.0)) return false;
+			const double _k1 = a1 / (1.0 + a2);
+			if (!(std::abs(_k1) < 1.0)) return false;
+			k2 = a2;
+			k1 = _k1;
+			const double c1 = std::sqrt(1.0 - k1 * k1);
+			const double c2 = std::sqrt(1.0 - k2 * k2);
+			const double v1 = b1 - b2 * a1;
+			const double v0 = b0 - v1 * k1 - b2 * a2;
+			w2 = b2;
+			w1 = v1 / c2;
+			w0 = v0 / (c1 * c2);
+			return true;
+		}
+
+		/** \brief Get the lattice delay cells equivalent to the Direct Form II delay cells of the same filter
+		*/
+		void DirectFormToLatticeState(double z1, double z2, double & s1, double & s2) const {
+			const double c1 = std::sqrt(1.0 - k1 * k1);
+			const double c2 = std::sqrt(1.0 - k2 * k2);
+			s1 = c1 * c2 * z1;
+			s2 = c2 * (k1 * z1 + z2);
+		}
+
+		/** \brief Get the Direct Form II delay cells equivalent to the lattice delay cells of the same filter
+		*/
+		void LatticeToDirectFormState(double s1, double s2, double & z1, double & z2) const {
+			const double c1 = std::sqrt(1.0 - k1 * k1);
+			const double c2 = std::sqrt(1.0 - k2 * k2);
+			z1 = s1 / (c1 * c2);
+			z2 = s2 / c2 - k1 * z1;
+		}
+
+		/** \brief Filter one sample with the given parameters, updating the lattice delay cells
+		*/
+		static double ProcessSample(double x, double k1, double k2, double w0, double w1, double w2, double & s1, double & s2) {
+			const double c1 = std::sqrt(1.0 - k1 * k1);
+			const double c2 = std::sqrt(1.0 - k2 * k2);
+			const double f1 = c2 * x - k2 * s2;
+			const double g2 = k2 * x + c2 * s2;
+			const double f0 = c1 * f1 - k1 * s1;
+			const double g1 = k1 * f1 + c1 * s1;
+			s1 = f0;
+			s2 = g1;
+			return w0 * f0 + w1 * g1 + w2 * g2;
+		}
+	};
+
 	/** \brief Type definition for a vector of filter coefficients for one biquad
 	*	\details Order: b0, b1, b2, a1, a2  
 	*/
@@ -66,7 +138,7 @@ namespace BRTProcessing {
 		*	\details By default, sets sampling frequency to 44100Hz.
 		*   \eh Nothing is reported to the error handler.
 		*/
-		CBiquadFilter() : generalGain {1.0f}, crossfadingEnabled {false}, firstBuffer{true}
+		CBiquadFilter() : generalGain {1.0f}, crossfadingEnabled {false}, firstBuffer{true}, transition {CROSSFADING}
 		{
 			// error handler: Trust in SetSamplingFreq for result			
 			InitFilterCoefficients();			
@@ -100,6 +172,18 @@ namespace BRTProcessing {
 			SetCoefficients(coefficients);
 		}
 
+		/**
+		 * @brief Set up coefficients of the filter from an array, without allocating memory
+		 * @param coefficients coefficients array. Order: b0, b1, b2, a0, a1, a2 or b0, b1, b2, a1, a2
+		 * @param numberOfCoefficients number of coefficients in the array, 6 or 5
+		 * @param _crossfadingEnabled true when cross fading must be applied between frames
+		 */
+		void Setup(const float * coefficients, std::size_t numberOfCoefficients, bool _crossfadingEnabled = true)
+		{
+			crossfadingEnabled = _crossfadingEnabled;
+			SetCoefficients(coefficients, numberOfCoefficients);
+		}
+
 		void Setup(float frequency, float Q, TBiquadType filterType, double commandGain, bool _crossfadingEnabled = true) {			
 			crossfadingEnabled = _crossfadingEnabled;
 			SetCoefficients(frequency, Q, filterType, commandGain);
@@ -278,6 +362,29 @@ namespace BRTProcessing {
 			return generalGain;
 		}
 		
+		/** \brief Set how the filter moves to new coefficients
+		*	\details With CROSSFADING (default) every frame with new coefficients is filtered twice, with the old and the new ones, and both
+		*	outputs are crossfaded. With COEFFICIENTS_INTERPOLATION the frame is filtered once, in normalized lattice form (see
+		*	TBiquadLattice), with the lattice parameters linearly interpolated from the old to the new filter along the frame, so the
+		*	filter stays stable and its state is carried over. If the old or the new filter is unstable that frame is crossfaded.
+		*	The steady state is the same in both modes.
+		*	\param [in] _transition transition mode
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void SetTransitionMode(TBiquadTransition _transition)
+		{
+			transition = _transition;
+		}
+
+		/** \brief Get how the filter moves to new coefficients
+		*	\retval transition transition mode
+		*   \eh Nothing is reported to the error handler.
+		*/
+		TBiquadTransition GetTransitionMode() const
+		{
+			return transition;
+		}
+
 		void ResetBuffers() {
 			z1 = 0;
 			z2 = 0;
@@ -321,7 +428,9 @@ namespace BRTProcessing {
 											: static_cast<float>(v);
 			};
 
-			if (crossfadingEnabled) {
+			if (crossfadingEnabled && transition == COEFFICIENTS_INTERPOLATION && ProcessInterpolatingCoefficients(inBuffer, writeSample, size)) {
+				// Filtered once, moving the lattice parameters. If there is no lattice the frame is crossfaded below
+			} else if (crossfadingEnabled) {
 				if (firstBuffer) {
 					for (int c = 0; c < size; ++c) {
 						const double r = ProcessSample(inBuffer[c], new_a1, new_a2, new_b0, new_b1, new_b2, new_z1, new_z2);
@@ -413,11 +522,20 @@ namespace BRTProcessing {
 		*   \eh Nothing is reported to the error handler. */
 		void SetCoefficients(const TBiquadCoefficients& coefficients)
 		{
-			if (coefficients.size() == 6) {
+			SetCoefficients(coefficients.data(), coefficients.size());
+		}
+
+		/** \brief Set up coefficients of the filter
+		*	\param [in] coefficients coefficients array. Order: b0, b1, b2, a0, a1, a2 or b0, b1, b2, a1, a2
+		*	\param [in] numberOfCoefficients number of coefficients in the array, 6 or 5
+		*   \eh On error, an error code is reported to the error handler. */
+		void SetCoefficients(const float * coefficients, std::size_t numberOfCoefficients)
+		{
+			if (numberOfCoefficients == 6) {
 				float a0 = coefficients[3];
 				SetCoefficients(coefficients[0] / a0, coefficients[1] / a0, coefficients[2] / a0, coefficients[4] / a0, coefficients[5] / a0);
 			}
-			else if (coefficients.size() == 5) {
+			else if (numberOfCoefficients == 5) {
 				SetCoefficients(coefficients[0], coefficients[1], coefficients[2], coefficients[3], coefficients[4]);
 			}
 			else {
@@ -756,6 +874,55 @@ namespace BRTProcessing {
 			return res;
 		}
 				
+		/**
+		 * @brief Filter a frame with new coefficients, moving from the current filter to the new one along the frame
+		 * @details Only one filter runs. The delay cells are converted to the normalized lattice of the current filter, the frame is
+		 * filtered while the lattice parameters are linearly interpolated to the ones of the new filter, and the cells are converted
+		 * back to Direct Form II with the new filter. The first frame is filtered with the new coefficients.
+		 * @return false, without filtering, if the current or the new filter has no lattice because it is unstable
+		 */
+		template <typename TWriteSample>
+		bool ProcessInterpolatingCoefficients(const CMonoBuffer<float> & inBuffer, TWriteSample & writeSample, int size)
+		{
+			if (firstBuffer) {
+				UpdateCoefficientsAfterInterpolation();
+				for (int c = 0; c < size; ++c) {
+					writeSample(c, ProcessSample(inBuffer[c], a1, a2, b0, b1, b2, z1, z2));
+				}
+				firstBuffer = false;
+				return true;
+			}
+			TBiquadLattice from, to;
+			if (!from.SetFromDirectForm(b0, b1, b2, a1, a2) || !to.SetFromDirectForm(new_b0, new_b1, new_b2, new_a1, new_a2)) return false;
+
+			double s1, s2;
+			from.DirectFormToLatticeState(z1, z2, s1, s2);
+			const double step = size > 1 ? 1.0 / static_cast<double>(size - 1) : 1.0;
+			const double d_k1 = to.k1 - from.k1, d_k2 = to.k2 - from.k2, d_w0 = to.w0 - from.w0, d_w1 = to.w1 - from.w1, d_w2 = to.w2 - from.w2;
+			for (int c = 0; c < size; ++c) {
+				const double alpha = c * step;
+				const double r = TBiquadLattice::ProcessSample(inBuffer[c], from.k1 + alpha * d_k1, from.k2 + alpha * d_k2,
+					from.w0 + alpha * d_w0, from.w1 + alpha * d_w1, from.w2 + alpha * d_w2, s1, s2);
+				writeSample(c, generalGain * static_cast<float>(r));
+			}
+			to.LatticeToDirectFormState(s1, s2, z1, z2);
+			UpdateCoefficientsAfterInterpolation();
+			return true;
+		}
+
+		/**
+		 * @brief Set current coefficients to new coefficients and disables the transition. The delay cells are kept.
+		 */
+		void UpdateCoefficientsAfterInterpolation()
+		{
+			crossfadingEnabled = false;
+			b0 = new_b0;
+			b1 = new_b1;
+			b2 = new_b2;
+			a1 = new_a1;
+			a2 = new_a2;
+		}
+
 		/**
 		 * @brief Updates filter attributes after crossfading by assigning new values and disabling crossfading.
 		 * @details Set current coefficients to new cofficients and updates the delay cells. Also update the crossfading Needed attribute.
@@ -788,6 +955,7 @@ namespace BRTProcessing {
 		double new_z1, new_z2;								// Keep last values to implement the delays of the filter (left and right channels)
 		bool   crossfadingEnabled;                          // True when cross fading must be applied in the next frame
 		bool   firstBuffer;									// Controls when the first buffer is to be processed 
+		TBiquadTransition transition;						// How the filter moves to new coefficients
 	};
 }
 #endif
@@ -49,7 +49,7 @@ namespace BRTProcessing {
 		/** \brief Default constructor
 		*   \eh On error, an error code is reported to the error handler.
 		*/
-		CBiquadFilterChain() {};
+		CBiquadFilterChain() : transition { CROSSFADING } {};
 
 			
 		/**
@@ -73,6 +73,7 @@ namespace BRTProcessing {
 			try
 			{
 				std::shared_ptr<CBiquadFilter> newFilter(new CBiquadFilter());
+				newFilter->SetTransitionMode(transition);
 				filters.push_back(newFilter);
 
 				SET_RESULT(RESULT_OK, "Filter added to filter chain succesfully");
@@ -188,6 +189,39 @@ namespace BRTProcessing {
 			}
 		}
 		
+		/** \brief Set the coefficients of the filters chain from an array with the coefficients of every biquad, one after the other
+		*	\details If the number of biquads fits the current number of filters in the chain, the existing filter coefficients are set without
+		*	allocating memory. Otherwise a new filters chain is created from scratch.
+		*	\param [in] coefficients ordered coefficients for all biquads in the chain
+		*	\param [in] numberOfFilters number of biquads
+		*	\param [in] numberOfCoefficientsPerFilter number of coefficients of each biquad, 6 or 5
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void SetFromCoefficientsArray(const float * coefficients, std::size_t numberOfFilters, std::size_t numberOfCoefficientsPerFilter, bool _crossfadingEnabled = true)
+		{
+			if (numberOfFilters != filters.size())
+			{
+				// Create chain from scratch
+				RemoveFilters();
+				AddNFilters(static_cast<int>(numberOfFilters));
+			}
+			for (std::size_t i = 0; i < numberOfFilters; i++)
+			{
+				filters[i]->Setup(coefficients + i * numberOfCoefficientsPerFilter, numberOfCoefficientsPerFilter, _crossfadingEnabled);
+			}
+		}
+
+		/** \brief Set how all the filters of the chain, and the ones added later, move to new coefficients
+		*	\param [in] _transition transition mode
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void SetTransitionMode(TBiquadTransition _transition)
+		{
+			transition = _transition;
+			for (std::shared_ptr<CBiquadFilter> & filter : filters) {
+				if (filter != nullptr) filter->SetTransitionMode(transition);
+			}
+		}
 
 		void ResetBuffers() {			
 			for (int i = 0; i < filters.size(); i++)
@@ -202,6 +236,7 @@ namespace BRTProcessing {
 		////////////////////////
 		std::vector<std::shared_ptr<CBiquadFilter>> filters;                    // Hold the filters in the chain. 
 																				// Indexes indicate the order within the chain.
+		TBiquadTransition transition;											// Transition mode of the filters
 	};
 }//end namespace Common
 #endif
\ No newline at end of file
@@ -285,8 +285,9 @@ namespace BRTProcessing {
 			//outputLeftUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true);
 			//outputRightUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true);			
 
+			// The history of IRs is stored with the same format as the table
 			for (auto& convolver : channelsConvolvers) {
-				convolver.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true);
+				convolver.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true, _irTable->GetSpectralStoragePrecision());
 			}
 
 			// Declare variable
@@ -0,0 +1,207 @@
+/**
+* \class CHRIRCache
+*
+* \brief Declaration of CHRIRCache class interface.
+* \detail Keeps the last pair of partitioned HRIRs obtained by a convolver, together with the direction they were obtained for. While the
+	source does not move beyond a configurable tolerance the stored HRIRs are reused, so no table query or interpolation is made.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This class is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _HRIR_CACHE_HPP_
+#define _HRIR_CACHE_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <Common/ErrorHandler.hpp>
+#include <Common/Vector3.hpp>
+#include <ServiceModules/ServicesBase.hpp>
+
+namespace BRTProcessing {
+
+	/**
+	 * @brief Data that identifies a pair of HRIRs obtained from a table
+	 */
+	struct THRIRCacheKey {
+		const BRTServices::CServicesBase * table = nullptr;		// Table the HRIRs were obtained from
+		uint32_t tableRevision = 0;								// Revision of the table data when the HRIRs were obtained
+		bool interpolation = false;								// Run time interpolation flag used
+		float leftAzimuth = 0.0f;
+		float leftElevation = 0.0f;
+		float rightAzimuth = 0.0f;
+		float rightElevation = 0.0f;
+		float distance = 0.0f;									// Source to listener distance, in metres
+		Common::CVector3 listenerPosition;						// Only relevant for tables with several reference positions
+	};
+
+	class CHRIRCache {
+	public:
+		CHRIRCache()
+			: angularTolerance { 0.0f }
+			, distanceTolerance { 0.0f }
+			, valid { false }
+			, hits { 0 }
+			, misses { 0 } { }
+
+		/**
+		 * @brief Set the maximum change of the source direction for which the stored HRIRs are reused.
+			With both tolerances set to 0, the stored HRIRs are only reused for exactly the same direction, so the output is not modified.
+		 * @param _angularTolerance maximum azimuth and elevation difference, in degrees
+		 * @param _distanceTolerance maximum difference of source distance and listener position, in metres
+		 */
+		void SetTolerance(float _angularTolerance, float _distanceTolerance) {
+			if (_angularTolerance < 0 || _distanceTolerance < 0) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The HRIR cache tolerances cannot be negative");
+				return;
+			}
+			angularTolerance = _angularTolerance;
+			distanceTolerance = _distanceTolerance;
+			Clear();
+		}
+
+		/**
+		 * @brief Get the angular tolerance
+		 * @return angular tolerance in degrees
+		 */
+		float GetAngularTolerance() const { return angularTolerance; }
+
+		/**
+		 * @brief Get the distance tolerance
+		 * @return distance tolerance in metres
+		 */
+		float GetDistanceTolerance() const { return distanceTolerance; }
+
+		/**
+		 * @brief Check if the stored HRIRs can be used for the given key. The hit and miss counters are updated.
+		 * @param _key data of the HRIRs needed
+		 * @return true if the stored HRIRs can be used
+		 */
+		bool Find(const THRIRCacheKey & _key) {
+			if (valid && IsWithinTolerance(_key)) {
+				hits++;
+				return true;
+			}
+			misses++;
+			return false;
+		}
+
+		/**
+		 * @brief Store a new pair of HRIRs, replacing the previous ones
+		 * @param _key data of the HRIRs
+		 * @param _leftHRIR partitioned HRIR of the left ear
+		 * @param _rightHRIR partitioned HRIR of the right ear
+		 */
+		void Store(const THRIRCacheKey & _key, BRTServices::TFRPartitions && _leftHRIR, BRTServices::TFRPartitions && _rightHRIR) {
+			storedKey = _key;
+			leftHRIR = std::move(_leftHRIR);
+			rightHRIR = std::move(_rightHRIR);
+			valid = true;
+		}
+
+		/**
+		 * @brief Get the stored HRIR of the left ear
+		 */
+		const BRTServices::TFRPartitions & GetLeftHRIR() const { return leftHRIR; }
+
+		/**
+		 * @brief Get the stored HRIR of the right ear
+		 */
+		const BRTServices::TFRPartitions & GetRightHRIR() const { return rightHRIR; }
+
+		/**
+		 * @brief Discard the stored HRIRs. Counters are not modified.
+		 */
+		void Clear() {
+			valid = false;
+			leftHRIR.clear();
+			rightHRIR.clear();
+		}
+
+		/**
+		 * @brief Discard the stored HRIRs without releasing their memory, so that it can be done from the audio thread. Counters are not modified.
+		 */
+		void Invalidate() { valid = false; }
+
+		/**
+		 * @brief Exchange the stored HRIRs with those of another cache. The tolerances and the counters of each cache are kept.
+		 * @param _other cache to exchange the HRIRs with
+		 */
+		void SwapHRIRs(CHRIRCache & _other) {
+			std::swap(valid, _other.valid);
+			std::swap(storedKey, _other.storedKey);
+			leftHRIR.swap(_other.leftHRIR);
+			rightHRIR.swap(_other.rightHRIR);
+		}
+
+		/**
+		 * @brief Get the ratio of queries answered with the stored HRIRs
+		 * @return hit rate, in range [0, 1]. 0 if there has not been any query.
+		 */
+		float GetHitRate() const {
+			uint64_t total = hits + misses;
+			return total == 0 ? 0.0f : static_cast<float>(hits) / total;
+		}
+
+		/**
+		 * @brief Get the number of queries answered with the stored HRIRs
+		 */
+		uint64_t GetNumberOfHits() const { return hits; }
+
+		/**
+		 * @brief Get the number of queries that needed a table query
+		 */
+		uint64_t GetNumberOfMisses() const { return misses; }
+
+		/**
+		 * @brief Set the hit and miss counters to zero
+		 */
+		void ResetCounters() {
+			hits = 0;
+			misses = 0;
+		}
+
+	private:
+		/// Check if the key is close enough to the stored one
+		bool IsWithinTolerance(const THRIRCacheKey & _key) const {
+			if (_key.table != storedKey.table || _key.tableRevision != storedKey.tableRevision || _key.interpolation != storedKey.interpolation) { return false; }
+			if (AngleDifference(_key.leftAzimuth, storedKey.leftAzimuth) > angularTolerance) { return false; }
+			if (AngleDifference(_key.leftElevation, storedKey.leftElevation) > angularTolerance) { return false; }
+			if (AngleDifference(_key.rightAzimuth, storedKey.rightAzimuth) > angularTolerance) { return false; }
+			if (AngleDifference(_key.rightElevation, storedKey.rightElevation) > angularTolerance) { return false; }
+			if (std::fabs(_key.distance - storedKey.distance) > distanceTolerance) { return false; }
+			return (_key.listenerPosition - storedKey.listenerPosition).GetDistance() <= distanceTolerance;
+		}
+
+		/// Absolute difference between two angles in degrees, taking into account the 360 wrap
+		static float AngleDifference(float _angle1, float _angle2) {
+			float difference = std::fabs(std::fmod(_angle1 - _angle2, 360.0f));
+			return difference > 180.0f ? 360.0f - difference : difference;
+		}
+
+		float angularTolerance;						// Maximum azimuth and elevation difference to reuse the stored HRIRs, in degrees
+		float distanceTolerance;					// Maximum distance difference to reuse the stored HRIRs, in metres
+		bool valid;									// True if there are HRIRs stored
+		THRIRCacheKey storedKey;					// Data of the stored HRIRs
+		BRTServices::TFRPartitions leftHRIR;		// Stored HRIR of the left ear
+		BRTServices::TFRPartitions rightHRIR;		// Stored HRIR of the right ear
+		uint64_t hits;								// Number of queries answered with the stored HRIRs
+		uint64_t misses;							// Number of queries that needed a table query
+	};
+}
+#endif
@@ -26,19 +26,25 @@
 #define _HRTF_CONVOLVER_
 
 #include <ProcessingModules/UniformPartitionedConvolution.hpp>
+#include <ProcessingModules/HRIRCache.hpp>
 #include <Common/Buffer.hpp>
-#include <Common/AddDelayExpansionMethod.hpp>
+#include <Common/FractionalDelayLine.hpp>
 #include <Common/SourceListenerRelativePositionCalculation.hpp>
 
 
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <utility>
 
 //#define EPSILON 0.0001f
 //#define ELEVATION_SINGULAR_POINT_UP 90.0
 //#define ELEVATION_SINGULAR_POINT_DOWN 270.0
 
+#ifndef DEFAULT_TABLE_CROSSFADE_FRAMES
+#define DEFAULT_TABLE_CROSSFADE_FRAMES 2
+#endif
+
 namespace BRTProcessing {
 	class CHRTFConvolver  {
 	public:
@@ -48,7 +54,12 @@ namespace BRTProcessing {
 			, enableSpatialization{true}
 			, enableITDSimulation{true}
 			, enableParallaxCorrection{true}
-			, convolutionBuffersInitialized{false} { }
+			, convolutionBuffersInitialized{false}
+			, pendingTableRevision{0}
+			, tableCrossfadeFrames{ DEFAULT_TABLE_CROSSFADE_FRAMES }
+			, crossfadeLength{0}
+			, crossfadePosition{0}
+			, silentInputFrames{0} { }
 
 		/**
 		 * @brief Enable processor
@@ -151,6 +162,115 @@ namespace BRTProcessing {
 		 * @return true if Parallax Correction is enabled, false otherwise
 		 */
 		bool IsParallaxCorrectionEnabled() { return enableParallaxCorrection; }
+
+		/**
+		 * @brief Set the tolerance of the HRIR cache. While the source direction does not change more than the tolerance, the HRIRs
+			of the previous frame are used without querying the table. With 0 tolerances (default) the HRIRs are only reused if the direction does not change.
+		 * @param _angularTolerance maximum azimuth and elevation change, in degrees
+		 * @param _distanceTolerance maximum source distance and listener position change, in metres
+		 */
+		void SetHRIRCacheTolerance(float _angularTolerance, float _distanceTolerance = 0.0f) {
+			std::lock_guard<std::mutex> l(mutex);
+			hrirCache.SetTolerance(_angularTolerance, _distanceTolerance);
+			fadingHRIRCache.SetTolerance(_angularTolerance, _distanceTolerance);
+		}
+
+		/**
+		 * @brief Get the angular tolerance of the HRIR cache
+		 * @return angular tolerance in degrees
+		 */
+		float GetHRIRCacheAngularTolerance() { return hrirCache.GetAngularTolerance(); }
+
+		/**
+		 * @brief Get the distance tolerance of the HRIR cache
+		 * @return distance tolerance in metres
+		 */
+		float GetHRIRCacheDistanceTolerance() { return hrirCache.GetDistanceTolerance(); }
+
+		/**
+		 * @brief Get the ratio of frames in which the HRIRs have been taken from the cache
+		 * @return hit rate, in range [0, 1]
+		 */
+		float GetHRIRCacheHitRate() { 
+			std::lock_guard<std::mutex> l(mutex);
+			return hrirCache.GetHitRate(); 
+		}
+
+		/**
+		 * @brief Set the counters used to calculate the HRIR cache hit rate to zero
+		 */
+		void ResetHRIRCacheHitRate() { 
+			std::lock_guard<std::mutex> l(mutex);
+			hrirCache.ResetCounters(); 
+		}
+
+		/**
+		 * @brief Set the length of the crossfade done when the table changes while the convolver is running. During the crossfade the
+			input is convolved with both tables, and the output goes from the previous table to the new one.
+		 * @param _numberOfFrames crossfade length in frames. With 0 the new table is used directly.
+		 */
+		void SetTableCrossfadeLength(int _numberOfFrames) {
+			if (_numberOfFrames < 0) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The table crossfade length cannot be negative");
+				return;
+			}
+			std::lock_guard<std::mutex> l(mutex);
+			tableCrossfadeFrames = _numberOfFrames;
+		}
+
+		/**
+		 * @brief Get the length of the crossfade done when the table changes
+		 * @return crossfade length in frames
+		 */
+		int GetTableCrossfadeLength() { 
+			std::lock_guard<std::mutex> l(mutex);
+			return tableCrossfadeFrames; 
+		}
+
+		/**
+		 * @brief Check if the output is fading from a previous table to the current one
+		 */
+		bool IsTableCrossfadeInProgress() { 
+			std::lock_guard<std::mutex> l(mutex);
+			return crossfadePosition < crossfadeLength; 
+		}
+
+		/**
+		 * @brief Prepare the convolvers for a table that is going to replace the current one. It has to be called from the thread that
+			changes the table, before sending it, so that the crossfade in the audio thread only swaps the prepared convolvers and does not allocate.
+			If the table reaches the convolver without being prepared, or its setup changes in between, the convolvers are prepared in the audio thread.
+		 * @param _newTable table that is going to be used
+		 */
+		void PrepareTableChange(std::shared_ptr<BRTServices::CServicesBase> _newTable) {
+			if (!_newTable || !_newTable->IsDataReady()) { return; }
+
+			BRTProcessing::CUniformPartitionedConvolution newLeftUPConvolution;
+			BRTProcessing::CUniformPartitionedConvolution newRightUPConvolution;
+			Common::CFractionalDelayLine newLeftChannelDelayLine;
+			Common::CFractionalDelayLine newRightChannelDelayLine;
+			SetupTableConvolution(_newTable, newLeftUPConvolution, newRightUPConvolution, newLeftChannelDelayLine, newRightChannelDelayLine);
+
+			std::lock_guard<std::mutex> l(mutex);
+			// The buffers left in the pending convolvers are released when the local ones go out of scope, in this thread
+			std::swap(newLeftUPConvolution, pendingLeftUPConvolution);
+			std::swap(newRightUPConvolution, pendingRightUPConvolution);
+			std::swap(newLeftChannelDelayLine, pendingLeftChannelDelayLine);
+			std::swap(newRightChannelDelayLine, pendingRightChannelDelayLine);
+			// The HRIRs left by the previous crossfade are released here, out of the audio thread
+			pendingHRIRCache.Clear();
+			pendingTable = _newTable;
+			pendingTableRevision = _newTable->GetSetupRevision();
+		}
+
+		/**
+		 * @brief Check if a table is used by the convolver, because it is the current one, it is fading out or it has been prepared to replace the current one
+		 * @param _table table to check
+		 * @return true if the table must be kept alive
+		 */
+		bool IsUsingTable(const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+			std::lock_guard<std::mutex> l(mutex);
+			return IsSameTable(activeTable, _table) || IsSameTable(fadingTable, _table) || IsSameTable(pendingTable, _table);
+		}
 		
 		/** \brief Process data from input buffer to generate spatialization by convolution
 		*	\param [in] inBuffer input buffer with anechoic audio
@@ -202,61 +322,29 @@ namespace BRTProcessing {
 				return;
 			}
 
+			// The table has been replaced while running: the convolution with the previous table fades out while the new one fades in
+			if (convolutionBuffersInitialized && !IsSameTable(activeTable, _listenerSphericalIRTable)) { BeginTableCrossfade(_listenerSphericalIRTable); }
+
 			// First time - Initialize convolution buffers
 			if (!convolutionBuffersInitialized) { InitializedSourceConvolutionBuffers(_listenerSphericalIRTable); }
 
-			// Calculate Source coordinates taking into account Source and Listener transforms
-			float leftAzimuth;
-			float leftElevation;
-			float rightAzimuth;
-			float rightElevation;
-			float centerAzimuth;
-			float centerElevation;
-			float interauralAzimuth;
-
-			Common::CSourceListenerRelativePositionCalculation::CalculateSourceListenerRelativePositions(sourceTransform, listenerTransform, _listenerSphericalIRTable, enableParallaxCorrection,leftElevation, leftAzimuth, rightElevation, rightAzimuth, centerElevation, centerAzimuth, interauralAzimuth);
-
-			// GET HRTF
-			std::vector<CMonoBuffer<float>>  leftHRIR_partitioned;
-			std::vector<CMonoBuffer<float>>  rightHRIR_partitioned;
-
-			//leftHRIR_partitioned = _listenerSphericalIRTable->GetHRIRPartitioned(Common::T_ear::LEFT, leftAzimuth, leftElevation, enableInterpolation, listenerTransform);
-			//rightHRIR_partitioned = _listenerSphericalIRTable->GetHRIRPartitioned(Common::T_ear::RIGHT, rightAzimuth, rightElevation, enableInterpolation, listenerTransform);			
-			leftHRIR_partitioned = _listenerSphericalIRTable->GetFR_SpatiallyOriented(leftAzimuth, leftElevation, distanceToListener, listenerTransform, Common::T_ear::LEFT, enableInterpolation);
-			rightHRIR_partitioned = _listenerSphericalIRTable->GetFR_SpatiallyOriented(rightAzimuth, rightElevation, distanceToListener, listenerTransform, Common::T_ear::RIGHT, enableInterpolation);
-
-			if (leftHRIR_partitioned.empty() || rightHRIR_partitioned.empty()) {
-				SET_RESULT(RESULT_ERROR_NULLPOINTER, "HRTF Convolver: No IR has been found in that position.");
+			// Once the input has been silent for longer than the HRIR and the ITD, the output is silent too
+			if (IsSilentInput(_inBuffer, _listenerSphericalIRTable)) {
 				outLeftBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
 				outRightBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
 				return;
 			}
 
-			// DO CONVOLUTION			
-			CMonoBuffer<float> leftChannel_withoutDelay;
-			CMonoBuffer<float> rightChannel_withoutDelay;
-			//UPC algorithm with memory
-			outputLeftUPConvolution.ProcessUPConvolutionWithMemory(_inBuffer, leftHRIR_partitioned, leftChannel_withoutDelay);
-			outputRightUPConvolution.ProcessUPConvolutionWithMemory(_inBuffer, rightHRIR_partitioned, rightChannel_withoutDelay);
-
-			// GET DELAY
-			//uint64_t leftDelay; 				///< Delay, in number of samples
-			//uint64_t rightDelay;				///< Delay, in number of samples
-			Common::CEarPair<uint64_t> delays({0,0});	///< Delay, in number of samples
+			if (!ProcessTableConvolution(_listenerSphericalIRTable, _inBuffer, outLeftBuffer, outRightBuffer, sourceTransform, listenerTransform, distanceToListener,
+					outputLeftUPConvolution, outputRightUPConvolution, leftChannelDelayLine, rightChannelDelayLine, hrirCache)) {
+				outLeftBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
+				outRightBuffer.Fill(globalParameters.GetBufferSize(), 0.0f);
+				return;
+			}
 
-			if (enableITDSimulation){
-				//BRTServices::THRIRPartitionedStruct delays = _listenerSphericalIRTable->GetHRIRDelay(Common::T_ear::BOTH, centerAzimuth, centerElevation, enableInterpolation, listenerTransform);
-				delays = _listenerSphericalIRTable->GetFR_Delay(centerAzimuth, centerElevation, distanceToListener, listenerTransform, enableInterpolation);				
-				/*leftDelay = delays.leftDelay;
-				rightDelay = delays.rightDelay;*/
+			if (crossfadePosition < crossfadeLength) {
+				ProcessTableCrossfade(_inBuffer, outLeftBuffer, outRightBuffer, sourceTransform, listenerTransform, distanceToListener);
 			}
-			/*else {
-				leftDelay = 0;
-				rightDelay = 0;
-			}*/
-			// ADD Delay
-			Common::CAddDelayExpansionMethod::ProcessAddDelay_ExpansionMethod(leftChannel_withoutDelay, outLeftBuffer, leftChannelDelayBuffer, delays.left);
-			Common::CAddDelayExpansionMethod::ProcessAddDelay_ExpansionMethod(rightChannel_withoutDelay, outRightBuffer, rightChannelDelayBuffer, delays.right);			
 		}
 
 		/// Reset convolvers and convolution buffers
@@ -268,9 +356,12 @@ namespace BRTProcessing {
 			// Reset convolver classes
 			outputLeftUPConvolution.Reset();
 			outputRightUPConvolution.Reset();
-			//Init buffer to store delay to be used in the ProcessAddDelay_ExpansionMethod method
-			leftChannelDelayBuffer.clear();
-			rightChannelDelayBuffer.clear();
+			hrirCache.Clear();
+			//Reset the lines that add the ITD
+			leftChannelDelayLine.Reset();
+			rightChannelDelayLine.Reset();
+			EndTableCrossfade();
+			silentInputFrames = 0;
 		}
 	private:
 
@@ -281,8 +372,11 @@ namespace BRTProcessing {
 		BRTProcessing::CUniformPartitionedConvolution outputLeftUPConvolution; // Object to make the inverse fft of the left channel with the UPC method
 		BRTProcessing::CUniformPartitionedConvolution outputRightUPConvolution; // Object to make the inverse fft of the rigth channel with the UPC method
 
-		CMonoBuffer<float> leftChannelDelayBuffer;			// To store the delay of the left channel of the expansion method
-		CMonoBuffer<float> rightChannelDelayBuffer;			// To store the delay of the right channel of the expansion method
+		CHRIRCache hrirCache;								// HRIRs of the last frame, reused while the source does not move beyond its tolerance
+		std::weak_ptr<BRTServices::CServicesBase> activeTable;	// Table the convolvers have been initialized for
+
+		Common::CFractionalDelayLine leftChannelDelayLine;	// To add the delay of the left channel
+		Common::CFractionalDelayLine rightChannelDelayLine;	// To add the delay of the right channel
 
 		bool enableProcessor;								// Flag to enable the processor
 		bool enableSpatialization;							// Flags for independent control of processes
@@ -291,6 +385,27 @@ namespace BRTProcessing {
 		bool enableParallaxCorrection;						// Enables/Disables the parallax correction on run time
 		bool convolutionBuffersInitialized;					// Flag to check if the convolution buffers have been initialized		
 
+		// Crossfade after a table change. The previous table is kept alive by the listener model until the crossfade ends, so it is not released in the audio thread.
+		BRTProcessing::CUniformPartitionedConvolution fadingLeftUPConvolution;	// Convolution of the left channel with the previous table
+		BRTProcessing::CUniformPartitionedConvolution fadingRightUPConvolution;	// Convolution of the right channel with the previous table
+		CHRIRCache fadingHRIRCache;							// HRIRs of the previous table
+		CHRIRCache pendingHRIRCache;						// HRIRs no longer used, released by the next preparation
+		Common::CFractionalDelayLine fadingLeftChannelDelayLine;	// Delay of the left channel with the previous table
+		Common::CFractionalDelayLine fadingRightChannelDelayLine;	// Delay of the right channel with the previous table
+		std::weak_ptr<BRTServices::CServicesBase> fadingTable;	// Previous table
+		CMonoBuffer<float> fadingLeftBuffer;				// Output of the left channel with the previous table
+		CMonoBuffer<float> fadingRightBuffer;				// Output of the right channel with the previous table
+		BRTProcessing::CUniformPartitionedConvolution pendingLeftUPConvolution;	// Convolution of the left channel prepared for the next table
+		BRTProcessing::CUniformPartitionedConvolution pendingRightUPConvolution;	// Convolution of the right channel prepared for the next table
+		Common::CFractionalDelayLine pendingLeftChannelDelayLine;	// Delay of the left channel prepared for the next table
+		Common::CFractionalDelayLine pendingRightChannelDelayLine;	// Delay of the right channel prepared for the next table
+		std::weak_ptr<BRTServices::CServicesBase> pendingTable;	// Table the pending convolvers have been prepared for
+		unsigned int pendingTableRevision;					// Setup revision of that table when they were prepared
+		int tableCrossfadeFrames;							// Length of the crossfade in frames
+		int crossfadeLength;								// Length of the current crossfade in samples
+		int crossfadePosition;								// Samples of the current crossfade already done
+		std::size_t silentInputFrames;						// Number of consecutive frames whose input is all zeros
+
 		/////////////////////
 		/// PRIVATE Methods        
 		/////////////////////
@@ -299,19 +414,202 @@ namespace BRTProcessing {
 		/// Initialize convolvers and convolition buffers		
 		void InitializedSourceConvolutionBuffers(std::shared_ptr<BRTServices::CServicesBase>& _listenerHRTF) {
 
-			int numOfSubfilters = _listenerHRTF->GetNumberOfSubfiltersFR();
-			int subfilterLength = _listenerHRTF->GetSubfilterLengthFR();
-
-			//Common::CGlobalParameters globalParameters;
-			outputLeftUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true);
-			outputRightUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true);
-			//Init buffer to store delay to be used in the ProcessAddDelay_ExpansionMethod method
-			leftChannelDelayBuffer.clear();
-			rightChannelDelayBuffer.clear();
+			SetupTableConvolution(_listenerHRTF, outputLeftUPConvolution, outputRightUPConvolution, leftChannelDelayLine, rightChannelDelayLine);
+			activeTable = _listenerHRTF;
 
 			// Declare variable
 			convolutionBuffersInitialized = true;
-		}		
+		}
+
+		/// Setup a pair of convolvers for a table and reset their delay lines
+		void SetupTableConvolution(const std::shared_ptr<BRTServices::CServicesBase> & _table,
+			BRTProcessing::CUniformPartitionedConvolution & _leftUPConvolution, BRTProcessing::CUniformPartitionedConvolution & _rightUPConvolution,
+			Common::CFractionalDelayLine & _leftChannelDelayLine, Common::CFractionalDelayLine & _rightChannelDelayLine) {
+
+			int numOfSubfilters = _table->GetNumberOfSubfiltersFR();
+			int subfilterLength = _table->GetSubfilterLengthFR();
+
+			// The history of HRIRs is stored with the same format as the table
+			Common::TSpectralPrecision storagePrecision = _table->GetSpectralStoragePrecision();
+			_leftUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true, storagePrecision);
+			_rightUPConvolution.Setup(globalParameters.GetBufferSize(), subfilterLength, numOfSubfilters, true, storagePrecision);
+			//Reset the lines that add the ITD
+			_leftChannelDelayLine.Reset();
+			_rightChannelDelayLine.Reset();
+		}
+
+		/// Check if a weak pointer points to a table, without taking its ownership
+		static bool IsSameTable(const std::weak_ptr<BRTServices::CServicesBase> & _weakTable, const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+			if (!_table || _weakTable.expired()) { return false; }
+			return !_weakTable.owner_before(_table) && !_table.owner_before(_weakTable);
+		}
+
+		/**
+		 * @brief Count the consecutive silent input frames, and check if the convolution of this frame can be skipped.
+		 * @details It can be skipped when the input has been zero for as many frames as the partitions of the HRIR, plus the input kept by
+		 *	the convolvers (up to three frames when the buffer size is not a power of two), plus those needed to flush the ITD lines, as then
+		 *	the convolution memory and the recent samples of the lines are all zeros. The convolvers are not
+		 *	run and the lines are not written while skipping, and both are still silent when the input comes back, so the only difference
+		 *	with processing every frame is that the ITD of the first frame after the silence starts directly at its value.
+		 * @return true if the output of this frame is silent and nothing has to be processed
+		 */
+		bool IsSilentInput(const CMonoBuffer<float> & _inBuffer, std::shared_ptr<BRTServices::CServicesBase> & _listenerHRTF) {
+			const bool silentFrame = std::all_of(_inBuffer.begin(), _inBuffer.end(), [](float sample) { return sample == 0.0f; });
+			if (!silentFrame) {
+				if (silentInputFrames > 0 && IsSkippingSilentInput(_listenerHRTF)) {
+					// The lines only hold zeros, so the ITD can jump to its current value instead of ramping from the one before the silence
+					leftChannelDelayLine.SkipNextDelayRamp();
+					rightChannelDelayLine.SkipNextDelayRamp();
+				}
+				silentInputFrames = 0;
+				return false;
+			}
+			silentInputFrames++;
+			return IsSkippingSilentInput(_listenerHRTF);
+		}
+
+		/**
+		 * @brief Check if the input has been silent long enough to skip the convolution, and there is no table crossfade in progress
+		 */
+		bool IsSkippingSilentInput(std::shared_ptr<BRTServices::CServicesBase> & _listenerHRTF) const {
+			if (crossfadePosition < crossfadeLength) return false;
+			const std::size_t bufferSize = globalParameters.GetBufferSize();
+			if (bufferSize == 0) return false;
+			const float itd = std::max(leftChannelDelayLine.GetDelay(), rightChannelDelayLine.GetDelay());
+			const std::size_t itdFrames = static_cast<std::size_t>(std::ceil(itd / bufferSize));
+			return silentInputFrames > static_cast<std::size_t>(_listenerHRTF->GetNumberOfSubfiltersFR()) + 3 + itdFrames;
+		}
+
+		/**
+		 * @brief Convolve the input with the HRIRs of one table and add the ITD
+		 * @return false if the table has no IR in that position
+		 */
+		bool ProcessTableConvolution(std::shared_ptr<BRTServices::CServicesBase> & _listenerSphericalIRTable, CMonoBuffer<float> & _inBuffer, CMonoBuffer<float> & outLeftBuffer, CMonoBuffer<float> & outRightBuffer,
+			Common::CTransform & sourceTransform, Common::CTransform & listenerTransform, float distanceToListener,
+			BRTProcessing::CUniformPartitionedConvolution & _leftUPConvolution, BRTProcessing::CUniformPartitionedConvolution & _rightUPConvolution,
+			Common::CFractionalDelayLine & _leftChannelDelayLine, Common::CFractionalDelayLine & _rightChannelDelayLine, CHRIRCache & _hrirCache) {
+
+			// Calculate Source coordinates taking into account Source and Listener transforms
+			float leftAzimuth;
+			float leftElevation;
+			float rightAzimuth;
+			float rightElevation;
+			float centerAzimuth;
+			float centerElevation;
+			float interauralAzimuth;
+
+			Common::CSourceListenerRelativePositionCalculation::CalculateSourceListenerRelativePositions(sourceTransform, listenerTransform, _listenerSphericalIRTable, enableParallaxCorrection,leftElevation, leftAzimuth, rightElevation, rightAzimuth, centerElevation, centerAzimuth, interauralAzimuth);
+
+			// GET HRTF, from the cache if the source has not moved beyond its tolerance
+			THRIRCacheKey hrirKey;
+			hrirKey.table = _listenerSphericalIRTable.get();
+			hrirKey.tableRevision = _listenerSphericalIRTable->GetSetupRevision();
+			hrirKey.interpolation = enableInterpolation;
+			hrirKey.leftAzimuth = leftAzimuth;
+			hrirKey.leftElevation = leftElevation;
+			hrirKey.rightAzimuth = rightAzimuth;
+			hrirKey.rightElevation = rightElevation;
+			hrirKey.distance = distanceToListener;
+			hrirKey.listenerPosition = listenerTransform.GetPosition();
+
+			if (!_hrirCache.Find(hrirKey)) {
+				std::vector<CMonoBuffer<float>> leftHRIR_partitioned = _listenerSphericalIRTable->GetFR_SpatiallyOriented(leftAzimuth, leftElevation, distanceToListener, listenerTransform, Common::T_ear::LEFT, enableInterpolation);
+				std::vector<CMonoBuffer<float>> rightHRIR_partitioned = _listenerSphericalIRTable->GetFR_SpatiallyOriented(rightAzimuth, rightElevation, distanceToListener, listenerTransform, Common::T_ear::RIGHT, enableInterpolation);
+
+				if (leftHRIR_partitioned.empty() || rightHRIR_partitioned.empty()) {
+					SET_RESULT(RESULT_ERROR_NULLPOINTER, "HRTF Convolver: No IR has been found in that position.");
+					_hrirCache.Invalidate();
+					return false;
+				}
+				_hrirCache.Store(hrirKey, std::move(leftHRIR_partitioned), std::move(rightHRIR_partitioned));
+			}
+			const std::vector<CMonoBuffer<float>> & leftHRIR_partitioned = _hrirCache.GetLeftHRIR();
+			const std::vector<CMonoBuffer<float>> & rightHRIR_partitioned = _hrirCache.GetRightHRIR();
+
+			// DO CONVOLUTION			
+			CMonoBuffer<float> leftChannel_withoutDelay;
+			CMonoBuffer<float> rightChannel_withoutDelay;
+			//UPC algorithm with memory
+			_leftUPConvolution.ProcessUPConvolutionWithMemory(_inBuffer, leftHRIR_partitioned, leftChannel_withoutDelay);
+			_rightUPConvolution.ProcessUPConvolutionWithMemory(_inBuffer, rightHRIR_partitioned, rightChannel_withoutDelay);
+
+			// GET DELAY
+			Common::CEarPair<uint64_t> delays({0,0});	///< Delay, in number of samples
+			if (enableITDSimulation){
+				delays = _listenerSphericalIRTable->GetFR_Delay(centerAzimuth, centerElevation, distanceToListener, listenerTransform, enableInterpolation);				
+			}
+			// ADD Delay
+			_leftChannelDelayLine.Process(leftChannel_withoutDelay, outLeftBuffer, static_cast<float>(delays.left));
+			_rightChannelDelayLine.Process(rightChannel_withoutDelay, outRightBuffer, static_cast<float>(delays.right));
+			return true;
+		}
+
+		/**
+		 * @brief Keep the convolution state of the current table to fade it out, and take the convolvers prepared for the new table.
+			The convolution buffers are swapped, not copied. If no convolvers have been prepared for the new table, they are initialized in this frame.
+		 */
+		void BeginTableCrossfade(const std::shared_ptr<BRTServices::CServicesBase> & _newTable) {
+			std::swap(outputLeftUPConvolution, fadingLeftUPConvolution);
+			std::swap(outputRightUPConvolution, fadingRightUPConvolution);
+			std::swap(leftChannelDelayLine, fadingLeftChannelDelayLine);
+			std::swap(rightChannelDelayLine, fadingRightChannelDelayLine);
+			// The HRIRs of the current table go to the fading cache, and those of the table that faded out before are left in the
+			// pending cache, to be released by the next preparation. Nothing is released in the audio thread.
+			hrirCache.SwapHRIRs(fadingHRIRCache);
+			hrirCache.SwapHRIRs(pendingHRIRCache);
+			hrirCache.Invalidate();
+			fadingTable = activeTable;
+			crossfadeLength = tableCrossfadeFrames * globalParameters.GetBufferSize();
+			crossfadePosition = 0;
+
+			if (IsSameTable(pendingTable, _newTable) && pendingTableRevision == _newTable->GetSetupRevision()) {
+				// The convolvers of the table that has just finished fading out are left as pending, to be released by the next preparation
+				std::swap(outputLeftUPConvolution, pendingLeftUPConvolution);
+				std::swap(outputRightUPConvolution, pendingRightUPConvolution);
+				std::swap(leftChannelDelayLine, pendingLeftChannelDelayLine);
+				std::swap(rightChannelDelayLine, pendingRightChannelDelayLine);
+				pendingTable.reset();
+				activeTable = _newTable;
+			} else {
+				convolutionBuffersInitialized = false;
+			}
+		}
+
+		/**
+		 * @brief Convolve the input with the previous table and mix it with the output of the new table, with a linear crossfade
+		 */
+		void ProcessTableCrossfade(CMonoBuffer<float> & _inBuffer, CMonoBuffer<float> & outLeftBuffer, CMonoBuffer<float> & outRightBuffer,
+			Common::CTransform & sourceTransform, Common::CTransform & listenerTransform, float distanceToListener) {
+
+			// If the previous table is not available any more, the new one is used directly. The listener model keeps it alive while it is
+			// fading, so this is never its last owner
+			std::shared_ptr<BRTServices::CServicesBase> previousTable = fadingTable.lock();
+			if (!previousTable || !ProcessTableConvolution(previousTable, _inBuffer, fadingLeftBuffer, fadingRightBuffer, sourceTransform, listenerTransform, distanceToListener,
+					fadingLeftUPConvolution, fadingRightUPConvolution, fadingLeftChannelDelayLine, fadingRightChannelDelayLine, fadingHRIRCache)) {
+				EndTableCrossfade();
+				return;
+			}
+
+			const float gainStep = 1.0f / static_cast<float>(crossfadeLength);
+			for (size_t i = 0; i < outLeftBuffer.size(); i++) {
+				const float newTableGain = std::min(1.0f, (crossfadePosition + i) * gainStep);
+				const float previousTableGain = 1.0f - newTableGain;
+				outLeftBuffer[i] = newTableGain * outLeftBuffer[i] + previousTableGain * fadingLeftBuffer[i];
+				outRightBuffer[i] = newTableGain * outRightBuffer[i] + previousTableGain * fadingRightBuffer[i];
+			}
+			crossfadePosition += static_cast<int>(outLeftBuffer.size());
+			if (crossfadePosition >= crossfadeLength) { EndTableCrossfade(); }
+		}
+
+		/**
+		 * @brief Stop using the previous table. The convolution buffers are kept, so they are not reallocated in the next crossfade.
+		 */
+		void EndTableCrossfade() {
+			fadingTable.reset();
+			fadingHRIRCache.Invalidate();
+			crossfadeLength = 0;
+			crossfadePosition = 0;
+		}
 	};
 }
 #endif
\ No newline at end of file
@@ -85,9 +85,10 @@ class CHRTFConvolverProcessor : public BRTConnectivity::CBRTConnectivity, public
 				std::weak_ptr<BRTServices::CServicesBase> listenerHRTF = GetServicePtrEntryPoint("listenerHRTF")->GetData();
 				std::weak_ptr<BRTServices::CServicesBase> listenerHRBRIR = GetServicePtrEntryPoint("listenerHRBRIR")->GetData();
 
-				if (listenerHRTF.lock() != nullptr) { 
+				// The tables are not locked here, so that this thread never becomes the last owner of a replaced one
+				if (!listenerHRTF.expired()) { 
 					Process(buffer, outLeftBuffer, outRightBuffer, sourcePosition, listenerPosition, listenerHRTF);
-				} else if (listenerHRBRIR.lock() != nullptr) {				
+				} else if (!listenerHRBRIR.expired()) {				
 					Process(buffer, outLeftBuffer, outRightBuffer, sourcePosition, listenerPosition, listenerHRBRIR);
 				} else {
 					SET_RESULT(RESULT_ERROR_NOTSET, "nonInterpolatedHRTF Convolver error: No nonInterpolatedHRTF or HRBRIR data available");
@@ -113,6 +114,17 @@ class CHRTFConvolverProcessor : public BRTConnectivity::CBRTConnectivity, public
 				}
 			}
 		} 
+
+		/**
+		 * @brief Check if a table is used by the convolver. It waits for the frame in progress, so a table that is not used can be released
+			without the audio thread still holding it.
+		 * @param _table table to check
+		 * @return true if the table must be kept alive
+		 */
+		bool IsUsingTable(const std::shared_ptr<BRTServices::CServicesBase> & _table) {
+			std::lock_guard<std::mutex> l(mutex);
+			return CHRTFConvolver::IsUsingTable(_table);
+		}
       
     private:
        
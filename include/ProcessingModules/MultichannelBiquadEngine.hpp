@@ -0,0 +1,477 @@
+/**
+* \class CMultichannelBiquadEngine
+*
+* \brief Declaration of CMultichannelBiquadEngine class
+* \date	Oct 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _MULTICHANNEL_BIQUAD_ENGINE_HPP_
+#define _MULTICHANNEL_BIQUAD_ENGINE_HPP_
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <Common/Buffer.hpp>
+#include <Common/ErrorHandler.hpp>
+#include <ProcessingModules/BiquadFilter.hpp>
+
+namespace BRTProcessing {
+
+	/**
+	 * @brief Cascades of biquad filters for many independent channels, processed several channels at a time.
+	 * @details Channels are grouped in blocks of Lanes channels. The coefficients and delay cells of every section are stored
+	 * per block as arrays with one entry per channel, and the samples of the block are interleaved, so that the inner loop runs
+	 * across channels and the compiler can map it onto vector registers of 4, 8 or 16 lanes. A block with fewer channels is filtered
+	 * with fewer lanes, so that the two channels of a binaural chain do not pay for the unused ones.
+	 * Each section behaves exactly as a CBiquadFilter inside a CBiquadFilterChain (Direct Form II in double precision, float
+	 * output of each section and crossfading between the old and the new coefficients over one frame, or lattice interpolation
+	 * when the transition mode is COEFFICIENTS_INTERPOLATION).
+	 * @tparam Lanes number of channels processed together
+	 */
+	template <std::size_t Lanes>
+	class CMultichannelBiquadEngine {
+		static_assert(Lanes == 4 || Lanes == 8 || Lanes == 16, "The biquad engine processes 4, 8 or 16 channels at a time");
+	public:
+		CMultichannelBiquadEngine()
+			: numberOfChannels { 0 }
+			, numberOfSections { 0 }
+			, numberOfBlocks { 0 }
+			, transition { CROSSFADING }
+		{
+		}
+
+		/**
+		 * @brief Allocate the sections of all the channels, with identity coefficients
+		 * @param _numberOfChannels number of channels
+		 * @param _numberOfSections number of biquad sections per channel
+		 * @return true if the setup was successful, false otherwise
+		 */
+		bool Setup(int _numberOfChannels, int _numberOfSections) {
+			if (_numberOfChannels < 1 || _numberOfSections < 1) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of channels and sections has to be greater than 0 in BRTProcessing::CMultichannelBiquadEngine");
+				return false;
+			}
+			numberOfChannels = _numberOfChannels;
+			numberOfSections = _numberOfSections;
+			numberOfBlocks = (numberOfChannels + Lanes - 1) / Lanes;
+			sections = std::vector<TSectionBlock>(numberOfBlocks * numberOfSections);
+			return true;
+		}
+
+		/**
+		 * @brief Set the coefficients of all the sections of one channel
+		 * @param _channel channel number
+		 * @param _coefficients coefficients of every section, one after the other. Order: b0, b1, b2, a0, a1, a2 or b0, b1, b2, a1, a2
+		 * @param _numberOfCoefficientsPerSection number of coefficients of each section, 6 or 5
+		 * @param _crossfadingEnabled true when cross fading must be applied in the next frame
+		 * @return true if the coefficients were set, false otherwise
+		 */
+		bool SetCoefficients(int _channel, const float * _coefficients, std::size_t _numberOfCoefficientsPerSection, bool _crossfadingEnabled = true) {
+			if (_channel < 0 || _channel >= numberOfChannels) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The channel number is out of range in BRTProcessing::CMultichannelBiquadEngine");
+				return false;
+			}
+			if (_numberOfCoefficientsPerSection != 6 && _numberOfCoefficientsPerSection != 5) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "A vector with 5 or 6 coefficients was expected in BiquadFilter definition.");
+				return false;
+			}
+			const std::size_t lane = _channel % Lanes;
+			for (int s = 0; s < numberOfSections; s++) {
+				const float * c = _coefficients + s * _numberOfCoefficientsPerSection;
+				float b0 = c[0], b1 = c[1], b2 = c[2], a1, a2;
+				if (_numberOfCoefficientsPerSection == 6) {
+					float a0 = c[3];
+					b0 /= a0; b1 /= a0; b2 /= a0;
+					a1 = c[4] / a0;
+					a2 = c[5] / a0;
+				} else {
+					a1 = c[3];
+					a2 = c[4];
+				}
+				TSectionBlock & section = GetSection(_channel / Lanes, s);
+				section.crossfading[lane] = _crossfadingEnabled;
+				section.newCoefficients.Set(lane, b0, b1, b2, a1, a2);
+				if (_crossfadingEnabled) {
+					section.new_z1[lane] = 0;
+					section.new_z2[lane] = 0;
+				} else {
+					section.coefficients.Set(lane, b0, b1, b2, a1, a2);
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Filter one channel in place
+		 * @param _channel channel number
+		 * @param buffer input and output buffer
+		 */
+		void Process(int _channel, CMonoBuffer<float> & buffer) {
+			if (_channel < 0 || _channel >= numberOfChannels) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The channel number is out of range in BRTProcessing::CMultichannelBiquadEngine::Process");
+				return;
+			}
+			if (buffer.size() == 0) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "Attempt to process a biquad filter with an empty input buffer");
+				return;
+			}
+			const std::size_t block = _channel / Lanes;
+			for (int s = 0; s < numberOfSections; s++) {
+				ProcessSection<1>(GetSection(block, s), _channel % Lanes, buffer.data(), buffer.size());
+			}
+		}
+
+		/**
+		 * @brief Filter all the channels, Lanes channels at a time
+		 * @param _inBuffers one input buffer per channel, all of the same size
+		 * @param outBuffers one output buffer per channel, resized if needed. It can be the same vector as the input
+		 */
+		void Process(const std::vector<CMonoBuffer<float>> & _inBuffers, std::vector<CMonoBuffer<float>> & outBuffers) {
+			if (_inBuffers.size() != static_cast<std::size_t>(numberOfChannels)) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of buffers has to be equal to the number of channels in BRTProcessing::CMultichannelBiquadEngine::Process");
+				return;
+			}
+			const std::size_t size = _inBuffers[0].size();
+			for (const CMonoBuffer<float> & inBuffer : _inBuffers) {
+				if (size == 0 || inBuffer.size() != size) {
+					SET_RESULT(RESULT_ERROR_BADSIZE, "Input buffers have to be non empty and of the same size in BRTProcessing::CMultichannelBiquadEngine::Process");
+					return;
+				}
+			}
+			outBuffers.resize(numberOfChannels);
+			for (int channel = 0; channel < numberOfChannels; channel++) {
+				if (outBuffers[channel].size() != size) outBuffers[channel].resize(size);
+			}
+			ProcessInterleaved([&](int channel) { return _inBuffers[channel].data(); }, [&](int channel) { return outBuffers[channel].data(); }, size);
+		}
+
+		/**
+		 * @brief Filter two channels at once, typically the left and the right ear, in the same pass
+		 * @param _inBuffer0 input buffer of channel 0
+		 * @param outBuffer0 output buffer of channel 0, resized if needed. It can be the input buffer
+		 * @param _inBuffer1 input buffer of channel 1, with the same size as the one of channel 0
+		 * @param outBuffer1 output buffer of channel 1, resized if needed. It can be the input buffer
+		 */
+		void Process(const CMonoBuffer<float> & _inBuffer0, CMonoBuffer<float> & outBuffer0, const CMonoBuffer<float> & _inBuffer1, CMonoBuffer<float> & outBuffer1) {
+			if (numberOfChannels != 2) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of channels has to be 2 in BRTProcessing::CMultichannelBiquadEngine::Process");
+				return;
+			}
+			const std::size_t size = _inBuffer0.size();
+			if (size == 0 || _inBuffer1.size() != size) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "Input buffers have to be non empty and of the same size in BRTProcessing::CMultichannelBiquadEngine::Process");
+				return;
+			}
+			if (outBuffer0.size() != size) outBuffer0.resize(size);
+			if (outBuffer1.size() != size) outBuffer1.resize(size);
+			const float * in[2] = { _inBuffer0.data(), _inBuffer1.data() };
+			float * out[2] = { outBuffer0.data(), outBuffer1.data() };
+			ProcessInterleaved([&](int channel) { return in[channel]; }, [&](int channel) { return out[channel]; }, size);
+		}
+
+		/**
+		 * @brief Reset the delay cells of all the sections
+		 */
+		void ResetBuffers() {
+			for (TSectionBlock & section : sections) {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					section.z1[l] = 0;
+					section.z2[l] = 0;
+					section.new_z1[l] = 0;
+					section.new_z2[l] = 0;
+					section.firstBuffer[l] = true;
+				}
+			}
+		}
+
+		/**
+		 * @brief Set how the sections move to new coefficients, as in CBiquadFilter::SetTransitionMode
+		 * @param _transition transition mode
+		 */
+		void SetTransitionMode(TBiquadTransition _transition) { transition = _transition; }
+
+		/**
+		 * @brief Get how the sections move to new coefficients
+		 * @return transition mode
+		 */
+		TBiquadTransition GetTransitionMode() const { return transition; }
+
+		int GetNumberOfChannels() const { return numberOfChannels; }
+		int GetNumberOfSections() const { return numberOfSections; }
+
+	private:
+		// Coefficients of one section for every channel of a block, normalized by a0
+		struct TCoefficientLanes {
+			alignas(64) double b0[Lanes];
+			alignas(64) double b1[Lanes];
+			alignas(64) double b2[Lanes];
+			alignas(64) double a1[Lanes];
+			alignas(64) double a2[Lanes];
+
+			TCoefficientLanes() {
+				for (std::size_t l = 0; l < Lanes; l++) Set(l, 1, 0, 0, 0, 0);
+			}
+			void Set(std::size_t l, double _b0, double _b1, double _b2, double _a1, double _a2) {
+				b0[l] = _b0; b1[l] = _b1; b2[l] = _b2; a1[l] = _a1; a2[l] = _a2;
+			}
+			void CopyLane(const TCoefficientLanes & other, std::size_t l) {
+				Set(l, other.b0[l], other.b1[l], other.b2[l], other.a1[l], other.a2[l]);
+			}
+		};
+
+		// One section for every channel of a block
+		struct TSectionBlock {
+			TCoefficientLanes coefficients;			// Current coefficients
+			TCoefficientLanes newCoefficients;		// Coefficients to crossfade to in the next frame
+			alignas(64) double z1[Lanes] = {};		// Delay cells of the current filter
+			alignas(64) double z2[Lanes] = {};
+			alignas(64) double new_z1[Lanes] = {};	// Delay cells of the new filter
+			alignas(64) double new_z2[Lanes] = {};
+			bool crossfading[Lanes];				// True when cross fading must be applied in the next frame
+			bool firstBuffer[Lanes];				// True until the first crossfaded frame has been processed
+
+			TSectionBlock() {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					crossfading[l] = false;
+					firstBuffer[l] = true;
+				}
+			}
+		};
+
+		TSectionBlock & GetSection(std::size_t block, int section) {
+			return sections[block * numberOfSections + section];
+		}
+
+		/**
+		 * @brief Filter all the channels, one block of Lanes channels at a time. All the input samples of a block are read before its
+		 * output is written, so the output of a channel can be its input.
+		 * @details A block with fewer channels than Lanes, such as the two ears of a binaural chain, is filtered with as many lanes as
+		 * it has channels, rounded up to a power of two, so that no time is spent filtering silence in the unused lanes.
+		 * @param getInput returns the input samples of a channel
+		 * @param getOutput returns where the output samples of a channel are written
+		 * @param size number of samples of every channel
+		 */
+		template <typename TGetInput, typename TGetOutput>
+		void ProcessInterleaved(TGetInput getInput, TGetOutput getOutput, std::size_t size) {
+			if (interleavedBuffer.size() < size * Lanes) interleavedBuffer.resize(size * Lanes);
+
+			for (std::size_t block = 0; block < numberOfBlocks; block++) {
+				const std::size_t firstChannel = block * Lanes;
+				const std::size_t channelsInBlock = std::min<std::size_t>(Lanes, numberOfChannels - firstChannel);
+				if (channelsInBlock == 1) {
+					// A single channel is filtered in its output buffer, without interleaving it
+					const float * in = getInput(static_cast<int>(firstChannel));
+					float * out = getOutput(static_cast<int>(firstChannel));
+					if (out != in) std::copy(in, in + size, out);
+					for (int s = 0; s < numberOfSections; s++) {
+						ProcessSection<1>(GetSection(block, s), 0, out, size);
+					}
+				} else if (channelsInBlock == 2) {
+					ProcessBlock<2>(block, channelsInBlock, getInput, getOutput, size);
+				} else if (channelsInBlock <= 4) {
+					ProcessBlock<std::min<std::size_t>(4, Lanes)>(block, channelsInBlock, getInput, getOutput, size);
+				} else if (channelsInBlock <= 8) {
+					ProcessBlock<std::min<std::size_t>(8, Lanes)>(block, channelsInBlock, getInput, getOutput, size);
+				} else {
+					ProcessBlock<Lanes>(block, channelsInBlock, getInput, getOutput, size);
+				}
+			}
+		}
+
+		/**
+		 * @brief Filter the first N lanes of a block, interleaved. Lanes without a channel are filled with silence.
+		 */
+		template <std::size_t N, typename TGetInput, typename TGetOutput>
+		void ProcessBlock(std::size_t block, std::size_t channelsInBlock, TGetInput & getInput, TGetOutput & getOutput, std::size_t size) {
+			const std::size_t firstChannel = block * Lanes;
+			float * x = interleavedBuffer.data();
+			for (std::size_t l = 0; l < N; l++) {
+				const float * in = l < channelsInBlock ? getInput(static_cast<int>(firstChannel + l)) : nullptr;
+				for (std::size_t i = 0; i < size; i++) {
+					x[i * N + l] = in ? in[i] : 0.0f;
+				}
+			}
+			for (int s = 0; s < numberOfSections; s++) {
+				ProcessSection<N>(GetSection(block, s), 0, x, size);
+			}
+			for (std::size_t l = 0; l < channelsInBlock; l++) {
+				float * out = getOutput(static_cast<int>(firstChannel + l));
+				for (std::size_t i = 0; i < size; i++) {
+					out[i] = x[i * N + l];
+				}
+			}
+		}
+
+		/**
+		 * @brief Filter N interleaved lanes of a section block, starting at lane firstLane
+		 * @details When no lane is crossfading only the current filter runs. Otherwise both filters run in every lane and each
+		 * lane weights the new one with 0 (not crossfading), 1 (first frame) or a linear ramp, as CBiquadFilter does.
+		 * In COEFFICIENTS_INTERPOLATION mode the block is filtered once in lattice form instead, unless a lane has no lattice.
+		 */
+		template <std::size_t N>
+		void ProcessSection(TSectionBlock & section, std::size_t firstLane, float * x, std::size_t size) {
+			const TCoefficientLanes & c = section.coefficients;
+			const TCoefficientLanes & nc = section.newCoefficients;
+
+			bool anyCrossfading = false;
+			double rampOffset[N], rampSlope[N];
+			for (std::size_t n = 0; n < N; n++) {
+				const std::size_t l = firstLane + n;
+				anyCrossfading |= section.crossfading[l];
+				rampOffset[n] = section.crossfading[l] && section.firstBuffer[l] ? 1.0 : 0.0;
+				rampSlope[n] = section.crossfading[l] && !section.firstBuffer[l] ? 1.0 : 0.0;
+			}
+
+			double z1[N], z2[N], new_z1[N], new_z2[N];
+			for (std::size_t n = 0; n < N; n++) {
+				z1[n] = section.z1[firstLane + n];
+				z2[n] = section.z2[firstLane + n];
+				new_z1[n] = section.new_z1[firstLane + n];
+				new_z2[n] = section.new_z2[firstLane + n];
+			}
+			const double * b0 = c.b0 + firstLane, * b1 = c.b1 + firstLane, * b2 = c.b2 + firstLane, * a1 = c.a1 + firstLane, * a2 = c.a2 + firstLane;
+
+			if (anyCrossfading && transition == COEFFICIENTS_INTERPOLATION && ProcessSectionInLattice<N>(section, firstLane, x, size, z1, z2)) {
+				// The cells of the new filter are the ones left by the lattice
+				for (std::size_t n = 0; n < N; n++) {
+					new_z1[n] = z1[n];
+					new_z2[n] = z2[n];
+				}
+			} else if (!anyCrossfading) {
+				ProcessWithCurrentCoefficients<N>(std::make_index_sequence<N>(), x, size, b0, b1, b2, a1, a2, z1, z2);
+			} else {
+				const double * nb0 = nc.b0 + firstLane, * nb1 = nc.b1 + firstLane, * nb2 = nc.b2 + firstLane, * na1 = nc.a1 + firstLane, * na2 = nc.a2 + firstLane;
+				// With a single sample frame the ramp cannot be spread, and the new filter is only used from the next frame
+				const double rampLength = size > 1 ? static_cast<double>(size - 1) : 1.0;
+				for (std::size_t i = 0; i < size; i++) {
+					const double alpha = static_cast<double>(i) / rampLength;
+					float * xi = x + i * N;
+					for (std::size_t n = 0; n < N; n++) {
+						const double m = xi[n] - a1[n] * z1[n] - a2[n] * z2[n];
+						const double s0 = static_cast<float>(b0[n] * m + b1[n] * z1[n] + b2[n] * z2[n]);
+						z2[n] = z1[n];
+						z1[n] = m;
+						const double new_m = xi[n] - na1[n] * new_z1[n] - na2[n] * new_z2[n];
+						const double s1 = static_cast<float>(nb0[n] * new_m + nb1[n] * new_z1[n] + nb2[n] * new_z2[n]);
+						new_z2[n] = new_z1[n];
+						new_z1[n] = new_m;
+						const double w = rampOffset[n] + rampSlope[n] * alpha;
+						xi[n] = static_cast<float>(s0 * (1.0 - w) + s1 * w);
+					}
+				}
+			}
+
+			// Lanes that have crossfaded keep the new filter. Delay cells that end up as NaN are reset, to prevent unstable states
+			for (std::size_t n = 0; n < N; n++) {
+				const std::size_t l = firstLane + n;
+				if (section.crossfading[l]) {
+					section.coefficients.CopyLane(nc, l);
+					z1[n] = new_z1[n];
+					z2[n] = new_z2[n];
+					section.crossfading[l] = false;
+					section.firstBuffer[l] = false;
+				}
+				section.z1[l] = z1[n] != z1[n] ? 0 : z1[n];
+				section.z2[l] = z2[n] != z2[n] ? 0 : z2[n];
+				section.new_z1[l] = section.z1[l];
+				section.new_z2[l] = section.z2[l];
+			}
+		}
+
+		/**
+		 * @brief Filter N interleaved lanes with their current coefficients
+		 * @details The lanes are expanded at compile time instead of looping over them, so that the delay cells of every lane are kept
+		 * in registers and the lanes run in parallel even when the compiler does not unroll or vectorize the loop, as with -O2.
+		 */
+		template <std::size_t N, std::size_t... n>
+		static void ProcessWithCurrentCoefficients(std::index_sequence<n...>, float * x, std::size_t size, const double * b0, const double * b1, const double * b2, const double * a1, const double * a2, double * z1, double * z2) {
+			const double laneB0[N] = { b0[n]... }, laneB1[N] = { b1[n]... }, laneB2[N] = { b2[n]... }, laneA1[N] = { a1[n]... }, laneA2[N] = { a2[n]... };
+			double laneZ1[N] = { z1[n]... }, laneZ2[N] = { z2[n]... };
+			for (std::size_t i = 0; i < size; i++) {
+				float * xi = x + i * N;
+				(ProcessSample(xi[n], laneB0[n], laneB1[n], laneB2[n], laneA1[n], laneA2[n], laneZ1[n], laneZ2[n]), ...);
+			}
+			((z1[n] = laneZ1[n]), ...);
+			((z2[n] = laneZ2[n]), ...);
+		}
+
+		/**
+		 * @brief Filter one sample in Direct Form II, as CBiquadFilter does
+		 */
+		static void ProcessSample(float & x, double b0, double b1, double b2, double a1, double a2, double & z1, double & z2) {
+			const double m = x - a1 * z1 - a2 * z2;
+			x = static_cast<float>(b0 * m + b1 * z1 + b2 * z2);
+			z2 = z1;
+			z1 = m;
+		}
+
+		/**
+		 * @brief Filter N interleaved lanes of a section block once, in normalized lattice form
+		 * @details Crossfading lanes interpolate the lattice parameters from the current to the new filter, or use the new filter
+		 * from the first sample in their first frame, as CBiquadFilter does. The other lanes keep their filter.
+		 * @param z1 Direct Form II delay cells of each lane, converted back with the filter that each lane ends with
+		 * @param z2 Direct Form II delay cells of each lane, converted back with the filter that each lane ends with
+		 * @return false, without filtering, if the filter of any lane has no lattice because it is unstable
+		 */
+		template <std::size_t N>
+		bool ProcessSectionInLattice(const TSectionBlock & section, std::size_t firstLane, float * x, std::size_t size, double * z1, double * z2) {
+			const TCoefficientLanes & c = section.coefficients;
+			const TCoefficientLanes & nc = section.newCoefficients;
+			TBiquadLattice to[N];
+			double k1[N], k2[N], w0[N], w1[N], w2[N], d_k1[N], d_k2[N], d_w0[N], d_w1[N], d_w2[N], s1[N], s2[N];
+			for (std::size_t n = 0; n < N; n++) {
+				const std::size_t l = firstLane + n;
+				const TCoefficientLanes & end = section.crossfading[l] ? nc : c;
+				TBiquadLattice from;
+				if (!to[n].SetFromDirectForm(end.b0[l], end.b1[l], end.b2[l], end.a1[l], end.a2[l])) return false;
+				if (section.crossfading[l] && !section.firstBuffer[l]) {
+					if (!from.SetFromDirectForm(c.b0[l], c.b1[l], c.b2[l], c.a1[l], c.a2[l])) return false;
+				} else {
+					from = to[n];
+				}
+				from.DirectFormToLatticeState(z1[n], z2[n], s1[n], s2[n]);
+				k1[n] = from.k1; k2[n] = from.k2; w0[n] = from.w0; w1[n] = from.w1; w2[n] = from.w2;
+				d_k1[n] = to[n].k1 - from.k1; d_k2[n] = to[n].k2 - from.k2;
+				d_w0[n] = to[n].w0 - from.w0; d_w1[n] = to[n].w1 - from.w1; d_w2[n] = to[n].w2 - from.w2;
+			}
+
+			const double step = size > 1 ? 1.0 / static_cast<double>(size - 1) : 1.0;
+			for (std::size_t i = 0; i < size; i++) {
+				const double alpha = static_cast<double>(i) * step;
+				float * xi = x + i * N;
+				for (std::size_t n = 0; n < N; n++) {
+					xi[n] = static_cast<float>(TBiquadLattice::ProcessSample(xi[n], k1[n] + alpha * d_k1[n], k2[n] + alpha * d_k2[n],
+						w0[n] + alpha * d_w0[n], w1[n] + alpha * d_w1[n], w2[n] + alpha * d_w2[n], s1[n], s2[n]));
+				}
+			}
+			for (std::size_t n = 0; n < N; n++) {
+				to[n].LatticeToDirectFormState(s1[n], s2[n], z1[n], z2[n]);
+			}
+			return true;
+		}
+
+		std::vector<TSectionBlock> sections;		// Section blocks, [block][section]
+		std::vector<float> interleavedBuffer;		// Samples of the block being processed, [sample][lane]
+		int numberOfChannels;
+		int numberOfSections;
+		std::size_t numberOfBlocks;
+		TBiquadTransition transition;				// How the sections move to new coefficients
+	};
+}
+#endif
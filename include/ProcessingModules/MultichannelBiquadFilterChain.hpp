@@ -29,10 +29,15 @@
 #include <Common/Buffer.hpp>
 #include <Common/GlobalParameters.hpp>
 #include <ProcessingModules/BiquadFilterChain.hpp>
+#include <ProcessingModules/MultichannelBiquadEngine.hpp>
 
 
 #define NUMBER_OF_COEFFICIENTS_IN_BIQUAD_SECTION 6
 
+#ifndef MULTICHANNEL_BIQUAD_LANES
+#define MULTICHANNEL_BIQUAD_LANES 8		// Channels filtered together by the biquad engine: 4, 8 or 16 depending on the vector width of the target
+#endif
+
 namespace BRTProcessing {
 
 	class CMultichannelBiquadFilterChain {
@@ -43,7 +48,6 @@ namespace BRTProcessing {
 			, numberOfChannels { 0 }
 			, numberOfBiquadSectionsPerChannel { 0 }
 			, numberOfCoefficientsPerChannel { 0 }
-			, biquadChainTable {}
 		{
 					
 		}
@@ -70,10 +74,7 @@ namespace BRTProcessing {
 			numberOfChannels = _numberOfChannels;
 			numberOfBiquadSectionsPerChannel = _numberOfBiquadSectionsPerChannel;
 						
-			biquadChainTable = std::vector<BRTProcessing::CBiquadFilterChain>(numberOfChannels);
-			for (int i = 0; i < numberOfChannels; i++) {
-				biquadChainTable[i].AddNFilters(numberOfBiquadSectionsPerChannel);
-			}
+			biquadEngine.Setup(numberOfChannels, numberOfBiquadSectionsPerChannel);
 
 			numberOfCoefficientsPerChannel = numberOfBiquadSectionsPerChannel * NUMBER_OF_COEFFICIENTS_IN_BIQUAD_SECTION;
 			initialized = true;
@@ -86,6 +87,16 @@ namespace BRTProcessing {
 		 * @param _coefficients vector of coefficients for the channel
 		 */
 		bool SetCoefficients(const int & _channel, const std::vector<float>& _coefficients)  {
+			return SetCoefficients(_channel, _coefficients.data(), _coefficients.size());
+		}
+
+		/**
+		 * @brief Store the coefficients of the filter for a given channel, without allocating memory
+		 * @param _channel channel number
+		 * @param _coefficients array of coefficients for the channel
+		 * @param _numberOfCoefficients number of coefficients in the array
+		 */
+		bool SetCoefficients(const int & _channel, const float * _coefficients, std::size_t _numberOfCoefficients) {
 			if (!initialized) return false;			
 
 			if (_channel < 0 || _channel >= numberOfChannels) {
@@ -93,12 +104,11 @@ namespace BRTProcessing {
 				return false;
 			}
 
-			if (_coefficients.size() != numberOfCoefficientsPerChannel) {
+			if (_coefficients == nullptr || _numberOfCoefficients != static_cast<std::size_t>(numberOfCoefficientsPerChannel)) {
 				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of coefficients is not correct in BRTProcessing::CMultichanneBiquadFilterChain");
 				return false;
 			}
-			SetCoefficients(biquadChainTable[_channel], _coefficients); //Set  coefficients		
-			return true;
+			return biquadEngine.SetCoefficients(_channel, _coefficients, NUMBER_OF_COEFFICIENTS_IN_BIQUAD_SECTION); //Set  coefficients
 		}
 		
 		/**
@@ -136,44 +146,91 @@ namespace BRTProcessing {
 
 			ASSERT(_inBuffer.size() == globalParameters.GetBufferSize(), RESULT_ERROR_BADSIZE, "InBuffer size has to be equal to the input size indicated by the BRT::GlobalParameters method", "");
 										
-			biquadChainTable[_channel].Process(outBuffer);			
+			biquadEngine.Process(_channel, outBuffer);
+		}
+
+		/**
+		 * @brief Filter all the channels at once. Channels are processed in groups of MULTICHANNEL_BIQUAD_LANES, so this is
+		 * faster than calling Process for every channel when there are many of them
+		 * @param _inBuffers one input buffer per channel
+		 * @param outBuffers one output buffer per channel
+		 */
+		void Process(const std::vector<CMonoBuffer<float>> & _inBuffers, std::vector<CMonoBuffer<float>> & outBuffers)
+		{
+			if (!initialized || !enableProcessor) {
+				outBuffers = _inBuffers;
+				return;
+			}
+			if (_inBuffers.size() != static_cast<std::size_t>(numberOfChannels)) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of buffers has to be equal to the number of channels in BRTProcessing::CMultichanneBiquadFilterChain::Process");
+				outBuffers = _inBuffers;
+				return;
+			}
+			biquadEngine.Process(_inBuffers, outBuffers);
+		}
+
+		/**
+		 * @brief Filter the two channels of a binaural chain, left (channel 0) and right (channel 1), in the same pass
+		 * @param _inLeftBuffer left ear input buffer
+		 * @param outLeftBuffer left ear output buffer
+		 * @param _inRightBuffer right ear input buffer
+		 * @param outRightBuffer right ear output buffer
+		 */
+		void Process(const CMonoBuffer<float> & _inLeftBuffer, CMonoBuffer<float> & outLeftBuffer, const CMonoBuffer<float> & _inRightBuffer, CMonoBuffer<float> & outRightBuffer)
+		{
+			if (!initialized || !enableProcessor) {
+				outLeftBuffer = _inLeftBuffer;
+				outRightBuffer = _inRightBuffer;
+				return;
+			}
+			if (numberOfChannels != 2) {
+				SET_RESULT(RESULT_ERROR_BADSIZE, "The number of channels has to be 2 to filter both ears in BRTProcessing::CMultichanneBiquadFilterChain::Process");
+				outLeftBuffer = _inLeftBuffer;
+				outRightBuffer = _inRightBuffer;
+				return;
+			}
+
+			ASSERT(_inLeftBuffer.size() == globalParameters.GetBufferSize() && _inRightBuffer.size() == globalParameters.GetBufferSize(), RESULT_ERROR_BADSIZE, "InBuffer size has to be equal to the input size indicated by the BRT::GlobalParameters method", "");
+
+			if (_inLeftBuffer.empty() || _inLeftBuffer.size() != _inRightBuffer.size()) {
+				// Each ear is filtered on its own
+				Process(0, _inLeftBuffer, outLeftBuffer);
+				Process(1, _inRightBuffer, outRightBuffer);
+				return;
+			}
+			biquadEngine.Process(_inLeftBuffer, outLeftBuffer, _inRightBuffer, outRightBuffer);
 		}
 
 		/**
 		 * @brief Reset the buffers of the process
 		 */
 		void ResetBuffers() {
-			for (auto& biquadChain : biquadChainTable) {
-				biquadChain.ResetBuffers();
-			}			
+			biquadEngine.ResetBuffers();
 		}
 
-	
-	private:
-		///////////////////////
-		// Private Methods
-		///////////////////////		
-				
 		/**
-		 * @brief Set the coefficients of the filter
-		 * @param _filter filter to set the coefficients
-		 * @param cofficients vector of coefficients
-		 */	
-		void SetCoefficients(BRTProcessing::CBiquadFilterChain & _filter, const std::vector<float> & cofficients) {
-
-			BRTProcessing::TFiltersChainCoefficients filterCoeficientsVector;
-			for (int i = 0; i < numberOfCoefficientsPerChannel; i += NUMBER_OF_COEFFICIENTS_IN_BIQUAD_SECTION) {
-				std::vector<float> stage(cofficients.begin() + i, cofficients.begin() + i + NUMBER_OF_COEFFICIENTS_IN_BIQUAD_SECTION);
-				filterCoeficientsVector.push_back(stage);
-			}
-			_filter.SetFromCoefficientsVector(filterCoeficientsVector);
+		 * @brief Set how the filters of all the channels move to new coefficients, as in CBiquadFilterChain::SetTransitionMode
+		 * @param _transition transition mode
+		 */
+		void SetTransitionMode(TBiquadTransition _transition) {
+			biquadEngine.SetTransitionMode(_transition);
 		}
 
+		/**
+		 * @brief Get how the filters of all the channels move to new coefficients
+		 * @return transition mode
+		 */
+		TBiquadTransition GetTransitionMode() const {
+			return biquadEngine.GetTransitionMode();
+		}
+
+	
+	private:
 		///////////////////////
 		// Private Attributes
 		///////////////////////		
 		Common::CGlobalParameters globalParameters;		
-		std::vector<BRTProcessing::CBiquadFilterChain> biquadChainTable;
+		CMultichannelBiquadEngine<MULTICHANNEL_BIQUAD_LANES> biquadEngine;	// Biquad sections of all the channels
 		
 		bool enableProcessor;				// Flag to enable the processor		
 		bool initialized;
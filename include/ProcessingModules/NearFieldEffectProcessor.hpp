@@ -101,8 +101,7 @@ class CNearFieldEffectProcessor : public BRTConnectivity::CBRTConnectivity/*, pu
 			if (leftBuffer.size() != 0  || rightBuffer.size() !=0)  {
 				CMonoBuffer<float> outLeftBuffer;
 				CMonoBuffer<float> outRightBuffer;				
-				spatiallyOrientedSOSFilter.ProcessByInterauralAzimuth(Common::T_ear::LEFT, leftBuffer, outLeftBuffer, sourcePosition, listenerPosition, Common::T_ear::LEFT, listenerNFCFilters);
-				spatiallyOrientedSOSFilter.ProcessByInterauralAzimuth(Common::T_ear::RIGHT, rightBuffer, outRightBuffer, sourcePosition, listenerPosition, Common::T_ear::RIGHT, listenerNFCFilters);
+				spatiallyOrientedSOSFilter.ProcessByInterauralAzimuth(leftBuffer, outLeftBuffer, rightBuffer, outRightBuffer, sourcePosition, listenerPosition, listenerNFCFilters);
 
 				GetSamplesExitPoint("leftEar")->sendData(outLeftBuffer);
 				GetSamplesExitPoint("rightEar")->sendData(outRightBuffer);
@@ -25,10 +25,12 @@
 #ifndef _C_UNIFORM_PARTITIONED_CONVOLUTION
 #define _C_UNIFORM_PARTITIONED_CONVOLUTION
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <Common/FFTCalculator.hpp>
 #include <Common/Buffer.hpp>
+#include <Common/PlanarBuffer.hpp>
 #include <Common/CommonDefinitions.hpp>
 
 /** \brief Type definition for partitioned HRIR table
@@ -54,6 +56,9 @@ namespace BRTProcessing {
 			, impulseResponseNumberOfSubfilters{ 0 }
 			, impulseResponse_Frequency_Block_Size{ 0 }
 			, storageInput_bufferSize { 0 }
+			, impulseResponseStoragePrecision { Common::TSpectralPrecision::float32 }
+			, storageInputFFT_head { 0 }
+			, storageHRIR_head { 0 }
 		{
 		}
 
@@ -63,21 +68,25 @@ namespace BRTProcessing {
 		*	\param [in] _HRIR_Frequency_Block_Size size of the FTT Impulse Response blocks, this number is (2*B + k) = 2^n
 		*	\param [in] _HRIR_Block_Number number of blocks in which is divided the impluse response
 		*	\param [in] _IRMemory if true, the method with IR memory will be used (otherwise, the method without memory will be used instead)
+		*	\param [in] _IRStoragePrecision format used to store the history of impulse responses in the method with IR memory. With a 16-bit format
+		*				 the history needs half of the memory and the conversion is done inside the multiply-accumulate loop (see Common::TSpectralPrecision for the accuracy)
 		*   \eh On error, an error code is reported to the error handler.
 		*/
-		void Setup(int _inputSize, int _IR_Frequency_Block_Size, int _IR_Block_Number, bool _IRMemory)
+		void Setup(int _inputSize, int _IR_Frequency_Block_Size, int _IR_Block_Number, bool _IRMemory, Common::TSpectralPrecision _IRStoragePrecision = Common::TSpectralPrecision::float32)
 		{
 			if (setupDone) {
 				//Second time that this method has been called - clear all buffers
 				storageInput_buffer.clear();
-				storageInputFFT_buffer.clear();
-				storageHRIR_buffer.clear();
+				storageInputFFT_buffer.Clear();
+				storageHRIR_buffer.Clear();
+				storageCompactHRIR_buffer.Clear();
 			}
 
 			inputSize = _inputSize;
 			impulseResponse_Frequency_Block_Size = _IR_Frequency_Block_Size;
 			impulseResponseNumberOfSubfilters = _IR_Block_Number;
 			impulseResponseMemory = _IRMemory;
+			impulseResponseStoragePrecision = _IRStoragePrecision;
 
 			if (Common::CalculateIsPowerOfTwo(inputSize)) {	
 				storageInput_bufferSize = inputSize;	
@@ -88,26 +97,20 @@ namespace BRTProcessing {
 			//Prepare the buffer with the space that we are going to need	
 			storageInput_buffer.resize(storageInput_bufferSize, 0.0f);
 
-			//Preparing the vector of buffers that is going to store the history of FFTs	
-			storageInputFFT_buffer.resize(impulseResponseNumberOfSubfilters);
-			for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
-				storageInputFFT_buffer[i].resize(impulseResponse_Frequency_Block_Size, 0.0f);
-			}
-			it_storageInputFFT = storageInputFFT_buffer.begin();
+			//Preparing the planar buffer that is going to store the history of FFTs, one channel per input block
+			storageInputFFT_buffer.Resize(impulseResponseNumberOfSubfilters, impulseResponse_Frequency_Block_Size);
+			storageInputFFT_head = 0;
 
-			//Preparing the vector of buffers that is going to store the history of the HRIR	
-			if (impulseResponseMemory)
+			//Preparing the planar buffer that is going to store the history of the HRIR. Every channel keeps all the subfilters of one IR, one after another
+			if (impulseResponseMemory && impulseResponseStoragePrecision != Common::TSpectralPrecision::float32)
 			{
-				storageHRIR_buffer.resize(impulseResponseNumberOfSubfilters);
-				for (int i = 0; i < impulseResponseNumberOfSubfilters; i++)
-				{
-					storageHRIR_buffer[i].resize(impulseResponseNumberOfSubfilters);
-					for (int j = 0; j < impulseResponseNumberOfSubfilters; j++)
-					{
-						storageHRIR_buffer[i][j].resize(impulseResponse_Frequency_Block_Size, 0.0f);
-					}
-				}
-				it_storageHRIR = storageHRIR_buffer.begin();
+				storageCompactHRIR_buffer.Resize(impulseResponseNumberOfSubfilters, impulseResponseNumberOfSubfilters * impulseResponse_Frequency_Block_Size);
+				storageHRIR_head = 0;
+			}
+			else if (impulseResponseMemory)
+			{
+				storageHRIR_buffer.Resize(impulseResponseNumberOfSubfilters, impulseResponseNumberOfSubfilters * impulseResponse_Frequency_Block_Size);
+				storageHRIR_head = 0;
 			}
 
 			setupDone = true;
@@ -127,7 +130,6 @@ namespace BRTProcessing {
 		{
 			CMonoBuffer<float> sum;
 			sum.resize(impulseResponse_Frequency_Block_Size, 0.0f);
-			CMonoBuffer<float> temp;
 
 			if (!setupDone) { 
 				SET_RESULT(RESULT_ERROR_NOTSET, "Storage buffer to perform UP convolution has not been initialized");
@@ -137,7 +139,7 @@ namespace BRTProcessing {
 			if (inBuffer_Time.size() == inputSize) {
 
 				//Step 1- extend the input time signal buffer in order to have double length
-				std::vector<float> inBuffer_Time_dobleSize;
+				CMonoBuffer<float> inBuffer_Time_dobleSize;
 				inBuffer_Time_dobleSize.reserve(inputSize * 2);
 				inBuffer_Time_dobleSize.insert(inBuffer_Time_dobleSize.begin(), storageInput_buffer.begin(), storageInput_buffer.end());
 				inBuffer_Time_dobleSize.insert(inBuffer_Time_dobleSize.end(), inBuffer_Time.begin(), inBuffer_Time.end());
@@ -146,28 +148,19 @@ namespace BRTProcessing {
 				//Step 2,3 - FFT of the input signal
 				CMonoBuffer<float> inBuffer_Frequency;
 				Common::CFFTCalculator::CalculateFFT(inBuffer_Time_dobleSize, inBuffer_Frequency);
-				*it_storageInputFFT = inBuffer_Frequency;		//Store the new input FFT into the first FTT history buffers
+				storageInputFFT_buffer.SetChannel(storageInputFFT_head, inBuffer_Frequency);		//Store the new input FFT into the first FTT history buffers
 
 				//Step 4, 5 - Multiplications and sums
-				auto it_product = it_storageInputFFT;
+				int productIndex = storageInputFFT_head;
 
 				for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
-					Common::CFFTCalculator::ProcessComplexMultiplication(*it_product, IR[i], temp);
-					sum += temp;
-					if (it_product == storageInputFFT_buffer.begin()) {
-						it_product = storageInputFFT_buffer.end() - 1;
+					if (IR[i].size() == impulseResponse_Frequency_Block_Size) {
+						Common::CFFTCalculator::ProcessComplexMultiplyAccumulate(storageInputFFT_buffer[productIndex].data(), IR[i].data(), sum.data(), impulseResponse_Frequency_Block_Size / 2);
 					}
-					else {
-						it_product--;
-					}
-				}
-				//Move iterator waiting for the next input block
-				if (it_storageInputFFT == storageInputFFT_buffer.end() - 1) {
-					it_storageInputFFT = storageInputFFT_buffer.begin();
-				}
-				else {
-					it_storageInputFFT++;
+					productIndex = (productIndex == 0) ? impulseResponseNumberOfSubfilters - 1 : productIndex - 1;
 				}
+				//Move head waiting for the next input block
+				MoveInputFFTHead();
 				// Make the IIF
 				CMonoBuffer<float> ouputBuffer_temp;
 				Common::CFFTCalculator::CalculateIFFT(sum, ouputBuffer_temp);
@@ -196,7 +189,6 @@ namespace BRTProcessing {
 		{			
 			CMonoBuffer<float> sum;
 			sum.resize(impulseResponse_Frequency_Block_Size, 0.0f);
-			CMonoBuffer<float> temp;
 
 			ASSERT(inBuffer_Time.size() == inputSize, RESULT_ERROR_BADSIZE, "Bad input size, don't match with the size setting up in the setup method", "");
 			ASSERT(impulseResponseNumberOfSubfilters == IR.size(), RESULT_ERROR_BADSIZE, "Bad input size, the number of impulse response partitions does not correspond to what is expected.", "Has this class been initialised correctly?");
@@ -206,14 +198,14 @@ namespace BRTProcessing {
 				if (inBuffer_Time.size() == inputSize && IR.size() != 0)
 				{
 					//Step 1- extend the input time signal buffer in order to have double length
-					std::vector<float> inBuffer_Time_dobleSize;
+					CMonoBuffer<float> inBuffer_Time_dobleSize;
 					inBuffer_Time_dobleSize.reserve(inputSize + storageInput_bufferSize );
 					inBuffer_Time_dobleSize.insert(inBuffer_Time_dobleSize.begin(), storageInput_buffer.begin(), storageInput_buffer.end());
 					inBuffer_Time_dobleSize.insert(inBuffer_Time_dobleSize.end(), inBuffer_Time.begin(), inBuffer_Time.end());
 					
 					//Store current input signal
 					//storageInput_buffer = inBuffer_Time;					
-					std::vector<float> tempStorageInput;
+					CMonoBuffer<float> tempStorageInput;
 					tempStorageInput.reserve(storageInput_bufferSize);
 					tempStorageInput.insert(tempStorageInput.begin(), storageInput_buffer.end() -(storageInput_bufferSize - inputSize), storageInput_buffer.end());
 					tempStorageInput.insert(tempStorageInput.end(), inBuffer_Time.begin(), inBuffer_Time.end());
@@ -223,47 +215,18 @@ namespace BRTProcessing {
 					CMonoBuffer<float> inBuffer_Frequency;
 					Common::CFFTCalculator::CalculateFFT(inBuffer_Time_dobleSize, inBuffer_Frequency);
 					//Store the new input FFT into the first FTT history buffers
-					*it_storageInputFFT = inBuffer_Frequency;
-
-					//Store the HRIR input signal in the storage HRIR matrix
-					*it_storageHRIR = IR;
+					storageInputFFT_buffer.SetChannel(storageInputFFT_head, inBuffer_Frequency);
 
 					//Step 4, 5 - Multiplications and sums
-					auto it_product = it_storageInputFFT;
-					auto it_HRIR_multiplicationFactor = it_storageHRIR;
-
-					for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
-						Common::CFFTCalculator::ProcessComplexMultiplication(*it_product, (*it_HRIR_multiplicationFactor)[i], temp);
-						sum += temp;
-						if (it_product == storageInputFFT_buffer.begin()) {
-							it_product = storageInputFFT_buffer.end() - 1;
-						}
-						else {
-							it_product--;
-						}
-
-						if (it_HRIR_multiplicationFactor == storageHRIR_buffer.end() - 1) {
-							it_HRIR_multiplicationFactor = storageHRIR_buffer.begin();
-						}
-						else {
-							it_HRIR_multiplicationFactor++;
-						}
-					}
-					//Move iterator waiting for the next input block
-					if (it_storageInputFFT == storageInputFFT_buffer.end() - 1) {
-						it_storageInputFFT = storageInputFFT_buffer.begin();
+					if (impulseResponseStoragePrecision == Common::TSpectralPrecision::float32) {
+						ProcessMultiplicationsWithFloatHistory(IR, sum);
 					}
 					else {
-						it_storageInputFFT++;
+						ProcessMultiplicationsWithCompactHistory(IR, sum);
 					}
 
-					//Move iterator waiting for the next input block
-					if (it_storageHRIR == storageHRIR_buffer.begin()) {
-						it_storageHRIR = storageHRIR_buffer.end() - 1;
-					}
-					else {
-						it_storageHRIR--;
-					}
+					//Move head waiting for the next input block
+					MoveInputFFTHead();
 
 					if (_doIFFT) {
 						// Make the IIF
@@ -310,8 +273,9 @@ namespace BRTProcessing {
 			if (setupDone) {				
 				setupDone = false;
 				storageInput_buffer.clear();
-				storageInputFFT_buffer.clear();
-				storageHRIR_buffer.clear();				
+				storageInputFFT_buffer.Clear();
+				storageHRIR_buffer.Clear();				
+				storageCompactHRIR_buffer.Clear();
 				inputSize = 0;
 				impulseResponseMemory = 0;
 				impulseResponseNumberOfSubfilters = 0;
@@ -327,12 +291,82 @@ namespace BRTProcessing {
 		int storageInput_bufferSize;					//Number of samples to be saved in each audio loop
 		bool impulseResponseMemory;					//Indicate if HRTF storage buffer has to be prepared to do UPC with memory
 		bool setupDone;								//It's true when setup has been called at least once
+		Common::TSpectralPrecision impulseResponseStoragePrecision;	//Format of the history of IRs in the method with memory
 				
-		std::vector<float> storageInput_buffer;						//To store the last input signal
-		std::vector<std::vector<float>> storageInputFFT_buffer;			//To store the history of input signals FFTs 
-		std::vector<std::vector<float>>::iterator it_storageInputFFT;	//Declare a general iterator to keep the head of the FTTs buffer
-		std::vector<THRIR_partitioned> storageHRIR_buffer;			//To store the HRIR of the orientation of the previous frames
-		std::vector<THRIR_partitioned>::iterator it_storageHRIR;		//Declare a general iterator to keep the head of the storageHRIR_buffer		
+		CMonoBuffer<float> storageInput_buffer;						//To store the last input signal
+		CMultiChannelBuffer<float> storageInputFFT_buffer;			//To store the history of input signals FFTs, one channel per input block
+		int storageInputFFT_head;									//Channel of storageInputFFT_buffer where the next input FFT is stored
+		CMultiChannelBuffer<float> storageHRIR_buffer;				//To store the HRIR of the previous frames, one channel per frame with all its subfilters together
+		CMultiChannelBuffer<uint16_t> storageCompactHRIR_buffer;	//Same as storageHRIR_buffer, with a 16-bit format
+		int storageHRIR_head;										//Channel of the HRIR history where the IR of the current frame is stored
+
+		// METHODS
+
+		/// Move the head of the input FFT history to the channel of the next input block
+		void MoveInputFFTHead() {
+			if (++storageInputFFT_head == impulseResponseNumberOfSubfilters) { storageInputFFT_head = 0; }
+		}
+
+		/// Move the head of the IR history to the channel of the next frame
+		void MoveHRIRHead() {
+			storageHRIR_head = (storageHRIR_head == 0) ? impulseResponseNumberOfSubfilters - 1 : storageHRIR_head - 1;
+		}
+
+		/// Store the new IR in the float history and accumulate the products of every input FFT with the subfilter of the IR of its frame
+		void ProcessMultiplicationsWithFloatHistory(const std::vector<CMonoBuffer<float>>& IR, CMonoBuffer<float>& sum) {
+			//Store the HRIR input signal in the storage HRIR matrix
+			float* newFrame = storageHRIR_buffer[storageHRIR_head].data();
+			for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
+				if (IR[i].size() != impulseResponse_Frequency_Block_Size) {
+					SET_RESULT(RESULT_ERROR_BADSIZE, "Bad impulse response subfilter size, it does not match the size set in the setup method");
+					// The frame is stored silent, so that the IR history stays in step with the input FFT history
+					std::fill(newFrame, newFrame + impulseResponseNumberOfSubfilters * impulseResponse_Frequency_Block_Size, 0.0f);
+					break;
+				}
+				std::copy(IR[i].begin(), IR[i].end(), newFrame + i * impulseResponse_Frequency_Block_Size);
+			}
+
+			int productIndex = storageInputFFT_head;
+			int frameIndex = storageHRIR_head;
+
+			for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
+				const float* subfilter = storageHRIR_buffer[frameIndex].data() + i * impulseResponse_Frequency_Block_Size;
+				Common::CFFTCalculator::ProcessComplexMultiplyAccumulate(storageInputFFT_buffer[productIndex].data(), subfilter, sum.data(), impulseResponse_Frequency_Block_Size / 2);
+				productIndex = (productIndex == 0) ? impulseResponseNumberOfSubfilters - 1 : productIndex - 1;
+				frameIndex = (frameIndex == impulseResponseNumberOfSubfilters - 1) ? 0 : frameIndex + 1;
+			}
+
+			//Move head waiting for the next input block
+			MoveHRIRHead();
+		}
+
+		/// Same as ProcessMultiplicationsWithFloatHistory, with the history stored with a 16-bit format
+		void ProcessMultiplicationsWithCompactHistory(const std::vector<CMonoBuffer<float>>& IR, CMonoBuffer<float>& sum) {
+			//Store the HRIR input signal in the storage HRIR matrix
+			uint16_t* newFrame = storageCompactHRIR_buffer[storageHRIR_head].data();
+			for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
+				if (IR[i].size() != impulseResponse_Frequency_Block_Size) {
+					SET_RESULT(RESULT_ERROR_BADSIZE, "Bad impulse response subfilter size, it does not match the size set in the setup method");
+					// The frame is stored silent, so that the IR history stays in step with the input FFT history
+					std::fill(newFrame, newFrame + impulseResponseNumberOfSubfilters * impulseResponse_Frequency_Block_Size, 0);
+					break;
+				}
+				Common::CReducedPrecision::Encode(IR[i].data(), newFrame + i * impulseResponse_Frequency_Block_Size, impulseResponse_Frequency_Block_Size, impulseResponseStoragePrecision);
+			}
+
+			int productIndex = storageInputFFT_head;
+			int frameIndex = storageHRIR_head;
+
+			for (int i = 0; i < impulseResponseNumberOfSubfilters; i++) {
+				const uint16_t* subfilter = storageCompactHRIR_buffer[frameIndex].data() + i * impulseResponse_Frequency_Block_Size;
+				Common::CFFTCalculator::ProcessComplexMultiplyAccumulate(storageInputFFT_buffer[productIndex].data(), subfilter, impulseResponseStoragePrecision, sum.data(), impulseResponse_Frequency_Block_Size / 2);
+				productIndex = (productIndex == 0) ? impulseResponseNumberOfSubfilters - 1 : productIndex - 1;
+				frameIndex = (frameIndex == impulseResponseNumberOfSubfilters - 1) ? 0 : frameIndex + 1;
+			}
+
+			//Move head waiting for the next input block
+			MoveHRIRHead();
+		}
 	};
 }
 #endif
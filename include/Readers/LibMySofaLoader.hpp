@@ -24,12 +24,46 @@
 #define _LIBMYSOFA_LOADER_
 
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <Common/ErrorHandler.hpp>
 #include <third_party_libraries/libmysofa/include/mysofa.h>
 
 namespace BRTReaders {
 
+	/**
+	 * @brief Read only view of an array of values owned by libmysofa (or by a static default). It does not copy the values,
+		so it is only valid while the loader that provides it is alive.
+	 */
+	class TSofaArrayView {
+	public:
+		TSofaArrayView()
+			: values { nullptr }
+			, elements { 0 } { }
+		TSofaArrayView(const float * _values, std::size_t _elements)
+			: values { _values }
+			, elements { _values == nullptr ? 0 : _elements } { }
+		TSofaArrayView(const MYSOFA_ARRAY * _array)
+			: values { _array == nullptr ? nullptr : _array->values }
+			, elements { (_array == nullptr || _array->values == nullptr) ? 0 : _array->elements } { }
+
+		std::size_t size() const { return elements; }
+		bool empty() const { return elements == 0; }
+		const float * data() const { return values; }
+		const float * begin() const { return values; }
+		const float * end() const { return values + elements; }
+		const float & operator[](std::size_t _index) const { return values[_index]; }
+		const float & at(std::size_t _index) const {
+			if (_index >= elements) { throw std::out_of_range("TSofaArrayView index out of range"); }
+			return values[_index];
+		}
+
+	private:
+		const float * values;
+		std::size_t elements;
+	};
+
 	class CLibMySOFALoader {
 
 	public:
@@ -257,6 +291,19 @@ namespace BRTReaders {
 			return _listenerUp;
 		}
 
+		// Views of the libmysofa arrays, no copies are made
+		TSofaArrayView GetSourcePositionArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->SourcePosition); }
+		TSofaArrayView GetSourceViewArray() { return error == -1 ? TSofaArrayView() : TSofaArrayView(mysofa_getSourceView()); }
+		TSofaArrayView GetSourceUpArray() { return error == -1 ? TSofaArrayView() : TSofaArrayView(mysofa_getSourceUp()); }
+		TSofaArrayView GetEmitterPositionArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->EmitterPosition); }
+		TSofaArrayView GetListenerPositionArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->ListenerPosition); }
+		TSofaArrayView GetListenerViewArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->ListenerView); }
+		TSofaArrayView GetListenerUpArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->ListenerUp); }
+		TSofaArrayView GetReceiverPositionArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->ReceiverPosition); }
+		TSofaArrayView GetDataDelayArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->DataDelay); }
+		TSofaArrayView GetDataIRArray() const { return error == -1 ? TSofaArrayView() : TSofaArrayView(&hrtf->hrtf->DataIR); }
+		TSofaArrayView GetDataSOSArray() { return error == -1 ? TSofaArrayView() : TSofaArrayView(GetDataSOS()); }
+
 		// Others methods
 		void Cartesian2Spherical() {
 			if (error == -1) return ;
@@ -25,12 +25,14 @@
 
 #define EPSILON 0.0001f
 
+#include <algorithm>
 #include <ostream>
 #include <string>
 #include <Common/ErrorHandler.hpp>
 #include <ServiceModules/ServicesBase.hpp>
 #include <ServiceModules/SphericalFIRTable.hpp>
 #include <ServiceModules/SphericalInterpolatedFIRTable.hpp>
+#include <ServiceModules/SphericalHarmonicFIRTable.hpp>
 #include <Readers/LibMySofaLoader.hpp>
 #include <third_party_libraries/libmysofa/include/mysofa.h>
 
@@ -126,6 +128,15 @@ namespace BRTReaders {
 			return ReadFIREFromSofa(sofafile, listenerHRTF, BRTServices::TServiceType::hrir_database_interpolated, _spatialResolution, _extrapolationMethod, 0.0f, 0.0f, 0.0f, 0.0f);				
 		}
 		
+		/** \brief Loads an HRTF from a sofa file into a spherical harmonic table. The order of the expansion has to be set in the table before.
+		*	\param [in] path of the sofa file
+		*	\param [out] listener affected by the hrtf
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		bool ReadHRTFFromSofa(const std::string & sofafile, std::shared_ptr<BRTServices::CSphericalHarmonicFIRTable> listenerHRTF) {
+			return ReadFIREFromSofa(sofafile, listenerHRTF, BRTServices::TServiceType::hrir_database_interpolated, -1, BRTServices::TEXTRAPOLATION_METHOD::none, 0.0f, 0.0f, 0.0f, 0.0f);
+		}
+
 		bool ReadHRTFRawFromSofa(const std::string & sofafile, std::shared_ptr<BRTServices::CSphericalFIRTable> listenerHRTF) {
 			return ReadFIREFromSofa(sofafile, listenerHRTF, BRTServices::TServiceType::hrir_database, -1, BRTServices::TEXTRAPOLATION_METHOD::none, 0.0f, 0.0f, 0.0f, 0.0f);			
 		}
@@ -251,10 +262,9 @@ namespace BRTReaders {
 
 		bool GetHRSOSCoefficients(BRTReaders::CLibMySOFALoader& loader, std::shared_ptr<BRTServices::CServicesBase>& data, std::string& _error) {
 			//Get source positions												
-			std::vector< double > sourcePositionsVector = std::move(loader.GetSourcePositionVector());
-			// GET delays and IRs
-			std::vector< double > dataDelays(loader.getHRTF()->DataDelay.values, loader.getHRTF()->DataDelay.values + loader.getHRTF()->DataDelay.elements);
-			std::vector< double > dataMeasurements(loader.GetDataSOS()->values, loader.GetDataSOS()->values + loader.GetDataSOS()->elements);
+			TSofaArrayView sourcePositionsVector = loader.GetSourcePositionArray();
+			// GET coefficients, read in place from the libmysofa arrays
+			TSofaArrayView dataMeasurements = loader.GetDataSOSArray();
 
 			// Check number of receivers	
 			int numberOfReceivers = loader.getHRTF()->R;
@@ -364,36 +374,23 @@ namespace BRTReaders {
 		bool GetDirectivityFIRE(BRTReaders::CLibMySOFALoader & loader, std::shared_ptr<BRTServices::CServicesBase> & data, BRTServices::TEXTRAPOLATION_METHOD _extrapolationMethod, std::string & error) {
 
 			//Get receiver positions
-			std::vector<double> receiverPositionsVector(loader.getHRTF()->ReceiverPosition.values, loader.getHRTF()->ReceiverPosition.values + loader.getHRTF()->ReceiverPosition.elements);
+			TSofaArrayView receiverPositionsVector = loader.GetReceiverPositionArray();
 
 			//Get source positions
-			std::vector<double> sourcePositionsVector = std::move(loader.GetSourcePositionVector());
-
-			std::vector<double> sourceViewVector = std::move(loader.GetSourceViewVector());
-			if (sourceViewVector.size() == 0) {
-				sourceViewVector = std::vector<double>({ 1, 0, 0 });
-			}
-			std::vector<double> sourceUpVector = std::move(loader.GetSourceUpVector());
-			if (sourceUpVector.size() == 0) {
-				sourceUpVector = std::vector<double>({ 0, 0, 1 });
-			}
+			TSofaArrayView sourcePositionsVector = loader.GetSourcePositionArray();
+			TSofaArrayView sourceViewVector = GetArrayOrDefault(loader.GetSourceViewArray(), DEFAULT_VIEW);
+			TSofaArrayView sourceUpVector = GetArrayOrDefault(loader.GetSourceUpArray(), DEFAULT_UP);
 
 			//Emitter
-			std::vector<double> emitterPositionsVector = std::move(loader.GetEmitterPositionVector());
+			TSofaArrayView emitterPositionsVector = loader.GetEmitterPositionArray();
 			//Listener
-			std::vector<double> listenerPositionsVector = std::move(loader.GetListenerPositionVector());
-			std::vector<double> listenerViewVector = std::move(loader.GetListenerViewVector());
-			if (listenerViewVector.size() == 0) {
-				listenerViewVector = std::vector<double>({ 1, 0, 0 });
-			}
-			std::vector<double> listenerUpVector = std::move(loader.GetListenerUpVector());
-			if (listenerUpVector.size() == 0) {
-				listenerUpVector = std::vector<double>({ 0, 0, 1 });
-			}
+			TSofaArrayView listenerPositionsVector = loader.GetListenerPositionArray();
+			TSofaArrayView listenerViewVector = GetArrayOrDefault(loader.GetListenerViewArray(), DEFAULT_VIEW);
+			TSofaArrayView listenerUpVector = GetArrayOrDefault(loader.GetListenerUpArray(), DEFAULT_UP);
 			//Delays
-			std::vector<double> dataDelayVector(loader.getHRTF()->DataDelay.values, loader.getHRTF()->DataDelay.values + loader.getHRTF()->DataDelay.elements);
-			//IRs
-			std::vector<double> dataMeasurements(loader.getHRTF()->DataIR.values, loader.getHRTF()->DataIR.values + loader.getHRTF()->DataIR.elements);
+			TSofaArrayView dataDelayVector = loader.GetDataDelayArray();
+			//IRs, read in place from the libmysofa array
+			TSofaArrayView dataMeasurements = loader.GetDataIRArray();
 
 			// Constants
 			int numberOfMeasurements = loader.getHRTF()->M;
@@ -504,33 +501,20 @@ namespace BRTReaders {
 		
 		bool GetIRFIRE(BRTReaders::CLibMySOFALoader & loader, std::shared_ptr<BRTServices::CServicesBase> & data, BRTServices::TEXTRAPOLATION_METHOD _extrapolationMethod) {
 			//Get source positions												
-			std::vector<double> sourcePositionsVector	= std::move(loader.GetSourcePositionVector());
-			
-			std::vector<double> sourceViewVector		= std::move(loader.GetSourceViewVector());
-			if (sourceViewVector.size() == 0) {
-				sourceViewVector = std::vector<double>({1,0,0});
-			}
-			std::vector<double> sourceUpVector			= std::move(loader.GetSourceUpVector());			
-			if (sourceUpVector.size() == 0) {
-				sourceUpVector = std::vector<double>({ 0,0,1 });
-			}
+			TSofaArrayView sourcePositionsVector = loader.GetSourcePositionArray();
+			TSofaArrayView sourceViewVector = GetArrayOrDefault(loader.GetSourceViewArray(), DEFAULT_VIEW);
+			TSofaArrayView sourceUpVector = GetArrayOrDefault(loader.GetSourceUpArray(), DEFAULT_UP);
 			
 			//Emitter
-			std::vector<double> emitterPositionsVector = std::move(loader.GetEmitterPositionVector());
+			TSofaArrayView emitterPositionsVector = loader.GetEmitterPositionArray();
 			//Listener
-			std::vector<double> listenerPositionsVector = std::move(loader.GetListenerPositionVector());
-			std::vector<double> listenerViewVector = std::move(loader.GetListenerViewVector());
-			if (listenerViewVector.size() == 0) {
-				listenerViewVector = std::vector<double>({ 1,0,0 });
-			}
-			std::vector<double> listenerUpVector = std::move(loader.GetListenerUpVector());
-			if (listenerUpVector.size() == 0) {
-				listenerUpVector = std::vector<double>({ 0,0,1 });
-			}
+			TSofaArrayView listenerPositionsVector = loader.GetListenerPositionArray();
+			TSofaArrayView listenerViewVector = GetArrayOrDefault(loader.GetListenerViewArray(), DEFAULT_VIEW);
+			TSofaArrayView listenerUpVector = GetArrayOrDefault(loader.GetListenerUpArray(), DEFAULT_UP);
 			//Delays
-			std::vector< double > dataDelayVector(loader.getHRTF()->DataDelay.values, loader.getHRTF()->DataDelay.values + loader.getHRTF()->DataDelay.elements);
-			//IRs
-			std::vector< double > dataMeasurements(loader.getHRTF()->DataIR.values, loader.getHRTF()->DataIR.values + loader.getHRTF()->DataIR.elements);
+			TSofaArrayView dataDelayVector = loader.GetDataDelayArray();
+			//IRs, read in place from the libmysofa array. Every IR is converted straight into the buffer that is moved into the table
+			TSofaArrayView dataMeasurements = loader.GetDataIRArray();
 
 			// Constants
 			const int numberOfMeasurements = loader.getHRTF()->M;
@@ -614,7 +598,7 @@ namespace BRTReaders {
 		 * @param elevation Output parameter containing the elevation.
 		 * @param distance Output parameter containing the distance.
 		 */			
-		void GetSourcePosition(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _sourcePositionsVector, std::size_t measure, double& azimuth, double& elevation, double& distance) {
+		void GetSourcePosition(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _sourcePositionsVector, std::size_t measure, double& azimuth, double& elevation, double& distance) {
 
 			int numberOfCoordinates = loader.getHRTF()->C;			
 			std::vector<double> _sourcePosition;
@@ -632,7 +616,7 @@ namespace BRTReaders {
 		}
 
 
-		Common::CVector3 GetSourcePositionCartesian(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _sourcePositionsVector, std::size_t measure) {
+		Common::CVector3 GetSourcePositionCartesian(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _sourcePositionsVector, std::size_t measure) {
 			int numberOfCoordinates = loader.getHRTF()->C;
 			std::vector<double> _sourcePosition;
 
@@ -654,7 +638,7 @@ namespace BRTReaders {
 		 * @param _emitter 
 		 * @return 
 		 */
-		Common::CVector3 GetEmitterPosition(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& emitterPositionsVector, std::size_t measure, std::size_t _emitter) {
+		Common::CVector3 GetEmitterPosition(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & emitterPositionsVector, std::size_t measure, std::size_t _emitter) {
 			int numberOfCoordinates = loader.getHRTF()->C;
 			//Get emmiter position	
 			std::vector<double> _emitterPosition;
@@ -675,7 +659,7 @@ namespace BRTReaders {
 		 * @param measure Measure to be recovered
 		 * @return View of the source, 3-dimensional vector, Cartesian.
 		 */
-		Common::CVector3 GetSourceView(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& sourceViewVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		Common::CVector3 GetSourceView(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & sourceViewVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			int numberOfCoordinates = loader.getHRTF()->C;
 			std::vector<double> _sourceView;			
 			
@@ -699,7 +683,7 @@ namespace BRTReaders {
 		 * @param measure Measure to be recovered
 		 * @return UP of the source, 3-dimensional vector, Cartesian.
 		 */
-		Common::CVector3 GetSourceUp(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& sourceUpVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		Common::CVector3 GetSourceUp(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & sourceUpVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			int numberOfCoordinates = loader.getHRTF()->C;			
 			std::vector<double> _sourceUp;
 			
@@ -723,7 +707,7 @@ namespace BRTReaders {
 		 * @param elevation Output parameter containing the elevation.
 		 * @param distance Output parameter containing the distance.		 
 		 */
-		void GetReceiverPosition(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& receiverPositionsVector, std::size_t measure, double& azimuth, double& elevation, double& distance) {			
+		void GetReceiverPosition(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & receiverPositionsVector, std::size_t measure, double& azimuth, double& elevation, double& distance) {			
 			int numberOfCoordinates = loader.getHRTF()->C;												
 			try {
 				if (IsReceiverPositionCoordinateSystemsSpherical(loader)) {
@@ -744,7 +728,7 @@ namespace BRTReaders {
 			}			
 		}
 		
-		std::vector<double> GetReceiverPosition(BRTReaders::CLibMySOFALoader & loader, const std::vector<double> & _receiverPositionsVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		std::vector<double> GetReceiverPosition(BRTReaders::CLibMySOFALoader & loader, const TSofaArrayView & _receiverPositionsVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			std::vector<double> _receiverPosition;
 			int numberOfCoordinates = loader.getHRTF()->C;
 			// Get Listener position
@@ -768,7 +752,7 @@ namespace BRTReaders {
 		 * @param measure  Measure to be recovered
 		 * @return positions of the listener, 3-dimensional vector, Cartesian.
 		 */
-		std::vector<double> GetListenerPosition(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _listenerPositionsVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		std::vector<double> GetListenerPosition(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _listenerPositionsVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			std::vector<double> _listenerPosition;
 			int numberOfCoordinates = loader.getHRTF()->C;
 			// Get Listener position						
@@ -791,7 +775,7 @@ namespace BRTReaders {
 		 * @param measure  Measure to be recovered
 		 * @return VIEW of the listener, 3-dimensional vector, Cartesian.
 		 */
-		std::vector<double> GetListenerView(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _listenerViewVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		std::vector<double> GetListenerView(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _listenerViewVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			std::vector<double> _listenerView;
 			int numberOfCoordinates = loader.getHRTF()->C;
 						
@@ -813,7 +797,7 @@ namespace BRTReaders {
 		 * @param measure  Measure to be recovered
 		 * @return UP of the listener, 3-dimensional vector, Cartesian.
 		 */
-		std::vector<double> GetListenerUp(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _listenerUpVector, std::size_t numberOfMeasurements, std::size_t measure) {
+		std::vector<double> GetListenerUp(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _listenerUpVector, std::size_t numberOfMeasurements, std::size_t measure) {
 			std::vector<double> _listenerUp;
 			int numberOfCoordinates = loader.getHRTF()->C;			
 			
@@ -829,7 +813,7 @@ namespace BRTReaders {
 		}
 
 
-		void GetDelays(BRTReaders::CLibMySOFALoader& loader, const std::vector<double>& _dataDelaysVector, double& leftDelay, double& rightDelay, std::size_t numberOfMeasurements, std::size_t numberOfReceivers, std::size_t measure) {
+		void GetDelays(BRTReaders::CLibMySOFALoader& loader, const TSofaArrayView & _dataDelaysVector, double& leftDelay, double& rightDelay, std::size_t numberOfMeasurements, std::size_t numberOfReceivers, std::size_t measure) {
 			leftDelay = -1;
 			rightDelay = -1;
 			if (_dataDelaysVector.size() == numberOfMeasurements * numberOfReceivers) {
@@ -847,7 +831,7 @@ namespace BRTReaders {
 			}			
 		}
 
-		void GetOneDelay(BRTReaders::CLibMySOFALoader & loader, const std::vector<double> & _dataDelaysVector, double & _delay, std::size_t numberOfMeasurements, std::size_t numberOfReceivers, std::size_t measure, std::size_t receiver) {
+		void GetOneDelay(BRTReaders::CLibMySOFALoader & loader, const TSofaArrayView & _dataDelaysVector, double & _delay, std::size_t numberOfMeasurements, std::size_t numberOfReceivers, std::size_t measure, std::size_t receiver) {
 			_delay = -1;			
 			if (_dataDelaysVector.size() == numberOfMeasurements * numberOfReceivers) {
 				_delay = _dataDelaysVector[array2DIndex(measure, receiver, numberOfReceivers)];
@@ -1110,21 +1094,18 @@ namespace BRTReaders {
 		 * [1, 2, 3, 4, 5, 6 , 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24]
 		 * 		
 		 */
-		void Get3DMatrixData(const std::vector<double>& dataIR, std::vector<float>& outIR, int numberOfReceivers, int numberOfSamples, int receiver, int measure) {
-			std::vector<float> IR(numberOfSamples, 0);
-			try {
-
-				for (std::size_t sample = 0; sample < numberOfSamples; sample++) {
-					const std::size_t index = array3DIndex(measure, receiver, sample, numberOfReceivers, numberOfSamples);
-					IR.at(sample) = dataIR.at(index);
-				}
-				outIR = std::move(IR);
-			}
-			catch (const std::exception&) {
+		void Get3DMatrixData(const TSofaArrayView & dataIR, Common::TAlignedVector<float>& outIR, int numberOfReceivers, int numberOfSamples, int receiver, int measure) {
+			outIR.resize(numberOfSamples);
+			if (numberOfSamples <= 0) { return; }
+			// The samples of one IR are contiguous, so the bounds are checked once for the last one
+			const std::size_t firstIndex = array3DIndex(measure, receiver, 0, numberOfReceivers, numberOfSamples);
+			if (firstIndex + numberOfSamples > dataIR.size()) {
 				SET_RESULT(RESULT_ERROR_EXCEPTION, "Error getting IR data from SOFA file. Fill with an emty vector.");
-				outIR = std::vector<float>(numberOfSamples, 0);
+				std::fill(outIR.begin(), outIR.end(), 0.0f);
+				return;
 			}
-		
+			const float * source = dataIR.data() + firstIndex;
+			std::copy(source, source + numberOfSamples, outIR.begin());
 		}
 
 		const std::size_t array3DIndex(const unsigned long measure, const unsigned long receiver, const unsigned long sample, const unsigned long numberOfReceivers, const unsigned long numberOfSamples)
@@ -1198,18 +1179,23 @@ namespace BRTReaders {
 		 *	E0 E1 E2 E3 E0 E1 E2 E3 E0 E1 E2 E3 E0 E1 E2 E3 E0 E1 E2 E3 E0 E1 E2 E3
 		 *	01 02 03 04	05 06 07 08	09 10 11 12	13 14 15 16	17 18 19 20	21 22 23 24
 		 */		 
-		void Get4DMatrixData(const std::vector<double>& dataIR, std::vector<float>& outIR, int numberOfReceivers, int numberOfSamples, int numberOfEmmiters, int measure, int receiver, int emmiter) {
-			std::vector<float> IR(numberOfSamples, 0);
-			try {
+		void Get4DMatrixData(const TSofaArrayView & dataIR, Common::TAlignedVector<float>& outIR, int numberOfReceivers, int numberOfSamples, int numberOfEmmiters, int measure, int receiver, int emmiter) {
+			outIR.resize(numberOfSamples);
+			if (numberOfSamples <= 0) { return; }
+			// Samples are numberOfEmmiters apart, so checking the index of the last one is enough
+			const std::size_t lastIndex = array4DIndex(measure, receiver, numberOfSamples - 1, emmiter, numberOfReceivers, numberOfSamples, numberOfEmmiters);
+			if (emmiter >= numberOfEmmiters || lastIndex >= dataIR.size()) {
+				SET_RESULT(RESULT_ERROR_EXCEPTION, "Error getting IR data from SOFA file. Fill with an emty vector.");
+				std::fill(outIR.begin(), outIR.end(), 0.0f);
+				return;
+			}
+			const float * source = dataIR.data() + array4DIndex(measure, receiver, 0, emmiter, numberOfReceivers, numberOfSamples, numberOfEmmiters);
+			if (numberOfEmmiters == 1) {
+				std::copy(source, source + numberOfSamples, outIR.begin());
+			} else {
 				for (std::size_t sample = 0; sample < numberOfSamples; sample++) {
-					const std::size_t index = array4DIndex(measure, receiver, sample, emmiter, numberOfReceivers, numberOfSamples, numberOfEmmiters);
-					IR[sample] = dataIR.at(index);
+					outIR[sample] = source[sample * numberOfEmmiters];
 				}
-				outIR = std::move(IR);
-			}
-			catch (const std::exception&) {
-				SET_RESULT(RESULT_ERROR_EXCEPTION, "Error getting IR data from SOFA file. Fill with an emty vector.");
-				outIR = std::vector<float>(numberOfSamples, 0);
 			}
 		}
 		
@@ -1228,7 +1214,7 @@ namespace BRTReaders {
 		 * <----Measure 0 -------->  <-------- Measure 1 -------->		 
 		 * [1, 2, 3, 4, 5, 6 , 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]
 		 */
-		void Get2DMatrixData(const std::vector<double>& dataTF, std::vector<float>& outTF, int numberOfSamples, int measure) {
+		void Get2DMatrixData(const TSofaArrayView & dataTF, std::vector<float>& outTF, int numberOfSamples, int measure) {
 			std::vector<float> TF(numberOfSamples, 0);
 			try {
 				for (std::size_t sample = 0; sample < numberOfSamples; sample++) {
@@ -1251,7 +1237,7 @@ namespace BRTReaders {
 		 * @param numberOfCoordinates 
 		 * @return 
 		 */
-		void GetOneVector3From2DMatrix(const std::vector<double>& _inVector, std::vector<double>& _outVector, std::size_t measure, int numberOfCoordinates) {						
+		void GetOneVector3From2DMatrix(const TSofaArrayView & _inVector, std::vector<double>& _outVector, std::size_t measure, int numberOfCoordinates) {						
 			if (numberOfCoordinates < 3) { _outVector = std::vector<double>({0, 0, 0}); }
 			
 			try {
@@ -1271,6 +1257,16 @@ namespace BRTReaders {
 		{
 			return numberOfSamples * measure + sample;
 		}
+
+		/**
+		 * @brief Return the array read from the SOFA file, or the given default 3D vector if the file does not contain it
+		 * @param _array Array read from the SOFA file
+		 * @param _default Default value, with 3 coordinates
+		 */
+		TSofaArrayView GetArrayOrDefault(const TSofaArrayView & _array, const float (&_default)[3]) {
+			if (_array.empty()) { return TSofaArrayView(_default, 3); }
+			return _array;
+		}
 		
 
 		/**
@@ -1343,6 +1339,9 @@ namespace BRTReaders {
 		////////////////
 		std::string errorDescription;
 
+		inline static const float DEFAULT_VIEW[3] = { 1, 0, 0 };	// Used when the SOFA file does not contain View vectors
+		inline static const float DEFAULT_UP[3] = { 0, 0, 1 };		// Used when the SOFA file does not contain Up vectors
+
 	};	
 };
 #endif 
@@ -71,7 +71,7 @@ namespace BRTServices
 		*	\sa SetupIFFT_OLA
 		*   \eh Nothing is reported to the error handler.
 		*/
-		const int GetSubfilterLengthFR() const override {
+		int GetSubfilterLengthFR() const override {
 			return subfilterLengthFR;
 		}
 
@@ -81,7 +81,7 @@ namespace BRTServices
 		*	\sa SetupIFFT_OLA
 		*   \eh Nothing is reported to the error handler.
 		*/
-		const int GetNumberOfSubfiltersFR() const override {
+		int GetNumberOfSubfiltersFR() const override {
 			return numberOfSubfiltersFR;
 		}
 		
@@ -60,49 +60,102 @@ namespace BRTServices {
 
 			_outTable.clear();
 			_outTable = _inTable;
+			return CalculateWindowingIRTable(_outTable, fadeInBegin, riseTime, fadeOutCutoff, fallTime, _sampleRate);
+		}
 
+		/**
+		 * @brief Calculate the windowing of the IR functions of the DataBase Table, in place
+		 * @param _table table with the IR data, windowed on return
+		 * @return true if the fade out window has been applied, so the length of the IRs may have changed
+		 */
+		static bool CalculateWindowingIRTable(BRTServices::TRawSofaData & _table, float fadeInBegin, float riseTime, float fadeOutCutoff, float fallTime, int _sampleRate) {
 			bool anyActionDone = false;
+			for (auto it = _table.begin(); it != _table.end(); it++) {
+				anyActionDone = CalculateWindowingIR(it->data, fadeInBegin, riseTime, fadeOutCutoff, fallTime, _sampleRate);
+			}
+			// Update impulseResponseLength and the number of subfilters
+			//impulseResponseLength = _outTable.begin()->data.IR.left.size();
+			//partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
+			return anyActionDone;
+		}
+
+		/**
+		 * @brief Calculate the windowing of one IR, in place
+		 * @param _ir IR data of both ears
+		 * @return true if the fade out window has been applied, so the length of the IR may have changed
+		 */
+		static bool CalculateWindowingIR(TIRStruct & _ir, float fadeInBegin, float riseTime, float fadeOutCutoff, float fallTime, int _sampleRate) {
 			bool fadeInEnabled = (fadeInBegin != 0 || riseTime != 0);
 			bool fadeOutEnabled = (fadeOutCutoff != 0 || fallTime != 0);
 
 			if (fadeInEnabled) {
-				for (auto it = _outTable.begin(); it != _outTable.end(); it++) {
-					it->data.IR.left = Common::CIRWindowing::Process(it->data.IR.left, Common::CIRWindowing::fadein, fadeInBegin, riseTime, _sampleRate);
-					it->data.IR.right = Common::CIRWindowing::Process(it->data.IR.right, Common::CIRWindowing::fadein, fadeInBegin, riseTime, _sampleRate);
-				}
+				_ir.IR.left = Common::CIRWindowing::Process(_ir.IR.left, Common::CIRWindowing::fadein, fadeInBegin, riseTime, _sampleRate);
+				_ir.IR.right = Common::CIRWindowing::Process(_ir.IR.right, Common::CIRWindowing::fadein, fadeInBegin, riseTime, _sampleRate);
 			}
 			if (fadeOutEnabled) {
-				for (auto it = _outTable.begin(); it != _outTable.end(); it++) {
-					it->data.IR.left = Common::CIRWindowing::Process(it->data.IR.left, Common::CIRWindowing::fadeout, fadeOutCutoff, fallTime, _sampleRate);
-					it->data.IR.right = Common::CIRWindowing::Process(it->data.IR.right, Common::CIRWindowing::fadeout, fadeOutCutoff, fallTime, _sampleRate);
+				_ir.IR.left = Common::CIRWindowing::Process(_ir.IR.left, Common::CIRWindowing::fadeout, fadeOutCutoff, fallTime, _sampleRate);
+				_ir.IR.right = Common::CIRWindowing::Process(_ir.IR.right, Common::CIRWindowing::fadeout, fadeOutCutoff, fallTime, _sampleRate);
+			}
+			return fadeOutEnabled;
+		}
+
+		/**
+		 * @brief Calculate the memory used by the IRs of a raw table
+		 * @return size in bytes
+		 */
+		static size_t CalculateMemoryFootprint(const TRawSofaData & _table) {
+			size_t size = 0;
+			for (const TSofaDataBucket & it : _table) {
+				size += (it.data.IR.left.size() + it.data.IR.right.size()) * sizeof(float);
+			}
+			return size;
+		}
+
+		/**
+		 * @brief Calculate the memory used by the partitioned FRs of a table by distances. The FRs held outside the table, as in shared memory, are not counted.
+		 * @return size in bytes
+		 */
+		static size_t CalculateMemoryFootprint(const TDistanceTable & _table) {
+			size_t size = 0;
+			for (const TDistanceBucket & distBucket : _table) {
+				for (const auto & it : distBucket.table) {
+					size += it.second.compactIR.left.data.size() * sizeof(uint16_t) + it.second.compactIR.right.data.size() * sizeof(uint16_t);
+					for (const CMonoBuffer<float> & subfilter : it.second.IR.left) { size += subfilter.size() * sizeof(float); }
+					for (const CMonoBuffer<float> & subfilter : it.second.IR.right) { size += subfilter.size() * sizeof(float); }
 				}
-				anyActionDone = true;
 			}
-			// Update impulseResponseLength and the number of subfilters
-			//impulseResponseLength = _outTable.begin()->data.IR.left.size();
-			//partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
-			return anyActionDone;
+			return size;
 		}
 
 		/**
 		 * @brief Calculate and remove the common delay of every IR functions of the DataBase Table. 
 		 */
 		static void RemoveCommonDelayFromTable(TRawSofaData & table) {
+			RemoveCommonDelay(table, [](TSofaDataBucket & _bucket) -> Common::CEarPair<uint64_t> & { return _bucket.data.delay; });
+		}
+
+		/**
+		 * @brief Calculate and remove the common delay of the elements of any table
+		 * @param table table, it must not be empty
+		 * @param getDelay function that returns a reference to the delays of one element of the table
+		 */
+		template <typename TTable, typename TGetDelay>
+		static void RemoveCommonDelay(TTable & table, TGetDelay getDelay) {
 			//1. Init the minumun value with the fist value of the table
 			auto it0 = table.begin();
-			uint64_t minimumDelayLeft = it0->data.delay.left; //Vrbl to store the minumun delay value for left ear
-			uint64_t minimumDelayRight = it0->data.delay.right; //Vrbl to store the minumun delay value for right ear
+			uint64_t minimumDelayLeft = getDelay(*it0).left; //Vrbl to store the minumun delay value for left ear
+			uint64_t minimumDelayRight = getDelay(*it0).right; //Vrbl to store the minumun delay value for right ear
 
 			//2. Find the common delay
 			//Scan the whole table looking for the minimum delay for left and right ears
 			for (auto it = table.begin(); it != table.end(); it++) {
 				//Left ear
-				if (it->data.delay.left < minimumDelayLeft) {
-					minimumDelayLeft = it->data.delay.left;
+				if (getDelay(*it).left < minimumDelayLeft) {
+					minimumDelayLeft = getDelay(*it).left;
 				}
 				//Right ear
-				if (it->data.delay.right < minimumDelayRight) {
-					minimumDelayRight = it->data.delay.right;
+				if (getDelay(*it).right < minimumDelayRight) {
+					minimumDelayRight = getDelay(*it).right;
 				}
 			}
 			//3. Delete the common delay
@@ -110,8 +163,8 @@ namespace BRTServices {
 			//The common delay of each canal have been calculated and subtracted separately in order to correct the asymmetry of the measurement
 			if (minimumDelayRight != 0 || minimumDelayLeft != 0) {
 				for (auto it = table.begin(); it != table.end(); it++) {
-					it->data.delay.left -= minimumDelayLeft; //Left ear
-					it->data.delay.right -= minimumDelayRight; //Right ear
+					getDelay(*it).left -= minimumDelayLeft; //Left ear
+					getDelay(*it).right -= minimumDelayRight; //Right ear
 				}
 			}
 			SET_RESULT(RESULT_OK, "Common delay deleted (" + std::to_string(minimumDelayLeft) + "," + std::to_string(minimumDelayRight) + ") from nonInterpolatedHRTF table succesfully");
@@ -121,187 +174,244 @@ namespace BRTServices {
 
 		/**
 		 * @brief Get interpolated and partitioned HRIR buffer for one ear, without delay
-		 * @param table Table with the HRIR data
+		 * @param _distanceBucket Distance bucket with the HRIR data table and its grid topology
 		 * @param ear ear for which ear we want to get the HRIR
 		 * @param _azimuth azimuth angle in degrees
 		 * @param _elevation elevation angle in degrees
 		 * @param runTimeInterpolation switch run-time interpolation
-		 * @param _numberOfSubfilters number of subfilters in which the HRIR is divided
-		 * @param _subfilterLength subfilter length
-		 * @param stepVector steps of the oofline interpolation grid
 		 * @return HRIR interpolated buffer for specified ear  without delay
 		 *   \eh On error, an error code is reported to the error handler.
 		 *       Warnings may be reported to the error handler.
 		 */
-		static const TFRPartitions GetHRIRFromPartitionedTable(const TSphericalFIRTablePartitioned & table, Common::T_ear ear, float _azimuth, float _elevation,
-			bool runTimeInterpolation, int32_t _numberOfSubfilters, int32_t _subfilterLength, std::unordered_map<TOrientation, float> stepVector)
+		static const TFRPartitions GetHRIRFromPartitionedTable(const TDistanceBucket & _distanceBucket, Common::T_ear ear, float _azimuth, float _elevation, bool runTimeInterpolation)
 		{
-
-			float sphereBorder = SPHERE_BORDER;
-			float epsilon_sewing = EPSILON_SEWING;
-			float azimuthMin = DEFAULT_MIN_AZIMUTH;
-			float elevationMin = DEFAULT_MIN_ELEVATION;
-			float elevationNorth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::north);
-			float elevationSouth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::south);
-
 			TFRPartitions newHRIR;
-						
-
-			if (!runTimeInterpolation) {
-				TFRPartitionedStruct temp = CQuasiUniformSphereDistribution::FindNearest<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, stepVector, _azimuth, _elevation);
-
-				if (ear == Common::T_ear::LEFT) { newHRIR = temp.IR.left; }
-				else if (ear == Common::T_ear::RIGHT) { newHRIR = temp.IR.right; }
-				else { SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get HRIR for a wrong ear (BOTH or NONE)"); }
-
+			if (ear != Common::T_ear::LEFT && ear != Common::T_ear::RIGHT) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get HRIR for a wrong ear (BOTH or NONE)");
 				return newHRIR;
 			}
 
-			//  We have to do the run time interpolation -- (runTimeInterpolation = true)
-
-			// Check if we are close to 360 azimuth or elevation and change to 0
-			if (Common::AreSame(_azimuth, sphereBorder, epsilon_sewing)) { _azimuth = azimuthMin; }
-			if (Common::AreSame(_elevation, sphereBorder, epsilon_sewing)) { _elevation = elevationMin; }
-
-			// Check if we are at a pole
-			int ielevation = static_cast<int>(round(_elevation));
-			if ((ielevation == elevationNorth) || (ielevation == elevationSouth)) {
-				Common::CEarPair<TFRPartitions> data;
-				GetPoleHRIRFromPartitionedTable(table, data, ielevation, azimuthMin);
-				if (ear == Common::T_ear::LEFT) {
-					return data.left;
-				}
-				else {
-					return data.right;
-				}				
-			}
+			const TFRPartitionedStruct * point1 = nullptr;
+			const TFRPartitionedStruct * point2 = nullptr;
+			const TFRPartitionedStruct * point3 = nullptr;
+			TBarycentricCoordinatesStruct barycentricCoordinates;
 
-			// We search if the point already exists
-			auto it = table.find(TOrientation(_azimuth, _elevation));
-			if (it != table.end())
-			{
-				if (ear == Common::T_ear::LEFT)
-				{
-					newHRIR = it->second.IR.left;
-				}
-				else
-				{
-					newHRIR = it->second.IR.right;
+			if (FindGridPoints(_distanceBucket, _azimuth, _elevation, runTimeInterpolation, barycentricCoordinates, point1, point2, point3)) {
+				if (point2 == nullptr) {
+					point1->GetIR(ear, newHRIR);
+				} else if (point1->IsCompact()) {
+					if (ear == Common::T_ear::LEFT) {
+						CalculatePartitionedFR_FromBarycentricCoordinates(point1->compactIR.left, point2->compactIR.left, point3->compactIR.left, barycentricCoordinates, newHRIR);
+					} else {
+						CalculatePartitionedFR_FromBarycentricCoordinates(point1->compactIR.right, point2->compactIR.right, point3->compactIR.right, barycentricCoordinates, newHRIR);
+					}
+				} else if (ear == Common::T_ear::LEFT) {
+					CalculatePartitionedFR_FromBarycentricCoordinates(point1->IR.left, point2->IR.left, point3->IR.left, barycentricCoordinates, newHRIR);
+				} else {
+					CalculatePartitionedFR_FromBarycentricCoordinates(point1->IR.right, point2->IR.right, point3->IR.right, barycentricCoordinates, newHRIR);
 				}
-				return newHRIR;
-			}
-
-			// ONLINE Interpolation 	
-			if (ear == Common::T_ear::LEFT) {
-				const TFRPartitionedStruct data = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_LeftEar());
-				return data.IR.left;
-			}
-			else
-			{
-				const TFRPartitionedStruct data = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_RightEar());
-				return data.IR.right;
 			}
+			return newHRIR;
 		}
 
-		static const Common::CEarPair<TFRPartitions> GetHRIRFromPartitionedTable_2Ears(const TSphericalFIRTablePartitioned & table, float _azimuth, float _elevation,
-								bool runTimeInterpolation, int32_t _numberOfSubfilters, int32_t _subfilterLength, std::unordered_map<TOrientation, float> stepVector) {
-
-			float sphereBorder = SPHERE_BORDER;
-			float epsilon_sewing = EPSILON_SEWING;
-			float azimuthMin = DEFAULT_MIN_AZIMUTH;
-			float elevationMin = DEFAULT_MIN_ELEVATION;
-			float elevationNorth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::north);
-			float elevationSouth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::south);
+		/**
+		 * @brief Get interpolated and partitioned HRIR buffers for both ears, without delay
+		 * @param _distanceBucket Distance bucket with the HRIR data table and its grid topology
+		 * @param _azimuth azimuth angle in degrees
+		 * @param _elevation elevation angle in degrees
+		 * @param runTimeInterpolation switch run-time interpolation
+		 * @return HRIR interpolated buffers without delay
+		 *   \eh On error, an error code is reported to the error handler.
+		 *       Warnings may be reported to the error handler.
+		 */
+		static const Common::CEarPair<TFRPartitions> GetHRIRFromPartitionedTable_2Ears(const TDistanceBucket & _distanceBucket, float _azimuth, float _elevation, bool runTimeInterpolation) {
 
-			//std::vector<CMonoBuffer<float>> newHRIR;
 			Common::CEarPair<TFRPartitions> data;
 
-			if (!runTimeInterpolation) {								
-				TFRPartitionedStruct temp = CQuasiUniformSphereDistribution::FindNearest<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, stepVector, _azimuth, _elevation);
-				data = std::move(temp.IR);
-				/*if (ear == Common::T_ear::LEFT) {
-					newHRIR = temp.IR.left;
-				} else if (ear == Common::T_ear::RIGHT) {
-					newHRIR = temp.IR.right;
+			const TFRPartitionedStruct * point1 = nullptr;
+			const TFRPartitionedStruct * point2 = nullptr;
+			const TFRPartitionedStruct * point3 = nullptr;
+			TBarycentricCoordinatesStruct barycentricCoordinates;
+
+			if (FindGridPoints(_distanceBucket, _azimuth, _elevation, runTimeInterpolation, barycentricCoordinates, point1, point2, point3)) {
+				if (point2 == nullptr) {
+					point1->GetIR(Common::T_ear::LEFT, data.left);
+					point1->GetIR(Common::T_ear::RIGHT, data.right);
+				} else if (point1->IsCompact()) {
+					CalculatePartitionedFR_FromBarycentricCoordinates(point1->compactIR.left, point2->compactIR.left, point3->compactIR.left, barycentricCoordinates, data.left);
+					CalculatePartitionedFR_FromBarycentricCoordinates(point1->compactIR.right, point2->compactIR.right, point3->compactIR.right, barycentricCoordinates, data.right);
 				} else {
-					SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get HRIR for a wrong ear (BOTH or NONE)");
-				}*/
+					CalculatePartitionedFR_FromBarycentricCoordinates(point1->IR, point2->IR, point3->IR, barycentricCoordinates, data);
+				}
+			}
+			return data;
+		}
 
-				return data;
+		/**
+		 * @brief Get the grid points needed to obtain the TF of one orientation. When the orientation is in the grid, or run-time interpolation is off,
+			only the first point is returned. Otherwise, the three vertices of the enclosing triangle and their barycentric coordinates are returned.
+		 * @param _distanceBucket Distance bucket with the data table and its grid topology
+		 * @param _azimuth azimuth angle in degrees
+		 * @param _elevation elevation angle in degrees
+		 * @param runTimeInterpolation switch run-time interpolation
+		 * @param [out] _barycentricCoordinates barycentric coordinates of the orientation, only if three points are returned
+		 * @param [out] _point1 first grid point
+		 * @param [out] _point2 second grid point, nullptr if only one point is needed
+		 * @param [out] _point3 third grid point, nullptr if only one point is needed
+		 * @return false if the points could not be found
+		 */
+		static bool FindGridPoints(const TDistanceBucket & _distanceBucket, float _azimuth, float _elevation, bool runTimeInterpolation,
+			TBarycentricCoordinatesStruct & _barycentricCoordinates, const TFRPartitionedStruct *& _point1, const TFRPartitionedStruct *& _point2, const TFRPartitionedStruct *& _point3) {
+
+			_point1 = nullptr;
+			_point2 = nullptr;
+			_point3 = nullptr;
+
+			if (!runTimeInterpolation) {
+				_point1 = _distanceBucket.gridTopology.FindNearest(_azimuth, _elevation);
+				if (_point1 == nullptr) {
+					SET_RESULT(RESULT_ERROR_NOTSET, "Not found a TF close to the azimuth and elevation given in the GRID, this should not happen, it is a coding error.");
+					return false;
+				}
+				return true;
 			}
 
 			//  We have to do the run time interpolation -- (runTimeInterpolation = true)
 
 			// Check if we are close to 360 azimuth or elevation and change to 0
-			if (Common::AreSame(_azimuth, sphereBorder, epsilon_sewing)) {
-				_azimuth = azimuthMin;
-			}
-			if (Common::AreSame(_elevation, sphereBorder, epsilon_sewing)) {
-				_elevation = elevationMin;
-			}
+			if (Common::AreSame(_azimuth, SPHERE_BORDER, EPSILON_SEWING)) { _azimuth = DEFAULT_MIN_AZIMUTH; }
+			if (Common::AreSame(_elevation, SPHERE_BORDER, EPSILON_SEWING)) { _elevation = DEFAULT_MIN_ELEVATION; }
 
 			// Check if we are at a pole
 			int ielevation = static_cast<int>(round(_elevation));
-			if ((ielevation == elevationNorth) || (ielevation == elevationSouth)) {
-				GetPoleHRIRFromPartitionedTable(table, data, ielevation, azimuthMin);
-				return data;
+			if ((ielevation == ELEVATION_NORTH_POLE) || (ielevation == ELEVATION_SOUTH_POLE)) {
+				_point1 = _distanceBucket.gridTopology.FindNearest(DEFAULT_MIN_AZIMUTH, ielevation);
+				if (_point1 == nullptr) {
+					SET_RESULT(RESULT_WARNING, "Orientations in GetHRIR_partitioned() not found");
+					return false;
+				}
+				return true;
 			}
 
 			// We search if the point already exists
-			auto it = table.find(TOrientation(_azimuth, _elevation));
-			if (it != table.end()) {
-				data = it->second.IR;
-				/*if (ear == Common::T_ear::LEFT) {
-					newHRIR = it->second.IR.left;
-				} else {
-					newHRIR = it->second.IR.right;
-				}*/
-				return data;
+			auto it = _distanceBucket.table.find(TOrientation(_azimuth, _elevation));
+			if (it != _distanceBucket.table.end()) {
+				_point1 = &(it->second);
+				return true;
 			}
 
 			// ONLINE Interpolation
-			//if (ear == Common::T_ear::LEFT) {
-				//const TFRPartitionedStruct data = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_LeftEar());
-			//	return data.IR.left;
-			//} else {
-				//const TFRPartitionedStruct data = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_RightEar());
-				//return data.IR.right;
-			//}
-			TFRPartitionedStruct auxLeft = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_LeftEar());
-			TFRPartitionedStruct auxRight = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuth, _elevation, stepVector, CFIRTableAuxiliarMethods::CalculatePartitionedHRIR_FromBarycentricCoordinates_RightEar());
-			data.left = std::move(auxLeft.IR.left);
-			data.right =std::move(auxRight.IR.right);
-			
-			return data;
+			return CSlopesMethodOnlineInterpolator::FindTriangle(_distanceBucket.gridTopology, _azimuth, _elevation, _barycentricCoordinates, _point1, _point2, _point3);
 		}
+
 		/**
-		 * @brief Get HRIR from a pole
-		 * @param table Table with the HRIR data
-		 * @param newHRIR
-		 * @param ear
-		 * @param ielevation
-		 * @param azimuthMin
+		 * @brief Weighted sum of the partitioned FR of three grid points, using their barycentric coordinates. The whole set of partitions is processed
+			as contiguous blocks with a single multiply-add loop, so that the compiler can vectorise it.
+		 * @param _fr1 partitioned FR of the first vertex
+		 * @param _fr2 partitioned FR of the second vertex
+		 * @param _fr3 partitioned FR of the third vertex
+		 * @param _barycentricCoordinates weights of the vertices
+		 * @param [out] _outFR interpolated partitioned FR. Its buffers are reused if they already have the right size.
 		 */
-		static void GetPoleHRIRFromPartitionedTable(const TSphericalFIRTablePartitioned & table, Common::CEarPair<TFRPartitions> & newHRIR, int ielevation, float azimuthMin) {
-			auto it = table.find(TOrientation(azimuthMin, ielevation));
-			if (it != table.end())
-			{
-				newHRIR = it->second.IR;
-				/*if (ear == Common::T_ear::LEFT)
-				{
-					newHRIR = it->second.IR.left;
+		static void CalculatePartitionedFR_FromBarycentricCoordinates(const TFRPartitions & _fr1, const TFRPartitions & _fr2, const TFRPartitions & _fr3,
+			const TBarycentricCoordinatesStruct & _barycentricCoordinates, TFRPartitions & _outFR) {
+
+			const size_t numberOfSubfilters = _fr1.size();
+			if (_fr2.size() != numberOfSubfilters || _fr3.size() != numberOfSubfilters) {
+				SET_RESULT(RESULT_WARNING, "Partitioned FRs with different number of subfilters in CalculatePartitionedFR_FromBarycentricCoordinates()");
+				_outFR.clear();
+				return;
+			}
+
+			const float alpha = _barycentricCoordinates.alpha;
+			const float beta = _barycentricCoordinates.beta;
+			const float gamma = _barycentricCoordinates.gamma;
+
+			_outFR.resize(numberOfSubfilters);
+			for (size_t subfilterID = 0; subfilterID < numberOfSubfilters; subfilterID++) {
+				const size_t subfilterLength = _fr1[subfilterID].size();
+				_outFR[subfilterID].resize(subfilterLength);
+
+				const float * x1 = _fr1[subfilterID].data();
+				const float * x2 = _fr2[subfilterID].data();
+				const float * x3 = _fr3[subfilterID].data();
+				float * y = _outFR[subfilterID].data();
+				for (size_t i = 0; i < subfilterLength; i++) {
+					y[i] = alpha * x1[i] + beta * x2[i] + gamma * x3[i];
 				}
-				else
-				{
-					newHRIR = it->second.IR.right;
-				}*/
 			}
-			else
-			{
-				SET_RESULT(RESULT_WARNING, "Orientations in GetHRIR_partitioned() not found");
+		}
+
+		/**
+		 * @brief Weighted sum of the partitioned FR of three grid points, for both ears
+		 * @param _fr1 partitioned FR of the first vertex
+		 * @param _fr2 partitioned FR of the second vertex
+		 * @param _fr3 partitioned FR of the third vertex
+		 * @param _barycentricCoordinates weights of the vertices
+		 * @param [out] _outFR interpolated partitioned FR
+		 */
+		static void CalculatePartitionedFR_FromBarycentricCoordinates(const Common::CEarPair<TFRPartitions> & _fr1, const Common::CEarPair<TFRPartitions> & _fr2, const Common::CEarPair<TFRPartitions> & _fr3,
+			const TBarycentricCoordinatesStruct & _barycentricCoordinates, Common::CEarPair<TFRPartitions> & _outFR) {
+			CalculatePartitionedFR_FromBarycentricCoordinates(_fr1.left, _fr2.left, _fr3.left, _barycentricCoordinates, _outFR.left);
+			CalculatePartitionedFR_FromBarycentricCoordinates(_fr1.right, _fr2.right, _fr3.right, _barycentricCoordinates, _outFR.right);
+		}
+
+		/**
+		 * @brief Weighted sum of the partitioned FR of three grid points stored in compact form, with reduced precision or held outside the table.
+			The conversion to float is done inside the multiply-add loop.
+		 * @param _fr1 partitioned FR of the first vertex
+		 * @param _fr2 partitioned FR of the second vertex
+		 * @param _fr3 partitioned FR of the third vertex
+		 * @param _barycentricCoordinates weights of the vertices
+		 * @param [out] _outFR interpolated partitioned FR, with float precision
+		 */
+		static void CalculatePartitionedFR_FromBarycentricCoordinates(const TFRPartitionsCompact & _fr1, const TFRPartitionsCompact & _fr2, const TFRPartitionsCompact & _fr3,
+			const TBarycentricCoordinatesStruct & _barycentricCoordinates, TFRPartitions & _outFR) {
+
+			if (_fr2.GetNumberOfValues() != _fr1.GetNumberOfValues() || _fr3.GetNumberOfValues() != _fr1.GetNumberOfValues() || _fr2.precision != _fr1.precision || _fr3.precision != _fr1.precision) {
+				SET_RESULT(RESULT_WARNING, "Partitioned FRs with different size or format in CalculatePartitionedFR_FromBarycentricCoordinates()");
+				_outFR.clear();
+				return;
+			}
+			if (_fr1.precision == Common::TSpectralPrecision::float32) {
+				CalculateCompactPartitionedFR_FromBarycentricCoordinates<Common::TSpectralPrecision::float32>(_fr1, _fr2, _fr3, _barycentricCoordinates, _outFR);
+			} else if (_fr1.precision == Common::TSpectralPrecision::bfloat16) {
+				CalculateCompactPartitionedFR_FromBarycentricCoordinates<Common::TSpectralPrecision::bfloat16>(_fr1, _fr2, _fr3, _barycentricCoordinates, _outFR);
+			} else {
+				CalculateCompactPartitionedFR_FromBarycentricCoordinates<Common::TSpectralPrecision::float16>(_fr1, _fr2, _fr3, _barycentricCoordinates, _outFR);
 			}
 		}
 
+		template <Common::TSpectralPrecision P>
+		static void CalculateCompactPartitionedFR_FromBarycentricCoordinates(const TFRPartitionsCompact & _fr1, const TFRPartitionsCompact & _fr2, const TFRPartitionsCompact & _fr3,
+			const TBarycentricCoordinatesStruct & _barycentricCoordinates, TFRPartitions & _outFR) {
+
+			const float alpha = _barycentricCoordinates.alpha;
+			const float beta = _barycentricCoordinates.beta;
+			const float gamma = _barycentricCoordinates.gamma;
+
+			_outFR.resize(_fr1.numberOfSubfilters);
+			for (int32_t subfilterID = 0; subfilterID < _fr1.numberOfSubfilters; subfilterID++) {
+				_outFR[subfilterID].resize(_fr1.subfilterLength);
+
+				float * y = _outFR[subfilterID].data();
+				if constexpr (P == Common::TSpectralPrecision::float32) {
+					const float * x1 = _fr1.GetFloatSubfilter(subfilterID);
+					const float * x2 = _fr2.GetFloatSubfilter(subfilterID);
+					const float * x3 = _fr3.GetFloatSubfilter(subfilterID);
+					for (int32_t i = 0; i < _fr1.subfilterLength; i++) {
+						y[i] = alpha * x1[i] + beta * x2[i] + gamma * x3[i];
+					}
+				} else {
+					const uint16_t * x1 = _fr1.GetSubfilter(subfilterID);
+					const uint16_t * x2 = _fr2.GetSubfilter(subfilterID);
+					const uint16_t * x3 = _fr3.GetSubfilter(subfilterID);
+					for (int32_t i = 0; i < _fr1.subfilterLength; i++) {
+						y[i] = alpha * Common::CReducedPrecision::ToFloat<P>(x1[i]) + beta * Common::CReducedPrecision::ToFloat<P>(x2[i]) + gamma * Common::CReducedPrecision::ToFloat<P>(x3[i]);
+					}
+				}
+			}
+		}
 
 		//static TFRPartitionedStruct GetHRIRDelayFromPartitioned(const TSphericalFIRTablePartitioned& table, Common::T_ear ear, float _azimuthCenter, float _elevationCenter,
 		//	bool runTimeInterpolation, int32_t _numberOfSubfilters, int32_t _subfilterLength, std::unordered_map<TOrientation, float> stepVector)
@@ -378,73 +488,32 @@ namespace BRTServices {
 
 		//}
 
-		static const Common::CEarPair<uint64_t> GetHRIRDelayFromPartitioned_2Ears(const TSphericalFIRTablePartitioned & table, float _azimuthCenter, float _elevationCenter,
-			bool runTimeInterpolation, int32_t _numberOfSubfilters, int32_t _subfilterLength, std::unordered_map<TOrientation, float> stepVector) {
-
-			float sphereBorder = SPHERE_BORDER;
-			float epsilon_sewing = EPSILON_SEWING;
-			float azimuthMin = DEFAULT_MIN_AZIMUTH;
-			float elevationMin = DEFAULT_MIN_ELEVATION;
-			float elevationNorth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::north);
-			float elevationSouth = CInterpolationAuxiliarMethods::GetPoleElevation(TPole::south);
-
-			Common::CEarPair<uint64_t> foundData;
-
-			if (!runTimeInterpolation) {
-				TFRPartitionedStruct aux = CQuasiUniformSphereDistribution::FindNearest<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, stepVector, _azimuthCenter, _elevationCenter);
-				foundData.left = aux.delay.left;
-				foundData.right = aux.delay.right;
-				return foundData;
-			}
-
-			// Calculate Delay using ONLINE Interpolation
-
-			// Check if we are close to 360 azimuth or elevation and change to 0
-			if (Common::AreSame(_azimuthCenter, sphereBorder, epsilon_sewing)) {
-				_azimuthCenter = 0.0f;
-			}
-			if (Common::AreSame(_elevationCenter, sphereBorder, epsilon_sewing)) {
-				_elevationCenter = 0.0f;
-			}
+		/**
+		 * @brief Get the delay, in number of samples, for both ears
+		 * @param _distanceBucket Distance bucket with the HRIR data table and its grid topology
+		 * @param _azimuthCenter azimuth angle from the head center in degrees
+		 * @param _elevationCenter elevation angle from the head center in degrees
+		 * @param runTimeInterpolation switch run-time interpolation
+		 * @return delays for both ears
+		 */
+		static const Common::CEarPair<uint64_t> GetHRIRDelayFromPartitioned_2Ears(const TDistanceBucket & _distanceBucket, float _azimuthCenter, float _elevationCenter, bool runTimeInterpolation) {
 
-			// Check if we are at a pole
-			int ielevation = static_cast<int>(round(_elevationCenter));
-			if ((ielevation == elevationNorth) || (ielevation == elevationSouth)) {
-				/*float leftDelay;
-				float rightDelay;
-				GetPoleDelayFromHRIRPartitionedTable(table, leftDelay, Common::T_ear::LEFT, ielevation, azimuthMin);
-				GetPoleDelayFromHRIRPartitionedTable(table, rightDelay, Common::T_ear::RIGHT, ielevation, azimuthMin);
-				data.delay.left = static_cast<uint64_t>(leftDelay);
-				data.delay.right = static_cast<uint64_t>(rightDelay);*/
-				return GetPoleDelayFromHRIRPartitionedTable_2Ears(table, ielevation, azimuthMin);				
-			}
+			Common::CEarPair<uint64_t> foundData { 0, 0 };
 
-			// We search if the point already exists
-			auto it = table.find(TOrientation(_azimuthCenter, _elevationCenter));
-			if (it != table.end()) {
-				/*TFRPartitionedStruct temp;
-				temp.delay.left = it->second.delay.left;
-				temp.delay.right = it->second.delay.right;*/
-				foundData = it->second.delay;
-				return foundData;
-			}
+			const TFRPartitionedStruct * point1 = nullptr;
+			const TFRPartitionedStruct * point2 = nullptr;
+			const TFRPartitionedStruct * point3 = nullptr;
+			TBarycentricCoordinatesStruct barycentricCoordinates;
 
-			const TFRPartitionedStruct temp = CSlopesMethodOnlineInterpolator::CalculateTF_OnlineMethod<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(table, _numberOfSubfilters, _subfilterLength, _azimuthCenter, _elevationCenter, stepVector, CFIRTableAuxiliarMethods::CalculateDelay_FromBarycentricCoordinates());			
-			return temp.delay;
-		}
-
-		static const Common::CEarPair<uint64_t> GetPoleDelayFromHRIRPartitionedTable_2Ears(const TSphericalFIRTablePartitioned & table, int ielevation, float azimuthMin) {
-			
-			Common::CEarPair<uint64_t> data;
-			//In the sphere poles the azimuth is always 0 degrees
-			auto it = table.find(TOrientation(azimuthMin, ielevation));
-			if (it != table.end()) {
-				data.left = it->second.delay.left;
-				data.right = it->second.delay.right;				
-			} else {
-				SET_RESULT(RESULT_WARNING, "Orientations in GetHRIRDelay() not found");
+			if (FindGridPoints(_distanceBucket, _azimuthCenter, _elevationCenter, runTimeInterpolation, barycentricCoordinates, point1, point2, point3)) {
+				if (point2 == nullptr) {
+					foundData = point1->delay;
+				} else {
+					foundData.left = static_cast<unsigned long>(round(barycentricCoordinates.alpha * point1->delay.left + barycentricCoordinates.beta * point2->delay.left + barycentricCoordinates.gamma * point3->delay.left));
+					foundData.right = static_cast<unsigned long>(round(barycentricCoordinates.alpha * point1->delay.right + barycentricCoordinates.beta * point2->delay.right + barycentricCoordinates.gamma * point3->delay.right));
+				}
 			}
-			return data;
+			return foundData;
 		}
 
 		/** \brief	Calculate the ITD value for a specific source
@@ -482,87 +551,6 @@ namespace BRTServices {
 		}
 
 
-		/**
-		 * @brief Calculate HRIR subfilters using a barycentric coordinates of the three nearest orientation.
-		 * @param ear
-		 * @param barycentricCoordinates
-		 * @param orientation_pto1
-		 * @param orientation_pto2
-		 * @param orientation_pto3
-		 * @return
-		*/
-		struct CalculatePartitionedHRIR_FromBarycentricCoordinates_LeftEar{
-		const TFRPartitionedStruct operator()(const TSphericalFIRTablePartitioned& t_HRTF_Resampled_partitioned, int32_t partitionedFRNumberOfSubfilters, int32_t partitionedFRSubfilterLength, TBarycentricCoordinatesStruct barycentricCoordinates, TOrientation orientation_pto1, TOrientation orientation_pto2, TOrientation orientation_pto3)
-		{
-			TFRPartitionedStruct data;
-			
-			// Find the HRIR for the given t_HRTF_DataBase_ListOfOrientations
-			auto it1 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto1.azimuth, orientation_pto1.elevation));
-			auto it2 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto2.azimuth, orientation_pto2.elevation));
-			auto it3 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto3.azimuth, orientation_pto3.elevation));
-
-			if (it1 != t_HRTF_Resampled_partitioned.end() && it2 != t_HRTF_Resampled_partitioned.end() && it3 != t_HRTF_Resampled_partitioned.end())
-			{
-				int subfilterLength = partitionedFRSubfilterLength;
-				data.IR.left.resize(partitionedFRNumberOfSubfilters);
-
-				for (int subfilterID = 0; subfilterID < partitionedFRNumberOfSubfilters; subfilterID++)
-				{
-					data.IR.left[subfilterID].resize(subfilterLength);
-					for (int i = 0; i < subfilterLength; i++)
-					{
-						data.IR.left[subfilterID][i] = barycentricCoordinates.alpha * it1->second.IR.left[subfilterID][i] + barycentricCoordinates.beta * it2->second.IR.left[subfilterID][i] + barycentricCoordinates.gamma * it3->second.IR.left[subfilterID][i];
-					}
-				}
-			}
-			else {
-				SET_RESULT(RESULT_WARNING, "Orientations in CalculatePartitionedHRIR_FromBarycentricCoordinates_LeftEar() not found");
-			}
-
-			return data;
-		}
-		};
-
-		/**
-		 * @brief Calculate HRIR subfilters using a barycentric coordinates of the three nearest orientation.
-		 * @param ear
-		 * @param barycentricCoordinates
-		 * @param orientation_pto1
-		 * @param orientation_pto2
-		 * @param orientation_pto3
-		 * @return
-		*/
-		struct CalculatePartitionedHRIR_FromBarycentricCoordinates_RightEar {
-			const TFRPartitionedStruct operator()(const TSphericalFIRTablePartitioned& t_HRTF_Resampled_partitioned, int32_t partitionedFRNumberOfSubfilters, int32_t partitionedFRSubfilterLength, TBarycentricCoordinatesStruct barycentricCoordinates, TOrientation orientation_pto1, TOrientation orientation_pto2, TOrientation orientation_pto3)
-			{
-				TFRPartitionedStruct data;
-
-				// Find the HRIR for the given t_HRTF_DataBase_ListOfOrientations
-				auto it1 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto1.azimuth, orientation_pto1.elevation));
-				auto it2 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto2.azimuth, orientation_pto2.elevation));
-				auto it3 = t_HRTF_Resampled_partitioned.find(TOrientation(orientation_pto3.azimuth, orientation_pto3.elevation));
-
-				if (it1 != t_HRTF_Resampled_partitioned.end() && it2 != t_HRTF_Resampled_partitioned.end() && it3 != t_HRTF_Resampled_partitioned.end())
-				{
-					int subfilterLength = partitionedFRSubfilterLength;
-
-					data.IR.right.resize(partitionedFRNumberOfSubfilters);
-					for (int subfilterID = 0; subfilterID < partitionedFRNumberOfSubfilters; subfilterID++)
-					{
-						data.IR.right[subfilterID].resize(subfilterLength, 0.0f);
-						for (int i = 0; i < subfilterLength; i++)
-						{
-							data.IR.right[subfilterID][i] = barycentricCoordinates.alpha * it1->second.IR.right[subfilterID][i] + barycentricCoordinates.beta * it2->second.IR.right[subfilterID][i] + barycentricCoordinates.gamma * it3->second.IR.right[subfilterID][i];
-						}
-					}
-				}
-				else {
-					SET_RESULT(RESULT_WARNING, "Orientations in CalculatePartitionedHRIR_FromBarycentricCoordinates_RightEar() not found");
-				}
-				return data;
-			}
-		};
-
 		/**
 		 * @brief Calculate HRIR DELAY using a barycentric coordinates of the three nearest orientation, in number of samples
 		 * @param ear
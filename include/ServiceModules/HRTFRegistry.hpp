@@ -0,0 +1,382 @@
+/**
+* \class CHRTFRegistry
+*
+* \brief Declaration of CHRTFRegistry class.
+* \detail Process-wide store of HRTF tables. Tables are identified by the identity of their SOFA file (path, size and modification time)
+	and by the processing parameters, so that every listener asking for the same HRTF gets the same table. Tables can be built on
+	demand or in advance on a background thread, and the least recently used ones that are not in use are released when the memory
+	used by the registry exceeds a configurable cap.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CHRTF_REGISTRY_HPP
+#define _CHRTF_REGISTRY_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <Common/ErrorHandler.hpp>
+#include <Common/GlobalParameters.hpp>
+#include <Common/ReducedPrecision.hpp>
+#include <ServiceModules/ServicesBase.hpp>
+#include <ServiceModules/SphericalInterpolatedFIRTable.hpp>
+
+namespace BRTServices
+{
+	/**
+	 * @brief Processing parameters of a table of the registry
+	 */
+	struct THRTFRegistryParameters {
+		int spatialResolution = DEFAULT_GRIDSAMPLING_STEP;										///< Step of the resampled grid, in degrees
+		TEXTRAPOLATION_METHOD extrapolationMethod = TEXTRAPOLATION_METHOD::nearest_point;	///< Method used to fill the gaps of the measurements
+		Common::TSpectralPrecision precision = Common::TSpectralPrecision::float32;			///< Storage format of the resampled table
+		bool sharedMemory = false;															///< Share the resampled table with other processes
+	};
+
+	/**
+	 * @brief Activity counters of the registry
+	 */
+	struct THRTFRegistryCounters {
+		uint64_t hits = 0;				///< Requests answered with a table already built
+		uint64_t misses = 0;			///< Requests that needed to build a table, or to wait for it
+		uint64_t builds = 0;			///< Tables built
+		uint64_t failedBuilds = 0;		///< Tables that could not be built
+		uint64_t evictions = 0;			///< Tables released to stay under the memory cap
+		size_t numberOfTables = 0;		///< Tables currently stored
+		size_t memoryUsed = 0;			///< Memory used by the stored tables, in bytes
+		size_t memoryCap = 0;			///< Memory cap, in bytes. 0 means no cap.
+	};
+
+	class CHRTFRegistry {
+	public:
+		/**
+		 * @brief Function that fills a table with the data of a SOFA file, for instance:
+			[](const std::string & _file, std::shared_ptr<CSphericalInterpolatedFIRTable> _table, int _step, TEXTRAPOLATION_METHOD _method) {
+				BRTReaders::CSOFAReader reader;
+				return reader.ReadHRTFFromSofa(_file, _table, _step, _method);
+			}
+		 */
+		using TTableLoader = std::function<bool(const std::string & _sofaFile, std::shared_ptr<CSphericalInterpolatedFIRTable> _table, int _spatialResolution, TEXTRAPOLATION_METHOD _extrapolationMethod)>;
+
+		/**
+		 * @brief Create the registry and start its background thread
+		 * @param _loader function used to fill the tables
+		 * @param _memoryCap maximum memory used by the tables, in bytes. 0 means no cap.
+		 */
+		CHRTFRegistry(TTableLoader _loader, size_t _memoryCap = 0)
+			: loader { std::move(_loader) }
+			, memoryCap { _memoryCap }
+			, useTick { 0 }
+			, stopWorker { false } {
+			worker = std::thread(&CHRTFRegistry::WorkerLoop, this);
+		}
+
+		~CHRTFRegistry() {
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				stopWorker = true;
+			}
+			workerCondition.notify_all();
+			if (worker.joinable()) { worker.join(); }
+		}
+
+		CHRTFRegistry(const CHRTFRegistry &) = delete;
+		CHRTFRegistry & operator=(const CHRTFRegistry &) = delete;
+
+		/**
+		 * @brief Get a table, building it in the calling thread if it is not in the registry. If it is being built by another thread, this call waits for it.
+			The table is shared with every other user of the registry, so its data and settings must not be modified.
+		 * @param _sofaFile path of the SOFA file
+		 * @param _parameters processing parameters
+		 * @return the table, or nullptr if it could not be built
+		 */
+		std::shared_ptr<CSphericalInterpolatedFIRTable> Get(const std::string & _sofaFile, const THRTFRegistryParameters & _parameters = THRTFRegistryParameters()) {
+			TKey key;
+			if (!MakeKey(_sofaFile, _parameters, key)) { return nullptr; }
+
+			std::unique_lock<std::mutex> l(mutex);
+			auto it = entries.find(key);
+			if (it != entries.end() && it->second.state == TState::ready) {
+				counters.hits++;
+				it->second.lastUse = ++useTick;
+				return it->second.table;
+			}
+			counters.misses++;
+
+			if (it == entries.end() || it->second.state == TState::pending) {
+				// Build it here, the worker will skip it
+				entries[key].state = TState::building;
+				l.unlock();
+				Build(key);
+				l.lock();
+			} else {
+				buildCondition.wait(l, [&]() {
+					auto found = entries.find(key);
+					return found == entries.end() || found->second.state == TState::ready;
+				});
+			}
+
+			it = entries.find(key);
+			if (it == entries.end()) { return nullptr; }
+			it->second.lastUse = ++useTick;
+			return it->second.table;
+		}
+
+		/**
+		 * @brief Get a table only if it is already built. Otherwise, its building is requested in the background and nullptr is returned.
+			The table is shared with every other user of the registry, so its data and settings must not be modified.
+		 * @param _sofaFile path of the SOFA file
+		 * @param _parameters processing parameters
+		 * @return the table, or nullptr if it is not ready yet
+		 */
+		std::shared_ptr<CSphericalInterpolatedFIRTable> TryGet(const std::string & _sofaFile, const THRTFRegistryParameters & _parameters = THRTFRegistryParameters()) {
+			TKey key;
+			if (!MakeKey(_sofaFile, _parameters, key)) { return nullptr; }
+
+			std::lock_guard<std::mutex> l(mutex);
+			auto it = entries.find(key);
+			if (it != entries.end() && it->second.state == TState::ready) {
+				counters.hits++;
+				it->second.lastUse = ++useTick;
+				return it->second.table;
+			}
+			counters.misses++;
+			if (it == entries.end()) { Enqueue(key); }
+			return nullptr;
+		}
+
+		/**
+		 * @brief Request a table to be built in the background, if it is not in the registry. It does not modify the counters.
+		 * @param _sofaFile path of the SOFA file
+		 * @param _parameters processing parameters
+		 * @return false if the file cannot be found
+		 */
+		bool Preload(const std::string & _sofaFile, const THRTFRegistryParameters & _parameters = THRTFRegistryParameters()) {
+			TKey key;
+			if (!MakeKey(_sofaFile, _parameters, key)) { return false; }
+
+			std::lock_guard<std::mutex> l(mutex);
+			if (entries.find(key) == entries.end()) { Enqueue(key); }
+			return true;
+		}
+
+		/**
+		 * @brief Set the maximum memory used by the tables. Tables in use are never released, so the cap can be exceeded while they are in use.
+		 * @param _memoryCap maximum memory in bytes. 0 means no cap.
+		 */
+		void SetMemoryCap(size_t _memoryCap) {
+			std::lock_guard<std::mutex> l(mutex);
+			memoryCap = _memoryCap;
+			EvictUnusedTables();
+		}
+
+		/**
+		 * @brief Get the maximum memory used by the tables
+		 * @return memory cap in bytes. 0 means no cap.
+		 */
+		size_t GetMemoryCap() const {
+			std::lock_guard<std::mutex> l(mutex);
+			return memoryCap;
+		}
+
+		/**
+		 * @brief Release the tables that are not in use, even if the memory cap has not been reached
+		 */
+		void ReleaseUnusedTables() {
+			std::lock_guard<std::mutex> l(mutex);
+			for (auto it = entries.begin(); it != entries.end();) {
+				if (it->second.state == TState::ready && it->second.table.use_count() == 1) {
+					it = entries.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+
+		/**
+		 * @brief Get the activity counters and the memory used
+		 */
+		THRTFRegistryCounters GetCounters() const {
+			std::lock_guard<std::mutex> l(mutex);
+			THRTFRegistryCounters result = counters;
+			result.numberOfTables = 0;
+			result.memoryUsed = 0;
+			for (const auto & it : entries) {
+				if (it.second.state != TState::ready) { continue; }
+				result.numberOfTables++;
+				result.memoryUsed += it.second.memorySize;
+			}
+			result.memoryCap = memoryCap;
+			return result;
+		}
+
+		/**
+		 * @brief Set the hit, miss, build and eviction counters to zero
+		 */
+		void ResetCounters() {
+			std::lock_guard<std::mutex> l(mutex);
+			counters = THRTFRegistryCounters();
+		}
+
+	private:
+		enum class TState { pending, building, ready };
+
+		/// Identity of a table: file identity, processing parameters and global audio parameters
+		struct TKey {
+			std::string path;
+			uintmax_t fileSize = 0;
+			int64_t modificationTime = 0;
+			int spatialResolution = 0;
+			int extrapolationMethod = 0;
+			int precision = 0;
+			bool sharedMemory = false;
+			int sampleRate = 0;
+			int bufferSize = 0;
+
+			bool operator<(const TKey & _other) const {
+				return std::tie(path, fileSize, modificationTime, spatialResolution, extrapolationMethod, precision, sharedMemory, sampleRate, bufferSize)
+					< std::tie(_other.path, _other.fileSize, _other.modificationTime, _other.spatialResolution, _other.extrapolationMethod, _other.precision, _other.sharedMemory, _other.sampleRate, _other.bufferSize);
+			}
+		};
+
+		struct TEntry {
+			TState state = TState::pending;
+			std::shared_ptr<CSphericalInterpolatedFIRTable> table;
+			size_t memorySize = 0;		// Memory used by the table, in bytes
+			uint64_t lastUse = 0;		// Value of useTick the last time the table was handed out
+		};
+
+		/// Identify a file and a set of parameters. The file identity changes if the file is modified.
+		bool MakeKey(const std::string & _sofaFile, const THRTFRegistryParameters & _parameters, TKey & _key) const {
+			std::error_code error;
+			std::filesystem::path path = std::filesystem::canonical(_sofaFile, error);
+			if (error) {
+				SET_RESULT(RESULT_ERROR_FILE, "HRTF registry: file not found " + _sofaFile);
+				return false;
+			}
+			_key.path = path.string();
+			_key.fileSize = std::filesystem::file_size(path, error);
+			auto modificationTime = std::filesystem::last_write_time(path, error);
+			_key.modificationTime = static_cast<int64_t>(modificationTime.time_since_epoch().count());
+			_key.spatialResolution = _parameters.spatialResolution;
+			_key.extrapolationMethod = static_cast<int>(_parameters.extrapolationMethod);
+			_key.precision = static_cast<int>(_parameters.precision);
+			_key.sharedMemory = _parameters.sharedMemory;
+			_key.sampleRate = globalParameters.GetSampleRate();
+			_key.bufferSize = globalParameters.GetBufferSize();
+			return true;
+		}
+
+		/// Add a pending entry and wake the worker up. The mutex must be locked.
+		void Enqueue(const TKey & _key) {
+			entries[_key].state = TState::pending;
+			pendingKeys.push_back(_key);
+			workerCondition.notify_one();
+		}
+
+		/// Build the table of an entry in the building state, without holding the mutex
+		void Build(const TKey & _key) {
+			std::shared_ptr<CSphericalInterpolatedFIRTable> table = std::make_shared<CSphericalInterpolatedFIRTable>();
+			table->SetSpectralStoragePrecision(static_cast<Common::TSpectralPrecision>(_key.precision));
+			if (_key.sharedMemory) { table->EnableSharedMemory(); }
+			bool result = loader && loader(_key.path, table, _key.spatialResolution, static_cast<TEXTRAPOLATION_METHOD>(_key.extrapolationMethod));
+			size_t memorySize = result ? table->GetMemoryFootprint() : 0;
+
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				if (result) {
+					TEntry & entry = entries[_key];
+					entry.state = TState::ready;
+					entry.table = std::move(table);
+					entry.memorySize = memorySize;
+					entry.lastUse = ++useTick;
+					counters.builds++;
+					EvictUnusedTables(&_key);	// The new table has not been handed out yet, but it is about to be
+				} else {
+					entries.erase(_key);
+					counters.failedBuilds++;
+					SET_RESULT(RESULT_ERROR_UNKNOWN, "HRTF registry: the table of " + _key.path + " could not be built");
+				}
+			}
+			buildCondition.notify_all();
+		}
+
+		/// Release the least recently used tables that are not in use until the memory cap is met, except the one given. The mutex must be locked.
+		void EvictUnusedTables(const TKey * _keep = nullptr) {
+			if (memoryCap == 0) { return; }
+			size_t memoryUsed = 0;
+			for (const auto & it : entries) { memoryUsed += it.second.memorySize; }
+
+			while (memoryUsed > memoryCap) {
+				auto leastRecentlyUsed = entries.end();
+				for (auto it = entries.begin(); it != entries.end(); ++it) {
+					// The registry holds one reference, any other one means the table is in use
+					if (it->second.state != TState::ready || it->second.table.use_count() > 1) { continue; }
+					if (_keep != nullptr && !(it->first < *_keep) && !(*_keep < it->first)) { continue; }
+					if (leastRecentlyUsed == entries.end() || it->second.lastUse < leastRecentlyUsed->second.lastUse) { leastRecentlyUsed = it; }
+				}
+				if (leastRecentlyUsed == entries.end()) { return; }
+				memoryUsed -= leastRecentlyUsed->second.memorySize;
+				entries.erase(leastRecentlyUsed);
+				counters.evictions++;
+			}
+		}
+
+		/// Background thread, builds the pending tables in order of request
+		void WorkerLoop() {
+			std::unique_lock<std::mutex> l(mutex);
+			while (true) {
+				workerCondition.wait(l, [this]() { return stopWorker || !pendingKeys.empty(); });
+				if (stopWorker) { return; }
+
+				TKey key = pendingKeys.front();
+				pendingKeys.pop_front();
+				auto it = entries.find(key);
+				if (it == entries.end() || it->second.state != TState::pending) { continue; } // Built meanwhile by Get
+				it->second.state = TState::building;
+
+				l.unlock();
+				Build(key);
+				l.lock();
+			}
+		}
+
+		TTableLoader loader;							// Function used to fill the tables
+		Common::CGlobalParameters globalParameters;		// Global parameters of the system, part of the identity of the tables
+		mutable std::mutex mutex;						// Protects every attribute below
+		std::condition_variable buildCondition;			// Notified every time a build finishes
+		std::condition_variable workerCondition;		// Notified when there is work for the background thread
+		std::map<TKey, TEntry> entries;					// Tables, being built or ready
+		std::deque<TKey> pendingKeys;					// Tables waiting for the background thread
+		THRTFRegistryCounters counters;					// Activity counters
+		size_t memoryCap;								// Maximum memory used by the tables, 0 means no cap
+		uint64_t useTick;								// Monotonic counter used to order the tables by last use
+		bool stopWorker;								// Set to stop the background thread
+		std::thread worker;								// Background thread
+	};
+}
+#endif
@@ -27,9 +27,11 @@
 #define _CONLINE_INTERPOLATION_HPP
 
 
+#include <array>
 #include <unordered_map>
 #include <vector>
 #include <ServiceModules/InterpolationAuxiliarMethods.hpp>
+#include <ServiceModules/SphericalGridTopology.hpp>
 
 namespace BRTServices
 {
@@ -50,7 +52,7 @@ namespace BRTServices
 		 * @return 
 		*/
 		template <typename T, typename U, typename Functor>
-		U CalculateTF_OnlineMethod(const T& resampledTable, int32_t numberOfSubfilters, int32_t subfilterLength, float _azimuth, float _elevation, std::unordered_map<TOrientation, float> stepMap, Functor f) const
+		U CalculateTF_OnlineMethod(const T& resampledTable, int32_t numberOfSubfilters, int32_t subfilterLength, float _azimuth, float _elevation, const std::unordered_map<TOrientation, float> & stepMap, Functor f) const
 		{
 			U data;
 
@@ -162,7 +164,7 @@ namespace BRTServices
 		 * @param orientation_ptoP 
 		 * @param nearestElevations 
 		*/
-		void find_4Nearest_Points(float _azimuth, float _elevation, std::unordered_map<TOrientation, float> stepMap, TOrientation& orientation_ptoA, TOrientation& orientation_ptoB, TOrientation& orientation_ptoC, TOrientation& orientation_ptoD, TOrientation& orientation_ptoP, std::pair<float, float>& nearestElevations)const
+		void find_4Nearest_Points(float _azimuth, float _elevation, const std::unordered_map<TOrientation, float> & stepMap, TOrientation& orientation_ptoA, TOrientation& orientation_ptoB, TOrientation& orientation_ptoC, TOrientation& orientation_ptoD, TOrientation& orientation_ptoP, std::pair<float, float>& nearestElevations)const
 		{
 			float aziCeilBack, aziCeilFront, aziFloorBack, aziFloorFront;
 
@@ -248,7 +250,7 @@ namespace BRTServices
 		///**
 		// * @brief Calculate from resample table HRIR subfilters using a barycentric interpolation of the three nearest orientation.
 		template <typename T, typename U, typename Functor>
-		static U CalculateTF_OnlineMethod(const T& resampledTable, int32_t numberOfSubfilters, int32_t subfilterLength, float _azimuth, float _elevation, std::unordered_map<TOrientation, float> stepMap, Functor f)
+		static U CalculateTF_OnlineMethod(const T& resampledTable, int32_t numberOfSubfilters, int32_t subfilterLength, float _azimuth, float _elevation, const std::unordered_map<TOrientation, float> & stepMap, Functor f)
 		{
 			U data;
 			TBarycentricCoordinatesStruct barycentricCoordinates;
@@ -286,6 +288,53 @@ namespace BRTServices
 
 		}
 
+		/**
+		 * @brief Find, using the precomputed grid topology, the triangle of grid points that encloses the orientation of interest and its barycentric coordinates
+		 * @param _topology grid topology built at the end of the table setup
+		 * @param _azimuth 
+		 * @param _elevation 
+		 * @param [out] _barycentricCoordinates barycentric coordinates of the orientation of interest
+		 * @param [out] _point1 data of the first vertex of the triangle
+		 * @param [out] _point2 data of the second vertex of the triangle
+		 * @param [out] _point3 data of the third vertex of the triangle
+		 * @return true if the triangle has been found
+		*/
+		template <typename U>
+		static bool FindTriangle(const CSphericalGridTopology<U> & _topology, float _azimuth, float _elevation, TBarycentricCoordinatesStruct & _barycentricCoordinates, const U *& _point1, const U *& _point2, const U *& _point3)
+		{
+			TGridCell cell;
+			if (!_topology.FindCell(_azimuth, _elevation, cell)) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "Orientation not found in the grid topology in the ONline interpolation (FindTriangle)");
+				return false;
+			}
+
+			// SLOPE METHOD
+			// First make the slope of 2 points, always the same 2 points, A->D
+			float slopeDiagonalTrapezoid = std::abs((cell.D.elevation - cell.A.elevation) / (cell.D.azimuth - cell.A.azimuth));
+			float slopeOrientationOfInterest = std::abs((_elevation - cell.A.elevation) / (_azimuth - cell.A.azimuth));
+
+			// Uses A,C,D or A,B,D
+			const TOrientation & p1 = cell.A;
+			const TOrientation & p2 = (slopeOrientationOfInterest >= slopeDiagonalTrapezoid) ? cell.C : cell.B;
+			const TOrientation & p3 = cell.D;
+
+			_barycentricCoordinates = CInterpolationAuxiliarMethods::GetBarycentricCoordinates(_azimuth, _elevation, p1.azimuth, p1.elevation, p2.azimuth, p2.elevation, p3.azimuth, p3.elevation);
+			if (_barycentricCoordinates.alpha < 0.0f || _barycentricCoordinates.beta < 0.0f || _barycentricCoordinates.gamma < 0.0f) {
+				SET_RESULT(RESULT_WARNING, "No Barycentric coordinates Triangle in FindTriangle()");
+				return false;
+			}
+
+			// The topology wraps azimuth 360 and the poles to the points stored in the table
+			_point1 = _topology.FindNearest(p1.azimuth, p1.elevation);
+			_point2 = _topology.FindNearest(p2.azimuth, p2.elevation);
+			_point3 = _topology.FindNearest(p3.azimuth, p3.elevation);
+			if (_point1 == nullptr || _point2 == nullptr || _point3 == nullptr) {
+				SET_RESULT(RESULT_WARNING, "Orientations in FindTriangle() not found");
+				return false;
+			}
+			return true;
+		}
+
 	
 	private:
 			
@@ -349,7 +398,7 @@ namespace BRTServices
 		 * @param orientation_ptoP 
 		 * @param nearestElevations 
 		*/
-		static void Find_4Nearest_Points(float _azimuth, float _elevation, std::unordered_map<TOrientation, float> stepMap, TOrientation& orientation_ptoA, TOrientation& orientation_ptoB, TOrientation& orientation_ptoC, TOrientation& orientation_ptoD, TOrientation& orientation_ptoP, std::pair<float, float>& nearestElevations)
+		static void Find_4Nearest_Points(float _azimuth, float _elevation, const std::unordered_map<TOrientation, float> & stepMap, TOrientation& orientation_ptoA, TOrientation& orientation_ptoB, TOrientation& orientation_ptoC, TOrientation& orientation_ptoD, TOrientation& orientation_ptoP, std::pair<float, float>& nearestElevations)
 		{
 			float azimuthCeilBack, azimuthCeilFront, azimuthFloorBack, azimuthFloorFront;
 			float azimuthStepCeil, azimuthStepFloor;
@@ -25,11 +25,14 @@
 #ifndef _SERVICE_INTERFACES_H_
 #define _SERVICE_INTERFACES_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <Common/ErrorHandler.hpp>
 #include <Common/Buffer.hpp>
+#include <Common/ReducedPrecision.hpp>
 
 #define MAX_DISTANCE_BETWEEN_ELEVATIONS 5
 #define NUMBER_OF_PARTS 4 
@@ -299,13 +302,132 @@ namespace BRTServices {
 	
 	using TFRPartitions = std::vector<CMonoBuffer<float>>; 
 
+	/**
+	 * @brief Partitioned FR stored with a 16-bit format. All the subfilters are stored one after another in a single buffer.
+	 */
+	struct TFRPartitionsCompact {
+		Common::TSpectralPrecision precision;	///< Format of the data
+		int32_t numberOfSubfilters;				///< Number of subfilters
+		int32_t subfilterLength;				///< Length of every subfilter
+		Common::TAlignedVector<uint16_t> data;	///< Data of all the subfilters, 16-bit formats only
+		const void * externalData;				///< Data of all the subfilters owned by someone else, for instance a shared memory segment. Any format.
+
+		TFRPartitionsCompact()
+			: precision { Common::TSpectralPrecision::float16 }
+			, numberOfSubfilters { 0 }
+			, subfilterLength { 0 }
+			, externalData { nullptr }
+		{ }
+
+		bool IsEmpty() const { return data.empty() && externalData == nullptr; }
+
+		/**
+		 * @brief Get the number of values stored
+		 */
+		size_t GetNumberOfValues() const { return static_cast<size_t>(numberOfSubfilters) * subfilterLength; }
+
+		/**
+		 * @brief Get the data of one subfilter, stored with a 16-bit format
+		 * @param _subfilterID index of the subfilter
+		 * @return pointer to the first value of the subfilter
+		 */
+		const uint16_t * GetSubfilter(int32_t _subfilterID) const {
+			const uint16_t * values = externalData != nullptr ? static_cast<const uint16_t *>(externalData) : data.data();
+			return values + static_cast<size_t>(_subfilterID) * subfilterLength;
+		}
+
+		/**
+		 * @brief Get the data of one subfilter, stored as float. Only external data can have this format.
+		 * @param _subfilterID index of the subfilter
+		 * @return pointer to the first value of the subfilter
+		 */
+		const float * GetFloatSubfilter(int32_t _subfilterID) const { return static_cast<const float *>(externalData) + static_cast<size_t>(_subfilterID) * subfilterLength; }
+
+		/**
+		 * @brief Use data owned by someone else, without copying it. The data must outlive this object.
+		 * @param _data data of all the subfilters, one after the other
+		 * @param _precision format of the data, float32 is allowed
+		 * @param _numberOfSubfilters number of subfilters
+		 * @param _subfilterLength length of every subfilter
+		 */
+		void SetExternalData(const void * _data, Common::TSpectralPrecision _precision, int32_t _numberOfSubfilters, int32_t _subfilterLength) {
+			Common::TAlignedVector<uint16_t>().swap(data);
+			externalData = _data;
+			precision = _precision;
+			numberOfSubfilters = _numberOfSubfilters;
+			subfilterLength = _subfilterLength;
+		}
+
+		/**
+		 * @brief Store a partitioned FR. All the subfilters must have the same length.
+		 * @param _fr partitioned FR
+		 * @param _precision 16-bit format, float16 or bfloat16
+		 */
+		void Encode(const TFRPartitions & _fr, Common::TSpectralPrecision _precision) {
+			precision = _precision;
+			externalData = nullptr;
+			numberOfSubfilters = static_cast<int32_t>(_fr.size());
+			subfilterLength = _fr.empty() ? 0 : static_cast<int32_t>(_fr[0].size());
+			data.resize(GetNumberOfValues());
+			for (int32_t i = 0; i < numberOfSubfilters; i++) {
+				Common::CReducedPrecision::Encode(_fr[i].data(), data.data() + static_cast<size_t>(i) * subfilterLength, subfilterLength, precision);
+			}
+		}
+
+		/**
+		 * @brief Get the stored partitioned FR with float precision
+		 * @param [out] _fr partitioned FR
+		 */
+		void Decode(TFRPartitions & _fr) const {
+			_fr.resize(numberOfSubfilters);
+			for (int32_t i = 0; i < numberOfSubfilters; i++) {
+				_fr[i].resize(subfilterLength);
+				if (precision == Common::TSpectralPrecision::float32) {
+					std::copy(GetFloatSubfilter(i), GetFloatSubfilter(i) + subfilterLength, _fr[i].begin());
+				} else {
+					Common::CReducedPrecision::Decode(GetSubfilter(i), _fr[i].data(), subfilterLength, precision);
+				}
+			}
+		}
+	};
+
 	struct TFRPartitionedStruct { 
 		TOrientation orientation;			///< Orientation of the FR
 		Common::CEarPair<uint64_t> delay;	///< Delay, in number of samples
 		Common::CEarPair<TFRPartitions> IR; ///< Impulse response dataa		
+		Common::CEarPair<TFRPartitionsCompact> compactIR;	///< Impulse response data with reduced precision, or held outside this struct. When it is used, IR is empty.
 		TFRPartitionedStruct() 
 			: delay { 0, 0 } 
 		{ }
+
+		/**
+		 * @brief Check if the impulse response is stored in compactIR, with reduced precision or outside this struct
+		 */
+		bool IsCompact() const { return !compactIR.left.IsEmpty() || !compactIR.right.IsEmpty(); }
+
+		/**
+		 * @brief Move the impulse response to reduced precision storage, releasing the float data
+		 * @param _precision 16-bit format, float16 or bfloat16
+		 */
+		void Compact(Common::TSpectralPrecision _precision) {
+			compactIR.left.Encode(IR.left, _precision);
+			compactIR.right.Encode(IR.right, _precision);
+			TFRPartitions().swap(IR.left);
+			TFRPartitions().swap(IR.right);
+		}
+
+		/**
+		 * @brief Get the impulse response of one ear with float precision, whatever the storage is
+		 * @param _ear ear, LEFT or RIGHT
+		 * @param [out] _fr partitioned FR
+		 */
+		void GetIR(Common::T_ear _ear, TFRPartitions & _fr) const {
+			if (IsCompact()) {
+				(_ear == Common::T_ear::LEFT ? compactIR.left : compactIR.right).Decode(_fr);
+			} else {
+				_fr = (_ear == Common::T_ear::LEFT) ? IR.left : IR.right;
+			}
+		}
 	};
 			
 	struct TSOSFilterStruct {		
@@ -320,6 +442,28 @@ namespace BRTServices {
 			coefs.right = std::move(_coefs.right);
 		}
 	};
+
+	/**
+	 * @brief Coefficients of one ear held by a SOS table, without copying them. They remain valid until the next setup of the table.
+	 */
+	struct TSOSCoefficientsView {
+		const float * data;		///< First coefficient, nullptr if nothing was found
+		size_t size;			///< Number of coefficients
+		int64_t cell;			///< Table cell (distance and orientation) the coefficients belong to, -1 if nothing was found
+
+		TSOSCoefficientsView()
+			: data { nullptr }
+			, size { 0 }
+			, cell { -1 } { }
+		TSOSCoefficientsView(const float * _data, size_t _size, int64_t _cell)
+			: data { _data }
+			, size { _size }
+			, cell { _cell } { }
+
+		bool empty() const { return data == nullptr || size == 0; }
+		const float * begin() const { return data; }
+		const float * end() const { return data + size; }
+	};
 	
 	enum class TServiceType {
 		none,
@@ -340,11 +484,13 @@ namespace BRTServices {
 	public:
 		CServicesBase()
 			: serviceType { TServiceType::none }
-			, dataReady { false }
-			, spatiallyOriented { false }
 			, samplingRate { -1 }
 			, numberOfEars { 0 }
 			, impulseResponseLength { 0 }
+			, dataReady { false }
+			, spatiallyOriented { false }
+			, setupRevision { 0 }
+			, rawDataReleaseEnabled { false }
 			, title { "" }
 			, fileName { "" }
 			, databaseName { "" }
@@ -358,8 +504,11 @@ namespace BRTServices {
 		virtual void DisableWoodworthITD() { };
 		virtual bool IsWoodworthITDEnabled() const { return false; }
 
-		virtual const int32_t GetNumberOfSubfiltersFR() const { return 0; }
-		virtual const int32_t GetSubfilterLengthFR() const { return 0; }
+		virtual int32_t GetNumberOfSubfiltersFR() const { return 0; }
+		virtual int32_t GetSubfilterLengthFR() const { return 0; }
+
+		virtual void SetSpectralStoragePrecision(Common::TSpectralPrecision _precision) { }
+		virtual Common::TSpectralPrecision GetSpectralStoragePrecision() const { return Common::TSpectralPrecision::float32; }
 
 		virtual void SetHeadRadius(float _headRadius) { };
 		virtual float GetHeadRadius() const { return 0.0f; }
@@ -376,6 +525,38 @@ namespace BRTServices {
 
 		virtual void SetGridSamplingStep(int _samplingStep) {}
 		virtual int GetGridSamplingStep() const { return 0; }
+
+		virtual void EnableSharedMemory() { }
+		virtual void DisableSharedMemory() { }
+		virtual bool IsSharedMemoryEnabled() const { return false; }
+		virtual bool IsUsingSharedMemory() const { return false; }
+
+		virtual void EnablePipelinedSetup(int _numberOfThreads = 0) { }
+		virtual void DisablePipelinedSetup() { }
+		virtual bool IsPipelinedSetupEnabled() const { return false; }
+
+		virtual void EnableProgressiveSetup() { }
+		virtual void DisableProgressiveSetup() { }
+		virtual bool IsProgressiveSetupEnabled() const { return false; }
+		virtual bool WaitForFullResolution() { return true; }
+
+		/**
+		 * @brief Release the raw data once the table has been built from it. The setup needs less memory, as the raw data is processed
+			in place instead of copied, and only the built table is kept. The windowing parameters cannot be changed afterwards, since
+			that needs the raw data. It has to be set before EndSetup. It has no effect in the services that do not keep raw data.
+		 */
+		virtual void EnableRawDataRelease() { rawDataReleaseEnabled = true; }
+
+		/**
+		 * @brief Keep the raw data after the setup. It has to be set before EndSetup.
+		 */
+		virtual void DisableRawDataRelease() { rawDataReleaseEnabled = false; }
+
+		/**
+		 * @brief Check if the raw data is released once the table has been built
+		 */
+		virtual bool IsRawDataReleaseEnabled() const { return rawDataReleaseEnabled; }
+		virtual size_t GetMemoryFootprint() const { return 0; }
 				
 		virtual bool BeginSetup() { return false; }
 		virtual bool BeginSetup(const int32_t & _IRLength, const BRTServices::TEXTRAPOLATION_METHOD & _extrapolationMethod) { return false; }
@@ -388,6 +569,7 @@ namespace BRTServices {
 		virtual bool AddSphericalFIRTable(std::shared_ptr<BRTServices::CServicesBase> _listenerIRData) { return false; }
 
 		virtual const std::vector<float> GetSOSCoefficients_SpatiallyOriented(float _azimuth, float _elevation, float _distance, Common::T_ear ear) const { return std::vector<float>(); }
+		virtual TSOSCoefficientsView GetSOSCoefficientsView_SpatiallyOriented(float _azimuth, float _elevation, float _distance, Common::T_ear ear) const { return TSOSCoefficientsView(); }
 		virtual const Common::CEarPair<CMonoBuffer<float>> GetSOSCoefficients_2Ears() const { return Common::CEarPair<CMonoBuffer<float>>(); }
 		
 		virtual const TFRPartitions GetFR_AmbisonicChannel(const int & channel, const Common::T_ear & _ear, const Common::CTransform & _referencePosition) { return TFRPartitions(); }
@@ -412,6 +594,13 @@ namespace BRTServices {
 
 		bool IsDataReady() { return dataReady; }
 
+		/**
+		 * @brief Get the revision of the service data, which changes every time the data is rebuilt or cleared. Consumers that keep data
+			obtained from the service can compare it to know if that data is still valid.
+		 * @return setup revision
+		 */
+		uint32_t GetSetupRevision() const { return setupRevision; }
+
 		bool IsSpatiallyOriented() const { return spatiallyOriented; }
 		
 		
@@ -499,6 +688,22 @@ namespace BRTServices {
 		
 		bool dataReady;					// Variable indicating whether the data has been loaded correctly.
 		bool spatiallyOriented;			// Variable that indicates if the IRs are spatially oriented, if the are IR for different azimuths and elevations or not. 
+		std::atomic<uint32_t> setupRevision;	// Incremented every time the service data is rebuilt or cleared
+		bool rawDataReleaseEnabled;		// Release the raw data once the table has been built
+
+		/**
+		 * @brief Check if the raw data of a table already set up has been released, so it cannot be processed again. The error handler
+			is informed if so. The mutex of the table must be locked.
+		 * @param _rawDataEmpty true if the table holds no raw data
+		 * @return true if the raw data has been released
+		 */
+		bool IsRawDataReleased(bool _rawDataEmpty) const {
+			if (dataReady && _rawDataEmpty) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "The raw data of this table has been released, so it cannot be processed again with new windowing parameters");
+				return true;
+			}
+			return false;
+		}
 
 	private:
 		std::string ID;
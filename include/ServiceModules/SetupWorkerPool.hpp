@@ -0,0 +1,144 @@
+/**
+* \class CSetupWorkerPool
+*
+* \brief Declaration of CSetupWorkerPool class.
+* \detail Small pool of worker threads used by the services to process the data of each measurement while the rest of the
+	measurements are still being read, instead of doing all the work at the end of the setup.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CSETUP_WORKER_POOL_HPP
+#define _CSETUP_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Common/ErrorHandler.hpp>
+
+namespace BRTServices
+{
+	class CSetupWorkerPool {
+	public:
+		/**
+		 * @brief Start the worker threads
+		 * @param _numberOfThreads number of threads. With 0, one less than the number of hardware threads is used, and at least one.
+		 */
+		CSetupWorkerPool(int _numberOfThreads = 0)
+			: pendingTasks { 0 }
+			, failedTasks { 0 }
+			, stopRequested { false } {
+
+			if (_numberOfThreads <= 0) {
+				const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+				_numberOfThreads = hardwareThreads > 1 ? static_cast<int>(hardwareThreads) - 1 : 1;
+			}
+			workers.reserve(_numberOfThreads);
+			for (int i = 0; i < _numberOfThreads; i++) {
+				workers.emplace_back([this]() { WorkerLoop(); });
+			}
+		}
+
+		/**
+		 * @brief Stop the worker threads. Tasks that have not started yet are discarded.
+		 */
+		~CSetupWorkerPool() {
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				stopRequested = true;
+			}
+			taskCondition.notify_all();
+			for (auto & worker : workers) {
+				if (worker.joinable()) { worker.join(); }
+			}
+		}
+
+		CSetupWorkerPool(const CSetupWorkerPool &) = delete;
+		CSetupWorkerPool & operator=(const CSetupWorkerPool &) = delete;
+
+		/**
+		 * @brief Queue a task to be run by one of the worker threads
+		 * @param _task task. It must not throw, but if it does the failure is reported by Wait.
+		 */
+		void Submit(std::function<void()> _task) {
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				tasks.push_back(std::move(_task));
+				pendingTasks++;
+			}
+			taskCondition.notify_one();
+		}
+
+		/**
+		 * @brief Block until every submitted task has finished
+		 * @return true if none of the tasks finished since the previous call has failed
+		 */
+		bool Wait() {
+			std::unique_lock<std::mutex> l(mutex);
+			doneCondition.wait(l, [this]() { return pendingTasks == 0; });
+			const bool success = failedTasks == 0;
+			failedTasks = 0;
+			return success;
+		}
+
+		/**
+		 * @brief Get the number of worker threads
+		 */
+		int GetNumberOfThreads() const { return static_cast<int>(workers.size()); }
+
+	private:
+		void WorkerLoop() {
+			while (true) {
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> l(mutex);
+					taskCondition.wait(l, [this]() { return stopRequested || !tasks.empty(); });
+					if (stopRequested) { return; }
+					task = std::move(tasks.front());
+					tasks.pop_front();
+				}
+				bool success = true;
+				try {
+					task();
+				} catch (...) {
+					success = false;
+					SET_RESULT(RESULT_ERROR_EXCEPTION, "Exception in a setup worker thread");
+				}
+				{
+					std::lock_guard<std::mutex> l(mutex);
+					if (!success) { failedTasks++; }
+					pendingTasks--;
+				}
+				doneCondition.notify_all();
+			}
+		}
+
+		std::mutex mutex;								// Protects the queue and the counters
+		std::condition_variable taskCondition;			// Notified when a task is queued or the pool is stopped
+		std::condition_variable doneCondition;			// Notified when a task finishes
+		std::deque<std::function<void()>> tasks;		// Tasks not started yet
+		std::vector<std::thread> workers;				// Worker threads
+		std::size_t pendingTasks;						// Tasks queued or running
+		std::size_t failedTasks;						// Tasks that have thrown since the last Wait
+		bool stopRequested;								// Set when the pool is being destroyed
+	};
+}
+#endif
@@ -0,0 +1,458 @@
+/**
+* \class CSharedFIRTableImage
+*
+* \brief Declaration of CSharedFIRTableImage class.
+* \detail Flat image of a resampled and partitioned FIR table, written once into a named shared memory segment so that other processes
+	can use it without repeating the offline processing. The segment name is derived from a hash of the raw data and of every processing
+	parameter, so tables are only shared when they would have been identical. The tables that use an image hold views into the segment.
+	The header records which process is writing the image and when it started, so that an image left half written by a process that
+	has crashed is removed and published again. A segment whose header has not been written yet is taken as being written too.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CSHARED_FIR_TABLE_IMAGE_HPP
+#define _CSHARED_FIR_TABLE_IMAGE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Common/ErrorHandler.hpp>
+#include <Common/ReducedPrecision.hpp>
+#include <Common/SharedMemorySegment.hpp>
+#include <ServiceModules/ServicesBase.hpp>
+#include <ServiceModules/SphericalFIRTableDefinitions.hpp>
+
+/** \brief Time, in seconds, after which an image that is still being written is considered abandoned, even if its publisher seems to be running */
+#ifndef SHARED_FIR_TABLE_PUBLISH_TIMEOUT
+#define SHARED_FIR_TABLE_PUBLISH_TIMEOUT 60
+#endif
+
+namespace BRTServices
+{
+	/**
+	 * @brief Processing parameters that, together with the raw data, determine the content of a resampled table
+	 */
+	struct TSharedFIRTableParameters {
+		int32_t serviceType = 0;
+		int32_t sampleRate = 0;
+		int32_t bufferSize = 0;
+		int32_t impulseResponseLength = 0;	///< Length given in BeginSetup
+		int32_t gridSamplingStep = 0;
+		int32_t gapThreshold = 0;
+		int32_t extrapolationMethod = 0;
+		int32_t precision = 0;				///< Storage format of the spectra
+		float fadeInBegin = 0;
+		float riseTime = 0;
+		float fadeOutCutoff = 0;
+		float fallTime = 0;
+	};
+
+	/**
+	 * @brief Dimensions of the partitioned data of a resampled table
+	 */
+	struct TSharedFIRTableLayout {
+		int32_t impulseResponseLength = 0;	///< Length after windowing
+		int32_t numberOfSubfilters = 0;
+		int32_t subfilterLength = 0;
+		Common::TSpectralPrecision precision = Common::TSpectralPrecision::float32;
+	};
+
+	class CSharedFIRTableImage {
+	public:
+
+		/**
+		 * @brief Calculate the content key of a table
+		 * @param _rawData raw data added to the table, before any processing
+		 * @param _parameters processing parameters
+		 * @return 64-bit key
+		 */
+		static uint64_t CalculateKey(const TRawSofaData & _rawData, const TSharedFIRTableParameters & _parameters) {
+			uint64_t hash = HASH_SEED;
+			hash = HashValue(hash, FORMAT_VERSION);
+			hash = HashBytes(hash, &_parameters, sizeof(_parameters));
+			hash = HashValue(hash, static_cast<uint64_t>(_rawData.size()));
+			for (const TSofaDataBucket & it : _rawData) {
+				const float position[3] = { it.referencePosition.x, it.referencePosition.y, it.referencePosition.z };
+				const double orientation[3] = { it.data.orientation.azimuth, it.data.orientation.elevation, it.data.orientation.distance };
+				hash = HashBytes(hash, position, sizeof(position));
+				hash = HashBytes(hash, orientation, sizeof(orientation));
+				hash = HashValue(hash, it.data.delay.left);
+				hash = HashValue(hash, it.data.delay.right);
+				hash = HashValue(hash, static_cast<uint64_t>(it.data.IR.left.size()));
+				hash = HashBytes(hash, it.data.IR.left.data(), it.data.IR.left.size() * sizeof(float));
+				hash = HashValue(hash, static_cast<uint64_t>(it.data.IR.right.size()));
+				hash = HashBytes(hash, it.data.IR.right.data(), it.data.IR.right.size() * sizeof(float));
+			}
+			return hash;
+		}
+
+		/**
+		 * @brief Get the name of the shared memory segment of a table
+		 * @param _key content key of the table
+		 * @return segment name
+		 */
+		static std::string GetSegmentName(uint64_t _key) {
+			char name[32];
+			std::snprintf(name, sizeof(name), "brt_fir_%016llx", static_cast<unsigned long long>(_key));
+			return std::string(name);
+		}
+
+		/**
+		 * @brief Open the image of a table published by this or another process. An image abandoned before being completed is removed,
+			so that it can be published again.
+		 * @param _key content key of the table
+		 * @return the segment, or nullptr if there is no complete image with that key
+		 */
+		static std::shared_ptr<Common::CSharedMemorySegment> Open(uint64_t _key) {
+			std::shared_ptr<Common::CSharedMemorySegment> segment = Common::CSharedMemorySegment::Open(GetSegmentName(_key));
+			if (!segment) { return nullptr; }
+
+			// Until its header is written, the publisher of an image is not known
+			const THeader * header = nullptr;
+			if (!IsHeaderPending(*segment)) {
+				header = GetHeader(*segment);
+				if (header == nullptr || header->key != _key) {
+					SET_RESULT(RESULT_WARNING, "The shared memory segment " + segment->GetName() + " does not hold a valid table image, it will be removed");
+					Common::CSharedMemorySegment::Remove(segment->GetName());
+					return nullptr;
+				}
+				if (header->ready.load(std::memory_order_acquire) == 1) { return segment; }
+			}
+			if (header == nullptr ? IsPendingHeaderAbandoned(*segment) : IsAbandoned(*header)) {
+				SET_RESULT(RESULT_WARNING, "The shared memory segment " + segment->GetName() + " was abandoned before being completed, it will be removed and the table will be processed locally");
+				Common::CSharedMemorySegment::Remove(segment->GetName());
+			} else {
+				SET_RESULT(RESULT_WARNING, "The shared memory segment " + segment->GetName() + " is still being written, the table will be processed locally");
+			}
+			return nullptr;
+		}
+
+		/**
+		 * @brief Write the image of a processed table into a new shared memory segment. It fails if the segment already exists.
+		 * @param _key content key of the table
+		 * @param _layout dimensions of the partitioned data
+		 * @param _table resampled table, by distance buckets. Its data can be stored in any format, but all of it must have the layout one.
+		 * @param _stepVector grid steps of the resampled table
+		 * @return the segment, or nullptr if it could not be created
+		 */
+		static std::shared_ptr<Common::CSharedMemorySegment> Publish(uint64_t _key, const TSharedFIRTableLayout & _layout, const TDistanceTable & _table, const std::unordered_map<TOrientation, float> & _stepVector) {
+			const uint64_t earDataSize = Align(GetEarDataSize(_layout));
+
+			// Size of every region
+			uint64_t numberOfEntries = 0;
+			for (const TDistanceBucket & bucket : _table) { numberOfEntries += bucket.table.size(); }
+			const uint64_t stepsOffset = Align(sizeof(THeader));
+			const uint64_t bucketsOffset = Align(stepsOffset + _stepVector.size() * sizeof(TStep));
+			const uint64_t entriesOffset = Align(bucketsOffset + _table.size() * sizeof(TBucket));
+			const uint64_t dataOffset = Align(entriesOffset + numberOfEntries * sizeof(TEntry));
+			const uint64_t totalSize = dataOffset + numberOfEntries * 2 * earDataSize;
+
+			std::shared_ptr<Common::CSharedMemorySegment> segment = Common::CSharedMemorySegment::Create(GetSegmentName(_key), static_cast<size_t>(totalSize));
+			if (!segment && RemoveIfAbandoned(_key)) {
+				segment = Common::CSharedMemorySegment::Create(GetSegmentName(_key), static_cast<size_t>(totalSize));
+			}
+			if (!segment) {
+				SET_RESULT(RESULT_WARNING, "The shared memory segment " + GetSegmentName(_key) + " could not be created, the table will not be shared");
+				return nullptr;
+			}
+			uint8_t * base = static_cast<uint8_t *>(segment->GetWritableData());
+
+			// Until the magic is written the segment is only zeros, which other processes take as an image that is still being written.
+			// The publisher and the time are written before it, so that they are valid as soon as the magic is.
+			THeader * header = new (base) THeader();
+			header->publisherProcessId = Common::CSharedMemorySegment::GetProcessIdentifier();
+			header->creationTime = GetCurrentTime();
+			header->version = FORMAT_VERSION;
+			std::atomic_thread_fence(std::memory_order_release);
+			std::memcpy(header->magic, MAGIC, sizeof(header->magic));
+			header->key = _key;
+			header->totalSize = totalSize;
+			header->impulseResponseLength = _layout.impulseResponseLength;
+			header->numberOfSubfilters = _layout.numberOfSubfilters;
+			header->subfilterLength = _layout.subfilterLength;
+			header->precision = static_cast<int32_t>(_layout.precision);
+			header->numberOfSteps = static_cast<uint32_t>(_stepVector.size());
+			header->numberOfBuckets = static_cast<uint32_t>(_table.size());
+			header->stepsOffset = stepsOffset;
+			header->bucketsOffset = bucketsOffset;
+
+			TStep * steps = reinterpret_cast<TStep *>(base + stepsOffset);
+			for (const auto & it : _stepVector) {
+				*steps++ = TStep { it.first.azimuth, it.first.elevation, it.first.distance, it.second };
+			}
+
+			TBucket * buckets = reinterpret_cast<TBucket *>(base + bucketsOffset);
+			TEntry * entries = reinterpret_cast<TEntry *>(base + entriesOffset);
+			uint64_t entryOffset = entriesOffset;
+			uint64_t earOffset = dataOffset;
+			for (const TDistanceBucket & bucket : _table) {
+				*buckets++ = TBucket { bucket.distance_mm, static_cast<uint32_t>(bucket.table.size()), entryOffset };
+				for (const auto & it : bucket.table) {
+					TEntry & entry = *entries++;
+					entry.azimuthKey = it.first.azimuth_q;
+					entry.elevationKey = it.first.elevation_q;
+					entry.distanceKey = it.first.distance_q;
+					entry.azimuth = it.second.orientation.azimuth;
+					entry.elevation = it.second.orientation.elevation;
+					entry.distance = it.second.orientation.distance;
+					entry.delayLeft = it.second.delay.left;
+					entry.delayRight = it.second.delay.right;
+					entry.leftOffset = earOffset;
+					WriteEarData(base + earOffset, _layout, it.second, Common::T_ear::LEFT);
+					earOffset += earDataSize;
+					entry.rightOffset = earOffset;
+					WriteEarData(base + earOffset, _layout, it.second, Common::T_ear::RIGHT);
+					earOffset += earDataSize;
+					entryOffset += sizeof(TEntry);
+				}
+			}
+
+			// Other processes only use the image once this flag is set
+			header->ready.store(1, std::memory_order_release);
+			return segment;
+		}
+
+		/**
+		 * @brief Fill a table with views into an image. No data is copied, so the segment must outlive the table.
+		 * @param _segment segment holding the image
+		 * @param [out] _layout dimensions of the partitioned data
+		 * @param [out] _table resampled table, by distance buckets. The grid topology of the buckets is not built.
+		 * @param [out] _stepVector grid steps of the resampled table
+		 * @return false if the image is not valid
+		 */
+		static bool Load(const Common::CSharedMemorySegment & _segment, TSharedFIRTableLayout & _layout, TDistanceTable & _table, std::unordered_map<TOrientation, float> & _stepVector) {
+			const THeader * header = GetHeader(_segment);
+			if (header == nullptr) { return false; }
+			const uint8_t * base = static_cast<const uint8_t *>(_segment.GetData());
+			const uint64_t totalSize = header->totalSize;
+
+			_layout.impulseResponseLength = header->impulseResponseLength;
+			_layout.numberOfSubfilters = header->numberOfSubfilters;
+			_layout.subfilterLength = header->subfilterLength;
+			_layout.precision = static_cast<Common::TSpectralPrecision>(header->precision);
+			const uint64_t earDataSize = GetEarDataSize(_layout);
+
+			if (!IsInside(header->stepsOffset, header->numberOfSteps * sizeof(TStep), totalSize) || !IsInside(header->bucketsOffset, header->numberOfBuckets * sizeof(TBucket), totalSize)) {
+				return false;
+			}
+
+			_stepVector.clear();
+			const TStep * steps = reinterpret_cast<const TStep *>(base + header->stepsOffset);
+			for (uint32_t i = 0; i < header->numberOfSteps; i++) {
+				_stepVector.emplace(TOrientation(steps[i].azimuth, steps[i].elevation, steps[i].distance), steps[i].step);
+			}
+
+			_table.clear();
+			_table.resize(header->numberOfBuckets);
+			const TBucket * buckets = reinterpret_cast<const TBucket *>(base + header->bucketsOffset);
+			for (uint32_t i = 0; i < header->numberOfBuckets; i++) {
+				if (!IsInside(buckets[i].entriesOffset, buckets[i].numberOfEntries * sizeof(TEntry), totalSize)) { return false; }
+				_table[i].distance_mm = buckets[i].distance_mm;
+				_table[i].table.reserve(buckets[i].numberOfEntries);
+
+				const TEntry * entries = reinterpret_cast<const TEntry *>(base + buckets[i].entriesOffset);
+				for (uint32_t j = 0; j < buckets[i].numberOfEntries; j++) {
+					const TEntry & entry = entries[j];
+					if (!IsInside(entry.leftOffset, earDataSize, totalSize) || !IsInside(entry.rightOffset, earDataSize, totalSize)) { return false; }
+
+					TOrientation_key key;
+					key.azimuth_q = entry.azimuthKey;
+					key.elevation_q = entry.elevationKey;
+					key.distance_q = entry.distanceKey;
+
+					TFRPartitionedStruct data;
+					data.orientation = TOrientation(entry.azimuth, entry.elevation, entry.distance);
+					data.delay.left = entry.delayLeft;
+					data.delay.right = entry.delayRight;
+					data.compactIR.left.SetExternalData(base + entry.leftOffset, _layout.precision, _layout.numberOfSubfilters, _layout.subfilterLength);
+					data.compactIR.right.SetExternalData(base + entry.rightOffset, _layout.precision, _layout.numberOfSubfilters, _layout.subfilterLength);
+					_table[i].table.emplace(key, std::move(data));
+				}
+			}
+			return true;
+		}
+
+	private:
+		static constexpr uint32_t FORMAT_VERSION = 2;
+		static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+		static constexpr uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+		static constexpr uint64_t ALIGNMENT = 64;	// Cache line, so that every subfilter array starts aligned
+		static constexpr char MAGIC[8] = { 'B', 'R', 'T', 'S', 'H', 'M', '0', '1' };
+
+		struct THeader {
+			char magic[8];
+			uint32_t version;
+			std::atomic<uint32_t> ready;	// Set to 1 once the whole image has been written
+			uint64_t publisherProcessId;	// Process that writes the image
+			int64_t creationTime;			// Seconds since the epoch when the publisher started writing the image
+			uint64_t key;
+			uint64_t totalSize;
+			int32_t impulseResponseLength;
+			int32_t numberOfSubfilters;
+			int32_t subfilterLength;
+			int32_t precision;
+			uint32_t numberOfSteps;
+			uint32_t numberOfBuckets;
+			uint64_t stepsOffset;
+			uint64_t bucketsOffset;
+		};
+
+		struct TStep {
+			double azimuth;
+			double elevation;
+			double distance;
+			float step;
+		};
+
+		struct TBucket {
+			int32_t distance_mm;
+			uint32_t numberOfEntries;
+			uint64_t entriesOffset;
+		};
+
+		struct TEntry {
+			int32_t azimuthKey;
+			int32_t elevationKey;
+			int32_t distanceKey;
+			double azimuth;
+			double elevation;
+			double distance;
+			uint64_t delayLeft;
+			uint64_t delayRight;
+			uint64_t leftOffset;		// Offsets from the beginning of the segment
+			uint64_t rightOffset;
+		};
+
+		static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The ready flag must be a plain 32-bit word to be shared between processes");
+
+		/// Get the header of an image, nullptr if the segment does not hold a valid image
+		static const THeader * GetHeader(const Common::CSharedMemorySegment & _segment) {
+			if (_segment.GetSize() < sizeof(THeader)) { return nullptr; }
+			const THeader * header = static_cast<const THeader *>(_segment.GetData());
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 || header->version != FORMAT_VERSION || header->totalSize > _segment.GetSize()) {
+				return nullptr;
+			}
+			return header;
+		}
+
+		/// Check if the publisher of a segment has not finished writing the magic of its header yet. The segment is created filled with
+		/// zeros and the magic is written byte by byte, so each byte is either zero or already the one of the magic.
+		static bool IsHeaderPending(const Common::CSharedMemorySegment & _segment) {
+			if (_segment.GetSize() < sizeof(THeader)) { return true; }
+			const char * magic = static_cast<const char *>(_segment.GetData());
+			bool complete = true;
+			for (size_t i = 0; i < sizeof(MAGIC); i++) {
+				if (magic[i] != 0 && magic[i] != MAGIC[i]) { return false; }
+				complete = complete && magic[i] == MAGIC[i];
+			}
+			return !complete;
+		}
+
+		/// Check if a segment whose header has not been written will never be. Without a header its publisher is not known, so it is
+		/// considered abandoned only if nobody has written it for too long.
+		static bool IsPendingHeaderAbandoned(const Common::CSharedMemorySegment & _segment) {
+			const int64_t modificationTime = _segment.GetModificationTime();
+			if (modificationTime < 0) { return false; }
+			const int64_t elapsed = GetCurrentTime() - modificationTime;
+			return elapsed < 0 || elapsed > SHARED_FIR_TABLE_PUBLISH_TIMEOUT;
+		}
+
+		/// Seconds since the epoch, the same clock in every process
+		static int64_t GetCurrentTime() {
+			return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		/// Check if an image that is not ready will never be, because its publisher has finished or has taken too long
+		static bool IsAbandoned(const THeader & _header) {
+			if (!Common::CSharedMemorySegment::IsProcessRunning(_header.publisherProcessId)) { return true; }
+			const int64_t elapsed = GetCurrentTime() - _header.creationTime;
+			return elapsed < 0 || elapsed > SHARED_FIR_TABLE_PUBLISH_TIMEOUT;
+		}
+
+		/// Remove the segment of a key if it holds an image that is not valid or has been abandoned
+		static bool RemoveIfAbandoned(uint64_t _key) {
+			std::shared_ptr<Common::CSharedMemorySegment> segment = Common::CSharedMemorySegment::Open(GetSegmentName(_key));
+			if (!segment) { return false; }
+			if (IsHeaderPending(*segment) && !IsPendingHeaderAbandoned(*segment)) { return false; }
+			const THeader * header = GetHeader(*segment);
+			if (header != nullptr && header->key == _key && (header->ready.load(std::memory_order_acquire) == 1 || !IsAbandoned(*header))) { return false; }
+			return Common::CSharedMemorySegment::Remove(segment->GetName());
+		}
+
+		/// Size in bytes of the partitioned data of one ear
+		static uint64_t GetEarDataSize(const TSharedFIRTableLayout & _layout) {
+			const uint64_t valueSize = _layout.precision == Common::TSpectralPrecision::float32 ? sizeof(float) : sizeof(uint16_t);
+			return static_cast<uint64_t>(_layout.numberOfSubfilters) * _layout.subfilterLength * valueSize;
+		}
+
+		/// Copy the partitioned data of one ear, which can be stored in any format, into the image
+		static void WriteEarData(uint8_t * _destination, const TSharedFIRTableLayout & _layout, const TFRPartitionedStruct & _data, Common::T_ear _ear) {
+			const size_t subfilterLength = static_cast<size_t>(_layout.subfilterLength);
+			if (_data.IsCompact()) {
+				const TFRPartitionsCompact & compact = (_ear == Common::T_ear::LEFT) ? _data.compactIR.left : _data.compactIR.right;
+				for (int32_t i = 0; i < _layout.numberOfSubfilters; i++) {
+					if (_layout.precision == Common::TSpectralPrecision::float32) {
+						std::memcpy(_destination + i * subfilterLength * sizeof(float), compact.GetFloatSubfilter(i), subfilterLength * sizeof(float));
+					} else {
+						std::memcpy(_destination + i * subfilterLength * sizeof(uint16_t), compact.GetSubfilter(i), subfilterLength * sizeof(uint16_t));
+					}
+				}
+			} else {
+				const TFRPartitions & partitions = (_ear == Common::T_ear::LEFT) ? _data.IR.left : _data.IR.right;
+				for (int32_t i = 0; i < _layout.numberOfSubfilters; i++) {
+					std::memcpy(_destination + i * subfilterLength * sizeof(float), partitions[i].data(), subfilterLength * sizeof(float));
+				}
+			}
+		}
+
+		static uint64_t Align(uint64_t _offset) { return (_offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+		static bool IsInside(uint64_t _offset, uint64_t _size, uint64_t _totalSize) { return _offset <= _totalSize && _size <= _totalSize - _offset; }
+
+		static uint64_t HashValue(uint64_t _hash, uint64_t _value) {
+			_hash = (_hash ^ _value) * HASH_MULTIPLIER;
+			return _hash ^ (_hash >> 29);
+		}
+
+		/// Hash a block of bytes, 8 at a time
+		static uint64_t HashBytes(uint64_t _hash, const void * _data, size_t _size) {
+			const uint8_t * bytes = static_cast<const uint8_t *>(_data);
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= _size; i += sizeof(uint64_t)) {
+				uint64_t word;
+				std::memcpy(&word, bytes + i, sizeof(word));
+				_hash = HashValue(_hash, word);
+			}
+			if (i < _size) {
+				uint64_t word = 0;
+				std::memcpy(&word, bytes + i, _size - i);
+				_hash = HashValue(_hash, word);
+			}
+			return _hash;
+		}
+	};
+}
+#endif
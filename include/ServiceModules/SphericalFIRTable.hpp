@@ -27,6 +27,8 @@
 #include <vector>
 #include <utility>
 #include <list>
+#include <deque>
+#include <memory>
 #include <cstdint>
 #include <Common/Buffer.hpp>
 #include <Common/ErrorHandler.hpp>
@@ -41,6 +43,7 @@
 #include <ServiceModules/OfflineInterpolationAuxiliarMethods.hpp>
 #include <ServiceModules/InterpolationAuxiliarMethods.hpp>
 #include <ServiceModules/SphericalSearchKDTree.hpp>
+#include <ServiceModules/SetupWorkerPool.hpp>
 
 namespace BRTBase { class CListener; }
 
@@ -67,6 +70,7 @@ namespace BRTServices
 			, riseTime { 0 }
 			, fadeOutCutoff { 0 }
 			, fallTime { 0 }			
+			, spectralStoragePrecision { Common::TSpectralPrecision::float32 }
 		{ 			
 		}
 								
@@ -91,13 +95,13 @@ namespace BRTServices
 		*	\retval n Number of HRIR subfilters
 		*   \eh Nothing is reported to the error handler.
 		*/
-		const int32_t GetNumberOfSubfiltersFR() const override { return partitionedFRNumberOfSubfilters; }
+		int32_t GetNumberOfSubfiltersFR() const override { return partitionedFRNumberOfSubfilters; }
 
 		/** \brief	Get the size of subfilters (blocks) in which the HRIR has been partitioned, every subfilter has the same size
 		*	\retval size Size of HRIR subfilters
 		*   \eh Nothing is reported to the error handler.
 		*/
-		const int32_t GetSubfilterLengthFR() const override { return partitionedFRSubfilterLength;	}
+		int32_t GetSubfilterLengthFR() const override { return partitionedFRSubfilterLength;	}
 		
 		/** \brief	Set the radius of the listener head
 		*   \eh Nothing is reported to the error handler.
@@ -169,6 +173,61 @@ namespace BRTServices
 			originalCranialGeometry = cranialGeometry;
 		}
 
+		/**
+		 * @brief Set the format used to store the partitioned table. With a 16-bit format the table needs half of the memory, see
+			Common::TSpectralPrecision for the accuracy. It has to be set before EndSetup.
+		 * @param _precision storage format
+		 */
+		void SetSpectralStoragePrecision(Common::TSpectralPrecision _precision) override {
+			spectralStoragePrecision = _precision;
+		}
+
+		/**
+		 * @brief Get the format used to store the partitioned table
+		 * @return storage format
+		 */
+		Common::TSpectralPrecision GetSpectralStoragePrecision() const override {
+			return spectralStoragePrecision;
+		}
+
+		/**
+		 * @brief Process every IR on worker threads as soon as it is added (windowing and partitioned FFT), so that the processing
+			overlaps the reading of the rest of the IRs. EndSetup only has to do the steps that need all the IRs. It has to be set before BeginSetup.
+		 * @param _numberOfThreads number of worker threads. With 0, one less than the number of hardware threads is used.
+		 */
+		void EnablePipelinedSetup(int _numberOfThreads = 0) override {
+			if (setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Pipelined setup cannot be enabled while a setup is in progress");
+				return;
+			}
+			setupWorkerPool = std::make_unique<CSetupWorkerPool>(_numberOfThreads);
+		}
+
+		/**
+		 * @brief Process all the IRs in EndSetup, in the calling thread. It has to be set before BeginSetup.
+		 */
+		void DisablePipelinedSetup() override {
+			if (setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Pipelined setup cannot be disabled while a setup is in progress");
+				return;
+			}
+			setupWorkerPool.reset();
+		}
+
+		/**
+		 * @brief Check if the IRs are processed on worker threads while they are added
+		 */
+		bool IsPipelinedSetupEnabled() const override { return setupWorkerPool != nullptr; }
+
+		/**
+		 * @brief Get the memory used by the table data: the raw data and the partitioned table
+		 * @return size in bytes
+		 */
+		size_t GetMemoryFootprint() const override {
+			std::lock_guard<std::mutex> l(mutex);
+			return CalculateMemoryFootprint();
+		}
+
 		/** 
 		* @brief Get the closest distance at which IR has been measured from a current reference location, azimuth, and elevation. 
 		*/
@@ -191,12 +250,18 @@ namespace BRTServices
 		 */
 		void SetWindowingParameters(float _fadeInBegin, float _riseTime, float _fadeOutCutoff, float _fallTime) override {
 			mutex.lock();
+			if (IsRawDataReleased(sofaIRDataBase.empty())) {
+				mutex.unlock();
+				return;
+			}
 			fadeInBegin = _fadeInBegin;
 			riseTime = _riseTime;
 			fadeOutCutoff = _fadeOutCutoff;
 			fallTime = _fallTime;
 
 			mutex.unlock();
+			// IRs already processed with the previous parameters are processed again in EndSetup
+			DiscardPipelinedIRs();
 			if (dataReady) {
 				setupInProgress = true;
 				dataReady = false;				
@@ -233,6 +298,7 @@ namespace BRTServices
 			spatiallyOriented = false;
 
 			// Clear every table						
+			DiscardPipelinedIRs();
 			sofaIRDataBase.clear();			
 			partitionedFRDataBase.clear();
 			referencePositionSearchList.clear();
@@ -270,6 +336,8 @@ namespace BRTServices
 			newData.referencePosition = _referencePosition;
 			newData.data = std::forward<TIRStruct>(newIRData);			
 			sofaIRDataBase.push_back(std::forward<TSofaDataBucket>(newData));				
+
+			if (setupWorkerPool) { SubmitPipelinedIR(sofaIRDataBase.back().data); }
 		}
 
 		/** \brief Stop the HRTF configuration
@@ -293,12 +361,33 @@ namespace BRTServices
 			}							
 			if (sofaIRDataBase.size() > 1) spatiallyOriented = true;					
 					
-			TRawSofaData windowingIRTable;
-			CalculateWindowingIRTable(sofaIRDataBase, windowingIRTable);
-			if (serviceType == TServiceType::hrir_database) {
-				CFIRTableAuxiliarMethods::RemoveCommonDelayFromTable(windowingIRTable); 
-			}					
-			SetupPartitionedTable(windowingIRTable);	// Prepare and fill all the partitioned table					
+			if (WaitForPipelinedIRs()) {
+				// Every IR has been windowed and partitioned while it was added, only the steps that need the whole table are left
+				if (pipelinedIRs.front().windowed) {
+					impulseResponseLength = pipelinedIRs.front().impulseResponseLength;
+					partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
+				}
+				if (serviceType == TServiceType::hrir_database) {
+					CFIRTableAuxiliarMethods::RemoveCommonDelay(pipelinedIRs, [](TPipelinedIR & _ir) -> Common::CEarPair<uint64_t> & { return _ir.partitionedIR.delay; });
+				}
+				SetupPartitionedTableFromPipeline();
+			} else {
+				TRawSofaData windowingIRTable;
+				if (rawDataReleaseEnabled) {
+					// The raw data is not kept, so it is windowed in place instead of copied
+					windowingIRTable = std::move(sofaIRDataBase);
+					sofaIRDataBase.clear();
+				} else {
+					windowingIRTable = sofaIRDataBase;
+				}
+				CalculateWindowingIRTable(windowingIRTable);
+				if (serviceType == TServiceType::hrir_database) {
+					CFIRTableAuxiliarMethods::RemoveCommonDelayFromTable(windowingIRTable); 
+				}					
+				SetupPartitionedTable(windowingIRTable);	// Prepare and fill all the partitioned table					
+			}
+			pipelinedIRs.clear();
+			if (rawDataReleaseEnabled) { TRawSofaData().swap(sofaIRDataBase); }
 			SortFRTableByDistance();					// Sort frequency domain table by distance from listener
 			BuildSearchTrees();							// Prepare all Search Trees
 			BuildReferenceListFromMap();				// Prepare reference position search list					
@@ -310,14 +399,17 @@ namespace BRTServices
 					if (it->second.distances.begin()->table.size() != 0) {
 						if (it->second.distances.begin()->table.begin()->second.IR.left.size() != 0) {								
 							partitionedFRSubfilterLength = it->second.distances.begin()->table.begin()->second.IR.left[0].size();								
+							CompactTable();
 							setupInProgress = false;
 							dataReady = true;
-							SET_RESULT(RESULT_OK, "The processing of the IR matrix has been successfully completed.");
+							setupRevision++;
+							SET_RESULT(RESULT_OK, "The processing of the IR matrix has been successfully completed, memory footprint " + std::to_string(CalculateMemoryFootprint()) + " bytes.");
 							return true;
 						}
 					}											
 				}					
 			}																									
+			return false;
 		}
 					
 		/**
@@ -509,65 +601,133 @@ namespace BRTServices
 			return static_cast<int>(std::ceil(partitions));
 		}
 
-		void SetupPartitionedTable(const TRawSofaData & _originalDataBase) {
+		/**
+		 * @brief Fill the partitioned table. The time domain data of every IR is released as soon as it has been partitioned.
+		 * @param _windowedDataBase windowed IRs
+		 */
+		void SetupPartitionedTable(TRawSofaData & _windowedDataBase) {
 			
-			for (auto itRawData = _originalDataBase.begin(); itRawData != _originalDataBase.end(); itRawData++) {
-				const Common::CVector3 _referencePosition = itRawData->referencePosition;
-				const double _azimuth = itRawData->data.orientation.azimuth;
-				const double _elevation = itRawData->data.orientation.elevation;
-				const double _distance = itRawData->data.orientation.distance;
-
-				const TVector3_key refKey(_referencePosition);
-				// Check if the reference Position is already in the table
-				auto refIt = partitionedFRDataBase.find(refKey);
-				if (refIt == partitionedFRDataBase.end()) {
-					// Create new reference position
-					TReferenceBucket newRef;
-					newRef.referenceKey = refKey;
-					newRef.referencePos = _referencePosition;
-
-					auto inserted = partitionedFRDataBase.emplace(refKey, std::move(newRef));
-					if (!inserted.second) {
-						SET_RESULT(RESULT_ERROR_BADALLOC, "Error emplacing IR into database. Reference Position [" + std::to_string(_referencePosition.x) + ", " + std::to_string(_referencePosition.y) + std::to_string(_referencePosition.z) + "], n position [" + std::to_string(_azimuth) + ", " + std::to_string(_elevation) + ", " + std::to_string(_distance) + "]");
-						return;
-					}
-					refIt = inserted.first;
-				}
+			for (auto itRawData = _windowedDataBase.begin(); itRawData != _windowedDataBase.end(); itRawData++) {
+				TFRPartitionedStruct newPartitionedIRData;
+				CalculatePartitionedIR(itRawData->data, newPartitionedIRData, globalParameters.GetBufferSize(), partitionedFRNumberOfSubfilters, CFIRTableAuxiliarMethods::SplitAndGetFFT_FRData());
+				itRawData->data.IR.left = CMonoBuffer<float>();
+				itRawData->data.IR.right = CMonoBuffer<float>();
+				if (!AddPartitionedIR(itRawData->referencePosition, std::move(newPartitionedIRData))) { return; }
+			}
+		}
 
-				// Find o create orientation bucket
-				TReferenceBucket & refBucket = refIt->second;
-				TDistanceBucket * distanceBucket = nullptr;
+		/**
+		 * @brief Fill the partitioned table with the IRs processed by the worker threads
+		 */
+		void SetupPartitionedTableFromPipeline() {
+			auto itRawData = sofaIRDataBase.begin();
+			for (auto itPipelined = pipelinedIRs.begin(); itPipelined != pipelinedIRs.end(); itPipelined++, itRawData++) {
+				if (!AddPartitionedIR(itRawData->referencePosition, std::move(itPipelined->partitionedIR))) { return; }
+			}
+		}
 
-				const int32_t distance_mm = quantise_dist_mm(_distance);
-				for (auto & distBucketIt : refBucket.distances) {
-					if (distBucketIt.distance_mm == distance_mm) {
-						distanceBucket = &distBucketIt;
-						break;
-					}
+		/**
+		 * @brief Emplace one partitioned IR into the bucket of its reference position and distance, creating the buckets if needed
+		 * @param _referencePosition reference position of the IR
+		 * @param _partitionedIR partitioned IR, with its orientation
+		 * @return false if the reference position bucket could not be created
+		 */
+		bool AddPartitionedIR(const Common::CVector3 & _referencePosition, TFRPartitionedStruct && _partitionedIR) {
+			const double _azimuth = _partitionedIR.orientation.azimuth;
+			const double _elevation = _partitionedIR.orientation.elevation;
+			const double _distance = _partitionedIR.orientation.distance;
+
+			const TVector3_key refKey(_referencePosition);
+			// Check if the reference Position is already in the table
+			auto refIt = partitionedFRDataBase.find(refKey);
+			if (refIt == partitionedFRDataBase.end()) {
+				// Create new reference position
+				TReferenceBucket newRef;
+				newRef.referenceKey = refKey;
+				newRef.referencePos = _referencePosition;
+
+				auto inserted = partitionedFRDataBase.emplace(refKey, std::move(newRef));
+				if (!inserted.second) {
+					SET_RESULT(RESULT_ERROR_BADALLOC, "Error emplacing IR into database. Reference Position [" + std::to_string(_referencePosition.x) + ", " + std::to_string(_referencePosition.y) + std::to_string(_referencePosition.z) + "], n position [" + std::to_string(_azimuth) + ", " + std::to_string(_elevation) + ", " + std::to_string(_distance) + "]");
+					return false;
 				}
+				refIt = inserted.first;
+			}
 
-				if (!distanceBucket) {
-					// Create new distance bucket
-					TDistanceBucket newDist;
-					newDist.distance_mm = distance_mm;
-					refBucket.distances.push_back(std::move(newDist));
-					distanceBucket = &refBucket.distances.back();
+			// Find o create orientation bucket
+			TReferenceBucket & refBucket = refIt->second;
+			TDistanceBucket * distanceBucket = nullptr;
+
+			const int32_t distance_mm = quantise_dist_mm(_distance);
+			for (auto & distBucketIt : refBucket.distances) {
+				if (distBucketIt.distance_mm == distance_mm) {
+					distanceBucket = &distBucketIt;
+					break;
 				}
+			}
 
-				// Emplace new IR into orientation table
-				const double _azimuthInRage = CInterpolationAuxiliarMethods::NormalizeAzimuth0_360(_azimuth);
-				const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
+			if (!distanceBucket) {
+				// Create new distance bucket
+				TDistanceBucket newDist;
+				newDist.distance_mm = distance_mm;
+				refBucket.distances.push_back(std::move(newDist));
+				distanceBucket = &refBucket.distances.back();
+			}
 
-				TFRPartitionedStruct newPartitionedIRData;
-				CalculatePartitionedIR(itRawData->data, newPartitionedIRData, globalParameters.GetBufferSize(), partitionedFRNumberOfSubfilters, CFIRTableAuxiliarMethods::SplitAndGetFFT_FRData());
-				//Emplace new IR into orientation table
-				auto emplaced = distanceBucket->table.emplace(TOrientation_key(_azimuthInRage, _elevationInRange, _distance), std::move(newPartitionedIRData));
-				if (!emplaced.second) {
-					SET_RESULT(RESULT_ERROR_BADALLOC, "Error emplacing IR into database. Reference Position [" + std::to_string(_referencePosition.x) + ", " + std::to_string(_referencePosition.y) + std::to_string(_referencePosition.z) + "], n position [" + std::to_string(_azimuthInRage) + ", " + std::to_string(_elevationInRange) + ", " + std::to_string(_distance) + "]");					
-				}
+			// Emplace new IR into orientation table
+			const double _azimuthInRage = CInterpolationAuxiliarMethods::NormalizeAzimuth0_360(_azimuth);
+			const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
+
+			auto emplaced = distanceBucket->table.emplace(TOrientation_key(_azimuthInRage, _elevationInRange, _distance), std::move(_partitionedIR));
+			if (!emplaced.second) {
+				SET_RESULT(RESULT_ERROR_BADALLOC, "Error emplacing IR into database. Reference Position [" + std::to_string(_referencePosition.x) + ", " + std::to_string(_referencePosition.y) + std::to_string(_referencePosition.z) + "], n position [" + std::to_string(_azimuthInRage) + ", " + std::to_string(_elevationInRange) + ", " + std::to_string(_distance) + "]");					
 			}
+			return true;
 		}
-		
+
+		/**
+		 * @brief Queue the windowing and partitioning of one IR on the worker threads. The result is stored in pipelinedIRs, in the
+			same position as the IR in sofaIRDataBase.
+		 * @param _ir IR just added, it is copied so the raw data is kept
+		 */
+		void SubmitPipelinedIR(const TIRStruct & _ir) {
+			pipelinedIRs.emplace_back();
+			TPipelinedIR & result = pipelinedIRs.back();	// Elements of a deque do not move when more elements are added
+			
+			const float _fadeInBegin = fadeInBegin;
+			const float _riseTime = riseTime;
+			const float _fadeOutCutoff = fadeOutCutoff;
+			const float _fallTime = fallTime;
+			const int sampleRate = globalParameters.GetSampleRate();
+			const int bufferSize = globalParameters.GetBufferSize();
+			const int numberOfSubfilters = partitionedFRNumberOfSubfilters;
+
+			setupWorkerPool->Submit([&result, ir = _ir, _fadeInBegin, _riseTime, _fadeOutCutoff, _fallTime, sampleRate, bufferSize, numberOfSubfilters]() mutable {
+				result.windowed = CFIRTableAuxiliarMethods::CalculateWindowingIR(ir, _fadeInBegin, _riseTime, _fadeOutCutoff, _fallTime, sampleRate);
+				result.impulseResponseLength = static_cast<int32_t>(ir.IR.left.size());
+				result.partitionedIR = CFIRTableAuxiliarMethods::SplitAndGetFFT_FRData()(ir, bufferSize, numberOfSubfilters);
+				result.partitionedIR.orientation = ir.orientation;
+			});
+		}
+
+		/**
+		 * @brief Wait for the worker threads to process every IR added
+		 * @return true if there is a processed IR for every IR of sofaIRDataBase
+		 */
+		bool WaitForPipelinedIRs() {
+			if (!setupWorkerPool || pipelinedIRs.empty()) { return false; }
+			bool success = setupWorkerPool->Wait();
+			return success && pipelinedIRs.size() == sofaIRDataBase.size();
+		}
+
+		/**
+		 * @brief Discard the IRs processed by the worker threads
+		 */
+		void DiscardPipelinedIRs() {
+			if (setupWorkerPool) { setupWorkerPool->Wait(); }
+			pipelinedIRs.clear();
+		}
+
 		/**
 		 * @brief Sort the tables by distances, in any reference_position bucket
 		 */
@@ -584,6 +744,31 @@ namespace BRTServices
 			}
 		}
 
+		/**
+		 * @brief Move the partitioned table to reduced precision storage, if it has been set
+		 */
+		void CompactTable() {
+			if (spectralStoragePrecision == Common::TSpectralPrecision::float32) { return; }
+			for (auto & refPair : partitionedFRDataBase) {
+				for (auto & distBucket : refPair.second.distances) {
+					for (auto & it : distBucket.table) {
+						it.second.Compact(spectralStoragePrecision);
+					}
+				}
+			}
+		}
+
+		/**
+		 * @brief Memory used by the raw data and the partitioned table. The mutex must be locked.
+		 */
+		size_t CalculateMemoryFootprint() const {
+			size_t size = CFIRTableAuxiliarMethods::CalculateMemoryFootprint(sofaIRDataBase);
+			for (const auto & refPair : partitionedFRDataBase) {
+				size += CFIRTableAuxiliarMethods::CalculateMemoryFootprint(refPair.second.distances);
+			}
+			return size;
+		}
+
 		void BuildSearchTrees() {
 			for (auto & refPair : partitionedFRDataBase) {
 				TReferenceBucket & refBucket = refPair.second;
@@ -714,6 +899,20 @@ namespace BRTServices
 			return distanceBucket;
 		}
 
+		/**
+		 * @brief Copy one element of the table, converting its IR to float if it is stored with reduced precision
+		 */
+		static void CopyWithFloatPrecision(const TFRPartitionedStruct & _source, TFRPartitionedStruct & _destination) {
+			if (!_source.IsCompact()) {
+				_destination = _source;
+				return;
+			}
+			_destination.orientation = _source.orientation;
+			_destination.delay = _source.delay;
+			_source.GetIR(Common::T_ear::LEFT, _destination.IR.left);
+			_source.GetIR(Common::T_ear::RIGHT, _destination.IR.right);
+		}
+
 		const TFRPartitionedStruct GetDataFromPartitionedSpatiallyOriented(const TDistanceBucket * distanceBucket, const float & _azimuth, const float & _elevation, bool _findNearest) const {
 			const double _azimuthInRage = CInterpolationAuxiliarMethods::NormalizeAzimuth0_360(_azimuth);
 			const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
@@ -722,7 +921,7 @@ namespace BRTServices
 			auto it = distanceBucket->table.find(TOrientation_key(_azimuthInRage, _elevationInRange));
 			if (it != distanceBucket->table.end()) {
 				// Exact match found
-				foundData = it->second;
+				CopyWithFloatPrecision(it->second, foundData);
 			} else {
 				// No exact match
 				if (!_findNearest) {
@@ -733,7 +932,7 @@ namespace BRTServices
 				TOrientation nearest = distanceBucket->searchTree.nearest(_azimuthInRage, _elevationInRange);			
 				auto it = distanceBucket->table.find(TOrientation_key(nearest));
 				if (it != distanceBucket->table.end()) {
-					foundData = it->second;
+					CopyWithFloatPrecision(it->second, foundData);
 				} else {
 					// ERROR: This should not happen
 					SET_RESULT(RESULT_ERROR_NOTALLOWED, "GetDataFromPartitionedSpatiallyOriented: SearchTree returned an orientation not present in FIR table");
@@ -799,12 +998,12 @@ namespace BRTServices
 		//}
 
 
-		void CalculateWindowingIRTable(const TRawSofaData & _inTable, TRawSofaData & _outTable) {
+		void CalculateWindowingIRTable(TRawSofaData & _table) {
 			
-			bool result = CFIRTableAuxiliarMethods::CalculateWindowingIRTable(_inTable, _outTable, fadeInBegin, riseTime, fadeOutCutoff, fallTime, globalParameters.GetSampleRate());
+			bool result = CFIRTableAuxiliarMethods::CalculateWindowingIRTable(_table, fadeInBegin, riseTime, fadeOutCutoff, fallTime, globalParameters.GetSampleRate());
 			if (result) {
 				// Update impulseResponseLength and the number of subfilters
-				impulseResponseLength = _outTable.begin()->data.IR.left.size();
+				impulseResponseLength = _table.begin()->data.IR.left.size();
 				partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
 			}
 
@@ -864,11 +1063,21 @@ namespace BRTServices
 		float riseTime;								// Variable to be used in the windowing IR process
 		float fadeOutCutoff;						// Variable to be used in the windowing IR process
 		float fallTime;								// Variable to be used in the windowing IR process 
+		Common::TSpectralPrecision spectralStoragePrecision;	// Format used to store the partitioned table
 
 		// Tables									
 		TRawSofaData sofaIRDataBase;					// Time domain database - orginal data from SOFA file		
 		TReferenceBucketMap partitionedFRDataBase;		// Frequency domain partitioned database
 		TReferenceEntryList referencePositionSearchList; // List of reference positions for nearest search (built from the map keys)					
+
+		// Pipelined setup
+		struct TPipelinedIR {
+			TFRPartitionedStruct partitionedIR;		// Windowed and partitioned IR
+			int32_t impulseResponseLength = 0;		// Length of the IR after the windowing
+			bool windowed = false;					// True if the fade out window has been applied
+		};
+		std::deque<TPipelinedIR> pipelinedIRs;			// IRs processed by the worker threads, in the same order as sofaIRDataBase
+		std::unique_ptr<CSetupWorkerPool> setupWorkerPool;	// Worker threads of the pipelined setup. Declared last so it stops before the data it writes is destroyed
 	};
 }
 #endif
@@ -37,6 +37,7 @@
 #include <Common/GlobalParameters.hpp>
 #include <ServiceModules/ServicesBase.hpp>
 #include <ServiceModules/SphericalSearchKDTree.hpp>
+#include <ServiceModules/SphericalGridTopology.hpp>
 
 namespace BRTServices {
 
@@ -48,6 +49,10 @@ namespace BRTServices {
 #define DEFAULT_GRIDSAMPLING_STEP 5
 #endif
 
+#ifndef DEFAULT_PROGRESSIVE_GRIDSAMPLING_STEP
+#define DEFAULT_PROGRESSIVE_GRIDSAMPLING_STEP 15	// Step of the coarse table published first in a progressive setup
+#endif
+
 #ifndef DEFAULT_HRTF_MEASURED_DISTANCE
 #define DEFAULT_HRTF_MEASURED_DISTANCE 1.95f	//TO be deleted
 #endif
@@ -81,6 +86,7 @@ namespace BRTServices {
 	struct TDistanceBucket {
 		int32_t distance_mm = 0;
 		CSphericalSearchKDTree<TOrientation> searchTree;
+		CSphericalGridTopology<BRTServices::TFRPartitionedStruct> gridTopology;	// Only for resampled grids, references the elements of table
 		TSphericalFIRTablePartitioned table;
 	};
 
@@ -0,0 +1,202 @@
+/**
+* \class CSphericalGridTopology
+*
+* \brief Declaration of CSphericalGridTopology class.
+* \detail Precomputed neighbourhood of a quasi-uniform resampled grid. The grid is stored as rings of constant elevation, each one
+	holding direct references to the grid points sorted by azimuth. Once it is built, the four grid points that enclose any direction
+	(and the nearest grid point) are found with index arithmetic, without hash lookups or step map copies.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _CSPHERICAL_GRID_TOPOLOGY_HPP
+#define _CSPHERICAL_GRID_TOPOLOGY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include <Common/ErrorHandler.hpp>
+#include <ServiceModules/ServicesBase.hpp>
+#include <ServiceModules/InterpolationAuxiliarMethods.hpp>
+
+namespace BRTServices
+{
+	/**
+	 * @brief Trapezoid of grid points that encloses one direction.
+	 *			   Back	  Front
+	 *	Ceil		A		B
+	 *	Floor		C		D
+	 */
+	struct TGridCell {
+		TOrientation A;			///< Ceil ring, back azimuth
+		TOrientation B;			///< Ceil ring, front azimuth
+		TOrientation C;			///< Floor ring, back azimuth
+		TOrientation D;			///< Floor ring, front azimuth
+		TOrientation P;			///< Mid point of the trapezoid
+		float elevationCeil;	///< Elevation of the ceil ring (not normalised, so it can be 360)
+		float elevationFloor;	///< Elevation of the floor ring
+	};
+
+	/**
+	 * @brief Ring (constant elevation) based view of a quasi-uniform grid created with CQuasiUniformSphereDistribution::CreateGrid
+	 * @tparam U type of the data stored in every grid point
+	 */
+	template <typename U>
+	class CSphericalGridTopology {
+	public:
+		CSphericalGridTopology()
+			: elevationStep { 0.0f }
+			, ready { false } { }
+
+		/**
+		 * @brief Build the rings of the grid. Must be called once the table has been filled and will not be modified anymore,
+			as direct references to its elements are stored.
+		 * @param _table grid table, created with CQuasiUniformSphereDistribution::CreateGrid
+		 * @param _stepMap azimuth step of every elevation of the grid, created with CQuasiUniformSphereDistribution::CreateGrid
+		 * @return true if every point of the grid has been found in the table
+		 */
+		template <typename T>
+		bool Build(const T & _table, const std::unordered_map<TOrientation, float> & _stepMap) {
+			Clear();
+
+			auto elevationStepIt = _stepMap.find(TOrientation(-1, -1));
+			if (elevationStepIt == _stepMap.end() || elevationStepIt->second <= 0) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "The grid elevation step has not been found, the grid topology cannot be built");
+				return false;
+			}
+			elevationStep = elevationStepIt->second;
+			int numberOfRings = static_cast<int>(std::lround(360.0 / elevationStep));
+			rings.resize(numberOfRings);
+
+			bool allPointsFound = true;
+			for (auto & stepIt : _stepMap) {
+				if (stepIt.first == TOrientation(-1, -1)) { continue; }
+
+				TRing & ring = rings[WrapIndex(std::lround(stepIt.first.elevation / elevationStep), numberOfRings)];
+				ring.elevation = stepIt.first.elevation;
+				ring.azimuthStep = stepIt.second;
+				int numberOfPoints = std::max(1, static_cast<int>(std::lround(360.0 / stepIt.second)));
+				ring.points.assign(numberOfPoints, nullptr);
+
+				for (int i = 0; i < numberOfPoints; i++) {
+					auto it = _table.find(TOrientation(i * ring.azimuthStep, ring.elevation));
+					if (it != _table.end()) {
+						ring.points[i] = &(it->second);
+					} else {
+						allPointsFound = false;
+					}
+				}
+			}
+			if (!allPointsFound) {
+				SET_RESULT(RESULT_WARNING, "Some points of the grid have not been found in the table while building the grid topology");
+			}
+			ready = true;
+			return allPointsFound;
+		}
+
+		/**
+		 * @brief Remove all the rings. It has to be called before the referenced table is modified or destroyed.
+		 */
+		void Clear() {
+			rings.clear();
+			elevationStep = 0.0f;
+			ready = false;
+		}
+
+		/**
+		 * @brief Check if the topology has been built
+		 */
+		bool IsReady() const { return ready; }
+
+		/**
+		 * @brief Find the grid point nearest to a direction. Poles and azimuth 360 are wrapped to their stored point.
+		 * @param _azimuth azimuth in degrees, in range [0, 360]
+		 * @param _elevation elevation in degrees, in range [0,90] U [270,360]
+		 * @return pointer to the grid point data, or nullptr if not found
+		 */
+		const U * FindNearest(double _azimuth, double _elevation) const {
+			const TRing * ring = GetRing(std::lround(_elevation / elevationStep));
+			if (ring == nullptr) { return nullptr; }
+			return ring->points[WrapIndex(std::lround(_azimuth / ring->azimuthStep), static_cast<int>(ring->points.size()))];
+		}
+
+		/**
+		 * @brief Find 4 nearest points (trapezoid) of the grid around a direction. Same algorithm as in the online interpolators, but the azimuth
+			steps are taken from the rings.
+		 * @param _azimuth azimuth in degrees
+		 * @param _elevation elevation in degrees
+		 * @param [out] _cell trapezoid that encloses the direction
+		 * @return false if any of the rings has not been found
+		 */
+		bool FindCell(float _azimuth, float _elevation, TGridCell & _cell) const {
+			if (!ready) { return false; }
+
+			int indexElevation = static_cast<int>(std::ceil(_elevation / elevationStep));
+			const TRing * ringCeil = GetRing(indexElevation);
+			const TRing * ringFloor = GetRing(indexElevation - 1);
+			if (ringCeil == nullptr || ringFloor == nullptr) { return false; }
+
+			float elevationCeil = elevationStep * indexElevation;
+			float elevationFloor = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(elevationStep * (indexElevation - 1));
+
+			float azimuthCeilBack, azimuthCeilFront, azimuthFloorBack, azimuthFloorFront;
+			CInterpolationAuxiliarMethods::CalculateAzimuth_BackandFront(azimuthCeilBack, azimuthCeilFront, ringCeil->azimuthStep, _azimuth);
+			CInterpolationAuxiliarMethods::CalculateAzimuth_BackandFront(azimuthFloorBack, azimuthFloorFront, ringFloor->azimuthStep, _azimuth);
+
+			// Mid Point of a trapezoid can be compute by averaging all azimuths
+			float azimuth_ptoP = (azimuthCeilBack + azimuthCeilFront + azimuthFloorBack + azimuthFloorFront) * 0.25;
+			_cell.P = TOrientation(azimuth_ptoP, elevationCeil - elevationStep * 0.5f);
+
+			// Particular case of points near poles
+			if (elevationCeil == ELEVATION_NORTH_POLE) { azimuthCeilFront = azimuthFloorFront; }
+			else if (elevationFloor == ELEVATION_SOUTH_POLE) { azimuthFloorFront = azimuthCeilFront; }
+
+			_cell.A = TOrientation(azimuthCeilBack, elevationCeil);
+			_cell.B = TOrientation(azimuthCeilFront, elevationCeil);
+			_cell.C = TOrientation(azimuthFloorBack, elevationFloor);
+			_cell.D = TOrientation(azimuthFloorFront, elevationFloor);
+			_cell.elevationCeil = elevationCeil;
+			_cell.elevationFloor = elevationFloor;
+			return true;
+		}
+
+	private:
+		struct TRing {
+			double elevation = 0.0;				// Elevation of the ring, in range [0,90] U [270,360)
+			float azimuthStep = 0.0f;			// Azimuth step between two consecutive points of the ring
+			std::vector<const U *> points;		// Grid points sorted by azimuth, points[i] is placed at azimuth i * azimuthStep
+		};
+
+		static int WrapIndex(long _index, int _size) {
+			long wrapped = _index % _size;
+			return static_cast<int>(wrapped < 0 ? wrapped + _size : wrapped);
+		}
+
+		const TRing * GetRing(long _elevationIndex) const {
+			if (rings.empty()) { return nullptr; }
+			const TRing & ring = rings[WrapIndex(_elevationIndex, static_cast<int>(rings.size()))];
+			if (ring.points.empty()) { return nullptr; }
+			return &ring;
+		}
+
+		float elevationStep;			// Elevation step, same for all the grid
+		std::vector<TRing> rings;		// Rings indexed by round(elevation / elevationStep), empty rings are outside the grid
+		bool ready;						// Set once the topology has been built
+	};
+}
+#endif
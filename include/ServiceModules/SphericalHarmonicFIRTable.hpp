@@ -0,0 +1,734 @@
+/**
+* \class CSphericalHarmonicFIRTable
+*
+* \brief Declaration of CSphericalHarmonicFIRTable class interface
+* \detail HRTF table that stores, instead of a resampled grid, the real spherical harmonic expansion of every value of the partitioned
+	spectra and of the delays. The HRTF of any direction is evaluated at run time, without grid lookups.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM ||
+* \b Website: https://www.sonicom.eu/
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no.101017743
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+
+#ifndef _CSPHERICAL_HARMONIC_FIR_TABLE_H_
+#define _CSPHERICAL_HARMONIC_FIR_TABLE_H_
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "Eigen/Dense"
+#include <Common/Buffer.hpp>
+#include <Common/ErrorHandler.hpp>
+#include <Common/GlobalParameters.hpp>
+#include <Common/CommonDefinitions.hpp>
+#include <Common/CranicalGeometry.hpp>
+#include <ServiceModules/ServicesBase.hpp>
+#include <ServiceModules/SphericalFIRTableDefinitions.hpp>
+#include <ServiceModules/FIRTableAuxiliarMethods.hpp>
+#include <ServiceModules/InterpolationAuxiliarMethods.hpp>
+
+#ifndef DEFAULT_SH_ORDER
+#define DEFAULT_SH_ORDER 10
+#endif
+
+#ifndef MAX_SH_ORDER
+#define MAX_SH_ORDER 30
+#endif
+
+#ifndef DEFAULT_SH_DELAY_ORDER
+#define DEFAULT_SH_DELAY_ORDER 6
+#endif
+
+#ifndef DEFAULT_SH_REGULARIZATION
+#define DEFAULT_SH_REGULARIZATION 1e-4f
+#endif
+
+namespace BRTServices
+{
+	/** \details This class gets impulse response data to compose HRTFs and stores them as real spherical harmonic (ACN, N3D) expansions.
+		Every value of the partitioned spectra of the IRs, and the delay of each ear, is fitted by regularized least squares on the
+		measured directions, so no grid, resampling or extrapolation is needed. The HRTF of a direction is the dot product of the
+		spherical harmonics of that direction with the coefficients of every value.
+	*/
+	class CSphericalHarmonicFIRTable : public CServicesBase
+	{
+	public:
+		/** \brief Default Constructor
+		*	\details By default, customized ITD is switched off and the expansion order is set to DEFAULT_SH_ORDER
+		*   \eh Nothing is reported to the error handler.
+		*/
+		CSphericalHarmonicFIRTable()
+			: partitionedFRNumberOfSubfilters { 0 }
+			, partitionedFRSubfilterLength { 0 }
+			, setupInProgress { false }
+			, customITD { false }
+			, order { DEFAULT_SH_ORDER }
+			, delayOrder { DEFAULT_SH_DELAY_ORDER }
+			, regularization { DEFAULT_SH_REGULARIZATION }
+			, fadeInBegin { 0 }
+			, riseTime { 0 }
+			, fadeOutCutoff { 0 }
+			, fallTime { 0 }
+		{ }
+
+		/** \brief Switch on ITD customization in accordance with the listener head radius
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void EnableWoodworthITD() override { customITD = true; }
+
+		/** \brief Switch off ITD customization in accordance with the listener head radius
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void DisableWoodworthITD() override { customITD = false; }
+
+		/** \brief Get the flag for HRTF cutomized ITD process
+		*	\retval HRTFCustomizedITD if true, the HRTF ITD customization process based on the head circumference is enabled
+		*   \eh Nothing is reported to the error handler.
+		*/
+		bool IsWoodworthITDEnabled() const override { return customITD; }
+
+		/** \brief	Get the number of subfilters (blocks) in which the HRIR has been partitioned
+		*	\retval n Number of HRIR subfilters
+		*   \eh Nothing is reported to the error handler.
+		*/
+		int32_t GetNumberOfSubfiltersFR() const override { return partitionedFRNumberOfSubfilters; }
+
+		/** \brief	Get the size of subfilters (blocks) in which the HRIR has been partitioned, every subfilter has the same size
+		*	\retval size Size of HRIR subfilters
+		*   \eh Nothing is reported to the error handler.
+		*/
+		int32_t GetSubfilterLengthFR() const override { return partitionedFRSubfilterLength; }
+
+		/** \brief	Set the radius of the listener head
+		*   \eh Nothing is reported to the error handler.
+		*/
+		void SetHeadRadius(float _headRadius) override {
+			std::lock_guard<std::mutex> l(mutex);
+			if (_headRadius >= 0.0f) {
+				// First time this is called we save the original cranial geometry
+				if (originalCranialGeometry.GetHeadRadius() == -1) { originalCranialGeometry = cranialGeometry; }
+				cranialGeometry.SetHeadRadius(_headRadius);
+			} else {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "Head Radius must be  greater than 0.");
+			}
+		}
+
+		/** \brief	Get the radius of the listener head in meters
+		*   \return listenerHeadRadius in meters
+		*   \eh Nothing is reported to the error handler.
+		*/
+		float GetHeadRadius() const override {
+			return cranialGeometry.GetHeadRadius();
+		}
+
+		/**
+		 * @brief Return to original ear positions and head radius.
+		 */
+		void RestoreHeadRadius() override {
+			std::lock_guard<std::mutex> l(mutex);
+			cranialGeometry = originalCranialGeometry;
+		}
+
+		/** \brief	Set the relative position of one ear (to the listener head center)
+		* 	\param [in]	_ear			ear type
+		*   \param [in]	_earPosition	ear local position
+		*   \eh <<Error not allowed>> is reported to error handler
+		*/
+		void SetEarPosition(Common::T_ear _ear, Common::CVector3 _earPosition) override {
+			if (_ear == Common::T_ear::LEFT) {
+				cranialGeometry.SetLeftEarPosition(_earPosition);
+			} else if (_ear == Common::T_ear::RIGHT) {
+				cranialGeometry.SetRightEarPosition(_earPosition);
+			} else {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to set listener ear transform for BOTH or NONE ears");
+			}
+		}
+
+		/** \brief	Get the relative position of one ear (to the listener head center)
+		* 	\param [in]	_ear			ear type
+		*   \return  Ear local position in meters
+		*   \eh <<Error not allowed>> is reported to error handler
+		*/
+		Common::CVector3 GetEarLocalPosition(Common::T_ear _ear) const override {
+			if (_ear == Common::T_ear::LEFT) { return cranialGeometry.GetLeftEarLocalPosition(); }
+			else if (_ear == Common::T_ear::RIGHT) { return cranialGeometry.GetRightEarLocalPosition(); }
+			else {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to set listener ear transform for BOTH or NONE ears");
+				return Common::CVector3();
+			}
+		}
+
+		/**
+		 * @brief Set current cranial geometry as default
+		 */
+		void SetCranialGeometryAsDefault() override {
+			originalCranialGeometry = cranialGeometry;
+		}
+
+		/**
+		* @brief Get the closest distance at which IR has been measured from a current reference location, azimuth, and elevation.
+		*/
+		double GetDistanceOfMeasurement(const Common::CTransform & _referenceLocation, const double & _azimuth, const double & _elevation, const double & _distance) const override {
+			std::lock_guard<std::mutex> l(mutex);
+			if (!dataReady) {
+				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "GetDistanceOfMeasurement: HRTF data not ready");
+				return 0;
+			}
+			const TSphericalHarmonicBucket * distanceBucket = FindNearestDistanceBucket(quantise_dist_mm(_distance));
+			if (!distanceBucket) {
+				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetDistanceOfMeasurement: Distance Bucket find error");
+				return 0;
+			}
+			return distanceBucket->distance;
+		}
+
+		/**
+		 * @brief Set parameters for the windowing IR process
+		 * @param _windowThreshold The midpoint of the window in time (seconds), that is, where the window reaches 0.5.
+		 * @param _windowRiseTime time (secons) for the window to go from 0 to 1. A value of zero would represent the step window.
+		 */
+		void SetWindowingParameters(float _fadeInBegin, float _riseTime, float _fadeOutCutoff, float _fallTime) override {
+			mutex.lock();
+			if (IsRawDataReleased(sofaIRDataBase.empty())) {
+				mutex.unlock();
+				return;
+			}
+			fadeInBegin = _fadeInBegin;
+			riseTime = _riseTime;
+			fadeOutCutoff = _fadeOutCutoff;
+			fallTime = _fallTime;
+			mutex.unlock();
+			if (dataReady) {
+				setupInProgress = true;
+				dataReady = false;
+				EndSetup();
+			}
+		}
+
+		/**
+		 * @brief Get parameters for the windowing IR process
+		 * @param [out] _windowThreshold
+		 * @param [out] _windowRiseTime
+		 */
+		void GetWindowingParameters(float & _fadeInWindowThreshold, float & _fadeInWindowRiseTime, float & _fadeOutWindowThreshold, float & _fadeOutWindowRiseTime) const override {
+			_fadeInWindowThreshold = fadeInBegin;
+			_fadeInWindowRiseTime = riseTime;
+			_fadeOutWindowThreshold = fadeOutCutoff;
+			_fadeOutWindowRiseTime = fallTime;
+		}
+
+		/**
+		 * @brief Set the order of the spherical harmonic expansion of the spectra. The table stores (order + 1)^2 coefficients for every
+			value of the partitioned spectra, so higher orders are more accurate but need more memory and more time to evaluate each
+			direction. The order of the expansion of the delays is limited to DEFAULT_SH_DELAY_ORDER. It has to be set before EndSetup.
+		 * @param _order expansion order, between 1 and MAX_SH_ORDER
+		 */
+		void SetSphericalHarmonicOrder(int _order) {
+			if (_order < 1 || _order > MAX_SH_ORDER) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The spherical harmonic order must be between 1 and " + std::to_string(MAX_SH_ORDER));
+				return;
+			}
+			order = _order;
+			delayOrder = std::min(order, DEFAULT_SH_DELAY_ORDER);
+		}
+
+		/**
+		 * @brief Get the order of the spherical harmonic expansion of the spectra
+		 */
+		int GetSphericalHarmonicOrder() const { return order; }
+
+		/**
+		 * @brief Set the regularization of the fit. The coefficients of order n are penalized in proportion to 1 + n(n + 1), which smooths
+			the expansion where the measured directions are sparse. It has to be set before EndSetup.
+		 * @param _regularization regularization factor, relative to the mean energy of the spherical harmonics on the measured directions
+		 */
+		void SetSphericalHarmonicRegularization(float _regularization) {
+			if (_regularization <= 0) {
+				SET_RESULT(RESULT_ERROR_OUTOFRANGE, "The spherical harmonic regularization must be greater than 0");
+				return;
+			}
+			regularization = _regularization;
+		}
+
+		/**
+		 * @brief Get the regularization of the fit
+		 */
+		float GetSphericalHarmonicRegularization() const { return regularization; }
+
+		/**
+		 * @brief Get the memory used by the table data: the raw data and the spherical harmonic coefficients.
+		 * @return size in bytes
+		 */
+		size_t GetMemoryFootprint() const override {
+			std::lock_guard<std::mutex> l(mutex);
+			return CalculateMemoryFootprint();
+		}
+
+		/** \brief Start a new HRTF configuration
+		*	\param [in] _HRIRLength buffer size of the HRIR to be added
+		*	\param [in] _extrapolationMethod not used, as the fit does not need a complete grid
+		*   \eh On success, RESULT_OK is reported to the error handler.
+		*       On error, an error code is reported to the error handler.
+		*/
+		bool BeginSetup(const int32_t & _HRIRLength, const BRTServices::TEXTRAPOLATION_METHOD & _extrapolationMethod) override {
+			std::lock_guard<std::mutex> l(mutex);
+			setupInProgress = true;
+			dataReady = false;
+
+			// Clear every table
+			distanceSHTable.clear();
+			sofaIRDataBase.clear();
+
+			// Update parameters
+			impulseResponseLength = _HRIRLength;
+			partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
+
+			SET_RESULT(RESULT_OK, "Spherical harmonic HRTF Setup started");
+			return true;
+		}
+
+		void AddIR(const Common::CVector3 & _referencePosition, const double & _azimuth, const double & _elevation, const double & _distance, TIRStruct && _newIR) override {
+			if (!setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Cannot add IR - Setup not in progress");
+				return;
+			}
+
+			const double _azimuthInRage = CInterpolationAuxiliarMethods::NormalizeAzimuth0_360(_azimuth);
+			const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
+
+			TSofaDataBucket newData;
+			newData.referencePosition = _referencePosition;
+			newData.data = TIRStruct(TOrientation(_azimuthInRage, _elevationInRange, _distance), std::forward<TIRStruct>(_newIR));
+			sofaIRDataBase.push_back(std::move(newData));
+		}
+
+		/** \brief Stop the HRTF configuration and fit the spherical harmonic coefficients
+		*   \eh On success, RESULT_OK is reported to the error handler.
+		*       On error, an error code is reported to the error handler.
+		*/
+		bool EndSetup() override {
+			std::lock_guard<std::mutex> l(mutex);
+			if (!setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Cannot end setup - Setup not in progress");
+				return false;
+			}
+			if (serviceType == TServiceType::none) {
+				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Cannot end setup - Service type not defined");
+				return false;
+			}
+			if (sofaIRDataBase.empty()) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "ERROR SphericalHarmonicFIRTable::EndSetup - No data to be processed");
+				return false;
+			}
+			if (sofaIRDataBase.size() > 1) spatiallyOriented = true;
+
+			TRawSofaData windowingIRTable;
+			if (rawDataReleaseEnabled) {
+				// The raw data is not kept, so it is windowed in place instead of copied
+				windowingIRTable = std::move(sofaIRDataBase);
+				sofaIRDataBase.clear();
+			} else {
+				windowingIRTable = sofaIRDataBase;
+			}
+			if (CFIRTableAuxiliarMethods::CalculateWindowingIRTable(windowingIRTable, fadeInBegin, riseTime, fadeOutCutoff, fallTime, globalParameters.GetSampleRate())) {
+				impulseResponseLength = windowingIRTable.begin()->data.IR.left.size();
+				partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
+			}
+			if (serviceType == TServiceType::hrir_database_interpolated) {
+				CFIRTableAuxiliarMethods::RemoveCommonDelayFromTable(windowingIRTable);
+			}
+
+			// Measurements of each distance, sorted by distance
+			std::map<int32_t, std::vector<size_t>> measurementsByDistance;
+			for (size_t i = 0; i < windowingIRTable.size(); i++) {
+				measurementsByDistance[quantise_dist_mm(windowingIRTable[i].data.orientation.distance)].push_back(i);
+			}
+
+			std::vector<TSphericalHarmonicBucket> newTable;
+			for (const auto & it : measurementsByDistance) {
+				TSphericalHarmonicBucket bucket;
+				bucket.distance_mm = it.first;
+				bucket.distance = windowingIRTable[it.second.front()].data.orientation.distance;
+				if (!FitDistanceBucket(windowingIRTable, it.second, bucket)) {
+					return false;
+				}
+				newTable.push_back(std::move(bucket));
+			}
+			distanceSHTable = std::move(newTable);
+
+			if (rawDataReleaseEnabled) { TRawSofaData().swap(sofaIRDataBase); }
+			setupInProgress = false;
+			dataReady = true;
+			setupRevision++;
+
+			SET_RESULT(RESULT_OK, "Spherical harmonic HRTF table of order " + std::to_string(order) + " fitted succesfully, memory footprint " + std::to_string(CalculateMemoryFootprint()) + " bytes");
+			return true;
+		}
+
+		/** \brief Get the partitioned HRTF of one ear for a direction
+		*	\param [in] _azimuth azimuth angle in degrees
+		*	\param [in] _elevation elevation angle in degrees
+		*	\param [in] _distance distance of the source, to choose the nearest measured distance
+		*	\param [in] ear for which ear we want to get the HRTF
+		*	\param [in] _runTimeInterpolation not used, the expansion is continuous on the sphere
+		*	\retval HRTF partitioned spectra for specified ear
+		*   \eh On error, an error code is reported to the error handler.
+		*/
+		const TFRPartitions GetFR_SpatiallyOriented(const float & _azimuth, const float & _elevation, const float & _distance, const Common::CTransform & _referenceLocation, const Common::T_ear & ear, bool _runTimeInterpolation) const override {
+			std::lock_guard<std::mutex> l(mutex);
+			TFRPartitions _foundData;
+
+			if (ear == Common::T_ear::BOTH || ear == Common::T_ear::NONE) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get IR for a wrong ear (BOTH or NONE)");
+				return _foundData;
+			}
+			if (setupInProgress || !dataReady) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "GetFR_SpatiallyOriented: spherical harmonic HRTF not ready, return empty");
+				return _foundData;
+			}
+
+			const TSphericalHarmonicBucket * distanceBucket = FindNearestDistanceBucket(quantise_dist_mm(_distance));
+			if (!distanceBucket) {
+				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFR_SpatiallyOriented: Distance Bucket find error");
+				return _foundData;
+			}
+
+			std::vector<float> sphericalHarmonics;
+			CalculateSphericalHarmonics(order, _azimuth, _elevation, sphericalHarmonics);
+			EvaluateSpectra(ear == Common::T_ear::LEFT ? distanceBucket->coefficients.left : distanceBucket->coefficients.right, sphericalHarmonics, _foundData);
+			return _foundData;
+		}
+
+		const Common::CEarPair<TFRPartitions> GetFR_SpatiallyOriented_2Ears(const float & _azimuth, const float & _elevation, const float & _distance, const Common::CTransform & _referenceLocation, bool _runTimeInterpolation) const override {
+			std::lock_guard<std::mutex> l(mutex);
+			Common::CEarPair<TFRPartitions> _foundData;
+
+			if (setupInProgress || !dataReady) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "GetFR_SpatiallyOriented_2Ears: spherical harmonic HRTF not ready, return empty");
+				return _foundData;
+			}
+
+			const TSphericalHarmonicBucket * distanceBucket = FindNearestDistanceBucket(quantise_dist_mm(_distance));
+			if (!distanceBucket) {
+				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFR_SpatiallyOriented_2Ears: Distance Bucket find error");
+				return _foundData;
+			}
+
+			// Both ears share the spherical harmonics of the direction
+			std::vector<float> sphericalHarmonics;
+			CalculateSphericalHarmonics(order, _azimuth, _elevation, sphericalHarmonics);
+			EvaluateSpectra(distanceBucket->coefficients.left, sphericalHarmonics, _foundData.left);
+			EvaluateSpectra(distanceBucket->coefficients.right, sphericalHarmonics, _foundData.right);
+			return _foundData;
+		}
+
+		/**
+		 * @brief Get the HRIR delay, in number of samples, for both ears
+		 * @param _azimuthCenter azimuth angle from the source and the listener head center in degrees
+		 * @param _elevationCenter elevation angle from the source and the listener head center in degrees
+		 * @param _distance distance from the source to the listener head center
+		 * @param _referenceLocation reference location of the listener
+		 * @param _runTimeInterpolation not used, the expansion is continuous on the sphere
+		 * @return
+		 */
+		const Common::CEarPair<uint64_t> GetFR_Delay(const float & _azimuthCenter, const float & _elevationCenter, const float & _distance, const Common::CTransform & _referenceLocation, bool _runTimeInterpolation) const override {
+			std::lock_guard<std::mutex> l(mutex);
+			Common::CEarPair<uint64_t> foundData { 0, 0 };
+
+			if (setupInProgress || !dataReady) {
+				SET_RESULT(RESULT_ERROR_NOTSET, "GetFR_Delay: spherical harmonic HRTF not ready, return empty");
+				return foundData;
+			}
+
+			// Modify delay if customized delay is activate
+			if (customITD) {
+				foundData.left = CFIRTableAuxiliarMethods::CalculateCustomizedDelay(_azimuthCenter, _elevationCenter, cranialGeometry, Common::T_ear::LEFT);
+				foundData.right = CFIRTableAuxiliarMethods::CalculateCustomizedDelay(_azimuthCenter, _elevationCenter, cranialGeometry, Common::T_ear::RIGHT);
+				return foundData;
+			}
+
+			const TSphericalHarmonicBucket * distanceBucket = FindNearestDistanceBucket(quantise_dist_mm(_distance));
+			if (!distanceBucket) {
+				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFR_Delay: Distance Bucket find error");
+				return foundData;
+			}
+
+			std::vector<float> sphericalHarmonics;
+			CalculateSphericalHarmonics(delayOrder, _azimuthCenter, _elevationCenter, sphericalHarmonics);
+			foundData.left = EvaluateDelay(distanceBucket->delayCoefficients.left, sphericalHarmonics);
+			foundData.right = EvaluateDelay(distanceBucket->delayCoefficients.right, sphericalHarmonics);
+			return foundData;
+		}
+
+	private:
+		// Spherical harmonic coefficients of the data measured at one distance
+		struct TSphericalHarmonicBucket {
+			int32_t distance_mm;
+			float distance;
+			Common::CEarPair<std::vector<float>> coefficients;			// Spectra coefficients, [coefficient][subfilter * subfilter length + value]
+			Common::CEarPair<std::vector<float>> delayCoefficients;	// Delay coefficients, [coefficient]
+		};
+
+		using TRowMajorMatrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+		////////////////////
+		// SETUP METHODS
+		////////////////////
+		/**
+		 * @brief Calculate the number of subfilters needed to partition the HRIR
+		 */
+		int CalculateNumberOPartitions(int _irLength) {
+			float partitions = (float)_irLength / (float)globalParameters.GetBufferSize();
+			return static_cast<int>(std::ceil(partitions));
+		}
+
+		/**
+		 * @brief Fit the spectra and delays of the measurements of one distance
+		 * @param _table windowed IRs. The IRs of the distance are released once their spectra have been calculated.
+		 * @param _measurements indices of the IRs of the distance
+		 * @param _bucket bucket where the coefficients are stored
+		 * @return true on success
+		 */
+		bool FitDistanceBucket(TRawSofaData & _table, const std::vector<size_t> & _measurements, TSphericalHarmonicBucket & _bucket) {
+			const int numberOfMeasurements = static_cast<int>(_measurements.size());
+			const int numberOfCoefficients = GetNumberOfCoefficients(order);
+			const int numberOfDelayCoefficients = GetNumberOfCoefficients(delayOrder);
+
+			// Spherical harmonics of the measured directions
+			Eigen::MatrixXd sphericalHarmonicsMatrix(numberOfMeasurements, numberOfCoefficients);
+			std::vector<double> sphericalHarmonics;
+			for (int i = 0; i < numberOfMeasurements; i++) {
+				const TOrientation & orientation = _table[_measurements[i]].data.orientation;
+				CalculateSphericalHarmonics(order, orientation.azimuth, orientation.elevation, sphericalHarmonics);
+				sphericalHarmonicsMatrix.row(i) = Eigen::Map<const Eigen::RowVectorXd>(sphericalHarmonics.data(), numberOfCoefficients);
+			}
+
+			// Least squares projections, from the measured values to the coefficients
+			Eigen::MatrixXd projection, delayProjection;
+			if (!CalculateProjection(sphericalHarmonicsMatrix, order, projection) ||
+				!CalculateProjection(sphericalHarmonicsMatrix.leftCols(numberOfDelayCoefficients), delayOrder, delayProjection)) {
+				SET_RESULT(RESULT_ERROR_INVALID_PARAM, "ERROR SphericalHarmonicFIRTable::EndSetup - The spherical harmonic fit could not be solved");
+				return false;
+			}
+
+			// Delays
+			Eigen::VectorXd leftDelays(numberOfMeasurements), rightDelays(numberOfMeasurements);
+			for (int i = 0; i < numberOfMeasurements; i++) {
+				leftDelays(i) = static_cast<double>(_table[_measurements[i]].data.delay.left);
+				rightDelays(i) = static_cast<double>(_table[_measurements[i]].data.delay.right);
+			}
+			const Eigen::VectorXf leftDelayCoefficients = (delayProjection * leftDelays).cast<float>();
+			const Eigen::VectorXf rightDelayCoefficients = (delayProjection * rightDelays).cast<float>();
+			_bucket.delayCoefficients.left.assign(leftDelayCoefficients.data(), leftDelayCoefficients.data() + numberOfDelayCoefficients);
+			_bucket.delayCoefficients.right.assign(rightDelayCoefficients.data(), rightDelayCoefficients.data() + numberOfDelayCoefficients);
+
+			// Partitioned spectra of every measurement, one row each
+			TRowMajorMatrix leftSpectra, rightSpectra;
+			for (int i = 0; i < numberOfMeasurements; i++) {
+				TIRStruct & ir = _table[_measurements[i]].data;
+				const TFRPartitionedStruct partitionedFR = CFIRTableAuxiliarMethods::SplitAndGetFFT_HRTFData()(ir, globalParameters.GetBufferSize(), partitionedFRNumberOfSubfilters);
+				CMonoBuffer<float>().swap(ir.IR.left);
+				CMonoBuffer<float>().swap(ir.IR.right);
+				const size_t numberOfSubfilters = static_cast<size_t>(partitionedFRNumberOfSubfilters);
+				if (partitionedFR.IR.left.size() != numberOfSubfilters || partitionedFR.IR.right.size() != numberOfSubfilters) {
+					SET_RESULT(RESULT_ERROR_BADSIZE, "ERROR SphericalHarmonicFIRTable::EndSetup - The IRs do not have the same length");
+					return false;
+				}
+				if (i == 0) {
+					partitionedFRSubfilterLength = static_cast<int32_t>(partitionedFR.IR.left[0].size());
+					leftSpectra.resize(numberOfMeasurements, partitionedFRNumberOfSubfilters * partitionedFRSubfilterLength);
+					rightSpectra.resize(numberOfMeasurements, partitionedFRNumberOfSubfilters * partitionedFRSubfilterLength);
+				}
+				for (int j = 0; j < partitionedFRNumberOfSubfilters; j++) {
+					std::copy(partitionedFR.IR.left[j].begin(), partitionedFR.IR.left[j].end(), leftSpectra.row(i).data() + j * partitionedFRSubfilterLength);
+					std::copy(partitionedFR.IR.right[j].begin(), partitionedFR.IR.right[j].end(), rightSpectra.row(i).data() + j * partitionedFRSubfilterLength);
+				}
+			}
+
+			// Spectra coefficients
+			const Eigen::MatrixXf floatProjection = projection.cast<float>();
+			TRowMajorMatrix leftCoefficients = floatProjection * leftSpectra;
+			leftSpectra.resize(0, 0);
+			TRowMajorMatrix rightCoefficients = floatProjection * rightSpectra;
+			rightSpectra.resize(0, 0);
+			_bucket.coefficients.left.assign(leftCoefficients.data(), leftCoefficients.data() + leftCoefficients.size());
+			_bucket.coefficients.right.assign(rightCoefficients.data(), rightCoefficients.data() + rightCoefficients.size());
+			return true;
+		}
+
+		/**
+		 * @brief Calculate the regularized least squares projection (Y'Y + lambda D)^-1 Y', where D penalizes each coefficient of order n
+			with 1 + n(n + 1)
+		 * @param _sphericalHarmonicsMatrix spherical harmonics of the measured directions, one row per direction
+		 * @param _order order of the expansion
+		 * @param _projection projection matrix, one row per coefficient
+		 * @return true if the system could be solved
+		 */
+		bool CalculateProjection(const Eigen::MatrixXd & _sphericalHarmonicsMatrix, int _order, Eigen::MatrixXd & _projection) const {
+			const int numberOfCoefficients = GetNumberOfCoefficients(_order);
+			Eigen::MatrixXd normalMatrix = _sphericalHarmonicsMatrix.transpose() * _sphericalHarmonicsMatrix;
+			const double lambda = regularization * normalMatrix.trace() / numberOfCoefficients;
+			for (int n = 0; n <= _order; n++) {
+				for (int m = -n; m <= n; m++) {
+					normalMatrix(n * n + n + m, n * n + n + m) += lambda * (1.0 + n * (n + 1));
+				}
+			}
+			Eigen::LDLT<Eigen::MatrixXd> solver(normalMatrix);
+			if (solver.info() != Eigen::Success) { return false; }
+			_projection = solver.solve(_sphericalHarmonicsMatrix.transpose());
+			return solver.info() == Eigen::Success;
+		}
+
+		////////////////////
+		// EVALUATION METHODS
+		////////////////////
+		/**
+		 * @brief Number of coefficients of a real spherical harmonic expansion
+		 */
+		static int GetNumberOfCoefficients(int _order) { return (_order + 1) * (_order + 1); }
+
+		/**
+		 * @brief Calculate the real spherical harmonics of a direction, in ACN order and N3D normalization, without the Condon-Shortley phase
+		 * @param _order order of the expansion
+		 * @param _azimuth azimuth in degrees
+		 * @param _elevation elevation in degrees
+		 * @param _sphericalHarmonics (order + 1)^2 values
+		 */
+		template <typename T>
+		static void CalculateSphericalHarmonics(int _order, double _azimuth, double _elevation, std::vector<T> & _sphericalHarmonics) {
+			const double azimuth = _azimuth * M_PI / 180.0;
+			const double elevation = _elevation * M_PI / 180.0;
+			const double x = std::sin(elevation);
+			const double s = std::cos(elevation);
+			_sphericalHarmonics.resize(GetNumberOfCoefficients(_order));
+
+			// Associated Legendre functions P(n, m) of order m, starting from P(m, m)
+			std::vector<double> legendre(_order + 1);
+			double legendreMM = 1.0;
+			for (int m = 0; m <= _order; m++) {
+				if (m > 0) { legendreMM *= (2 * m - 1) * s; }
+				const double cosine = std::cos(m * azimuth);
+				const double sine = std::sin(m * azimuth);
+				legendre[m] = legendreMM;
+				if (m < _order) { legendre[m + 1] = (2 * m + 1) * x * legendreMM; }
+				for (int n = m + 2; n <= _order; n++) {
+					legendre[n] = ((2 * n - 1) * x * legendre[n - 1] - (n + m - 1) * legendre[n - 2]) / (n - m);
+				}
+				// N3D normalization, sqrt((2n + 1) (2 - delta(m)) (n - m)! / (n + m)!)
+				double factorialRatio = 1.0;
+				for (int i = 1; i <= 2 * m; i++) { factorialRatio /= i; }
+				for (int n = m; n <= _order; n++) {
+					if (n > m) { factorialRatio *= static_cast<double>(n - m) / (n + m); }
+					const double normalization = std::sqrt((2 * n + 1) * (m == 0 ? 1.0 : 2.0) * factorialRatio);
+					_sphericalHarmonics[n * n + n + m] = static_cast<T>(normalization * legendre[n] * cosine);
+					if (m > 0) { _sphericalHarmonics[n * n + n - m] = static_cast<T>(normalization * legendre[n] * sine); }
+				}
+			}
+		}
+
+		/**
+		 * @brief Evaluate the partitioned spectra of a direction, adding every row of coefficients weighted by its spherical harmonic
+		 * @param _coefficients spectra coefficients of one ear
+		 * @param _sphericalHarmonics spherical harmonics of the direction
+		 * @param _fr partitioned spectra
+		 */
+		void EvaluateSpectra(const std::vector<float> & _coefficients, const std::vector<float> & _sphericalHarmonics, TFRPartitions & _fr) const {
+			const Eigen::Index numberOfValues = static_cast<Eigen::Index>(partitionedFRNumberOfSubfilters) * partitionedFRSubfilterLength;
+			const Eigen::Map<const Eigen::VectorXf> weights(_sphericalHarmonics.data(), _sphericalHarmonics.size());
+			_fr.resize(partitionedFRNumberOfSubfilters);
+			for (int32_t j = 0; j < partitionedFRNumberOfSubfilters; j++) {
+				_fr[j].resize(partitionedFRSubfilterLength);
+				// Coefficients of this subfilter, one row per spherical harmonic
+				const Eigen::Map<const TRowMajorMatrix, 0, Eigen::OuterStride<>> rows(_coefficients.data() + j * partitionedFRSubfilterLength,
+					weights.size(), partitionedFRSubfilterLength, Eigen::OuterStride<>(numberOfValues));
+				Eigen::Map<Eigen::VectorXf>(_fr[j].data(), partitionedFRSubfilterLength).noalias() = rows.transpose() * weights;
+			}
+		}
+
+		/**
+		 * @brief Evaluate the delay of a direction
+		 * @param _coefficients delay coefficients of one ear
+		 * @param _sphericalHarmonics spherical harmonics of the direction
+		 * @return delay in samples
+		 */
+		static uint64_t EvaluateDelay(const std::vector<float> & _coefficients, const std::vector<float> & _sphericalHarmonics) {
+			float delay = 0;
+			for (size_t k = 0; k < _coefficients.size(); k++) {
+				delay += _coefficients[k] * _sphericalHarmonics[k];
+			}
+			return delay > 0 ? static_cast<uint64_t>(std::round(delay)) : 0;
+		}
+
+		//////////////////////////////////
+		// FIND METHODS
+		//////////////////////////////////
+		const TSphericalHarmonicBucket * FindNearestDistanceBucket(int32_t queryDistanceMm) const {
+			if (distanceSHTable.empty()) { return nullptr; }
+
+			// distanceSHTable is sorted by distance_mm
+			auto it = std::lower_bound(distanceSHTable.begin(), distanceSHTable.end(), queryDistanceMm,
+				[](const TSphericalHarmonicBucket & b, int32_t key) { return b.distance_mm < key; });
+
+			if (it == distanceSHTable.begin()) return &(*it);
+			if (it == distanceSHTable.end()) return &distanceSHTable.back();
+
+			const auto & hi = *it;
+			const auto & lo = *(it - 1);
+			return (queryDistanceMm - lo.distance_mm <= hi.distance_mm - queryDistanceMm) ? &lo : &hi;
+		}
+
+		// Memory used by the raw data and the coefficients. The mutex must be locked.
+		size_t CalculateMemoryFootprint() const {
+			size_t size = CFIRTableAuxiliarMethods::CalculateMemoryFootprint(sofaIRDataBase);
+			for (const TSphericalHarmonicBucket & it : distanceSHTable) {
+				size += (it.coefficients.left.size() + it.coefficients.right.size()) * sizeof(float);
+				size += (it.delayCoefficients.left.size() + it.delayCoefficients.right.size()) * sizeof(float);
+			}
+			return size;
+		}
+
+		///////////////
+		// ATTRIBUTES
+		///////////////
+		mutable std::mutex mutex;					// Thread management
+		Common::CGlobalParameters globalParameters; // Global parameters of the system
+
+		int32_t partitionedFRNumberOfSubfilters;	// Number of subfilters (blocks) for the UPC algorithm
+		int32_t partitionedFRSubfilterLength;		// Size of one HRIR subfilter
+
+		Common::CCranialGeometry cranialGeometry;			// Cranial geometry of the listener
+		Common::CCranialGeometry originalCranialGeometry;	// Cranial geometry of the listener
+
+		bool setupInProgress;	// Variable that indicates the HRTF add and fit algorithm are in process
+		bool customITD;			// Indicate the use of a customized delay
+		int order;				// Order of the expansion of the spectra
+		int delayOrder;			// Order of the expansion of the delays
+		float regularization;	// Regularization of the least squares fit
+
+		float fadeInBegin;		// Variable to be used in the windowing IR process
+		float riseTime;			// Variable to be used in the windowing IR process
+		float fadeOutCutoff;	// Variable to be used in the windowing IR process
+		float fallTime;			// Variable to be used in the windowing IR process
+
+		// Tables
+		TRawSofaData sofaIRDataBase;								// Time domain database - original data from SOFA file
+		std::vector<TSphericalHarmonicBucket> distanceSHTable;		// Spherical harmonic coefficients, by distance buckets
+	};
+}
+#endif
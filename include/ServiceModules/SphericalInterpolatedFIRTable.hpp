@@ -30,7 +30,13 @@
 #include <vector>
 #include <utility>
 #include <list>
+#include <deque>
+#include <memory>
 #include <cstdint>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <unordered_set>
 #include <Common/Buffer.hpp>
 #include <Common/ErrorHandler.hpp>
 #include <Common/FFTCalculator.hpp>
@@ -40,6 +46,7 @@
 #include <Common/IRWindowing.hpp>
 #include <ServiceModules/ServicesBase.hpp>
 #include <ServiceModules/SphericalFIRTableDefinitions.hpp>
+#include <ServiceModules/SharedFIRTableImage.hpp>
 #include <ServiceModules/FIRTableAuxiliarMethods.hpp>
 #include <ServiceModules/OnlineInterpolation.hpp>
 #include <ServiceModules/GridsManager.hpp>
@@ -47,6 +54,7 @@
 #include <ServiceModules/OfflineInterpolation.hpp>
 #include <ServiceModules/OfflineInterpolationAuxiliarMethods.hpp>
 #include <ServiceModules/InterpolationAuxiliarMethods.hpp>
+#include <ServiceModules/SetupWorkerPool.hpp>
 
 namespace BRTBase { class CListener; }
 
@@ -81,7 +89,24 @@ namespace BRTServices
 			, partitionedFRNumberOfSubfilters { 0 }
 			, partitionedFRSubfilterLength { 0 }			
 			, extrapolationMethod{ TEXTRAPOLATION_METHOD::nearest_point }
+			, spectralStoragePrecision{ Common::TSpectralPrecision::float32 }
+			, sharedMemoryEnabled{ false }
+			, progressiveSetupEnabled{ false }
+			, progressiveGridSamplingStep{ DEFAULT_PROGRESSIVE_GRIDSAMPLING_STEP }
+			, progressiveSetupRunning{ false }
+			, fullResolutionReady{ false }
+			, cancelProgressiveSetup{ false }
+			, publishedTable{ nullptr }
+			, activeLookups{ { 0 }, { 0 } }
+			, lookupEpoch{ 0 }
 		{ }
+
+		/** \brief Destructor
+		*	\details Stops the background build of the full resolution table, if any
+		*/
+		~CSphericalInterpolatedFIRTable() {
+			StopProgressiveSetup();
+		}
 		
 		/** \brief Switch on ITD customization in accordance with the listener head radius
 		*   \eh Nothing is reported to the error handler.
@@ -103,13 +128,13 @@ namespace BRTServices
 		*	\retval n Number of HRIR subfilters
 		*   \eh Nothing is reported to the error handler.
 		*/		
-		const int32_t GetNumberOfSubfiltersFR() const override { return partitionedFRNumberOfSubfilters;	}
+		int32_t GetNumberOfSubfiltersFR() const override { return partitionedFRNumberOfSubfilters;	}
 
 		/** \brief	Get the size of subfilters (blocks) in which the HRIR has been partitioned, every subfilter has the same size
 		*	\retval size Size of HRIR subfilters
 		*   \eh Nothing is reported to the error handler.
 		*/		
-		const int32_t GetSubfilterLengthFR() const override {	return partitionedFRSubfilterLength; }
+		int32_t GetSubfilterLengthFR() const override {	return partitionedFRSubfilterLength; }
 			
 		/** \brief	Set the radius of the listener head
 		*   \eh Nothing is reported to the error handler.
@@ -188,12 +213,13 @@ namespace BRTServices
 		*/
 		double GetDistanceOfMeasurement(const Common::CTransform & _referenceLocation, const double & _azimuth, const double & _elevation, const double & _distance) const override {
 
-			if (!dataReady) {
+			CLookupGuard lookup(*this);
+			if (lookup.table == nullptr) {
 				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "GetDistanceOfMeasurement: HRTF data not ready");
 				return 0;
 			}
 			// Find Table to use if exists
-			const TDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
+			const TDistanceBucket * distanceBucket = FindDistanceBucket(lookup.table->distances, _distance);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetDistanceOfMeasurement: Distance Bucket find error");
 				return 0;
@@ -212,18 +238,24 @@ namespace BRTServices
 		 * @param _windowRiseTime time (secons) for the window to go from 0 to 1. A value of zero would represent the step window. 
 		 */
 		void SetWindowingParameters(float _fadeInBegin, float _riseTime, float _fadeOutCutoff, float _fallTime) override {
+			StopProgressiveSetup();
 			mutex.lock();
+			if (IsRawDataReleased(sofaIRDataBase.empty())) {
+				mutex.unlock();
+				return;
+			}
 			fadeInBegin = _fadeInBegin;
 			riseTime = _riseTime;
 			fadeOutCutoff = _fadeOutCutoff;
 			fallTime = _fallTime;
 
 			mutex.unlock();
+			// IRs already windowed with the previous parameters are windowed again in EndSetup
+			DiscardPipelinedIRs();
 			if (dataReady) {
 				setupInProgress = true;
 				dataReady = false;
-				distanceFRTable.clear();
-				stepVector.clear();
+				ReplaceTable(nullptr);
 				EndSetup();
 			}
 		}
@@ -256,20 +288,177 @@ namespace BRTServices
 			return gridSamplingStep;
 		}
 
+		/**
+		 * @brief Set the format used to store the resampled table. With a 16-bit format the table needs half of the memory, see
+			Common::TSpectralPrecision for the accuracy. It has to be set before EndSetup.
+		 * @param _precision storage format
+		 */
+		void SetSpectralStoragePrecision(Common::TSpectralPrecision _precision) override {
+			spectralStoragePrecision = _precision;
+		}
+		/**
+		 * @brief Get the format used to store the resampled table
+		 * @return storage format
+		 */
+		Common::TSpectralPrecision GetSpectralStoragePrecision() const override {
+			return spectralStoragePrecision;
+		}
+
+		/**
+		 * @brief Share the resampled table with other processes. In EndSetup, if a table with the same raw data and processing parameters
+			has already been published, it is used directly from shared memory without any processing. Otherwise the table is processed
+			and published, and this table also uses the published copy. It has to be set before EndSetup.
+		 */
+		void EnableSharedMemory() override { sharedMemoryEnabled = true; }
+
+		/**
+		 * @brief Do not share the resampled table with other processes. It has to be set before EndSetup.
+		 */
+		void DisableSharedMemory() override { sharedMemoryEnabled = false; }
+
+		/**
+		 * @brief Check if the resampled table is shared with other processes
+		 */
+		bool IsSharedMemoryEnabled() const override { return sharedMemoryEnabled; }
+
+		/**
+		 * @brief Window every IR on worker threads as soon as it is added, so that it overlaps the reading of the rest of the IRs.
+			The partitioned FFTs are calculated on the resampled grid, which needs all the IRs, so they are still done in EndSetup.
+			It has to be set before BeginSetup.
+		 * @param _numberOfThreads number of worker threads. With 0, one less than the number of hardware threads is used.
+		 */
+		void EnablePipelinedSetup(int _numberOfThreads = 0) override {
+			if (setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Pipelined setup cannot be enabled while a setup is in progress");
+				return;
+			}
+			setupWorkerPool = std::make_unique<CSetupWorkerPool>(_numberOfThreads);
+		}
+
+		/**
+		 * @brief Window all the IRs in EndSetup, in the calling thread. It has to be set before BeginSetup.
+		 */
+		void DisablePipelinedSetup() override {
+			if (setupInProgress) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Pipelined setup cannot be disabled while a setup is in progress");
+				return;
+			}
+			setupWorkerPool.reset();
+		}
+
+		/**
+		 * @brief Check if the IRs are windowed on worker threads while they are added
+		 */
+		bool IsPipelinedSetupEnabled() const override { return setupWorkerPool != nullptr; }
+
+		/**
+		 * @brief Make the service available as soon as possible after EndSetup. EndSetup builds a coarse table, with the step set by
+			SetProgressiveGridSamplingStep, and returns. The table with the grid sampling step is built on a background thread and
+			replaces the coarse one when it is finished. Both tables have the same partitions, so the convolvers using the service
+			keep working during the change. It has to be set before EndSetup.
+		 */
+		void EnableProgressiveSetup() override { progressiveSetupEnabled = true; }
+
+		/**
+		 * @brief Build the table with the grid sampling step in EndSetup. It has to be set before EndSetup.
+		 */
+		void DisableProgressiveSetup() override { progressiveSetupEnabled = false; }
+
+		/**
+		 * @brief Check if EndSetup builds a coarse table first and the full resolution one in background
+		 */
+		bool IsProgressiveSetupEnabled() const override { return progressiveSetupEnabled; }
+
+		/**
+		 * @brief Set sampling step of the coarse table built first in a progressive setup. If it is not greater than the grid sampling
+			step, the full resolution table is built directly.
+		 * @param _samplingStep step in degrees
+		 */
+		void SetProgressiveGridSamplingStep(int _samplingStep) {
+			progressiveGridSamplingStep = _samplingStep;
+		}
+
+		/**
+		 * @brief Get sampling step of the coarse table built first in a progressive setup
+		 */
+		int GetProgressiveGridSamplingStep() const {
+			return progressiveGridSamplingStep;
+		}
+
+		/**
+		 * @brief Check if the table with the grid sampling step is the one in use
+		 */
+		bool IsFullResolutionReady() const {
+			std::lock_guard<std::mutex> l(mutex);
+			return fullResolutionReady;
+		}
+
+		/**
+		 * @brief Block until the background build of the full resolution table, if any, has finished
+		 * @return true if the table with the grid sampling step is the one in use
+		 */
+		bool WaitForFullResolution() override {
+			std::unique_lock<std::mutex> l(mutex);
+			fullResolutionCondition.wait(l, [this]() { return !progressiveSetupRunning; });
+			return fullResolutionReady;
+		}
+
+		/**
+		 * @brief Check if the resampled table is currently held in a shared memory segment
+		 */
+		bool IsUsingSharedMemory() const override {
+			std::lock_guard<std::mutex> l(mutex);
+			return resampledTable && resampledTable->segment != nullptr;
+		}
+
+		/**
+		 * @brief Get the name of the shared memory segment used by this table
+		 * @return segment name, empty if no segment is used
+		 */
+		std::string GetSharedMemoryName() const {
+			std::lock_guard<std::mutex> l(mutex);
+			return resampledTable && resampledTable->segment ? resampledTable->segment->GetName() : std::string();
+		}
+
+		/**
+		 * @brief Get the memory used by the table data: the raw data and the resampled table. The resampled table is not counted when it is
+			held in shared memory.
+		 * @return size in bytes
+		 */
+		size_t GetMemoryFootprint() const override {
+			std::lock_guard<std::mutex> l(mutex);
+			return CalculateMemoryFootprint();
+		}
+
+		/**
+		 * @brief Remove the name of the shared memory segment used by this table, so that no other process can use it from now on.
+			The segment is removed automatically when the last table that uses it, in any process, releases it. This method is only
+			needed to discard it earlier, or where the automatic removal is not supported. On Windows the segment is released when
+			the last process that uses it finishes, so this method does nothing.
+		 * @return true if the name has been removed
+		 */
+		bool RemoveSharedMemory() {
+			std::lock_guard<std::mutex> l(mutex);
+			if (!resampledTable || !resampledTable->segment) { return false; }
+			return Common::CSharedMemorySegment::Remove(resampledTable->segment->GetName());
+		}
+
 		/** \brief Start a new HRTF configuration
 		*	\param [in] _HRIRLength buffer size of the HRIR to be added
 		*   \eh On success, RESULT_OK is reported to the error handler.
 		*       On error, an error code is reported to the error handler.
 		*/
 		bool BeginSetup(const int32_t & _HRIRLength, const BRTServices::TEXTRAPOLATION_METHOD & _extrapolationMethod) override {
+			StopProgressiveSetup();
 			std::lock_guard<std::mutex> l(mutex);
 			// Change class state
 			setupInProgress = true;			
 			dataReady = false;
+			fullResolutionReady = false;
 
 			// Clear every table
-			stepVector.clear();
-			distanceFRTable.clear();
+			DiscardPipelinedIRs();
+			ReplaceTable(nullptr);
 			sofaIRDataBase.clear();
 
 			//Update parameters
@@ -296,6 +485,8 @@ namespace BRTServices
 			newData.data =TIRStruct(TOrientation(_azimuthInRage, _elevationInRange, _distance), std::forward<TIRStruct>(_newIR));			
 
 			sofaIRDataBase.push_back(std::forward<TSofaDataBucket>(newData));
+
+			if (setupWorkerPool) { SubmitPipelinedIR(sofaIRDataBase.back()); }
 		}
 
 		/** \brief Stop the HRTF configuration
@@ -303,6 +494,7 @@ namespace BRTServices
 		*       On error, an error code is reported to the error handler.
 		*/
 		bool EndSetup() override {
+			StopProgressiveSetup();
 			std::lock_guard<std::mutex> l(mutex);
 			if (!setupInProgress) {
 				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Cannot end setup - Setup not in progress");
@@ -314,52 +506,110 @@ namespace BRTServices
 			}
 
 			if (sofaIRDataBase.empty()) {
+				setupInProgress = false;
 				SET_RESULT(RESULT_ERROR_NOTSET, "ERROR SphericalFIRTable::EndSetup - No data to be processed");
 				return false;
 			}
 			if (sofaIRDataBase.size() > 1) spatiallyOriented = true;
 
+			// The same table may have been published already, by this or another process
+			uint64_t sharedKey = 0;
+			if (sharedMemoryEnabled) {
+				sharedKey = CSharedFIRTableImage::CalculateKey(sofaIRDataBase, GetSharedTableParameters());
+				if (AttachSharedTable(CSharedFIRTableImage::Open(sharedKey))) {
+					DiscardPipelinedIRs();
+					ReleaseRawData();
+					setupInProgress = false;
+					dataReady = true;
+					fullResolutionReady = true;
+					setupRevision++;
+
+					SET_RESULT(RESULT_OK, "HRTF table attached to shared memory segment " + resampledTable->segment->GetName() + ", memory footprint " + std::to_string(CalculateMemoryFootprint()) + " bytes");
+					return true;
+				}
+			}
+
 			TRawSofaData windowingIRTable;
-			CalculateWindowingIRTable(sofaIRDataBase, windowingIRTable);
+			if (WaitForPipelinedIRs()) {
+				// Every IR has been windowed while it was added
+				if (pipelinedIRs.front().windowed) {
+					impulseResponseLength = pipelinedIRs.front().windowedIR.data.IR.left.size();
+					partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
+				}
+				windowingIRTable.reserve(pipelinedIRs.size());
+				for (auto & it : pipelinedIRs) {
+					windowingIRTable.push_back(std::move(it.windowedIR));
+				}
+				pipelinedIRs.clear();
+			} else {
+				DiscardPipelinedIRs();
+				if (rawDataReleaseEnabled) {
+					// The raw data is not kept, so it is windowed in place instead of copied
+					windowingIRTable = std::move(sofaIRDataBase);
+					sofaIRDataBase.clear();
+				} else {
+					windowingIRTable = sofaIRDataBase;
+				}
+				CalculateWindowingIRTable(windowingIRTable);
+			}
 			if (serviceType == TServiceType::hrir_database_interpolated) {
 				CFIRTableAuxiliarMethods::RemoveCommonDelayFromTable(windowingIRTable);
 			}
 
+			// The IRs are moved to the tables of each distance, which are released while the resampled table is built
 			TRawSofaTableByDistances sofaIRDatabaseByDistances;
 			SlipRawDataByDistances(windowingIRTable, sofaIRDatabaseByDistances);
 
-			distanceFRTable.clear();
-			for (auto & distBucketIt : sofaIRDatabaseByDistances) {
-				std::vector<TOrientation> _orientationList = offlineInterpolation.CalculateListOfOrientations(distBucketIt.table);
-				CalculateExtrapolation(distBucketIt.table, _orientationList); // Make the extrapolation if it's needed
-				offlineInterpolation.CalculateTF_InPoles<TRawSofaTable, BRTServices::TIRStruct>(distBucketIt.table, impulseResponseLength, gridSamplingStep, CFIRTableAuxiliarMethods::CalculateHRIRFromHemisphereParts());
-				offlineInterpolation.CalculateTF_SphericalCaps<TRawSofaTable, BRTServices::TIRStruct>(distBucketIt.table, impulseResponseLength, gapThreshold, gridSamplingStep, CFIRTableAuxiliarMethods::CalculateHRIRFromBarycentrics_OfflineInterpolation());
-
-				TDistanceBucket aux;
-				aux.distance_mm = distBucketIt.distance_mm;
-
-				//Creation and filling of resampling HRTF table
-				CQuasiUniformSphereDistribution::CreateGrid<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(aux.table, stepVector, gridSamplingStep, distBucketIt.distance);
-				offlineInterpolation.FillResampledTable<TRawSofaTable, TSphericalFIRTablePartitioned, BRTServices::TIRStruct, BRTServices::TFRPartitionedStruct>(distBucketIt.table, aux.table, globalParameters.GetBufferSize(), impulseResponseLength, partitionedFRNumberOfSubfilters, CFIRTableAuxiliarMethods::SplitAndGetFFT_HRTFData(), CFIRTableAuxiliarMethods::CalculateHRIRFromBarycentrics_OfflineInterpolation());
-
-				// Add to vector of tables
-				distanceFRTable.push_back(std::move(aux));
+			// In a progressive setup a coarse table is published first, and the full resolution one is built in background. The coarse
+			// build reads the raw tables in place and leaves them as they were, so that they are not copied.
+			const bool progressive = progressiveSetupEnabled && progressiveGridSamplingStep > gridSamplingStep;
+			const TBuildParameters buildParameters = GetBuildParameters();
+			std::unique_ptr<TResampledTable> newTable(new TResampledTable());
+			if (progressive) {
+				BuildResampledTable(sofaIRDatabaseByDistances, progressiveGridSamplingStep, buildParameters, true, newTable->distances, newTable->steps, offlineInterpolation, extrapolation);
+			} else {
+				BuildResampledTable(sofaIRDatabaseByDistances, gridSamplingStep, buildParameters, false, newTable->distances, newTable->steps, offlineInterpolation, extrapolation);
+			}
+			if (newTable->distances.empty() || newTable->distances.front().table.empty()) {
+				ReleaseRawData();
+				setupInProgress = false;
+				SET_RESULT(RESULT_ERROR_NOTSET, "ERROR SphericalFIRTable::EndSetup - The resampled table is empty");
+				return false;
 			}
 
 			//Setup values
-			if (!distanceFRTable.empty()) {
-				auto it = distanceFRTable.begin();
-				if (!it->table.empty()) {
-					partitionedFRSubfilterLength = it->table.begin()->second.IR.left[0].size();
-					//partitionedFRSubfilterLength = it->table> second.IR.left[0].size();
-					setupInProgress = false;
-					dataReady = true;
-
-					SET_RESULT(RESULT_OK, "Non-Interpolated HRTF Matrix resample completed succesfully");
-					return true;
-				}
+			partitionedFRSubfilterLength = newTable->distances.front().table.begin()->second.IR.left[0].size();
+			CompactTable(newTable->distances, buildParameters.precision);
+			// Once published, the local copy is replaced by the shared one
+			if (!(sharedMemoryEnabled && !progressive && AttachSharedTable(CSharedFIRTableImage::Publish(sharedKey, GetSharedTableLayout(buildParameters, partitionedFRSubfilterLength), newTable->distances, newTable->steps)))) {
+				ReplaceTable(std::move(newTable));
+			}
+			ReleaseRawData();
+			setupInProgress = false;
+			dataReady = true;
+			setupRevision++;
+
+			if (progressive) {
+				fullResolutionReady = false;
+				progressiveSetupRunning = true;
+				progressiveSetupThread = std::thread([this, rawTables = std::move(sofaIRDatabaseByDistances), step = gridSamplingStep, sharedKey, buildParameters]() mutable {
+					try {
+						BuildFullResolutionTable(rawTables, step, buildParameters, sharedKey);
+					} catch (...) {
+						SET_RESULT(RESULT_ERROR_EXCEPTION, "Exception building the full resolution HRTF table");
+					}
+					{
+						std::lock_guard<std::mutex> l(mutex);
+						progressiveSetupRunning = false;
+					}
+					fullResolutionCondition.notify_all();
+				});
+				SET_RESULT(RESULT_OK, "Coarse HRTF table ready, the full resolution table is being built in background");
+				return true;
 			}
-			return false;
+			fullResolutionReady = true;
+			SET_RESULT(RESULT_OK, "Non-Interpolated HRTF Matrix resample completed succesfully, memory footprint " + std::to_string(CalculateMemoryFootprint()) + " bytes");
+			return true;
 		}
 
 
@@ -381,7 +631,7 @@ namespace BRTServices
 
 
 		const TFRPartitions GetFR_SpatiallyOriented(const float & _azimuth, const float & _elevation, const float & _distance, const Common::CTransform & _referenceLocation, const Common::T_ear & ear, bool _runTimeInterpolation) const override { 			
-			//std::lock_guard<std::mutex> l(mutex);
+			CLookupGuard lookup(*this);	// Without the mutex, the table is kept until the lookup finishes
 			TFRPartitions _foundData;
 
 			if (ear == Common::T_ear::BOTH || ear == Common::T_ear::NONE) {
@@ -389,43 +639,41 @@ namespace BRTServices
 				return _foundData;
 			}
 			
-			if (setupInProgress) {
+			if (lookup.table == nullptr) {
 				SET_RESULT(RESULT_ERROR_NOTSET, "GetHRIR_partitioned: nonInterpolatedHRTF Setup in progress return empty");
 				return _foundData;
 			}
 
 			// Find Table to use if exists
-			const TDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
+			const TDistanceBucket * distanceBucket = FindDistanceBucket(lookup.table->distances, _distance);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
 				return _foundData;
 			}
 				
-			_foundData = CFIRTableAuxiliarMethods::GetHRIRFromPartitionedTable(distanceBucket->table, ear, _azimuth, _elevation, _runTimeInterpolation,
-				partitionedFRNumberOfSubfilters, partitionedFRSubfilterLength, stepVector);
+			_foundData = CFIRTableAuxiliarMethods::GetHRIRFromPartitionedTable(*distanceBucket, ear, _azimuth, _elevation, _runTimeInterpolation);
 			return _foundData;
 		}
 		
 		const Common::CEarPair<TFRPartitions> GetFR_SpatiallyOriented_2Ears(const float & _azimuth, const float & _elevation, const float & _distance, const Common::CTransform & _referenceLocation, bool _runTimeInterpolation) const override { 
 		
-			std::lock_guard<std::mutex> l(mutex);
+			CLookupGuard lookup(*this);
 			Common::CEarPair<TFRPartitions> _foundData;
 			
-			if (setupInProgress) {
+			if (lookup.table == nullptr) {
 				SET_RESULT(RESULT_ERROR_NOTSET, "GetHRIR_partitioned: nonInterpolatedHRTF Setup in progress return empty");
 				return _foundData;
 			}			
 
 			// Find Table to use if exists
-			const TDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
+			const TDistanceBucket * distanceBucket = FindDistanceBucket(lookup.table->distances, _distance);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
 				return _foundData;
 			}
 
 			//TFRPartitions foundData;
-			_foundData = CFIRTableAuxiliarMethods::GetHRIRFromPartitionedTable_2Ears(distanceBucket->table, _azimuth, _elevation, _runTimeInterpolation,
-				partitionedFRNumberOfSubfilters, partitionedFRSubfilterLength, stepVector);
+			_foundData = CFIRTableAuxiliarMethods::GetHRIRFromPartitionedTable_2Ears(*distanceBucket, _azimuth, _elevation, _runTimeInterpolation);
 			return _foundData;
 		}
 				
@@ -441,10 +689,10 @@ namespace BRTServices
 		 */
 		const Common::CEarPair<uint64_t> GetFR_Delay(const float & _azimuthCenter, const float & _elevationCenter, const float & _distance, const Common::CTransform & _referenceLocation, bool _runTimeInterpolation) const override { 
 			
-			std::lock_guard<std::mutex> l(mutex);			
+			CLookupGuard lookup(*this);
 			Common::CEarPair<uint64_t> foundData { 0, 0 };
 
-			if (setupInProgress) {
+			if (lookup.table == nullptr) {
 				SET_RESULT(RESULT_ERROR_NOTSET, "GetHRIR_partitioned: nonInterpolatedHRTF Setup in progress return empty");
 				return foundData;
 			}
@@ -457,20 +705,59 @@ namespace BRTServices
 			}
 
 			// Find Table to use if exists
-			const TDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
+			const TDistanceBucket * distanceBucket = FindDistanceBucket(lookup.table->distances, _distance);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
 				return foundData;
 			}		
 			
-			foundData = CFIRTableAuxiliarMethods::GetHRIRDelayFromPartitioned_2Ears(distanceBucket->table, _azimuthCenter, _elevationCenter, _runTimeInterpolation,
-				partitionedFRNumberOfSubfilters, partitionedFRSubfilterLength, stepVector);
+			foundData = CFIRTableAuxiliarMethods::GetHRIRDelayFromPartitioned_2Ears(*distanceBucket, _azimuthCenter, _elevationCenter, _runTimeInterpolation);
 			
 			return foundData;
 		}
 
 
 	private:				
+		/// Resampled table and the data it depends on. It is not modified once it is in use.
+		struct TResampledTable {
+			std::shared_ptr<Common::CSharedMemorySegment> segment;	// Segment holding the table, if it is shared. Declared first, as the table holds views into it.
+			TDistanceTable distances;								// Data in our grid, interpolated, by distance buckets
+			std::unordered_map<TOrientation, float> steps;			// Store hrtf interpolated grids steps
+		};
+
+		/// Processing parameters used to build a resampled table
+		struct TBuildParameters {
+			int32_t impulseResponseLength;
+			int32_t numberOfSubfilters;
+			int bufferSize;
+			int gapThreshold;
+			TEXTRAPOLATION_METHOD extrapolationMethod;
+			Common::TSpectralPrecision precision;
+			bool sharedMemory;
+		};
+
+		/// Access to the table in use from a lookup. The table is not released while the guard exists.
+		/// The lookup is counted in the epoch in which it reads the table, so that replacing it only waits for the lookups of the previous one.
+		class CLookupGuard {
+		public:
+			CLookupGuard(const CSphericalInterpolatedFIRTable & _owner) : owner { _owner } {
+				// If a table is published between reading the epoch and counting the lookup, it is counted again in the new epoch
+				epoch = owner.lookupEpoch.load();
+				owner.activeLookups[epoch & 1].fetch_add(1);
+				while (owner.lookupEpoch.load() != epoch) {
+					owner.activeLookups[epoch & 1].fetch_sub(1);
+					epoch = owner.lookupEpoch.load();
+					owner.activeLookups[epoch & 1].fetch_add(1);
+				}
+				table = owner.publishedTable.load();
+			}
+			~CLookupGuard() { owner.activeLookups[epoch & 1].fetch_sub(1); }
+			const TResampledTable * table;
+		private:
+			const CSphericalInterpolatedFIRTable & owner;
+			unsigned int epoch;
+		};
+
 		////////////////////
 		// SETUP METHODS
 		////////////////////
@@ -484,10 +771,10 @@ namespace BRTServices
 		/**
 		 * @brief Slip raw IR data into different tables according to the distance of the measurement. 
 		 * Every table will be used to create a resampled and partitioned HRTF table for that distance.
-		 * @param _inputData Raw IR data read from the sofa file
+		 * @param _inputData Raw IR data read from the sofa file. The IRs are moved to the output, and it is released on return.
 		 * @param _outpuTable vector of tables sliped by distance
 		 */
-		void SlipRawDataByDistances(const TRawSofaData & _inputData, TRawSofaTableByDistances & _outpuTable) {
+		void SlipRawDataByDistances(TRawSofaData & _inputData, TRawSofaTableByDistances & _outpuTable) {
 			if (!setupInProgress) {
 				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Cannot add IR - Setup not in progress");
 				return;
@@ -497,7 +784,7 @@ namespace BRTServices
 				const double & _azimuth = dataIt.data.orientation.azimuth;
 				const double & _elevation = dataIt.data.orientation.elevation;
 				const double & _distance = dataIt.data.orientation.distance;
-				TIRStruct newIRData = dataIt.data;
+				TIRStruct newIRData = std::move(dataIt.data);
 				// Find o create orientation bucket
 				TDistanceBucketRawSofa * distanceBucket = nullptr;
 
@@ -532,6 +819,7 @@ namespace BRTServices
 					}
 				}
 			}
+			TRawSofaData().swap(_inputData);
 			// Sort distance buckets by distance_mm
 			std::sort(_outpuTable.begin(), _outpuTable.end(),
 				[](const TDistanceBucketRawSofa & a, const TDistanceBucketRawSofa & b) {
@@ -542,15 +830,15 @@ namespace BRTServices
 		/**
 		 * @brief Call the extrapolation method. Fill the gaps of the table with the selected extrapolation method.		 
 		*/
-		void CalculateExtrapolation(TRawSofaTable & _table, std::vector<TOrientation> & _orientationList) {
+		void CalculateExtrapolation(TRawSofaTable & _table, std::vector<TOrientation> & _orientationList, const TBuildParameters & _parameters, CExtrapolation & _extrapolation) {
 			// Select the one that extrapolates with zeros or the one that extrapolates based on the nearest point according to some parameter.			
-			if (extrapolationMethod == BRTServices::TEXTRAPOLATION_METHOD::zero_insertion) {
+			if (_parameters.extrapolationMethod == BRTServices::TEXTRAPOLATION_METHOD::zero_insertion) {
 				SET_RESULT(RESULT_WARNING, "At least one large gap has been found in the loaded nonInterpolatedHRTF sofa file, an extrapolation with zeros will be performed to fill it.");
-				extrapolation.Process<TRawSofaTable, BRTServices::TIRStruct>(_table, _orientationList, impulseResponseLength, DEFAULT_EXTRAPOLATION_STEP, CFIRTableAuxiliarMethods::GetZerosHRIR());
+				_extrapolation.Process<TRawSofaTable, BRTServices::TIRStruct>(_table, _orientationList, _parameters.impulseResponseLength, DEFAULT_EXTRAPOLATION_STEP, CFIRTableAuxiliarMethods::GetZerosHRIR());
 			}
-			else if (extrapolationMethod == BRTServices::TEXTRAPOLATION_METHOD::nearest_point) {
+			else if (_parameters.extrapolationMethod == BRTServices::TEXTRAPOLATION_METHOD::nearest_point) {
 				SET_RESULT(RESULT_WARNING, "At least one large gap has been found in the loaded nonInterpolatedHRTF sofa file, an extrapolation will be made to the nearest point to fill it.");
-				extrapolation.Process<TRawSofaTable, BRTServices::TIRStruct>(_table, _orientationList, impulseResponseLength, DEFAULT_EXTRAPOLATION_STEP, CFIRTableAuxiliarMethods::GetNearestPointHRIR());
+				_extrapolation.Process<TRawSofaTable, BRTServices::TIRStruct>(_table, _orientationList, _parameters.impulseResponseLength, DEFAULT_EXTRAPOLATION_STEP, CFIRTableAuxiliarMethods::GetNearestPointHRIR());
 			}
 			else {
 				SET_RESULT(RESULT_ERROR_NOTSET, "Extrapolation Method not set up.");
@@ -613,12 +901,12 @@ namespace BRTServices
 		//	return fadeOutCutoff != 0 || fallTime != 0;
 		//}
 
-		void CalculateWindowingIRTable(const TRawSofaData & _inTable, TRawSofaData & _outTable) {
+		void CalculateWindowingIRTable(TRawSofaData & _table) {
 
-			if (CFIRTableAuxiliarMethods::CalculateWindowingIRTable(_inTable, _outTable, fadeInBegin, riseTime, fadeOutCutoff, fallTime, globalParameters.GetSampleRate())) {
+			if (CFIRTableAuxiliarMethods::CalculateWindowingIRTable(_table, fadeInBegin, riseTime, fadeOutCutoff, fallTime, globalParameters.GetSampleRate())) {
 
 				// Update impulseResponseLength and the number of subfilters
-				impulseResponseLength = _outTable.begin()->data.IR.left.size();
+				impulseResponseLength = _table.begin()->data.IR.left.size();
 				partitionedFRNumberOfSubfilters = CalculateNumberOPartitions(impulseResponseLength);
 			}			
 		}
@@ -629,16 +917,16 @@ namespace BRTServices
 
 		/**
 		 * @brief Find distance bucket for a given reference location and distance
-		 * @param _referenceLocation reference location
+		 * @param _table resampled table to search
 		 * @param _distance_m distance in meters
 		 * @return 
 		 */
-		const TDistanceBucket * FindDistanceBucket(const float & _distance_m) const {
+		const TDistanceBucket * FindDistanceBucket(const TDistanceTable & _table, const float & _distance_m) const {
 			const TDistanceBucket * distanceBucket = nullptr;
 
 			// Pick distance bucket (exact or nearest)
 			const int32_t qDistance_mm = quantise_dist_mm(_distance_m);
-			distanceBucket = FindNearestDistanceBucket(qDistance_mm);
+			distanceBucket = FindNearestDistanceBucket(_table, qDistance_mm);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
 				return distanceBucket;
@@ -646,18 +934,18 @@ namespace BRTServices
 			return distanceBucket;
 		}
 
-		const TDistanceBucket * FindNearestDistanceBucket(int32_t queryDistanceMm) const {
+		const TDistanceBucket * FindNearestDistanceBucket(const TDistanceTable & _table, int32_t queryDistanceMm) const {
 
 			// refBucket.distances MUST be sorted by distance_mm (done in finalizeBuild()).
-			auto it = std::lower_bound(distanceFRTable.begin(), distanceFRTable.end(), queryDistanceMm,
+			auto it = std::lower_bound(_table.begin(), _table.end(), queryDistanceMm,
 				[](const TDistanceBucket & b, int32_t key) { return b.distance_mm < key; });
 
 			// Nearest: choose closest between it and previous
-			if (it == distanceFRTable.begin())
+			if (it == _table.begin())
 				return &(*it);
 
-			if (it == distanceFRTable.end())
-				return &distanceFRTable.back();
+			if (it == _table.end())
+				return &_table.back();
 
 			const auto & hi = *it;
 			const auto & lo = *(it - 1);
@@ -667,17 +955,266 @@ namespace BRTServices
 
 			return (dLo <= dHi) ? &lo : &hi; // tie: pick any (lo)
 		}
+		// Move a resampled table to reduced precision storage, if it has been set
+		static void CompactTable(TDistanceTable & _table, Common::TSpectralPrecision _precision) {
+			if (_precision == Common::TSpectralPrecision::float32) { return; }
+			for (auto & distBucketIt : _table) {
+				for (auto & it : distBucketIt.table) {
+					it.second.Compact(_precision);
+				}
+			}
+		}
+
+		// Release the raw data, if it has been set. The mutex must be locked.
+		void ReleaseRawData() {
+			if (rawDataReleaseEnabled) { TRawSofaData().swap(sofaIRDataBase); }
+		}
+
+		// Memory used by the raw data and the resampled table. The mutex must be locked.
+		size_t CalculateMemoryFootprint() const {
+			size_t size = CFIRTableAuxiliarMethods::CalculateMemoryFootprint(sofaIRDataBase);
+			if (resampledTable) { size += CFIRTableAuxiliarMethods::CalculateMemoryFootprint(resampledTable->distances); }
+			return size;
+		}
+
+		// Processing parameters used to identify a shared table
+		TSharedFIRTableParameters GetSharedTableParameters() const {
+			TSharedFIRTableParameters parameters;
+			parameters.serviceType = static_cast<int32_t>(serviceType);
+			parameters.sampleRate = globalParameters.GetSampleRate();
+			parameters.bufferSize = globalParameters.GetBufferSize();
+			parameters.impulseResponseLength = impulseResponseLength;
+			parameters.gridSamplingStep = gridSamplingStep;
+			parameters.gapThreshold = gapThreshold;
+			parameters.extrapolationMethod = static_cast<int32_t>(extrapolationMethod);
+			parameters.precision = static_cast<int32_t>(spectralStoragePrecision);
+			parameters.fadeInBegin = fadeInBegin;
+			parameters.riseTime = riseTime;
+			parameters.fadeOutCutoff = fadeOutCutoff;
+			parameters.fallTime = fallTime;
+			return parameters;
+		}
+
+		// Processing parameters of a resampled table, taken with the mutex locked so that a background build does not read the members
+		TBuildParameters GetBuildParameters() const {
+			TBuildParameters parameters;
+			parameters.impulseResponseLength = impulseResponseLength;
+			parameters.numberOfSubfilters = partitionedFRNumberOfSubfilters;
+			parameters.bufferSize = globalParameters.GetBufferSize();
+			parameters.gapThreshold = gapThreshold;
+			parameters.extrapolationMethod = extrapolationMethod;
+			parameters.precision = spectralStoragePrecision;
+			parameters.sharedMemory = sharedMemoryEnabled;
+			return parameters;
+		}
+
+		// Dimensions of a processed table
+		static TSharedFIRTableLayout GetSharedTableLayout(const TBuildParameters & _parameters, int32_t _subfilterLength) {
+			TSharedFIRTableLayout layout;
+			layout.impulseResponseLength = _parameters.impulseResponseLength;
+			layout.numberOfSubfilters = _parameters.numberOfSubfilters;
+			layout.subfilterLength = _subfilterLength;
+			layout.precision = _parameters.precision;
+			return layout;
+		}
+
+		// Replace the resampled table with the one held in a shared memory segment. The mutex must be locked.
+		bool AttachSharedTable(std::shared_ptr<Common::CSharedMemorySegment> _segment) {
+			if (!_segment) { return false; }
+
+			TSharedFIRTableLayout layout;
+			std::unique_ptr<TResampledTable> sharedTable = LoadSharedTable(std::move(_segment), layout);
+			if (!sharedTable) { return false; }
+
+			ReplaceTable(std::move(sharedTable));
+			impulseResponseLength = layout.impulseResponseLength;
+			partitionedFRNumberOfSubfilters = layout.numberOfSubfilters;
+			partitionedFRSubfilterLength = layout.subfilterLength;
+			return true;
+		}
+
+		// Read the table held in a shared memory segment, with the topology of the grids built. The table keeps the segment.
+		std::unique_ptr<TResampledTable> LoadSharedTable(std::shared_ptr<Common::CSharedMemorySegment> _segment, TSharedFIRTableLayout & _layout) const {
+			std::unique_ptr<TResampledTable> table(new TResampledTable());
+			if (!CSharedFIRTableImage::Load(*_segment, _layout, table->distances, table->steps) || table->distances.empty() || table->distances.front().table.empty()) {
+				SET_RESULT(RESULT_WARNING, "The table image in shared memory segment " + _segment->GetName() + " could not be loaded");
+				return nullptr;
+			}
+			for (auto & distBucketIt : table->distances) {
+				distBucketIt.gridTopology.Build(distBucketIt.table, table->steps);
+			}
+			table->segment = std::move(_segment);
+			return table;
+		}
+
+		/**
+		 * @brief Replace the table used by the lookups. It waits until no lookup is using the previous table, so it must not be called
+			from the audio thread. The mutex must be locked. Lookups of the new table do not delay it.
+		 * @param _table new table, nullptr while there is no data ready
+		 * @return the previous table, so that it can be released out of the lock
+		 */
+		std::unique_ptr<TResampledTable> ReplaceTable(std::unique_ptr<TResampledTable> _table) {
+			publishedTable.store(_table.get());
+			// A lookup counted in the new epoch reads the new table, so once none of the previous epoch is active the previous table is not used anymore
+			const unsigned int previousEpoch = lookupEpoch.fetch_add(1);
+			while (activeLookups[previousEpoch & 1].load() != 0) { std::this_thread::yield(); }
+			resampledTable.swap(_table);
+			return _table;
+		}
+
+		/**
+		 * @brief Resample and partition the raw data of every distance
+		 * @param _rawTables raw data split by distances. The table of each distance is released once it has been resampled.
+		 * @param _gridSamplingStep step of the resampled grid
+		 * @param _parameters processing parameters, taken with the mutex locked
+		 * @param _keepRawTables if true, the IRs added to the raw tables by the extrapolation and the interpolation in the poles and caps
+			are removed afterwards, so that they can be resampled again with other step. Otherwise the raw tables are released.
+		 * @param _outTable resampled table, with the topology of the grids built
+		 * @param _outStepVector steps of the resampled grid
+		 * @param _offlineInterpolation, _extrapolation processors to be used, so that the build can run in other thread
+		 * @return false if the build has been cancelled
+		 */
+		bool BuildResampledTable(TRawSofaTableByDistances & _rawTables, int _gridSamplingStep, const TBuildParameters & _parameters, bool _keepRawTables, TDistanceTable & _outTable, std::unordered_map<TOrientation, float> & _outStepVector,
+			COfflineInterpolation & _offlineInterpolation, CExtrapolation & _extrapolation) {
+
+			for (auto & distBucketIt : _rawTables) {
+				if (cancelProgressiveSetup) { return false; }
+
+				std::vector<TOrientation> _orientationList = _offlineInterpolation.CalculateListOfOrientations(distBucketIt.table);
+				CalculateExtrapolation(distBucketIt.table, _orientationList, _parameters, _extrapolation); // Make the extrapolation if it's needed
+				_offlineInterpolation.CalculateTF_InPoles<TRawSofaTable, BRTServices::TIRStruct>(distBucketIt.table, _parameters.impulseResponseLength, _gridSamplingStep, CFIRTableAuxiliarMethods::CalculateHRIRFromHemisphereParts());
+				_offlineInterpolation.CalculateTF_SphericalCaps<TRawSofaTable, BRTServices::TIRStruct>(distBucketIt.table, _parameters.impulseResponseLength, _parameters.gapThreshold, _gridSamplingStep, CFIRTableAuxiliarMethods::CalculateHRIRFromBarycentrics_OfflineInterpolation());
+
+				TDistanceBucket aux;
+				aux.distance_mm = distBucketIt.distance_mm;
+
+				//Creation and filling of resampling HRTF table
+				CQuasiUniformSphereDistribution::CreateGrid<TSphericalFIRTablePartitioned, TFRPartitionedStruct>(aux.table, _outStepVector, _gridSamplingStep, distBucketIt.distance);
+				_offlineInterpolation.FillResampledTable<TRawSofaTable, TSphericalFIRTablePartitioned, BRTServices::TIRStruct, BRTServices::TFRPartitionedStruct>(distBucketIt.table, aux.table, _parameters.bufferSize, _parameters.impulseResponseLength, _parameters.numberOfSubfilters, CFIRTableAuxiliarMethods::SplitAndGetFFT_HRTFData(), CFIRTableAuxiliarMethods::CalculateHRIRFromBarycentrics_OfflineInterpolation());
+
+				// Add to vector of tables
+				_outTable.push_back(std::move(aux));
+				if (_keepRawTables) {
+					// Only IRs are added before the resampling, the original ones are not modified
+					const std::unordered_set<TOrientation> originalOrientations(_orientationList.begin(), _orientationList.end());
+					for (auto it = distBucketIt.table.begin(); it != distBucketIt.table.end();) {
+						if (originalOrientations.count(it->first) == 0) { it = distBucketIt.table.erase(it); }
+						else { ++it; }
+					}
+				} else {
+					TRawSofaTable().swap(distBucketIt.table);	// The raw data of this distance is not needed any more
+				}
+			}
+
+			// The topology references the table elements, so it is built once every bucket is in its final place
+			for (auto & distBucketIt : _outTable) {
+				distBucketIt.gridTopology.Build(distBucketIt.table, _outStepVector);
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Build the full resolution table of a progressive setup and replace the coarse table with it. It runs in the
+			background thread, only the replacement is done with the mutex locked.
+		 * @param _rawTables raw data split by distances
+		 * @param _gridSamplingStep step of the resampled grid
+		 * @param _parameters processing parameters, taken with the mutex locked in EndSetup
+		 * @param _sharedKey key of the table in shared memory, if it is shared
+		 */
+		void BuildFullResolutionTable(TRawSofaTableByDistances & _rawTables, int _gridSamplingStep, const TBuildParameters & _parameters, uint64_t _sharedKey) {
+			COfflineInterpolation backgroundOfflineInterpolation;
+			CExtrapolation backgroundExtrapolation;
+			std::unique_ptr<TResampledTable> newTable(new TResampledTable());
+
+			if (!BuildResampledTable(_rawTables, _gridSamplingStep, _parameters, false, newTable->distances, newTable->steps, backgroundOfflineInterpolation, backgroundExtrapolation)) { return; }
+			if (newTable->distances.empty() || newTable->distances.front().table.empty()) { return; }
+			const int32_t subfilterLength = static_cast<int32_t>(newTable->distances.front().table.begin()->second.IR.left[0].size());
+			CompactTable(newTable->distances, _parameters.precision);
+
+			if (_parameters.sharedMemory) {
+				// Once published, the local copy is replaced by the shared one
+				std::shared_ptr<Common::CSharedMemorySegment> newSegment = CSharedFIRTableImage::Publish(_sharedKey, GetSharedTableLayout(_parameters, subfilterLength), newTable->distances, newTable->steps);
+				TSharedFIRTableLayout layout;
+				std::unique_ptr<TResampledTable> sharedTable = newSegment ? LoadSharedTable(std::move(newSegment), layout) : nullptr;
+				if (sharedTable) { newTable = std::move(sharedTable); }
+			}
+
+			std::unique_ptr<TResampledTable> coarseTable;
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				if (cancelProgressiveSetup) { return; }
+				coarseTable = ReplaceTable(std::move(newTable));
+				fullResolutionReady = true;
+				setupRevision++;
+			}
+			// The coarse table is released out of the lock
+			coarseTable.reset();
+			SET_RESULT(RESULT_OK, "Full resolution HRTF table ready");
+		}
+
+		/**
+		 * @brief Cancel the background build of the full resolution table, if any, and wait for it. It must be called without the mutex locked.
+		 */
+		void StopProgressiveSetup() {
+			if (!progressiveSetupThread.joinable()) { return; }
+			cancelProgressiveSetup = true;
+			progressiveSetupThread.join();
+			cancelProgressiveSetup = false;
+		}
+
+		/**
+		 * @brief Queue the windowing of one IR on the worker threads. The result is stored in pipelinedIRs, in the same position
+			as the IR in sofaIRDataBase.
+		 * @param _ir IR just added, it is copied so the raw data is kept
+		 */
+		void SubmitPipelinedIR(const TSofaDataBucket & _ir) {
+			pipelinedIRs.emplace_back();
+			TPipelinedIR & result = pipelinedIRs.back();	// Elements of a deque do not move when more elements are added
+
+			const float _fadeInBegin = fadeInBegin;
+			const float _riseTime = riseTime;
+			const float _fadeOutCutoff = fadeOutCutoff;
+			const float _fallTime = fallTime;
+			const int sampleRate = globalParameters.GetSampleRate();
+
+			setupWorkerPool->Submit([&result, ir = _ir, _fadeInBegin, _riseTime, _fadeOutCutoff, _fallTime, sampleRate]() mutable {
+				result.windowed = CFIRTableAuxiliarMethods::CalculateWindowingIR(ir.data, _fadeInBegin, _riseTime, _fadeOutCutoff, _fallTime, sampleRate);
+				result.windowedIR = std::move(ir);
+			});
+		}
+
+		/**
+		 * @brief Wait for the worker threads to window every IR added
+		 * @return true if there is a windowed IR for every IR of sofaIRDataBase
+		 */
+		bool WaitForPipelinedIRs() {
+			if (!setupWorkerPool || pipelinedIRs.empty()) { return false; }
+			bool success = setupWorkerPool->Wait();
+			return success && pipelinedIRs.size() == sofaIRDataBase.size();
+		}
+
+		/**
+		 * @brief Discard the IRs windowed by the worker threads
+		 */
+		void DiscardPipelinedIRs() {
+			if (setupWorkerPool) { setupWorkerPool->Wait(); }
+			pipelinedIRs.clear();
+		}
+
 		// Reset HRTF		
 		void Reset() {
+			StopProgressiveSetup();
 
 			//Change class state
 			setupInProgress = false;			
 			dataReady = false;
+			fullResolutionReady = false;
+			setupRevision++;
 
 			//Clear every table						
-			distanceFRTable.clear();
+			DiscardPipelinedIRs();
+			ReplaceTable(nullptr);
 			sofaIRDataBase.clear();
-			stepVector.clear();
 
 			//Update parameters			
 			impulseResponseLength = 0;			
@@ -696,6 +1233,15 @@ namespace BRTServices
 		Common::CCranialGeometry cranialGeometry;			// Cranial geometry of the listener
 		Common::CCranialGeometry originalCranialGeometry;	// Cranial geometry of the listener
 		TEXTRAPOLATION_METHOD extrapolationMethod;			// Methods that is going to be used to extrapolate
+		Common::TSpectralPrecision spectralStoragePrecision;	// Format used to store the resampled table
+		bool sharedMemoryEnabled;								// Share the resampled table with other processes
+		bool progressiveSetupEnabled;							// Publish a coarse table in EndSetup and build the full resolution one in background
+		int progressiveGridSamplingStep;						// Step of the coarse table of a progressive setup
+		bool progressiveSetupRunning;							// The full resolution table is being built in background. Protected by the mutex.
+		bool fullResolutionReady;								// The table in use has the grid sampling step. Protected by the mutex.
+		std::atomic<bool> cancelProgressiveSetup;				// Requests the background build to stop
+		std::condition_variable fullResolutionCondition;		// Notified when the background build finishes
+		std::thread progressiveSetupThread;						// Background build of the full resolution table
 
 		float sphereBorder;		// Define spheere "sewing"
 		float epsilon_sewing;	// Interpolation parameter
@@ -718,14 +1264,24 @@ namespace BRTServices
 
 		// Tables						
 		TRawSofaData sofaIRDataBase;						// Time domain database - original data from SOFA file; 
-		TDistanceTable distanceFRTable;						// Data in our grid, interpolated, by distance buckets				
-		std::unordered_map<TOrientation, float> stepVector; // Store hrtf interpolated grids steps
+		std::unique_ptr<TResampledTable> resampledTable;	// Table in use, nullptr while there is no data ready. Replaced with the mutex locked.
+		std::atomic<const TResampledTable *> publishedTable;	// Same table, read by the lookups without locking the mutex
+		mutable std::atomic<int> activeLookups[2];			// Number of lookups reading publishedTable, by the parity of the epoch in which they started
+		std::atomic<unsigned int> lookupEpoch;				// Incremented each time a table is published
 				
 		// Processors
 		//CQuasiUniformSphereDistribution quasiUniformSphereDistribution;
 		COfflineInterpolation offlineInterpolation;
 		CExtrapolation extrapolation;
 
+		// Pipelined setup
+		struct TPipelinedIR {
+			TSofaDataBucket windowedIR;		// IR after the windowing
+			bool windowed = false;			// True if the fade out window has been applied
+		};
+		std::deque<TPipelinedIR> pipelinedIRs;				// IRs windowed by the worker threads, in the same order as sofaIRDataBase
+		std::unique_ptr<CSetupWorkerPool> setupWorkerPool;	// Worker threads of the pipelined setup. Declared last so it stops before the data it writes is destroyed
+
 		//friend class CHRTFTester;
 	};
 }
@@ -29,6 +29,7 @@
 #include <Common/Buffer.hpp>
 #include <Common/CommonDefinitions.hpp>
 #include <ServiceModules/ServicesBase.hpp>
+#include <ServiceModules/InterpolationAuxiliarMethods.hpp>
 #include <ServiceModules/SphericalSearchKDTree.hpp>
 
 
@@ -41,7 +42,11 @@ using TSphericalSOSTable = std::unordered_map<TOrientation_key, BRTServices::TSO
 struct TSOSDistanceBucket {
 	int32_t distance_mm = 0;
 	BRTServices::CSphericalSearchKDTree<TOrientation> searchTree;
-	TSphericalSOSTable table;
+	TSphericalSOSTable table;				// Coefficients added during the setup. It is emptied in EndSetup, once they are in the contiguous array
+	std::vector<float> coefficients;		// Coefficients of every cell, [cell][ear][coefficient], cells in the order of the search tree orientations
+	std::vector<int32_t> azimuthIndex;		// Cell of every azimuth step, -1 if not measured. Only when all the cells have zero elevation and the azimuths are on a regular grid
+	double azimuthStep = 0;					// Azimuth step of azimuthIndex, in degrees
+	int64_t firstCell = 0;					// Identifier of the first cell of this bucket in the whole table
 };
 using TSOSDistanceTable = std::vector<TSOSDistanceBucket>;
 
@@ -64,6 +69,7 @@ namespace BRTServices {
 		*/
 		CSphericalSOSTable()
 			: setupInProgress { false }
+			, numberOfCoefficients { 0 }
 		{
 			serviceType = TServiceType::sos_filter_database;
 		}
@@ -156,18 +162,39 @@ namespace BRTServices {
 				return a.distance_mm < b.distance_mm;
 			});
 			
-			// Build search trees for each distance bucket
+			// Move the coefficients of each distance bucket to a contiguous array, in the same order as its search tree
+			numberOfCoefficients = sosDistanceTable.front().table.begin()->second.coefs.left.size();
+			int64_t numberOfCells = 0;
 			for (auto & distBucketIt : sosDistanceTable) {
-					std::vector<TOrientation> orientations;
-					orientations.reserve(distBucketIt.table.size());
-					for (const auto & tableIt : distBucketIt.table) {
-						orientations.push_back(tableIt.second.orientation);
+				std::vector<TOrientation> orientations;
+				orientations.reserve(distBucketIt.table.size());
+				distBucketIt.coefficients.clear();
+				distBucketIt.coefficients.reserve(distBucketIt.table.size() * 2 * numberOfCoefficients);
+				for (const auto & tableIt : distBucketIt.table) {
+					const Common::CEarPair<CMonoBuffer<float>> & coefs = tableIt.second.coefs;
+					if (coefs.left.size() != numberOfCoefficients || (!coefs.right.empty() && coefs.right.size() != numberOfCoefficients)) {
+						SET_RESULT(RESULT_ERROR_BADSIZE, "All the positions of the SOS Filter table must have the same number of coefficients in BRTServices::CSphericalSOSTable");
+						return false;
 					}
-					distBucketIt.searchTree.build(std::move(orientations));
-			}			
+					orientations.push_back(tableIt.second.orientation);
+					distBucketIt.coefficients.insert(distBucketIt.coefficients.end(), coefs.left.begin(), coefs.left.end());
+					if (coefs.right.empty()) {
+						// Tables with one ear only use the left coefficients
+						distBucketIt.coefficients.insert(distBucketIt.coefficients.end(), numberOfCoefficients, 0.0f);
+					} else {
+						distBucketIt.coefficients.insert(distBucketIt.coefficients.end(), coefs.right.begin(), coefs.right.end());
+					}
+				}
+				BuildAzimuthIndex(orientations, distBucketIt);
+				distBucketIt.searchTree.build(std::move(orientations));
+				distBucketIt.firstCell = numberOfCells;
+				numberOfCells += distBucketIt.searchTree.size();
+				TSphericalSOSTable().swap(distBucketIt.table);
+			}
 		
 			if (numberOfEars != -1) {				
 				dataReady = true;
+				setupRevision++;
 				SET_RESULT(RESULT_OK, "SOS Filter Setup finished");				
 				setupInProgress = false;
 				return true;
@@ -187,44 +214,57 @@ namespace BRTServices {
 		 * @return std::vector<float> contains the coefficients following this order [f1_b0, f1_b1, f1_b2, f1_a1, f1_a2, f2_b0, f2_b1, f2_b2, f2_a1, f2_a2]
 		 */
 		const std::vector<float> GetSOSCoefficients_SpatiallyOriented(float _azimuth, float _elevation, float _distance, Common::T_ear ear) const override {
-					
-			std::vector<float> foundData;
+			const TSOSCoefficientsView foundData = GetSOSCoefficientsView_SpatiallyOriented(_azimuth, _elevation, _distance, ear);
+			return std::vector<float>(foundData.begin(), foundData.end());
+		}
+
+		/**
+		 * @brief Get IIR filter coefficients for SOS Filter, for one ear, without copying them or allocating memory. The coefficients are
+			stored contiguously, and the cell is found by direct indexing of the azimuth when all the cells of the distance have zero
+			elevation and a regular azimuth step, as in the near-field tables, or with the search tree otherwise.
+		 * @param _azimuth azimuth angle in degrees
+		 * @param _elevation elevation angle in degrees
+		 * @param _distance distance in meters
+		 * @param ear ear for which we want to get the coefficients
+		 * @return view of the coefficients, in the same order as GetSOSCoefficients_SpatiallyOriented. It is valid until the next BeginSetup.
+		 */
+		TSOSCoefficientsView GetSOSCoefficientsView_SpatiallyOriented(float _azimuth, float _elevation, float _distance, Common::T_ear ear) const override {
+
 			if (!dataReady) {
 				SET_RESULT(RESULT_ERROR_NOTINITIALIZED, "Spherical SOS table was not initialized in BRTServices::CSphericalSOSTable::GetSOSFilterCoefficients()");
-				return foundData;
+				return TSOSCoefficientsView();
 			}
 
 			if (ear == Common::T_ear::BOTH || ear == Common::T_ear::NONE) {
 				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get SOS Filter coefficients for a wrong ear (BOTH or NONE)");
-				return foundData;
+				return TSOSCoefficientsView();
 			}
 
 			if (!spatiallyOriented) { 
 				SET_RESULT(RESULT_ERROR_NOTALLOWED, "Attempt to get SOS Filter coefficients with spatial orientation parameters, but SOS table is not spatially oriented");
-				return foundData;
+				return TSOSCoefficientsView();
 			}
 
 			if ((ear == Common::T_ear::RIGHT) && numberOfEars == 1) {
 				// This is a workaround to make our near-field SOS SOFA files work; we should correct it those SOFA.
-				return GetSOSCoefficients_SpatiallyOriented(-_azimuth, _elevation, _distance, Common::T_ear::LEFT);
+				return GetSOSCoefficientsView_SpatiallyOriented(-_azimuth, _elevation, _distance, Common::T_ear::LEFT);
 			}
 
-			//ASSERT(_distance > 0, RESULT_ERROR_OUTOFRANGE, "Distance must be greater than zero when", "");			
-
+			std::lock_guard<std::mutex> l(mutex);
 			// Find Table to use if exists
 			const TSOSDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
-				return foundData;
-			}		
-			
-			Common::CEarPair<CMonoBuffer<float>> data = GetDataFromSphericalSOSTable(distanceBucket, _azimuth, _elevation, true);
-			
-			if (ear == Common::T_ear::LEFT) {
-				return data.left;
-			} else if (ear == Common::T_ear::RIGHT) {
-				return data.right;
-			}			
+				return TSOSCoefficientsView();
+			}
+
+			const int32_t cell = FindCell(*distanceBucket, _azimuth, _elevation);
+			if (cell < 0) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "GetSOSCoefficientsView_SpatiallyOriented: no SOS coefficients found in the distance bucket");
+				return TSOSCoefficientsView();
+			}
+			const size_t earOffset = (ear == Common::T_ear::LEFT) ? 0 : numberOfCoefficients;
+			return TSOSCoefficientsView(distanceBucket->coefficients.data() + 2 * numberOfCoefficients * cell + earOffset, numberOfCoefficients, distanceBucket->firstCell + cell);
 		}
 
 		/**
@@ -245,58 +285,81 @@ namespace BRTServices {
 				return foundData;
 			}
 			
-			float _azimuth = 0;
-			float _elevation = 0;
-			float _distance = 0;
-			bool _findNearest = true;
+			std::lock_guard<std::mutex> l(mutex);
 			// Find Table to use if exists
-			const TSOSDistanceBucket * distanceBucket = FindDistanceBucket(_distance);
+			const TSOSDistanceBucket * distanceBucket = FindDistanceBucket(0);
 			if (!distanceBucket) {
 				SET_RESULT(RESULT_ERROR_UNKNOWN, "GetFRPartitioned_SpatiallyOriented_2Ears: Distance Bucket find error");
 				return foundData;
 			}
 			
-			return GetDataFromSphericalSOSTable(distanceBucket, _azimuth, _elevation, true);
+			const int32_t cell = FindCell(*distanceBucket, 0, 0);
+			if (cell < 0) {
+				SET_RESULT(RESULT_ERROR_NOTALLOWED, "GetSOSCoefficients_2Ears: no SOS coefficients found in the distance bucket");
+				return foundData;
+			}
+			const float * cellCoefficients = distanceBucket->coefficients.data() + 2 * numberOfCoefficients * cell;
+			foundData.left.assign(cellCoefficients, cellCoefficients + numberOfCoefficients);
+			if (numberOfEars != 1) {
+				foundData.right.assign(cellCoefficients + numberOfCoefficients, cellCoefficients + 2 * numberOfCoefficients);
+			}
+			return foundData;
 		}
 
 	private:
 		
 		/**
-		 * @brief Find and return the coefficients for a given distance bucket and orientation parameters. If _findNearest is true, it will return the coefficients of the nearest orientation if an exact match is not found. If _findNearest is false, it will return an empty data if an exact match is not found.
-		 * @param distanceBucket 
-		 * @param _azimuth 
-		 * @param _elevation 
-		 * @param _findNearest 
-		 * @return 
+		 * @brief Index the cells of a distance bucket by azimuth, if all of them have zero elevation and their azimuths are multiples of
+			a common step, which is the case of the tables indexed by interaural azimuth
+		 * @param _orientations orientations of the cells, in the order of the contiguous array
+		 * @param _distanceBucket bucket where the index is stored
 		 */
-		const Common::CEarPair<CMonoBuffer<float>> GetDataFromSphericalSOSTable(const TSOSDistanceBucket * distanceBucket, const float & _azimuth, const float & _elevation, bool _findNearest) const {
+		void BuildAzimuthIndex(const std::vector<TOrientation> & _orientations, TSOSDistanceBucket & _distanceBucket) const {
+			_distanceBucket.azimuthIndex.clear();
+			_distanceBucket.azimuthStep = 0;
+
+			std::vector<double> azimuths;
+			azimuths.reserve(_orientations.size());
+			for (const TOrientation & orientation : _orientations) {
+				if (quantise_azel_0p01(orientation.elevation) != 0) { return; }
+				azimuths.push_back(orientation.azimuth);
+			}
+			std::sort(azimuths.begin(), azimuths.end());
+			double step = 360.0;
+			for (size_t i = 1; i < azimuths.size(); i++) {
+				const double difference = azimuths[i] - azimuths[i - 1];
+				if (difference > 0.01 && difference < step) { step = difference; }
+			}
+			const int numberOfSteps = static_cast<int>(std::lround(360.0 / step));
+			if (azimuths.size() < 2 || std::abs(numberOfSteps * step - 360.0) > 0.01) { return; }
+
+			std::vector<int32_t> azimuthIndex(numberOfSteps, -1);
+			for (size_t i = 0; i < _orientations.size(); i++) {
+				const double position = _orientations[i].azimuth / step;
+				if (std::abs(position - std::round(position)) * step > 0.01) { return; }
+				azimuthIndex[std::lround(position) % numberOfSteps] = static_cast<int32_t>(i);
+			}
+			_distanceBucket.azimuthIndex = std::move(azimuthIndex);
+			_distanceBucket.azimuthStep = step;
+		}
 
-			std::lock_guard<std::mutex> l(mutex);
+		/**
+		 * @brief Find the cell of a distance bucket nearest to an orientation
+		 * @param _distanceBucket distance bucket
+		 * @param _azimuth azimuth in degrees
+		 * @param _elevation elevation in degrees
+		 * @return position of the cell in the contiguous array of the bucket, -1 if the bucket is empty
+		 */
+		int32_t FindCell(const TSOSDistanceBucket & _distanceBucket, float _azimuth, float _elevation) const {
 			const double _azimuthInRage = CInterpolationAuxiliarMethods::NormalizeAzimuth0_360(_azimuth);
-			const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
-
-			Common::CEarPair<CMonoBuffer<float>> foundData;
-			auto it = distanceBucket->table.find(TOrientation_key(_azimuthInRage, _elevationInRange));
-			if (it != distanceBucket->table.end()) {
-				// Exact match found
-				foundData = it->second.coefs;
-			} else {
-				// No exact match
-				if (!_findNearest) {
-					SET_RESULT(RESULT_ERROR_OUTOFRANGE, "GetDataFromSphericalSOSTable: Requested azimuth and elevation not found in SOS table");
-					return foundData;
-				}
-				// Find nearest
-				TOrientation nearest = distanceBucket->searchTree.nearest(_azimuthInRage, _elevationInRange);
-				auto it = distanceBucket->table.find(TOrientation_key(nearest));
-				if (it != distanceBucket->table.end()) {
-					foundData = it->second.coefs;
-				} else {
-					// ERROR: This should not happen
-					SET_RESULT(RESULT_ERROR_NOTALLOWED, "GetDataFromSphericalSOSTable: SearchTree returned an orientation not present in SOS table");
-				}
+			if (!_distanceBucket.azimuthIndex.empty()) {
+				// The nearest cell is the one of the nearest azimuth step, whatever the elevation, when that step has been measured
+				const size_t step = static_cast<size_t>(std::lround(_azimuthInRage / _distanceBucket.azimuthStep)) % _distanceBucket.azimuthIndex.size();
+				const int32_t cell = _distanceBucket.azimuthIndex[step];
+				if (cell >= 0) { return cell; }
 			}
-			return foundData;
+			const double _elevationInRange = CInterpolationAuxiliarMethods::NormalizeElevation_0_90_270_360(_elevation);
+			return _distanceBucket.searchTree.nearestIndex(_azimuthInRage, _elevationInRange);
 		}
 		
 		/**
@@ -350,6 +413,8 @@ namespace BRTServices {
 			dataReady = false;
 			sosDistanceTable.clear();			
 			numberOfEars = -1;	
+			setupRevision++;
+			numberOfCoefficients = 0;
 		}
 
 		//int CalculateTableAzimuthStep() {			
@@ -409,7 +474,8 @@ namespace BRTServices {
 		mutable std::mutex mutex;			// Thread management
 		bool setupInProgress;				// Variable that indicates the SOS Filter load is in process		
 		
-		TSOSDistanceTable sosDistanceTable; // SOS Filter table indexed by distance buckets, each containing a search tree and a hash table indexed by orientation
+		TSOSDistanceTable sosDistanceTable; // SOS Filter table indexed by distance buckets, each containing a search tree and the contiguous coefficients of its cells
+		size_t numberOfCoefficients;		// Number of coefficients of each ear in every cell
 		
 		Common::CVector3 leftEarLocalPosition;		// Listener left ear relative position
 		Common::CVector3 rightEarLocalPosition;		// Listener right ear relative position
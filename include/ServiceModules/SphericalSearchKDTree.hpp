@@ -5,6 +5,7 @@
 * \detail Balanced 3D KD-tree for nearest-neighbor search on a sphere. Converts (azimuth, elevation) to a 3D unit direction vector.
 	Nearest neighbor search minimizes angular distance on the sphere. For unit vectors, minimizing angular distance is equivalent to 
 	minimizing Euclidean distance (monotonic relationship).
+	The tree is stored in a flat array with an implicit layout, built in place. Nearest, k-nearest, radius and batch queries are available.
 * \date	Dec 2025
 *
 * \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco ||
@@ -31,8 +32,7 @@
 #include <array>
 #include <cmath>
 #include <limits>
-#include <memory>
-#include <numeric>
+#include <utility>
 #include <vector>
 
 namespace BRTServices {
@@ -57,44 +57,91 @@ namespace BRTServices {
 	// Return the nearest orientation for (azimuth, elevation).
 	// Inputs must be normalized using your convention.
 	OrientationT nearest(double azimuth0_360, double elevation0_360) const {
-		if (!m_root || m_directions.empty())
-			return OrientationT(azimuth0_360, elevation0_360);
-
-		const auto queryDir = sphericalToUnitVector(azimuth0_360, elevation0_360);
-
-		int bestIndex = -1;
-		float bestDistance2 = std::numeric_limits<float>::infinity();
-		nearestSearch(m_root.get(), queryDir, bestIndex, bestDistance2);
-
+		const int bestIndex = nearestIndex(sphericalToUnitVector(azimuth0_360, elevation0_360));
 		if (bestIndex >= 0)
 			return m_orientations[bestIndex];
 
-		// Extremely unlikely fallback
+		// Empty tree
 		return OrientationT(azimuth0_360, elevation0_360);
 	}
 
+	// Return the position, in the vector used to build the tree, of the nearest orientation for (azimuth, elevation), or -1 if the tree is empty.
+	// Inputs must be normalized using your convention.
+	int nearestIndex(double azimuth0_360, double elevation0_360) const {
+		return nearestIndex(sphericalToUnitVector(azimuth0_360, elevation0_360));
+	}
+
+	// Batch version of nearest(). Resolves all the queries in one call, reusing the results vector storage.
+	// Query orientations must be normalized using your convention.
+	void nearest(const std::vector<OrientationT> & queries, std::vector<OrientationT> & results) const {
+		results.clear();
+		results.reserve(queries.size());
+		for (const auto & query : queries)
+			results.push_back(nearest(query.azimuth, query.elevation));
+	}
+
+	// Return up to k orientations nearest to (azimuth, elevation), sorted from the nearest one.
+	void kNearest(double azimuth0_360, double elevation0_360, size_t k, std::vector<OrientationT> & results) const {
+		results.clear();
+		if (k == 0 || m_nodes.empty())
+			return;
+
+		std::vector<std::pair<float, int>> heap; // Max-heap of (squared distance, index) with the k best candidates
+		heap.reserve(std::min(k, m_nodes.size()) + 1);
+		kNearestSearch(0, static_cast<int>(m_nodes.size()), 0, sphericalToUnitVector(azimuth0_360, elevation0_360), k, heap);
+
+		std::sort_heap(heap.begin(), heap.end());
+		results.reserve(heap.size());
+		for (const auto & candidate : heap)
+			results.push_back(m_orientations[candidate.second]);
+	}
+
+	std::vector<OrientationT> kNearest(double azimuth0_360, double elevation0_360, size_t k) const {
+		std::vector<OrientationT> results;
+		kNearest(azimuth0_360, elevation0_360, k, results);
+		return results;
+	}
+
+	// Return all the orientations whose angular distance to (azimuth, elevation) is not greater than radiusDegrees, in no particular order.
+	void withinRadius(double azimuth0_360, double elevation0_360, double radiusDegrees, std::vector<OrientationT> & results) const {
+		results.clear();
+		if (m_nodes.empty() || radiusDegrees < 0.0)
+			return;
+
+		// Angular distance to squared chord length between unit vectors
+		const double radius = std::min(radiusDegrees, 180.0);
+		const float maxDistance2 = static_cast<float>(2.0 - 2.0 * std::cos(degToRad(radius)));
+		radiusSearch(0, static_cast<int>(m_nodes.size()), 0, sphericalToUnitVector(azimuth0_360, elevation0_360), maxDistance2, results);
+	}
+
+	std::vector<OrientationT> withinRadius(double azimuth0_360, double elevation0_360, double radiusDegrees) const {
+		std::vector<OrientationT> results;
+		withinRadius(azimuth0_360, elevation0_360, radiusDegrees, results);
+		return results;
+	}
+
 	// Convenience accessors
 	size_t size() const noexcept { return m_orientations.size(); }
 	bool empty() const noexcept { return m_orientations.empty(); }
 
 	void clear() {
 		m_orientations.clear();
-		m_directions.clear();
-		m_root.reset();
+		m_nodes.clear();
 	}
 
 private:
+	// The tree is stored in a flat array with an implicit layout: the node of a range [begin, end) is at its middle position,
+	// its left subtree is [begin, middle) and its right subtree is [middle + 1, end). Ranges of up to LEAF_SIZE nodes are leaves,
+	// which are scanned linearly. The split axis is depth % 3.
 	struct Node {
-		int index = -1; // Index into m_orientations/m_directions
-		int axis = 0; // Split axis: 0=x, 1=y, 2=z
-		float splitValue = 0.f; // Coordinate value on split axis
-		std::unique_ptr<Node> left;
-		std::unique_ptr<Node> right;
+		std::array<float, 3> direction; // Unit vector
+		int index; // Index into m_orientations
 	};
 
+	static constexpr int LEAF_SIZE = 8;
+
 	std::vector<OrientationT> m_orientations;
-	std::vector<std::array<float, 3>> m_directions; // Unit vectors per orientation
-	std::unique_ptr<Node> m_root;
+	std::vector<Node> m_nodes;
 
 private:
 	static inline double degToRad(double degrees) {
@@ -132,71 +179,146 @@ private:
 	}
 
 	void rebuildDirectionsAndTree() {
-		m_directions.clear();
-		m_directions.reserve(m_orientations.size());
+		m_nodes.clear();
+		m_nodes.reserve(m_orientations.size());
 
-		for (const auto & ori : m_orientations)
-			m_directions.push_back(sphericalToUnitVector(ori.azimuth, ori.elevation));
+		for (size_t i = 0; i < m_orientations.size(); i++)
+			m_nodes.push_back({ sphericalToUnitVector(m_orientations[i].azimuth, m_orientations[i].elevation), static_cast<int>(i) });
 
-		std::vector<int> indices(m_directions.size());
-		std::iota(indices.begin(), indices.end(), 0);
-
-		m_root = buildRecursive(indices, 0);
+		buildInPlace(0, static_cast<int>(m_nodes.size()), 0);
 	}
 
-	std::unique_ptr<Node> buildRecursive(std::vector<int> & indices, int depth) {
-		if (indices.empty())
-			return nullptr;
+	// Place the median of the range in its middle position and recurse on both halves. No memory is allocated.
+	void buildInPlace(int begin, int end, int depth) {
+		if (end - begin <= LEAF_SIZE)
+			return;
 
 		const int axis = depth % 3;
-		const size_t mid = indices.size() / 2;
+		const int middle = begin + (end - begin) / 2;
 
-		auto axisComparator = [&](int a, int b) {
-			return m_directions[a][axis] < m_directions[b][axis];
-		};
-		std::nth_element(indices.begin(), indices.begin() + mid, indices.end(), axisComparator);
+		std::nth_element(m_nodes.begin() + begin, m_nodes.begin() + middle, m_nodes.begin() + end,
+			[axis](const Node & a, const Node & b) { return a.direction[axis] < b.direction[axis]; });
 
-		const int currentIndex = indices[mid];
-
-		std::vector<int> leftIndices(indices.begin(), indices.begin() + mid);
-		std::vector<int> rightIndices(indices.begin() + mid + 1, indices.end());
+		buildInPlace(begin, middle, depth + 1);
+		buildInPlace(middle + 1, end, depth + 1);
+	}
 
-		auto node = std::make_unique<Node>();
-		node->index = currentIndex;
-		node->axis = axis;
-		node->splitValue = m_directions[currentIndex][axis];
-		node->left = buildRecursive(leftIndices, depth + 1);
-		node->right = buildRecursive(rightIndices, depth + 1);
+	int nearestIndex(const std::array<float, 3> & queryDir) const {
+		if (m_nodes.empty())
+			return -1;
 
-		return node;
+		int bestNode = -1;
+		float bestDistance2 = std::numeric_limits<float>::infinity();
+		nearestSearch(0, static_cast<int>(m_nodes.size()), 0, queryDir, bestNode, bestDistance2);
+		return bestNode >= 0 ? m_nodes[bestNode].index : -1;
 	}
 
-	void nearestSearch(const Node * node,
+	void nearestSearch(int begin, int end,
+		int depth,
 		const std::array<float, 3> & queryDir,
-		int & bestIndex,
+		int & bestNode,
 		float & bestDistance2) const {
-		if (!node)
+		if (end - begin <= LEAF_SIZE) {
+			for (int i = begin; i < end; i++) {
+				const float d2 = squaredDistance(m_nodes[i].direction, queryDir);
+				if (d2 < bestDistance2) {
+					bestDistance2 = d2;
+					bestNode = i;
+				}
+			}
 			return;
+		}
 
-		const int nodeIndex = node->index;
-
-		const float d2 = squaredDistance(m_directions[nodeIndex], queryDir);
+		const int middle = begin + (end - begin) / 2;
+		const float d2 = squaredDistance(m_nodes[middle].direction, queryDir);
 		if (d2 < bestDistance2) {
 			bestDistance2 = d2;
-			bestIndex = nodeIndex;
+			bestNode = middle;
 		}
 
-		const int axis = node->axis;
-		const float diff = queryDir[axis] - node->splitValue;
+		const int axis = depth % 3;
+		const float diff = queryDir[axis] - m_nodes[middle].direction[axis];
+
+		if (diff < 0.f) {
+			nearestSearch(begin, middle, depth + 1, queryDir, bestNode, bestDistance2);
+			// Check if the hypersphere crosses the splitting plane.
+			if (diff * diff < bestDistance2)
+				nearestSearch(middle + 1, end, depth + 1, queryDir, bestNode, bestDistance2);
+		} else {
+			nearestSearch(middle + 1, end, depth + 1, queryDir, bestNode, bestDistance2);
+			if (diff * diff < bestDistance2)
+				nearestSearch(begin, middle, depth + 1, queryDir, bestNode, bestDistance2);
+		}
+	}
 
-		const Node * nearChild = (diff < 0.f) ? node->left.get() : node->right.get();
-		const Node * farChild = (diff < 0.f) ? node->right.get() : node->left.get();
+	// Offer a candidate to the max-heap of the k best candidates
+	void offerCandidate(int node, float d2, size_t k, std::vector<std::pair<float, int>> & heap) const {
+		if (heap.size() < k) {
+			heap.emplace_back(d2, m_nodes[node].index);
+			std::push_heap(heap.begin(), heap.end());
+		} else if (d2 < heap.front().first) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = std::make_pair(d2, m_nodes[node].index);
+			std::push_heap(heap.begin(), heap.end());
+		}
+	}
 
-		nearestSearch(nearChild, queryDir, bestIndex, bestDistance2);
+	void kNearestSearch(int begin, int end,
+		int depth,
+		const std::array<float, 3> & queryDir,
+		size_t k,
+		std::vector<std::pair<float, int>> & heap) const {
+		if (end - begin <= LEAF_SIZE) {
+			for (int i = begin; i < end; i++)
+				offerCandidate(i, squaredDistance(m_nodes[i].direction, queryDir), k, heap);
+			return;
+		}
+
+		const int middle = begin + (end - begin) / 2;
+		offerCandidate(middle, squaredDistance(m_nodes[middle].direction, queryDir), k, heap);
+
+		const int axis = depth % 3;
+		const float diff = queryDir[axis] - m_nodes[middle].direction[axis];
+		const bool goLeft = diff < 0.f;
+
+		if (goLeft)
+			kNearestSearch(begin, middle, depth + 1, queryDir, k, heap);
+		else
+			kNearestSearch(middle + 1, end, depth + 1, queryDir, k, heap);
+
+		// The far side can only contain better candidates if the heap is not full or the hypersphere crosses the splitting plane.
+		if (heap.size() < k || diff * diff < heap.front().first) {
+			if (goLeft)
+				kNearestSearch(middle + 1, end, depth + 1, queryDir, k, heap);
+			else
+				kNearestSearch(begin, middle, depth + 1, queryDir, k, heap);
+		}
+	}
+
+	void radiusSearch(int begin, int end,
+		int depth,
+		const std::array<float, 3> & queryDir,
+		float maxDistance2,
+		std::vector<OrientationT> & results) const {
+		if (end - begin <= LEAF_SIZE) {
+			for (int i = begin; i < end; i++) {
+				if (squaredDistance(m_nodes[i].direction, queryDir) <= maxDistance2)
+					results.push_back(m_orientations[m_nodes[i].index]);
+			}
+			return;
+		}
+
+		const int middle = begin + (end - begin) / 2;
+		if (squaredDistance(m_nodes[middle].direction, queryDir) <= maxDistance2)
+			results.push_back(m_orientations[m_nodes[middle].index]);
+
+		const int axis = depth % 3;
+		const float diff = queryDir[axis] - m_nodes[middle].direction[axis];
 
-		// Check if the hypersphere crosses the splitting plane.
-		if (diff * diff < bestDistance2)
-			nearestSearch(farChild, queryDir, bestIndex, bestDistance2);
+		if (diff < 0.f || diff * diff <= maxDistance2)
+			radiusSearch(begin, middle, depth + 1, queryDir, maxDistance2, results);
+		if (diff >= 0.f || diff * diff <= maxDistance2)
+			radiusSearch(middle + 1, end, depth + 1, queryDir, maxDistance2, results);
 	}
 };
 } // namespace
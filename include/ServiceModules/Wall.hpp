@@ -144,7 +144,7 @@ public:
 	/** \brief Returns the normal vector to the wall. If the wall is properly defined, it points towards inside the room.
 	*	\param [out] Normal: normal vector to the wall.
 	*/
-	Common::CVector3& GetNormal() const {
+	Common::CVector3 GetNormal() const {
 		Common::CVector3 p1, p2, normal;
 		float modulus;
 
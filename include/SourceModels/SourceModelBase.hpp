@@ -72,6 +72,15 @@ namespace BRTSourceModel {
 			dataReady = true;
 		}
 
+		/**
+		 * @brief Set audio frame buffers from one channel of a multichannel buffer
+		 * @param _buffer samples of the channel
+		 */
+		void SetBuffer(CMultiChannelBuffer<float>::TConstChannel _buffer) {
+			samplesBuffer.assign(_buffer.begin(), _buffer.end());
+			dataReady = true;
+		}
+
 		/**
 		 * @brief Get the last audio frame buffer
 		 * @return last samples buffer
@@ -0,0 +1,72 @@
+// Behaviour test of CBufferKernels::ResampleLinear: exact copies, expansion, compression, backwards reading and the last position of the source
+
+#include <cstddef>
+#include <vector>
+#include <Common/BufferKernels.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+	// Linear interpolation in double precision, at the positions computed in single precision as the kernel does
+	double Reference(const std::vector<float> & src, float startPosition, float step, std::size_t i) {
+		const double position = startPosition + step * static_cast<float>(i);
+		std::size_t j = static_cast<std::size_t>(position);
+		if (j > src.size() - 2) j = src.size() - 2;
+		const double fraction = position - static_cast<double>(j);
+		return src[j] + (static_cast<double>(src[j + 1]) - src[j]) * fraction;
+	}
+
+	double MaximumError(const std::vector<float> & src, const std::vector<float> & dst, float startPosition, float step) {
+		double error = 0;
+		for (std::size_t i = 0; i < dst.size(); i++) error = std::max(error, std::abs(dst[i] - Reference(src, startPosition, step, i)));
+		return error;
+	}
+}
+
+int main() {
+	std::vector<float> src(64);
+	for (std::size_t i = 0; i < src.size(); i++) src[i] = static_cast<float>(std::sin(0.2 * static_cast<double>(i)) + 0.01 * static_cast<double>(i));
+	const double tolerance = 1.0e-6;
+
+	// Step 1 from an integer position is an exact copy, up to the last sample of the source
+	std::vector<float> dst(src.size());
+	Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), dst.size(), 0.0f, 1.0f);
+	BRT_CHECK(dst == src);
+	dst.assign(10, 0.0f);
+	Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), dst.size(), 7.0f, 1.0f);
+	for (std::size_t i = 0; i < dst.size(); i++) BRT_CHECK(dst[i] == src[7 + i]);
+
+	// Expansion and compression, ending exactly on the last sample of the source
+	for (std::size_t nFrames : { std::size_t(2), std::size_t(63), std::size_t(64), std::size_t(100), std::size_t(257) }) {
+		const float step = static_cast<float>(src.size() - 1) / static_cast<float>(nFrames - 1);
+		dst.assign(nFrames, 0.0f);
+		Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), nFrames, 0.0f, step);
+		BRT_CHECK_NEAR(MaximumError(src, dst, 0.0f, step), 0, tolerance);
+		BRT_CHECK(dst.front() == src.front());
+		BRT_CHECK_NEAR(dst.back(), src.back(), tolerance);
+	}
+
+	// Fractional start and step, as used by the delay lines
+	dst.assign(40, 0.0f);
+	Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), dst.size(), 3.3f, 1.37f);
+	BRT_CHECK_NEAR(MaximumError(src, dst, 3.3f, 1.37f), 0, tolerance);
+
+	// Reading backwards, when a delay grows faster than the time passes
+	dst.assign(30, 0.0f);
+	Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), dst.size(), 60.5f, -2.0f);
+	BRT_CHECK_NEAR(MaximumError(src, dst, 60.5f, -2.0f), 0, tolerance);
+	BRT_CHECK_NEAR(dst[0], 0.5 * (src[60] + src[61]), tolerance);
+
+	// A source of two samples, the smallest one allowed
+	const std::vector<float> pair = { 1.0f, 3.0f };
+	dst.assign(5, 0.0f);
+	Common::CBufferKernels::ResampleLinear(pair.data(), pair.size(), dst.data(), dst.size(), 0.0f, 0.25f);
+	const float expected[] = { 1.0f, 1.5f, 2.0f, 2.5f, 3.0f };
+	for (std::size_t i = 0; i < dst.size(); i++) BRT_CHECK(dst[i] == expected[i]);
+
+	// No frames, nothing is written
+	dst.assign(4, -7.0f);
+	Common::CBufferKernels::ResampleLinear(src.data(), src.size(), dst.data(), 0, 0.0f, 1.0f);
+	for (float sample : dst) BRT_CHECK(sample == -7.0f);
+
+	return BRTTest::Result("BufferKernelsResampleTest");
+}
@@ -0,0 +1,79 @@
+/**
+* \brief Reference model of the delay lines shared by their behaviour tests
+* \details It keeps every sample written to the line and computes, in double precision, the expected output of the last frame for a
+* delay that moves linearly along it. The delay of sample i is reached at its end, so the frame ends exactly at its last delay.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This file is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _BRT_TEST_DELAY_LINE_REFERENCE_HPP_
+#define _BRT_TEST_DELAY_LINE_REFERENCE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <Common/Buffer.hpp>
+
+namespace BRTTest {
+
+	class CReferenceDelayLine {
+	public:
+		void Write(const CMonoBuffer<float> & input) {
+			history.insert(history.end(), input.begin(), input.end());
+			frameSize = input.size();
+		}
+
+		/// Expected output of the last frame written, with a delay that moves from startDelay to endDelay along it
+		std::vector<double> Read(double startDelay, double endDelay) const {
+			std::vector<double> output(frameSize);
+			const std::size_t frameStart = history.size() - frameSize;
+			const double delayStep = (endDelay - startDelay) / static_cast<double>(frameSize);
+			for (std::size_t i = 0; i < frameSize; i++) {
+				const double position = static_cast<double>(frameStart + i) - (startDelay + delayStep * static_cast<double>(i + 1));
+				const double integerPart = std::floor(position);
+				const double fraction = position - integerPart;
+				output[i] = Sample(static_cast<long>(integerPart)) * (1 - fraction) + Sample(static_cast<long>(integerPart) + 1) * fraction;
+			}
+			return output;
+		}
+
+	private:
+		std::vector<float> history;
+		std::size_t frameSize = 0;
+		double Sample(long index) const { return index < 0 || index >= static_cast<long>(history.size()) ? 0.0 : history[index]; }
+	};
+
+	/// Fill a frame of a test signal, two sines with no common period, continuous from one frame to the next
+	inline void FillDelayLineFrame(CMonoBuffer<float> & frame, std::size_t frameSize, std::size_t frameNumber) {
+		frame.resize(frameSize);
+		for (std::size_t i = 0; i < frameSize; i++) {
+			const double t = static_cast<double>(frameNumber * frameSize + i);
+			frame[i] = static_cast<float>(0.5 * std::sin(0.017 * t) + 0.4 * std::sin(0.23 * t + 0.5));
+		}
+	}
+
+	/// Largest difference between an output and the expected one, or 1 if their sizes are different
+	inline double MaximumError(const CMonoBuffer<float> & output, const std::vector<double> & expected) {
+		double error = output.size() == expected.size() ? 0 : 1;
+		for (std::size_t i = 0; i < output.size() && i < expected.size(); i++) error = std::max(error, std::abs(output[i] - expected[i]));
+		return error;
+	}
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Behaviour test of CFractionalDelayLine: constant delays, delay ramps, wrap-around of the circular buffer and growth of its capacity
+
+#include <cstddef>
+#include <vector>
+#include <Common/FractionalDelayLine.hpp>
+#include "TestCheck.hpp"
+#include "DelayLineReference.hpp"
+
+namespace {
+	const std::size_t frameSize = 256;
+
+	void FillFrame(CMonoBuffer<float> & frame, std::size_t frameNumber) {
+		BRTTest::FillDelayLineFrame(frame, frameSize, frameNumber);
+	}
+}
+
+int main() {
+	const double tolerance = 1.0e-5;
+	CMonoBuffer<float> input(frameSize), output;
+	std::vector<double> expected;
+
+	Common::CFractionalDelayLine line;
+	BRTTest::CReferenceDelayLine reference;
+	const std::size_t initialCapacity = line.GetCapacity();
+	BRT_CHECK(initialCapacity >= FRACTIONAL_DELAY_LINE_INITIAL_CAPACITY);
+
+	// Integer delays, constant and changing, and fractional delay ramps. The frames wrap around the circular buffer many times
+	const float delays[] = { 0, 0, 17, 17, 17, 20.5f, 20.5f, 31.25f, 12.75f, 12, 12, 400, 400, 3.5f, 0, 0 };
+	std::size_t frameNumber = 0;
+	float previousDelay = 0;
+	for (int repetition = 0; repetition < 4; repetition++) {
+		for (float delay : delays) {
+			FillFrame(input, frameNumber++);
+			line.Process(input, output, delay);
+			reference.Write(input);
+			expected = reference.Read(previousDelay, delay);
+			BRT_CHECK(output.size() == frameSize);
+			BRT_CHECK_NEAR(BRTTest::MaximumError(output, expected), 0, tolerance);
+			BRT_CHECK(line.GetDelay() == delay);
+			previousDelay = delay;
+		}
+	}
+	BRT_CHECK(line.GetCapacity() == initialCapacity);
+
+	// A constant integer delay is an exact copy of the input delayed
+	for (int i = 0; i < 3; i++) {
+		FillFrame(input, frameNumber++);
+		line.Process(input, output, 0);
+		reference.Write(input);
+		expected = reference.Read(0, 0);
+	}
+	for (std::size_t i = 0; i < frameSize; i++) BRT_CHECK(output[i] == input[i]);
+
+	// A ramp to a delay longer than the capacity grows the buffer and keeps the history that is still read
+	const float longDelay = static_cast<float>(initialCapacity) + 100;
+	FillFrame(input, frameNumber++);
+	line.Process(input, output, longDelay);
+	reference.Write(input);
+	expected = reference.Read(0, longDelay);
+	BRT_CHECK(line.GetCapacity() > initialCapacity);
+	BRT_CHECK_NEAR(BRTTest::MaximumError(output, expected), 0, tolerance);
+	for (int i = 0; i < 20; i++) {
+		FillFrame(input, frameNumber++);
+		line.Process(input, output, longDelay);
+		reference.Write(input);
+		expected = reference.Read(longDelay, longDelay);
+		BRT_CHECK_NEAR(BRTTest::MaximumError(output, expected), 0, tolerance);
+	}
+
+	// After SkipNextDelayRamp the frame starts directly at its delay
+	line.SkipNextDelayRamp();
+	FillFrame(input, frameNumber++);
+	line.Process(input, output, 40.5f);
+	reference.Write(input);
+	expected = reference.Read(40.5f, 40.5f);
+	BRT_CHECK_NEAR(BRTTest::MaximumError(output, expected), 0, tolerance);
+
+	// Negative delays are clamped to zero
+	FillFrame(input, frameNumber++);
+	line.Process(input, output, -3);
+	reference.Write(input);
+	expected = reference.Read(40.5f, 0);
+	BRT_CHECK_NEAR(BRTTest::MaximumError(output, expected), 0, tolerance);
+	BRT_CHECK(line.GetDelay() == 0);
+
+	// After a reset the line is silent until the delay has passed, and the capacity is kept
+	const std::size_t capacity = line.GetCapacity();
+	line.Reset();
+	BRT_CHECK(line.GetCapacity() == capacity);
+	BRT_CHECK(line.GetDelay() == 0);
+	line.SkipNextDelayRamp();
+	FillFrame(input, 0);
+	line.Process(input, output, 100);
+	for (std::size_t i = 0; i < 100; i++) BRT_CHECK(output[i] == 0.0f);
+	for (std::size_t i = 100; i < frameSize; i++) BRT_CHECK(output[i] == input[i - 100]);
+
+	return BRTTest::Result("FractionalDelayLineTest");
+}
@@ -0,0 +1,205 @@
+// Behaviour test of the audibility culling of CISMEnvironment: budget of rendered image sources, threshold and fade out of the evicted ones
+
+#include <Common/FFTCalculator.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+#include <ServiceModules/Room.hpp>
+#include <EnvironmentModels/ISMEnvironment/ISMEnvironment.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+	const int bufferSize = 256;
+	const int settleFrames = 60;		// Longer than the fade in and fade out of the image sources, about 35 frames
+	const int measureFrames = 30;
+
+	// Two environments with the same room, source and listener, fed with the same noise. The first one renders every visible image source
+	struct TScene {
+		std::shared_ptr<BRTServices::CRoom> room;
+		Common::CTransform source;
+		Common::CTransform listener;
+		BRTEnvironmentModel::CISMEnvironment reference;
+		BRTEnvironmentModel::CISMEnvironment culled;
+		CMultiChannelBuffer<float> referenceOutput;
+		CMultiChannelBuffer<float> culledOutput;
+		std::vector<Common::CTransform> referencePositions;
+		std::vector<Common::CTransform> culledPositions;
+		std::mt19937 generator { 7 };
+
+		TScene() : room { std::make_shared<BRTServices::CRoom>() } {
+			room->SetupShoeBox(8, 6, 3);
+			source.SetPosition(Common::CVector3(1, 0.5, 0.2));
+			listener.SetPosition(Common::CVector3(-1.5, -1, 0));
+			reference.Setup(2, 30, 10, room, source, listener);
+			culled.Setup(2, 30, 10, room, source, listener);
+			const std::size_t n = reference.GetNumberOfImageSources();
+			referenceOutput = CMultiChannelBuffer<float>(n, bufferSize);
+			culledOutput = CMultiChannelBuffer<float>(n, bufferSize);
+			referencePositions.resize(n);
+			culledPositions.resize(n);
+		}
+
+		std::size_t Size() const { return referencePositions.size(); }
+
+		// Process one frame and accumulate the energy of each channel of both outputs
+		void Process(std::vector<double> * referenceEnergy = nullptr, std::vector<double> * culledEnergy = nullptr) {
+			std::uniform_real_distribution<float> noise(-1, 1);
+			CMonoBuffer<float> input(bufferSize);
+			for (float & sample : input) sample = noise(generator);
+			reference.Process(input, source, listener, referenceOutput, referencePositions);
+			culled.Process(input, source, listener, culledOutput, culledPositions);
+			for (std::size_t channel = 0; channel < Size(); channel++) {
+				for (int i = 0; i < bufferSize; i++) {
+					if (referenceEnergy) (*referenceEnergy)[channel] += referenceOutput[channel][i] * referenceOutput[channel][i];
+					if (culledEnergy) (*culledEnergy)[channel] += culledOutput[channel][i] * culledOutput[channel][i];
+				}
+			}
+		}
+
+		// Largest difference between the channels of the culled output that are not silent and the reference output
+		double DifferenceOfRenderedChannels() const {
+			double difference = 0;
+			for (std::size_t channel = 0; channel < Size(); channel++) {
+				for (int i = 0; i < bufferSize; i++) {
+					if (culledOutput[channel][i] == 0) continue;
+					difference = std::max(difference, static_cast<double>(std::fabs(culledOutput[channel][i] - referenceOutput[channel][i])));
+				}
+			}
+			return difference;
+		}
+	};
+
+	std::size_t CountNonSilent(const std::vector<double> & energy) {
+		return static_cast<std::size_t>(std::count_if(energy.begin(), energy.end(), [](double e) { return e > 0; }));
+	}
+
+	// True if every channel that is not silent in the culled output is louder, in the reference output, than every silent one
+	bool KeepsTheLoudest(const std::vector<double> & referenceEnergy, const std::vector<double> & culledEnergy) {
+		double quietestKept = INFINITY;
+		double loudestDropped = 0;
+		for (std::size_t channel = 0; channel < referenceEnergy.size(); channel++) {
+			if (culledEnergy[channel] > 0) {
+				quietestKept = std::min(quietestKept, referenceEnergy[channel]);
+			} else {
+				loudestDropped = std::max(loudestDropped, referenceEnergy[channel]);
+			}
+		}
+		return quietestKept > loudestDropped;
+	}
+
+	void TestWithoutLimits() {
+		TScene scene;
+		BRT_CHECK(scene.culled.GetAudibilityBudget() == 0);
+		BRT_CHECK(std::isinf(scene.culled.GetAudibilityThreshold()) && scene.culled.GetAudibilityThreshold() < 0);
+
+		std::vector<double> referenceEnergy(scene.Size(), 0.0), culledEnergy(scene.Size(), 0.0);
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		for (int frame = 0; frame < measureFrames; frame++) scene.Process(&referenceEnergy, &culledEnergy);
+
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == scene.culled.GetNumberOfVisibleImageSources());
+		BRT_CHECK(CountNonSilent(culledEnergy) == scene.culled.GetNumberOfVisibleImageSources());
+		BRT_CHECK(scene.DifferenceOfRenderedChannels() == 0);
+	}
+
+	void TestBudget() {
+		const std::size_t budget = 6;
+		TScene scene;
+		BRT_CHECK(scene.culled.SetAudibilityBudget(static_cast<int>(budget)));
+		BRT_CHECK(scene.culled.GetAudibilityBudget() == budget);
+
+		std::vector<double> referenceEnergy(scene.Size(), 0.0), culledEnergy(scene.Size(), 0.0);
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		for (int frame = 0; frame < measureFrames; frame++) {
+			scene.Process(&referenceEnergy, &culledEnergy);
+			BRT_CHECK(scene.DifferenceOfRenderedChannels() == 0);
+		}
+
+		BRT_CHECK(scene.culled.GetNumberOfVisibleImageSources() > budget);
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == budget);
+		BRT_CHECK(CountNonSilent(culledEnergy) == budget);
+		BRT_CHECK(KeepsTheLoudest(referenceEnergy, culledEnergy));
+	}
+
+	void TestEvictionFadesOut() {
+		const std::size_t budget = 4;
+		TScene scene;
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		const std::size_t visible = scene.culled.GetNumberOfVisibleImageSources();
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == visible);
+
+		// In the first frame after the budget is reduced, the evicted image sources are still rendered and fading out
+		scene.culled.SetAudibilityBudget(static_cast<int>(budget));
+		std::vector<double> referenceEnergy(scene.Size(), 0.0), culledEnergy(scene.Size(), 0.0);
+		scene.Process(&referenceEnergy, &culledEnergy);
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() > budget);
+		BRT_CHECK(CountNonSilent(culledEnergy) > budget);
+		for (std::size_t channel = 0; channel < scene.Size(); channel++) {
+			BRT_CHECK(culledEnergy[channel] <= referenceEnergy[channel] * (1 + 1e-5));
+		}
+
+		// Once the fade out is over, only the budget is rendered
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		std::fill(referenceEnergy.begin(), referenceEnergy.end(), 0.0);
+		std::fill(culledEnergy.begin(), culledEnergy.end(), 0.0);
+		for (int frame = 0; frame < measureFrames; frame++) scene.Process(&referenceEnergy, &culledEnergy);
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == budget);
+		BRT_CHECK(CountNonSilent(culledEnergy) == budget);
+		BRT_CHECK(KeepsTheLoudest(referenceEnergy, culledEnergy));
+
+		// Without a limit again, the evicted image sources fade in and match the reference
+		scene.culled.SetAudibilityBudget(0);
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == visible);
+		BRT_CHECK(scene.DifferenceOfRenderedChannels() < 1e-6);
+	}
+
+	void TestThreshold() {
+		TScene scene;
+		std::vector<double> referenceEnergy(scene.Size(), 0.0), culledEnergy(scene.Size(), 0.0);
+
+		// A threshold above any image source renders none of them
+		scene.culled.SetAudibilityThreshold(100.0f);
+		BRT_CHECK(scene.culled.GetAudibilityThreshold() == 100.0f);
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		for (int frame = 0; frame < measureFrames; frame++) scene.Process(&referenceEnergy, &culledEnergy);
+		BRT_CHECK(scene.culled.GetNumberOfRenderedImageSources() == 0);
+		BRT_CHECK(CountNonSilent(culledEnergy) == 0);
+
+		// An intermediate threshold keeps only the loudest image sources
+		scene.culled.SetAudibilityThreshold(-14.0f);
+		std::fill(referenceEnergy.begin(), referenceEnergy.end(), 0.0);
+		std::fill(culledEnergy.begin(), culledEnergy.end(), 0.0);
+		for (int frame = 0; frame < settleFrames; frame++) scene.Process();
+		for (int frame = 0; frame < measureFrames; frame++) scene.Process(&referenceEnergy, &culledEnergy);
+		const std::size_t rendered = scene.culled.GetNumberOfRenderedImageSources();
+		BRT_CHECK(rendered > 0 && rendered < scene.culled.GetNumberOfVisibleImageSources());
+		BRT_CHECK(CountNonSilent(culledEnergy) == rendered);
+		BRT_CHECK(KeepsTheLoudest(referenceEnergy, culledEnergy));
+		BRT_CHECK(scene.DifferenceOfRenderedChannels() < 1e-6);
+	}
+
+	void TestInvalidBudget() {
+		Common::CErrorHandler::Instance().SetAssertMode(ASSERT_MODE_CONTINUE);
+		TScene scene;
+		scene.culled.SetAudibilityBudget(5);
+		BRT_CHECK(!scene.culled.SetAudibilityBudget(-1));
+		BRT_CHECK(Common::CErrorHandler::Instance().GetLastResult() == RESULT_ERROR_INVALID_PARAM);
+		BRT_CHECK(scene.culled.GetAudibilityBudget() == 5);
+	}
+}
+
+int main() {
+	Common::CGlobalParameters globalParameters;
+	globalParameters.SetBufferSize(bufferSize);
+	globalParameters.SetSampleRate(48000);
+
+	TestWithoutLimits();
+	TestBudget();
+	TestEvictionFadesOut();
+	TestThreshold();
+	TestInvalidBudget();
+	return BRTTest::Result("ISMAudibilityTest");
+}
@@ -0,0 +1,99 @@
+// Behaviour test of CMultiTapDelayLine: several taps with their own delay ramps, wrap-around of the circular buffer and growth of its capacity
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <Common/MultiTapDelayLine.hpp>
+#include "TestCheck.hpp"
+#include "DelayLineReference.hpp"
+
+namespace {
+	const std::size_t frameSize = 256;
+
+	void FillFrame(CMonoBuffer<float> & frame, std::size_t frameNumber) {
+		BRTTest::FillDelayLineFrame(frame, frameSize, frameNumber);
+	}
+
+	// Delay of a tap in a frame: still, ramping slowly, ramping fast in both directions and jumping
+	float TapDelay(std::size_t tap, std::size_t frame) {
+		switch (tap) {
+		case 0: return 100;
+		case 1: return 50.0f + 0.37f * static_cast<float>(frame);
+		case 2: return 300.0f + 200.0f * static_cast<float>(std::sin(0.2 * static_cast<double>(frame)));
+		default: return frame % 20 < 10 ? 12.5f : 900.25f;
+		}
+	}
+}
+
+int main() {
+	const double tolerance = 1.0e-5;
+	const std::size_t numberOfTaps = 4;
+	Common::CMultiTapDelayLine line;
+	line.SetNumberOfTaps(numberOfTaps);
+	BRT_CHECK(line.GetNumberOfTaps() == numberOfTaps);
+	const std::size_t initialCapacity = line.GetCapacity();
+
+	BRTTest::CReferenceDelayLine reference;
+	CMonoBuffer<float> input, output;
+	std::vector<float> previousDelays(numberOfTaps);
+	std::size_t frameNumber = 0;
+
+	// Every tap follows its own delay, ramped along each frame from the delay of the previous one. The first read starts at its delay.
+	// The frames wrap around the circular buffer many times
+	for (; frameNumber < 200; frameNumber++) {
+		FillFrame(input, frameNumber);
+		line.Write(input);
+		reference.Write(input);
+		for (std::size_t tap = 0; tap < numberOfTaps; tap++) {
+			const float delay = TapDelay(tap, frameNumber);
+			const float startDelay = frameNumber == 0 ? delay : previousDelays[tap];
+			line.ReadTap(tap, output, delay);
+			BRT_CHECK_NEAR(BRTTest::MaximumError(output, reference.Read(startDelay, delay)), 0, tolerance);
+			BRT_CHECK(line.GetTapDelay(tap) == delay);
+			previousDelays[tap] = delay;
+		}
+	}
+	BRT_CHECK(line.GetCapacity() == initialCapacity);
+
+	// A constant integer delay is an exact copy of the input delayed
+	FillFrame(input, frameNumber++);
+	line.Write(input);
+	reference.Write(input);
+	line.ReadTap(0, output, 100);
+	const std::vector<double> expected = reference.Read(100, 100);
+	for (std::size_t i = 0; i < frameSize; i++) BRT_CHECK(output[i] == static_cast<float>(expected[i]));
+
+	// A tap that is reset starts at its new delay. Its delay then grows beyond the capacity, which grows keeping the history that is read
+	const float longDelay = static_cast<float>(initialCapacity) + 500;
+	float delay = 3000, startDelay = 3000;
+	line.ResetTap(3);
+	for (int frame = 0; frame < 20; frame++, frameNumber++) {
+		FillFrame(input, frameNumber);
+		line.Write(input);
+		reference.Write(input);
+		line.ReadTap(3, output, delay);
+		BRT_CHECK_NEAR(BRTTest::MaximumError(output, reference.Read(startDelay, delay)), 0, tolerance);
+		startDelay = delay;
+		delay = std::min(delay + 150, longDelay);
+	}
+	BRT_CHECK(line.GetCapacity() > initialCapacity);
+
+	// Reading a tap that does not exist reports an error and leaves the output untouched
+	Common::CErrorHandler::Instance().SetAssertMode(ASSERT_MODE_CONTINUE);
+	output.assign(3, 1.0f);
+	line.ReadTap(numberOfTaps, output, 10);
+	BRT_CHECK(Common::CErrorHandler::Instance().GetLastResult() == RESULT_ERROR_OUTOFRANGE);
+	BRT_CHECK(output.size() == 3 && output[0] == 1.0f);
+
+	// After a reset the line is silent, the taps start at their delay and the capacity is kept
+	const std::size_t capacity = line.GetCapacity();
+	line.Reset();
+	BRT_CHECK(line.GetCapacity() == capacity);
+	FillFrame(input, 0);
+	line.Write(input);
+	line.ReadTap(1, output, 64);
+	for (std::size_t i = 0; i < 64; i++) BRT_CHECK(output[i] == 0.0f);
+	for (std::size_t i = 64; i < frameSize; i++) BRT_CHECK(output[i] == input[i - 64]);
+
+	return BRTTest::Result("MultiTapDelayLineTest");
+}
@@ -0,0 +1,128 @@
+// Benchmark of CMultichannelBiquadFilterChain against one CBiquadFilterChain per channel. It checks that both give the same output,
+// also while the coefficients change, and prints the time per frame of each one for several numbers of channels
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <ProcessingModules/MultichannelBiquadFilterChain.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+	const int frameSize = 256;
+	const int numberOfSections = 3;
+	const int framesPerRun = 2000;
+	const int numberOfRuns = 15;		// The fastest run is reported
+
+	std::vector<float> GetCoefficients(int channel, int version) {
+		std::vector<float> coefficients;
+		for (int s = 0; s < numberOfSections; s++) {
+			const float shift = 0.02f * static_cast<float>(channel % 5) + 0.05f * static_cast<float>(version);
+			coefficients.insert(coefficients.end(), { 0.2f + 0.05f * s, 0.1f, 0.05f + shift, 1.0f, -0.6f + 0.1f * s + shift, 0.2f });
+		}
+		return coefficients;
+	}
+
+	// The same channels filtered by one CBiquadFilterChain per channel and by a CMultichannelBiquadFilterChain
+	struct TChains {
+		std::vector<BRTProcessing::CBiquadFilterChain> perChannel;
+		BRTProcessing::CMultichannelBiquadFilterChain multichannel;
+		std::vector<CMonoBuffer<float>> input;
+		std::vector<CMonoBuffer<float>> perChannelOutput;
+		std::vector<CMonoBuffer<float>> multichannelOutput;
+
+		explicit TChains(int numberOfChannels)
+			: perChannel(numberOfChannels)
+			, input(numberOfChannels, CMonoBuffer<float>(frameSize))
+			, perChannelOutput(numberOfChannels, CMonoBuffer<float>(frameSize))
+			, multichannelOutput(numberOfChannels, CMonoBuffer<float>(frameSize)) {
+			multichannel.Setup(numberOfChannels, numberOfSections);
+			SetCoefficients(0);
+			for (int c = 0; c < numberOfChannels; c++) {
+				for (int i = 0; i < frameSize; i++) input[c][i] = static_cast<float>(std::sin(0.01 * i * (c + 1)) + 0.3 * std::sin(0.7 * i));
+			}
+		}
+
+		int Size() const { return static_cast<int>(perChannel.size()); }
+
+		void SetCoefficients(int version) {
+			for (int c = 0; c < Size(); c++) {
+				const std::vector<float> coefficients = GetCoefficients(c, version);
+				perChannel[c].SetFromCoefficientsArray(coefficients.data(), numberOfSections, 6);
+				multichannel.SetCoefficients(c, coefficients);
+			}
+		}
+
+		void ProcessPerChannel() {
+			for (int c = 0; c < Size(); c++) {
+				perChannelOutput[c] = input[c];
+				perChannel[c].Process(perChannelOutput[c]);
+			}
+		}
+
+		// Binaural chains use the two ear overload, the rest the one for all the channels
+		void ProcessMultichannel() {
+			if (Size() == 2) {
+				multichannel.Process(input[0], multichannelOutput[0], input[1], multichannelOutput[1]);
+			} else {
+				multichannel.Process(input, multichannelOutput);
+			}
+		}
+
+		double MaximumDifference() const {
+			double difference = 0;
+			for (int c = 0; c < Size(); c++) {
+				for (int i = 0; i < frameSize; i++) difference = std::max(difference, static_cast<double>(std::abs(perChannelOutput[c][i] - multichannelOutput[c][i])));
+			}
+			return difference;
+		}
+	};
+
+	template <typename TProcess>
+	double GetMicrosecondsPerFrame(TProcess process) {
+		double fastest = 0;
+		for (int run = 0; run < numberOfRuns; run++) {
+			const auto start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < framesPerRun; frame++) process();
+			const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / framesPerRun;
+			fastest = run == 0 ? elapsed : std::min(fastest, elapsed);
+		}
+		return fastest;
+	}
+
+	void TestSameOutput(int numberOfChannels, BRTProcessing::TBiquadTransition transition) {
+		TChains chains(numberOfChannels);
+		for (BRTProcessing::CBiquadFilterChain & chain : chains.perChannel) chain.SetTransitionMode(transition);
+		chains.multichannel.SetTransitionMode(transition);
+		for (int frame = 0; frame < 12; frame++) {
+			if (frame % 4 == 2) chains.SetCoefficients(frame);
+			chains.ProcessPerChannel();
+			chains.ProcessMultichannel();
+			BRT_CHECK(chains.MaximumDifference() == 0);
+		}
+	}
+
+	void Benchmark(int numberOfChannels) {
+		TChains chains(numberOfChannels);
+		const double perChannelTime = GetMicrosecondsPerFrame([&]() { chains.ProcessPerChannel(); });
+		const double multichannelTime = GetMicrosecondsPerFrame([&]() { chains.ProcessMultichannel(); });
+		std::printf("%2d channels x %d sections x %d samples: per channel %7.2f us, multichannel %7.2f us (x%.2f)\n", numberOfChannels,
+			numberOfSections, frameSize, perChannelTime, multichannelTime, perChannelTime / multichannelTime);
+	}
+}
+
+int main() {
+	Common::CGlobalParameters globalParameters;
+	globalParameters.SetBufferSize(frameSize);
+
+	for (int numberOfChannels : { 1, 2, 3, 8, 19 }) {
+		TestSameOutput(numberOfChannels, BRTProcessing::CROSSFADING);
+		TestSameOutput(numberOfChannels, BRTProcessing::COEFFICIENTS_INTERPOLATION);
+	}
+	for (int numberOfChannels : { 1, 2, 4, 8, 16 }) {
+		Benchmark(numberOfChannels);
+	}
+	return BRTTest::Result("MultichannelBiquadBenchmark");
+}
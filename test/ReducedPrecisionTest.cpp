@@ -0,0 +1,108 @@
+// Behaviour test of CReducedPrecision: round trip, rounding to the nearest even value, saturation and NaN of float16 and bfloat16
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <Common/ReducedPrecision.hpp>
+#include "TestCheck.hpp"
+
+using Common::CReducedPrecision;
+using Common::TSpectralPrecision;
+
+int main() {
+	// Every finite half value, normal or subnormal, survives the round trip bit for bit. Infinities saturate, NaN stays NaN
+	int halfRoundTripErrors = 0;
+	for (uint32_t bits = 0; bits <= 0xffffu; bits++) {
+		const uint16_t half = static_cast<uint16_t>(bits);
+		const float value = CReducedPrecision::HalfToFloat(half);
+		const uint16_t exponent = half & 0x7c00u;
+		if (exponent != 0x7c00u) {
+			if (CReducedPrecision::FloatToHalf(value) != half) halfRoundTripErrors++;
+		} else if ((half & 0x03ffu) != 0) {
+			BRT_CHECK(std::isnan(value));
+			BRT_CHECK(std::isnan(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(value))));
+		} else {
+			BRT_CHECK(std::isinf(value));
+			BRT_CHECK(std::abs(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(value))) == 65504.0f);
+		}
+	}
+	BRT_CHECK(halfRoundTripErrors == 0);
+
+	// Every bfloat16 value that is not NaN survives the round trip bit for bit
+	int bfloatRoundTripErrors = 0;
+	for (uint32_t bits = 0; bits <= 0xffffu; bits++) {
+		const uint16_t bfloat = static_cast<uint16_t>(bits);
+		const float value = CReducedPrecision::BFloat16ToFloat(bfloat);
+		if (std::isnan(value)) {
+			BRT_CHECK(std::isnan(CReducedPrecision::BFloat16ToFloat(CReducedPrecision::FloatToBFloat16(value))));
+		} else if (CReducedPrecision::FloatToBFloat16(value) != bfloat) {
+			bfloatRoundTripErrors++;
+		}
+	}
+	BRT_CHECK(bfloatRoundTripErrors == 0);
+
+	// Random values are rounded to the nearest representable value, within the relative error bound
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<float> mantissaDistribution(1.0f, 2.0f);
+	std::uniform_int_distribution<int> exponentDistribution(-14, 15);
+	std::vector<float> values;
+	for (int i = 0; i < 100000; i++) {
+		const float value = std::ldexp(mantissaDistribution(generator), exponentDistribution(generator));
+		values.push_back(i % 2 == 0 ? value : -value);
+	}
+	const float halfBound = CReducedPrecision::GetRelativeErrorBound(TSpectralPrecision::float16);
+	const float bfloatBound = CReducedPrecision::GetRelativeErrorBound(TSpectralPrecision::bfloat16);
+	int halfRoundingErrors = 0, bfloatRoundingErrors = 0;
+	for (float value : values) {
+		const uint16_t half = CReducedPrecision::FloatToHalf(value);
+		const float halfValue = CReducedPrecision::HalfToFloat(half);
+		const float halfNeighbourDown = CReducedPrecision::HalfToFloat(static_cast<uint16_t>(half - 1));
+		const float halfNeighbourUp = CReducedPrecision::HalfToFloat(static_cast<uint16_t>(half + 1));
+		if (std::abs(halfValue - value) > halfBound * std::abs(value)
+			|| std::abs(halfValue - value) > std::abs(halfNeighbourDown - value)
+			|| (!std::isinf(halfNeighbourUp) && std::abs(halfValue - value) > std::abs(halfNeighbourUp - value))) {
+			halfRoundingErrors++;
+		}
+		const uint16_t bfloat = CReducedPrecision::FloatToBFloat16(value);
+		const float bfloatValue = CReducedPrecision::BFloat16ToFloat(bfloat);
+		if (std::abs(bfloatValue - value) > bfloatBound * std::abs(value)
+			|| std::abs(bfloatValue - value) > std::abs(CReducedPrecision::BFloat16ToFloat(static_cast<uint16_t>(bfloat - 1)) - value)
+			|| std::abs(bfloatValue - value) > std::abs(CReducedPrecision::BFloat16ToFloat(static_cast<uint16_t>(bfloat + 1)) - value)) {
+			bfloatRoundingErrors++;
+		}
+	}
+	BRT_CHECK(halfRoundingErrors == 0);
+	BRT_CHECK(bfloatRoundingErrors == 0);
+
+	// Ties are rounded to the even value
+	BRT_CHECK(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(1.0f + std::ldexp(1.0f, -11))) == 1.0f);
+	BRT_CHECK(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(1.0f + 3 * std::ldexp(1.0f, -11))) == 1.0f + std::ldexp(1.0f, -9));
+	BRT_CHECK(CReducedPrecision::BFloat16ToFloat(CReducedPrecision::FloatToBFloat16(1.0f + std::ldexp(1.0f, -8))) == 1.0f);
+	BRT_CHECK(CReducedPrecision::BFloat16ToFloat(CReducedPrecision::FloatToBFloat16(1.0f + 3 * std::ldexp(1.0f, -8))) == 1.0f + std::ldexp(1.0f, -6));
+
+	// Half precision saturates large values and keeps small ones within its absolute error
+	BRT_CHECK(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(1.0e6f)) == 65504.0f);
+	BRT_CHECK(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(-1.0e6f)) == -65504.0f);
+	BRT_CHECK_NEAR(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(1.0e-6f)), 1.0e-6, 3.0e-8);
+	BRT_CHECK(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(1.0e-9f)) == 0.0f);
+	BRT_CHECK(std::isnan(CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+	BRT_CHECK(std::isnan(CReducedPrecision::BFloat16ToFloat(CReducedPrecision::FloatToBFloat16(std::numeric_limits<float>::quiet_NaN()))));
+
+	// Buffers are converted as the single values
+	for (TSpectralPrecision precision : { TSpectralPrecision::float16, TSpectralPrecision::bfloat16 }) {
+		std::vector<uint16_t> encoded(values.size());
+		std::vector<float> decoded(values.size());
+		CReducedPrecision::Encode(values.data(), encoded.data(), values.size(), precision);
+		CReducedPrecision::Decode(encoded.data(), decoded.data(), values.size(), precision);
+		int bufferErrors = 0;
+		for (size_t i = 0; i < values.size(); i++) {
+			const float expected = precision == TSpectralPrecision::float16 ? CReducedPrecision::HalfToFloat(CReducedPrecision::FloatToHalf(values[i]))
+				: CReducedPrecision::BFloat16ToFloat(CReducedPrecision::FloatToBFloat16(values[i]));
+			if (decoded[i] != expected) bufferErrors++;
+		}
+		BRT_CHECK(bufferErrors == 0);
+	}
+
+	return BRTTest::Result("ReducedPrecisionTest");
+}
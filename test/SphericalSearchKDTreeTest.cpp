@@ -0,0 +1,116 @@
+// Behaviour test of CSphericalSearchKDTree: nearest, k nearest, radius and batch queries against a brute force search
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <ServiceModules/SphericalSearchKDTree.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+	struct TTestOrientation {
+		double azimuth;
+		double elevation;
+		TTestOrientation(double _azimuth, double _elevation) : azimuth { _azimuth }, elevation { _elevation } { }
+	};
+
+	// Angular distance in degrees, with the elevation in [0, 90] U [270, 360)
+	double AngularDistance(double azimuth1, double elevation1, double azimuth2, double elevation2) {
+		const double toRadians = 3.14159265358979323846 / 180.0;
+		if (elevation1 >= 270) elevation1 -= 360;
+		if (elevation2 >= 270) elevation2 -= 360;
+		const double cosine = std::sin(elevation1 * toRadians) * std::sin(elevation2 * toRadians)
+			+ std::cos(elevation1 * toRadians) * std::cos(elevation2 * toRadians) * std::cos((azimuth1 - azimuth2) * toRadians);
+		return std::acos(std::max(-1.0, std::min(1.0, cosine))) / toRadians;
+	}
+
+	double ToWrappedElevation(double elevation) { return elevation < 0 ? elevation + 360 : elevation; }
+}
+
+int main() {
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> azimuthDistribution(0, 360), elevationDistribution(-90, 90);
+
+	std::vector<TTestOrientation> orientations;
+	for (int i = 0; i < 2000; i++) {
+		orientations.emplace_back(azimuthDistribution(generator), ToWrappedElevation(elevationDistribution(generator)));
+	}
+	BRTServices::CSphericalSearchKDTree<TTestOrientation> tree;
+	tree.build(orientations);
+	BRT_CHECK(tree.size() == orientations.size());
+
+	const double tolerance = 0.01; // Degrees, the tree compares unit vectors in single precision
+	std::vector<TTestOrientation> queries;
+	for (int q = 0; q < 200; q++) {
+		const TTestOrientation query(azimuthDistribution(generator), ToWrappedElevation(elevationDistribution(generator)));
+		queries.push_back(query);
+
+		std::vector<double> distances;
+		for (const TTestOrientation & orientation : orientations) {
+			distances.push_back(AngularDistance(query.azimuth, query.elevation, orientation.azimuth, orientation.elevation));
+		}
+		std::vector<double> sortedDistances = distances;
+		std::sort(sortedDistances.begin(), sortedDistances.end());
+
+		// Nearest
+		const TTestOrientation nearest = tree.nearest(query.azimuth, query.elevation);
+		BRT_CHECK_NEAR(AngularDistance(query.azimuth, query.elevation, nearest.azimuth, nearest.elevation), sortedDistances[0], tolerance);
+		const int nearestIndex = tree.nearestIndex(query.azimuth, query.elevation);
+		BRT_CHECK(nearestIndex >= 0 && nearestIndex < static_cast<int>(orientations.size()));
+		if (nearestIndex >= 0) BRT_CHECK_NEAR(distances[nearestIndex], sortedDistances[0], tolerance);
+
+		// k nearest, sorted from the nearest one
+		const size_t k = 7;
+		const std::vector<TTestOrientation> kNearest = tree.kNearest(query.azimuth, query.elevation, k);
+		BRT_CHECK(kNearest.size() == k);
+		for (size_t i = 0; i < kNearest.size(); i++) {
+			BRT_CHECK_NEAR(AngularDistance(query.azimuth, query.elevation, kNearest[i].azimuth, kNearest[i].elevation), sortedDistances[i], tolerance);
+		}
+
+		// Within radius, apart from the orientations right on the border
+		const double radius = 6;
+		const std::vector<TTestOrientation> inside = tree.withinRadius(query.azimuth, query.elevation, radius);
+		size_t surelyInside = 0, maybeInside = 0;
+		for (double distance : distances) {
+			if (distance < radius - tolerance) surelyInside++;
+			if (distance <= radius + tolerance) maybeInside++;
+		}
+		BRT_CHECK(inside.size() >= surelyInside && inside.size() <= maybeInside);
+		for (const TTestOrientation & orientation : inside) {
+			BRT_CHECK(AngularDistance(query.azimuth, query.elevation, orientation.azimuth, orientation.elevation) <= radius + tolerance);
+		}
+	}
+
+	// Batch queries give the same results as single queries
+	std::vector<TTestOrientation> batchResults;
+	tree.nearest(queries, batchResults);
+	BRT_CHECK(batchResults.size() == queries.size());
+	for (size_t q = 0; q < queries.size() && q < batchResults.size(); q++) {
+		const TTestOrientation single = tree.nearest(queries[q].azimuth, queries[q].elevation);
+		BRT_CHECK(single.azimuth == batchResults[q].azimuth && single.elevation == batchResults[q].elevation);
+	}
+
+	// Exact points are found, also across the azimuth wrap and at the poles
+	BRTServices::CSphericalSearchKDTree<TTestOrientation> grid;
+	std::vector<TTestOrientation> gridOrientations;
+	for (int elevation = -90; elevation <= 90; elevation += 15) {
+		for (int azimuth = 0; azimuth < 360; azimuth += 15) {
+			gridOrientations.emplace_back(azimuth, ToWrappedElevation(elevation));
+			if (elevation == -90 || elevation == 90) break;
+		}
+	}
+	grid.build(gridOrientations);
+	const TTestOrientation wrapped = grid.nearest(359, 0);
+	BRT_CHECK(wrapped.azimuth == 0 && wrapped.elevation == 0);
+	const TTestOrientation pole = grid.nearest(123, 89);
+	BRT_CHECK(pole.elevation == 90);
+
+	// Fewer orientations than requested, and an empty tree
+	BRT_CHECK(grid.kNearest(0, 0, gridOrientations.size() + 10).size() == gridOrientations.size());
+	BRTServices::CSphericalSearchKDTree<TTestOrientation> empty;
+	BRT_CHECK(empty.empty());
+	BRT_CHECK(empty.nearestIndex(10, 10) == -1);
+	BRT_CHECK(empty.kNearest(10, 10, 3).empty());
+	BRT_CHECK(empty.withinRadius(10, 10, 30).empty());
+
+	return BRTTest::Result("SphericalSearchKDTreeTest");
+}
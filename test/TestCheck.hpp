@@ -0,0 +1,60 @@
+/**
+* \brief Minimal checks shared by the behaviour tests
+* \details Each test is a standalone program, built with include/ in the include path, that prints the failed checks and returns
+* a non-zero code if any of them fails.
+* \date	October 2026
+*
+* \authors 3DI-DIANA Research Group (University of Malaga), in alphabetical order: M. Cuevas-Rodriguez, D. Gonzalez-Toledo, L. Molina-Tanco, F. Morales-Benitez ||
+* Coordinated by , A. Reyes-Lecuona (University of Malaga)||
+* \b Contact: areyes@uma.es
+*
+* \b Copyright: University of Malaga
+*
+* \b Contributions: (additional authors/contributors can be added here)
+*
+* \b Project: SONICOM (https://www.sonicom.eu/) ||
+*
+* \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreement no. 101017743
+*
+* This file is part of the Binaural Rendering Toolbox (BRT), coordinated by A. Reyes-Lecuona (areyes@uma.es) and L. Picinali (l.picinali@imperial.ac.uk)
+*
+* \b Licence: This program is free software, you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+*/
+
+#ifndef _BRT_TEST_CHECK_HPP_
+#define _BRT_TEST_CHECK_HPP_
+
+#include <cmath>
+#include <cstdio>
+
+namespace BRTTest {
+	inline int & FailedChecks() {
+		static int failedChecks = 0;
+		return failedChecks;
+	}
+
+	/// Print the result of the test and get the exit code of the program
+	inline int Result(const char * testName) {
+		std::printf("%s: %s (%d failed checks)\n", testName, FailedChecks() == 0 ? "passed" : "FAILED", FailedChecks());
+		return FailedChecks() == 0 ? 0 : 1;
+	}
+}
+
+#define BRT_CHECK(condition)																			\
+	do {																								\
+		if (!(condition)) {																				\
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);				\
+			BRTTest::FailedChecks()++;																	\
+		}																								\
+	} while (0)
+
+#define BRT_CHECK_NEAR(value, expected, tolerance)														\
+	do {																								\
+		const double _value = (value), _expected = (expected);										\
+		if (!(std::abs(_value - _expected) <= (tolerance))) {										\
+			std::printf("%s:%d: check failed: %s = %.9g, expected %.9g\n", __FILE__, __LINE__, #value, _value, _expected); \
+			BRTTest::FailedChecks()++;																	\
+		}																								\
+	} while (0)
+
+#endif
@@ -0,0 +1,138 @@
+// Behaviour test of CWaveguide: propagation delay of static and moving sources and listeners, wrap-around and growth of the ring buffer
+
+#include <cstddef>
+#include <vector>
+#include <Common/Waveguide.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+	const std::size_t frameSize = 256;
+
+	// Keeps every sample pushed into the waveguide
+	class CInputHistory {
+	public:
+		void FillFrame(CMonoBuffer<float> & frame) {
+			frame.resize(frameSize);
+			for (std::size_t i = 0; i < frameSize; i++) {
+				const double t = static_cast<double>(samples.size());
+				frame[i] = static_cast<float>(0.7 * std::sin(0.011 * t) + 0.2 * std::sin(0.29 * t));
+				samples.push_back(frame[i]);
+			}
+		}
+
+		// True if the frame is the last frame pushed, delayed exactly by the given number of samples
+		bool IsDelayedLastFrame(const CMonoBuffer<float> & frame, std::size_t delay) const {
+			if (frame.size() != frameSize) return false;
+			for (std::size_t i = 0; i < frameSize; i++) {
+				const long index = static_cast<long>(samples.size() - frameSize + i) - static_cast<long>(delay);
+				if (frame[i] != (index < 0 ? 0.0f : samples[index])) return false;
+			}
+			return true;
+		}
+
+		// True if the frame is the last frame pushed, delayed by a whole number of samples within one sample of the given delay. The
+		// waveguide rounds the delay to whole samples, and which neighbour it ends on depends on how the distance was reached
+		bool IsDelayedLastFrameNear(const CMonoBuffer<float> & frame, double delay) const {
+			for (double candidate = std::floor(delay) - 1; candidate <= std::ceil(delay) + 1; candidate++) {
+				if (candidate >= 0 && IsDelayedLastFrame(frame, static_cast<std::size_t>(candidate))) return true;
+			}
+			return false;
+		}
+
+	private:
+		std::vector<float> samples;
+	};
+
+	double DelayInSamples(float distance, const Common::CGlobalParameters & globalParameters) {
+		return distance * globalParameters.GetSampleRate() / globalParameters.GetSoundSpeed();
+	}
+}
+
+int main() {
+	Common::CGlobalParameters globalParameters;
+	globalParameters.SetBufferSize(frameSize);
+	globalParameters.SetSampleRate(48000);
+	globalParameters.SetSoundSpeed(343);
+
+	CMonoBuffer<float> input, output;
+	Common::CVector3 emittedPosition;
+
+	// Without propagation delay the frame and the source position are passed through
+	{
+		Common::CWaveguide waveguide;
+		CInputHistory history;
+		history.FillFrame(input);
+		waveguide.PushBack(input, Common::CVector3(5, 1, 0), Common::CVector3(0, 0, 0));
+		waveguide.PopFront(output, Common::CVector3(0, 0, 0), emittedPosition);
+		BRT_CHECK(history.IsDelayedLastFrame(output, 0));
+		BRT_CHECK(emittedPosition == Common::CVector3(5, 1, 0));
+	}
+
+	Common::CWaveguide waveguide;
+	waveguide.SetMaximumDistance(2);	// Shorter than the distances below, so the ring buffer has to grow
+	waveguide.EnablePropagationDelay();
+	BRT_CHECK(waveguide.IsPropagationDelayEnabled());
+	CInputHistory history;
+	const Common::CVector3 listener(0, 0, 0);
+
+	// Static source. After the first frames, every frame is the input delayed by the propagation time, also while the ring wraps around
+	Common::CVector3 source(3.43f, 0, 0);
+	bool staticDelayIsExact = true;
+	for (int frame = 0; frame < 400; frame++) {
+		history.FillFrame(input);
+		waveguide.PushBack(input, source, listener);
+		waveguide.PopFront(output, listener, emittedPosition);
+		BRT_CHECK(output.size() == frameSize);
+		if (frame >= 2) staticDelayIsExact &= history.IsDelayedLastFrame(output, 480); // 3.43 m at 343 m/s and 48 kHz
+	}
+	BRT_CHECK(staticDelayIsExact);
+	BRT_CHECK(emittedPosition == source);
+
+	// The source jumps further away. The output is stretched while the gap is filled and then settles on the new delay
+	source = Common::CVector3(10, 0, 0);
+	bool movingOutputIsBounded = true;
+	bool newDelayIsExact = true;
+	for (int frame = 0; frame < 60; frame++) {
+		history.FillFrame(input);
+		waveguide.PushBack(input, source, listener);
+		waveguide.PopFront(output, listener, emittedPosition);
+		BRT_CHECK(output.size() == frameSize);
+		for (float sample : output) movingOutputIsBounded &= std::abs(sample) <= 1.0f;
+		if (frame >= 10) newDelayIsExact &= history.IsDelayedLastFrameNear(output, DelayInSamples(10, globalParameters));
+	}
+	BRT_CHECK(movingOutputIsBounded);
+	BRT_CHECK(newDelayIsExact);
+	BRT_CHECK(emittedPosition == source);
+
+	// The listener moves slowly towards the source (Doppler). The output stays continuous and ends on the delay of the new distance
+	Common::CVector3 movingListener = listener;
+	float previousSample = output.back();
+	float largestStep = 0;
+	for (int frame = 0; frame < 100; frame++) {
+		if (frame < 50) movingListener.x += 0.05f;
+		history.FillFrame(input);
+		waveguide.PushBack(input, source, movingListener);
+		waveguide.PopFront(output, movingListener, emittedPosition);
+		BRT_CHECK(output.size() == frameSize);
+		for (float sample : output) {
+			largestStep = std::max(largestStep, std::abs(sample - previousSample));
+			previousSample = sample;
+		}
+	}
+	// The input changes by less than 0.07 per sample, the compression of the frame can only increase that slightly
+	BRT_CHECK(largestStep < 0.1f);
+	BRT_CHECK(history.IsDelayedLastFrameNear(output, DelayInSamples(source.x - movingListener.x, globalParameters)));
+
+	// After a reset the waveguide starts again from silence, with the same delay
+	waveguide.Reset();
+	BRT_CHECK(waveguide.IsPropagationDelayEnabled());
+	CInputHistory newHistory;
+	for (int frame = 0; frame < 20; frame++) {
+		newHistory.FillFrame(input);
+		waveguide.PushBack(input, source, movingListener);
+		waveguide.PopFront(output, movingListener, emittedPosition);
+	}
+	BRT_CHECK(newHistory.IsDelayedLastFrameNear(output, DelayInSamples(source.x - movingListener.x, globalParameters)));
+
+	return BRTTest::Result("WaveguideTest");
+}